@@ -0,0 +1,183 @@
+/**
+ * @brief Reproducible graph generators for the benchmark suite.
+ */
+
+#include "generators.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Next value of a splitmix64 stream
+ * @param state Stream state, advanced by the call
+ * @return Pseudo-random 64-bit value
+ */
+uint64_t benchRandom(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Uniform double in [0, 1) from a splitmix64 stream
+ */
+double benchUniform(uint64_t *state) {
+    return (double)(benchRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Set up an empty workload with room for the given number of edges
+ */
+static int initBench(struct benchgraph_t *bg, const char *name, size_t nodecount, size_t edgecap) {
+    memset(bg, 0, sizeof(struct benchgraph_t));
+    bg->name = name;
+    bg->nodecount = nodecount;
+    bg->edges = (struct benchedge_t *)malloc((edgecap > 0 ? edgecap : 1) * sizeof(struct benchedge_t));
+    return bg->edges != NULL;
+}
+
+/**
+ * @brief Append an edge with a random capacity
+ */
+static void pushEdge(struct benchgraph_t *bg, size_t u, size_t v, uint64_t *state) {
+    struct benchedge_t *e = &bg->edges[bg->edgecount++];
+    e->u = u;
+    e->v = v;
+    e->cap = 1.0 + 99.0 * benchUniform(state);
+}
+
+/**
+ * @brief Generate a 2D or 3D grid, connecting each node to its next neighbor along every dimension.
+ *
+ * @param bg Workload to be filled
+ * @param dimcount 2 or 3
+ * @param side Extent along every dimension
+ * @param seed Seed for the capacities
+ * @return 1 if successful; otherwise, 0.
+ */
+int genGrid(struct benchgraph_t *bg, size_t dimcount, size_t side, uint64_t seed) {
+    if ((dimcount != 2 && dimcount != 3) || side == 0) return 0;
+    size_t n = side * side * (dimcount == 3 ? side : 1);
+    if (!initBench(bg, dimcount == 2 ? "grid2d" : "grid3d", n, n * dimcount)) return 0;
+    bg->dimcount = dimcount;
+    size_t stride[3] = { 1, side, side * side };
+    for (size_t k = 0; k < dimcount; k++) bg->dimarr[k] = side;
+    uint64_t state = seed;
+    for (size_t p = 0; p < n; p++) {
+        for (size_t k = 0; k < dimcount; k++) {
+            if ((p / stride[k]) % side + 1 < side) pushEdge(bg, p, p + stride[k], &state);
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Generate an R-MAT (stochastic Kronecker) graph.
+ *
+ * @param bg Workload to be filled
+ * @param scale log2 of the node count
+ * @param edgefactor Edges per node
+ * @param a Probability of the top-left quadrant
+ * @param b Probability of the top-right quadrant
+ * @param c Probability of the bottom-left quadrant
+ * @param seed Seed
+ * @return 1 if successful; otherwise, 0.
+ */
+int genRmat(struct benchgraph_t *bg, size_t scale, size_t edgefactor, double a, double b, double c, uint64_t seed) {
+    if (scale == 0 || scale >= 8 * sizeof(size_t)) return 0;
+    size_t n = (size_t)1 << scale;
+    size_t m = n * edgefactor;
+    if (!initBench(bg, "rmat", n, m)) return 0;
+    uint64_t state = seed;
+    while (bg->edgecount < m) {
+        size_t u = 0, v = 0;
+        for (size_t bit = 0; bit < scale; bit++) {
+            double r = benchUniform(&state);
+            size_t ubit = (r >= a + b);
+            size_t vbit = (r >= a && r < a + b) || (r >= a + b + c);
+            u = (u << 1) | ubit;
+            v = (v << 1) | vbit;
+        }
+        if (u != v) pushEdge(bg, u, v, &state);
+    }
+    return 1;
+}
+
+/**
+ * @brief Generate an Erdos-Renyi G(n, m) graph
+ *
+ * @param bg Workload to be filled
+ * @param n Node count
+ * @param m Edge count
+ * @param seed Seed
+ * @return 1 if successful; otherwise, 0.
+ */
+int genErdosRenyi(struct benchgraph_t *bg, size_t n, size_t m, uint64_t seed) {
+    if (n < 2) return 0;
+    if (!initBench(bg, "erdosrenyi", n, m)) return 0;
+    uint64_t state = seed;
+    while (bg->edgecount < m) {
+        size_t u = (size_t)(benchRandom(&state) % n);
+        size_t v = (size_t)(benchRandom(&state) % n);
+        if (u != v) pushEdge(bg, u, v, &state);
+    }
+    return 1;
+}
+
+/**
+ * @brief Pick a node by weight, from the cumulative weights
+ */
+static size_t pickWeighted(const double *cumulative, size_t n, double r) {
+    double target = r * cumulative[n - 1];
+    size_t lo = 0, hi = n - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cumulative[mid] > target) hi = mid; else lo = mid + 1;
+    }
+    return lo;
+}
+
+/**
+ * @brief Generate a power-law graph with the Chung-Lu model.
+ *
+ * @param bg Workload to be filled
+ * @param n Node count
+ * @param m Edge count
+ * @param exponent Degree distribution exponent
+ * @param seed Seed
+ * @return 1 if successful; otherwise, 0.
+ */
+int genPowerLaw(struct benchgraph_t *bg, size_t n, size_t m, double exponent, uint64_t seed) {
+    if (n < 2 || !(exponent > 1.0)) return 0;
+    double *cumulative = (double *)malloc(n * sizeof(double));
+    if (cumulative == NULL) return 0;
+    if (!initBench(bg, "powerlaw", n, m)) {
+        free(cumulative);
+        return 0;
+    }
+    double power = -1.0 / (exponent - 1.0);
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += pow((double)(i + 1), power);
+        cumulative[i] = sum;
+    }
+    uint64_t state = seed;
+    while (bg->edgecount < m) {
+        size_t u = pickWeighted(cumulative, n, benchUniform(&state));
+        size_t v = pickWeighted(cumulative, n, benchUniform(&state));
+        if (u != v) pushEdge(bg, u, v, &state);
+    }
+    free(cumulative);
+    return 1;
+}
+
+/**
+ * @brief Release the edge list of a workload
+ * @param bg Workload
+ */
+void freeBenchGraph(struct benchgraph_t *bg) {
+    free(bg->edges);
+    bg->edges = NULL;
+    bg->edgecount = 0;
+}
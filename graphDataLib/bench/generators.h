@@ -0,0 +1,115 @@
+/**
+ * @brief Reproducible graph generators for the benchmark suite.
+ *
+ * Every generator is driven by a splitmix64 stream from the given seed, so the same arguments always produce the same
+ * edge list on every platform.  Generated edges have capacities drawn uniformly from [1, 100).  Random generators
+ * never produce self-loops, but may produce duplicate edges, as real edge lists often do.
+ */
+
+#ifndef GRAPHDATA_BENCH_GENERATORS_H
+#define GRAPHDATA_BENCH_GENERATORS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Generated edge
+ */
+struct benchedge_t {
+    size_t u;
+    size_t v;
+    double cap;
+};
+
+/**
+ * @brief Generated workload: node count, edge list, and the grid shape for grid workloads
+ */
+struct benchgraph_t {
+    /**
+     * @brief Workload name used in the report
+     */
+    const char *name;
+    size_t nodecount;
+    size_t edgecount;
+    struct benchedge_t *edges;
+    /**
+     * @brief Number of grid dimensions, or 0 for workloads that are not grids
+     */
+    size_t dimcount;
+    /**
+     * @brief Grid extents
+     */
+    size_t dimarr[3];
+};
+
+/**
+ * @brief Next value of a splitmix64 stream
+ * @param state Stream state, advanced by the call
+ * @return Pseudo-random 64-bit value
+ */
+uint64_t benchRandom(uint64_t *state);
+
+/**
+ * @brief Uniform double in [0, 1) from a splitmix64 stream
+ */
+double benchUniform(uint64_t *state);
+
+/**
+ * @brief Generate a 2D or 3D grid, connecting each node to its next neighbor along every dimension.
+ *
+ * Edges run from lower to higher node ids, in the x-fastest node order of ARRAY SPATIAL graphs.
+ *
+ * @param bg Workload to be filled
+ * @param dimcount 2 or 3
+ * @param side Extent along every dimension
+ * @param seed Seed for the capacities
+ * @return 1 if successful; otherwise, 0.
+ */
+int genGrid(struct benchgraph_t *bg, size_t dimcount, size_t side, uint64_t seed);
+
+/**
+ * @brief Generate an R-MAT (stochastic Kronecker) graph.
+ *
+ * @param bg Workload to be filled
+ * @param scale log2 of the node count
+ * @param edgefactor Edges per node
+ * @param a Probability of the top-left quadrant
+ * @param b Probability of the top-right quadrant
+ * @param c Probability of the bottom-left quadrant
+ * @param seed Seed
+ * @return 1 if successful; otherwise, 0.
+ */
+int genRmat(struct benchgraph_t *bg, size_t scale, size_t edgefactor, double a, double b, double c, uint64_t seed);
+
+/**
+ * @brief Generate an Erdos-Renyi G(n, m) graph
+ *
+ * @param bg Workload to be filled
+ * @param n Node count
+ * @param m Edge count
+ * @param seed Seed
+ * @return 1 if successful; otherwise, 0.
+ */
+int genErdosRenyi(struct benchgraph_t *bg, size_t n, size_t m, uint64_t seed);
+
+/**
+ * @brief Generate a power-law graph with the Chung-Lu model.
+ *
+ * Node i has expected degree proportional to (i + 1)^(-1 / (exponent - 1)).
+ *
+ * @param bg Workload to be filled
+ * @param n Node count
+ * @param m Edge count
+ * @param exponent Degree distribution exponent (greater than 1; typically 2 to 3)
+ * @param seed Seed
+ * @return 1 if successful; otherwise, 0.
+ */
+int genPowerLaw(struct benchgraph_t *bg, size_t n, size_t m, double exponent, uint64_t seed);
+
+/**
+ * @brief Release the edge list of a workload
+ * @param bg Workload
+ */
+void freeBenchGraph(struct benchgraph_t *bg);
+
+#endif //GRAPHDATA_BENCH_GENERATORS_H
@@ -0,0 +1,339 @@
+/**
+ * @brief Benchmark driver: times the graph operations of every backend on generated workloads, and reports JSON.
+ *
+ * Each workload/backend pair runs in its own child process, so that the peak RSS reported for it covers only that
+ * pair.  For every operation the report gives the operation count, total time, throughput, and latency percentiles
+ * (per call for add, lookup and neighbor iteration; per whole-graph call for reset and clear).
+ *
+ * Usage: graphbench [-n nodes] [-s seed] [-w workload] [-b backend] [-o file]
+ */
+
+#include "generators.h"
+#include <graphInit.h>
+#include <graphOps.h>
+#include <util/crudops.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/**
+ * @brief Default target node count of every workload
+ */
+#define BENCH_DEFAULT_NODES 4096
+
+/**
+ * @brief Edges per node for the random workloads
+ */
+#define BENCH_EDGE_FACTOR 8
+
+/**
+ * @brief Capacity lookups timed per run
+ */
+#define BENCH_LOOKUPS 100000
+
+/**
+ * @brief Neighbor lists fetched per run
+ */
+#define BENCH_NEIGHBORS 10000
+
+/**
+ * @brief Whole-graph resets timed per run
+ */
+#define BENCH_RESETS 5
+
+/**
+ * @brief Backend under test
+ */
+struct benchbackend_t {
+    const char *name;
+    enum GRAPHDOMAIN flags;
+    /**
+     * @brief Nonzero if the backend can only hold grid workloads (fixed degree, one slot per dimension)
+     */
+    int gridonly;
+};
+
+static const struct benchbackend_t backends[] = {
+        { "LINKED", LINKED | DIRECTED | GENERIC, 0 },
+        { "HASHED", HASHED | DIRECTED | GENERIC, 0 },
+        { "ARRAY", ARRAY | UNDIRECTED | SPATIAL, 1 },
+};
+
+/**
+ * @brief Output stream and JSON separator state
+ */
+struct benchreport_t {
+    FILE *out;
+    int first;
+    const char *workload;
+    const char *backend;
+    size_t nodes;
+    size_t edges;
+};
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static long peakRssKb(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+static int compareNs(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Nearest-rank percentile of sorted samples
+ */
+static uint64_t percentile(const uint64_t *sorted, size_t count, double pct) {
+    if (count == 0) return 0;
+    size_t rank = (size_t)(pct / 100.0 * (double)count + 0.5);
+    if (rank == 0) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+/**
+ * @brief Write one result record
+ * @param r Report state
+ * @param op Operation name
+ * @param samples Latency of each timed call, in ns (sorted in place)
+ * @param count Number of samples
+ * @param ops Number of operations covered by the samples
+ */
+static void report(struct benchreport_t *r, const char *op, uint64_t *samples, size_t count, size_t ops) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) total += samples[i];
+    qsort(samples, count, sizeof(uint64_t), compareNs);
+    double seconds = (double)total / 1e9;
+    fprintf(r->out, "%s    {\"workload\": \"%s\", \"backend\": \"%s\", \"nodes\": %zu, \"edges\": %zu, "
+                    "\"op\": \"%s\", \"count\": %zu, \"seconds\": %.6f, \"ops_per_sec\": %.1f, "
+                    "\"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu, \"peak_rss_kb\": %ld}",
+            r->first ? "" : ",\n", r->workload, r->backend, r->nodes, r->edges, op, ops, seconds,
+            seconds > 0.0 ? (double)ops / seconds : 0.0,
+            (unsigned long long)percentile(samples, count, 50.0),
+            (unsigned long long)percentile(samples, count, 90.0),
+            (unsigned long long)percentile(samples, count, 99.0),
+            (unsigned long long)(count > 0 ? samples[count - 1] : 0), peakRssKb());
+    r->first = 0;
+}
+
+/**
+ * @brief Run every operation of one backend on one workload
+ * @return 1 if successful; otherwise, 0.
+ */
+static int runBackend(const struct benchgraph_t *bg, const struct benchbackend_t *be, struct benchreport_t *r,
+                      uint64_t seed) {
+    struct dimensions_t *dims = NULL;
+    if (be->gridonly) {
+        dims = (bg->dimcount == 2) ? createDimensions(2, bg->dimarr[0], bg->dimarr[1])
+                                   : createDimensions(3, bg->dimarr[0], bg->dimarr[1], bg->dimarr[2]);
+    }
+    struct graph_t *g = initGraph(be->flags, 0, dims);
+    if (g == NULL) {
+        destroyDimensions((void **)&dims);
+        return 0;
+    }
+    struct graphops_t *gops = getOperations(g);
+    size_t samplecap = bg->nodecount + bg->edgecount;
+    if (samplecap < BENCH_LOOKUPS) samplecap = BENCH_LOOKUPS;
+    uint64_t *ns = (uint64_t *)malloc(samplecap * sizeof(uint64_t));
+    if (gops == NULL || ns == NULL) {
+        free(ns);
+        destroyGraphops((void **)&gops);
+        clearGraph(g);
+        destroyGraph((void **)&g);
+        destroyDimensions((void **)&dims);
+        return 0;
+    }
+
+    //add: nodes (where the backend has them to add), then edges
+    size_t count = 0;
+    if (gops->addNode != NULL && !be->gridonly) {
+        for (size_t i = 0; i < bg->nodecount; i++) {
+            uint64_t t = nowNs();
+            gops->addNode(&i, g);
+            ns[count++] = nowNs() - t;
+        }
+    }
+    for (size_t i = 0; i < bg->edgecount; i++) {
+        struct benchedge_t e = bg->edges[i];
+        uint64_t t = nowNs();
+        gops->addEdge(&e.u, &e.v, &e.cap, g);
+        ns[count++] = nowNs() - t;
+    }
+    report(r, "add", ns, count, count);
+
+    //lookup: capacities of random existing edges
+    uint64_t state = seed ^ 0x5DEECE66DULL;
+    double sink = 0.0;
+    count = 0;
+    for (size_t i = 0; i < BENCH_LOOKUPS && bg->edgecount > 0; i++) {
+        const struct benchedge_t *e = &bg->edges[benchRandom(&state) % bg->edgecount];
+        double cap = 0.0;
+        uint64_t t = nowNs();
+        gops->getCapacity(&e->u, &e->v, &cap, g);
+        ns[count++] = nowNs() - t;
+        sink += cap;
+    }
+    report(r, "lookup", ns, count, count);
+
+    //neighbor iteration: fetch and walk the neighbor list of random nodes
+    count = 0;
+    size_t visited = 0;
+    for (size_t i = 0; i < BENCH_NEIGHBORS; i++) {
+        size_t id = (size_t)(benchRandom(&state) % bg->nodecount);
+        uint64_t t = nowNs();
+        struct node_t *list = gops->getNeighbors(&id, g);
+        for (struct node_t *n = list; n != NULL; n = n->next) visited++;
+        destroyNodes((void **)&list);
+        ns[count++] = nowNs() - t;
+    }
+    report(r, "neighbors", ns, count, visited);
+
+    count = 0;
+    for (size_t i = 0; i < BENCH_RESETS; i++) {
+        uint64_t t = nowNs();
+        gops->resetGraph(g, NULL, NULL);
+        ns[count++] = nowNs() - t;
+    }
+    report(r, "reset", ns, count, count);
+
+    destroyGraphops((void **)&gops);
+    uint64_t t = nowNs();
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    ns[0] = nowNs() - t;
+    report(r, "clear", ns, 1, 1);
+
+    free(ns);
+    destroyDimensions((void **)&dims);
+    //keep the lookups from being optimized away
+    return sink >= 0.0 || sink < 0.0;
+}
+
+/**
+ * @brief Child exit status bits: the run failed, and the child wrote at least one record
+ */
+#define BENCH_EXIT_FAILED 1
+#define BENCH_EXIT_WROTE 2
+
+/**
+ * @brief Run one backend on one workload in a child process
+ *
+ * The child writes through its own copy of the report state, so the parent takes the
+ * separator state back from the exit status; a child that fails after writing some
+ * records still leaves the next record needing a comma.
+ * @return 1 if the child reported its results; otherwise, 0.
+ */
+static int runIsolated(const struct benchgraph_t *bg, const struct benchbackend_t *be, struct benchreport_t *r,
+                       uint64_t seed) {
+    fflush(r->out);
+    pid_t pid = fork();
+    if (pid < 0) return 0;
+    if (pid == 0) {
+        int ok = runBackend(bg, be, r, seed);
+        fflush(r->out);
+        _exit((ok ? 0 : BENCH_EXIT_FAILED) | (r->first ? 0 : BENCH_EXIT_WROTE));
+    }
+    int status = 0;
+    int exited = waitpid(pid, &status, 0) == pid && WIFEXITED(status);
+    if (exited && (WEXITSTATUS(status) & BENCH_EXIT_WROTE)) r->first = 0;
+    if (!exited || (WEXITSTATUS(status) & ~BENCH_EXIT_WROTE) != 0) {
+        fprintf(stderr, "graphbench: %s on %s failed\n", be->name, bg->name);
+        return 0;
+    }
+    return 1;
+}
+
+static size_t intRoot(size_t n, size_t k) {
+    size_t r = 1;
+    while (1) {
+        size_t next = r + 1, p = 1;
+        for (size_t i = 0; i < k; i++) p *= next;
+        if (p > n) return r;
+        r = next;
+    }
+}
+
+static size_t intLog2(size_t n) {
+    size_t s = 0;
+    while (((size_t)2 << s) <= n) s++;
+    return s;
+}
+
+int main(int argc, char **argv) {
+    size_t nodes = BENCH_DEFAULT_NODES;
+    uint64_t seed = 42;
+    const char *onlyworkload = NULL;
+    const char *onlybackend = NULL;
+    FILE *out = stdout;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:w:b:o:")) != -1) {
+        switch (opt) {
+            case 'n': nodes = (size_t)strtoull(optarg, NULL, 10); break;
+            case 's': seed = (uint64_t)strtoull(optarg, NULL, 10); break;
+            case 'w': onlyworkload = optarg; break;
+            case 'b': onlybackend = optarg; break;
+            case 'o':
+                out = fopen(optarg, "w");
+                if (out == NULL) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n nodes] [-s seed] [-w workload] [-b backend] [-o file]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (nodes < 16) nodes = 16;
+
+    struct benchgraph_t workloads[5];
+    memset(workloads, 0, sizeof(workloads));
+    int ok = genGrid(&workloads[0], 2, intRoot(nodes, 2), seed)
+             && genGrid(&workloads[1], 3, intRoot(nodes, 3), seed)
+             && genRmat(&workloads[2], intLog2(nodes), BENCH_EDGE_FACTOR, 0.57, 0.19, 0.19, seed)
+             && genErdosRenyi(&workloads[3], nodes, nodes * BENCH_EDGE_FACTOR, seed)
+             && genPowerLaw(&workloads[4], nodes, nodes * BENCH_EDGE_FACTOR, 2.5, seed);
+    if (!ok) {
+        fprintf(stderr, "graphbench: could not generate workloads\n");
+        for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) freeBenchGraph(&workloads[w]);
+        if (out != stdout) fclose(out);
+        return 1;
+    }
+
+    struct benchreport_t r = { out, 1, NULL, NULL, 0, 0 };
+    fprintf(out, "{\n  \"seed\": %llu,\n  \"target_nodes\": %zu,\n  \"results\": [\n",
+            (unsigned long long)seed, nodes);
+    int failures = 0;
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+        const struct benchgraph_t *bg = &workloads[w];
+        if (onlyworkload != NULL && strcmp(onlyworkload, bg->name) != 0) continue;
+        for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+            const struct benchbackend_t *be = &backends[b];
+            if (onlybackend != NULL && strcmp(onlybackend, be->name) != 0) continue;
+            if (be->gridonly && bg->dimcount == 0) continue;
+            r.workload = bg->name;
+            r.backend = be->name;
+            r.nodes = bg->nodecount;
+            r.edges = bg->edgecount;
+            if (!runIsolated(bg, be, &r, seed)) failures++;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) freeBenchGraph(&workloads[w]);
+    if (out != stdout) fclose(out);
+    return failures > 0;
+}
@@ -32,7 +32,8 @@ enum GRAPHDOMAIN {
     /**
      * @brief Graph structures shared with other processes via memory-mapped files
      * 
-     * Shared graph structures directly denote array-based graphs
+     * Shared graph structures directly denote array-based graphs.  ARRAY | SPATIAL graphs with this flag keep their
+     * arrays in tiles of the file named by graphconfig_t.mmappath (see impl/sharedmmapgraph.h).
      */
     SHARED_MMAP = 0x0002,
     /**
@@ -75,18 +76,266 @@ enum GRAPHDOMAIN {
     LABELED     = 0x2000
 };
 
+/**
+ * @brief Placement policy for the backing arrays of large graphs on NUMA systems.
+ *
+ * Only implementations with large flat arrays (ARRAY) make use of the policy; others ignore it.
+ */
+enum NUMAPOLICY {
+    /**
+     * @brief No explicit placement.  Pages are placed on the node of the first thread that touches them.
+     */
+    NUMA_DEFAULT    = 0,
+    /**
+     * @brief Pages are interleaved round-robin across all online NUMA nodes.
+     */
+    NUMA_INTERLEAVE = 1,
+    /**
+     * @brief Arrays are split into one contiguous slice of graph nodes per NUMA node.
+     *
+     * Slice boundaries follow the memChunkRange() partition of the graph nodes, so a worker handling part i of the
+     * nodes finds the node, capacity and flow entries for those nodes on NUMA node i.
+     */
+    NUMA_PARTITION  = 2
+};
+
+/**
+ * @brief Allocation strategy for the backing arrays of large graphs.
+ *
+ * Large random-access arrays spend much of their time in TLB misses when backed by base pages.  The strategies other
+ * than ALLOC_MALLOC trade some memory granularity for huge page backing.  If a strategy cannot be satisfied (for
+ * example, no hugetlbfs pages are reserved), the next weaker strategy is used; the strategy actually used is recorded
+ * in the implementation metadata.
+ */
+enum ALLOCSTRATEGY {
+    /**
+     * @brief Arrays are taken from the heap with calloc().
+     */
+    ALLOC_MALLOC    = 0,
+    /**
+     * @brief Arrays are taken from the heap, aligned to a huge page boundary.
+     */
+    ALLOC_ALIGNED   = 1,
+    /**
+     * @brief Arrays are anonymous memory mappings with base pages.
+     */
+    ALLOC_MMAP      = 2,
+    /**
+     * @brief Arrays are huge-page-aligned anonymous mappings, advised for transparent huge pages (MADV_HUGEPAGE).
+     */
+    ALLOC_THP       = 3,
+    /**
+     * @brief Arrays are mapped from the hugetlbfs pool (MAP_HUGETLB).  Falls back to ALLOC_THP.
+     */
+    ALLOC_HUGETLB   = 4
+};
+
+/**
+ * @brief Concurrency mode for the operations of a graph.
+ */
+enum CONCURRENCY {
+    /**
+     * @brief No internal locking.  Callers must serialize all access to the graph.
+     */
+    CONCURRENCY_NONE    = 0,
+    /**
+     * @brief Mutating operations are guarded by a set of locks striped by node id, so writers working on different
+     * nodes proceed in parallel.
+     *
+     * Edge operations lock the stripe of the node that owns the edge (u for DIRECTED graphs; the smaller id otherwise).
+     * ARRAY reads take no locks.  LINKED reads share a structure lock that is only held exclusively for node and edge
+     * removal, node insertion, edge counts and resets.  Requires a build with thread support.
+     */
+    CONCURRENCY_STRIPED = 1
+};
+
+/**
+ * @brief Memory ordering of the atomic value operations (graphops_t.atomicAddCapacity and atomicAddFlow).
+ */
+enum MEMORDER {
+    /**
+     * @brief Each atomic update is sequentially consistent with all other atomic operations.
+     */
+    MEMORDER_SEQCST     = 0,
+    /**
+     * @brief Atomic updates are never lost, but impose no ordering on other memory.  Suitable for accumulation passes
+     * whose results are only read after the workers have been joined.
+     */
+    MEMORDER_RELAXED    = 1
+};
+
+/**
+ * @brief Operation statistics for a graph (see util/graphstats.h).
+ */
+enum GRAPHSTATS {
+    /**
+     * @brief No statistics are kept.
+     */
+    STATS_OFF           = 0,
+    /**
+     * @brief The operations returned by getOperations() keep call counts, probe lengths and latency histograms.  Only
+     * takes effect in builds with GRAPHDATA_STATS; otherwise, the setting is ignored.
+     */
+    STATS_ON            = 1
+};
+
+/**
+ * @brief Backend selection for LINKED and HASHED graphs (see util/adaptive.h).
+ */
+enum ADAPTMODE {
+    /**
+     * @brief The graph keeps the implementation it was created with.
+     */
+    ADAPT_OFF           = 0,
+    /**
+     * @brief The graph starts with the implementation it was created with, and moves between LINKED and HASHED as its
+     * size and the mix of operations change.  Ignored for ARRAY graphs.
+     */
+    ADAPT_AUTO          = 1
+};
+
+/**
+ * @brief Order of the node ids of a SPATIAL grid (see util/cartesian.h).
+ */
+enum NODEORDER {
+    /**
+     * @brief Row-major ids, with the first dimension varying fastest.  Ids are dense.
+     */
+    ORDER_ROWMAJOR      = 0,
+    /**
+     * @brief Morton (Z-order) ids: the bits of the coordinates are interleaved, so nodes that are close along any
+     * dimension are close in the id space.  Each dimension is padded to a power of two, leaving unused ids.
+     */
+    ORDER_MORTON        = 1,
+    /**
+     * @brief Tiled ids: the grid is cut into cubic tiles, numbered row-major, and the nodes of each tile are numbered
+     * row-major within it.  Each dimension is padded to a whole number of tiles, leaving unused ids.
+     */
+    ORDER_TILED         = 2
+};
+
+/**
+ * @brief Options for cloneGraph()
+ */
+enum CLONEFLAGS {
+    /**
+     * @brief Copy the structure and all values
+     */
+    CLONE_FULL          = 0,
+    /**
+     * @brief Copy only the structure, with zeroed capacities and flows and no features or attribute columns.
+     *
+     * ARRAY clones share the node array of the original rather than copying it, so the topology of either graph must
+     * not change while the clone exists, and the clone must be destroyed before the original.  Both rules are enforced:
+     * the original counts its live clones, and while any exist, edges cannot be added to or removed from either graph,
+     * and clearGraph() fails on the original.
+     */
+    CLONE_STRUCTURE     = 1
+};
+
+/**
+ * @brief Memory allocator for the internal structures of a graph.
+ *
+ * Every function receives the ctx value, so one set of functions can serve many arenas or tenants.  Block sizes are
+ * passed to realloc and free, so allocators without per-block headers (arenas, bump allocators) can account for and
+ * release memory without bookkeeping of their own.
+ *
+ * Structures returned to consumers as copies (such as the lists from getNeighbors or getEdges) are not graph memory,
+ * and are always allocated with malloc() so that they can be released with free().
+ */
+struct graphallocator_t {
+    /**
+     * @brief Allocate size bytes.  Returns NULL on failure.
+     */
+    void * (*alloc)(size_t size, void *ctx);
+    /**
+     * @brief Resize the block at ptr (of oldsize bytes) to newsize bytes.  Returns NULL on failure, leaving ptr valid.
+     */
+    void * (*realloc)(void *ptr, size_t oldsize, size_t newsize, void *ctx);
+    /**
+     * @brief Release the block at ptr, of size bytes.
+     */
+    void (*free)(void *ptr, size_t size, void *ctx);
+    /**
+     * @brief User context passed to every call.
+     */
+    void *ctx;
+};
+
+/**
+ * @brief Optional settings for graph creation.
+ *
+ * Settings that do not change what the graph represents (as GRAPHDOMAIN does), but how it is stored and handled.  A
+ * graph holds its own copy of the settings it was created with.
+ */
+struct graphconfig_t {
+    /**
+     * @brief NUMA placement policy for the graph backing arrays.
+     */
+    enum NUMAPOLICY numa;
+    /**
+     * @brief Allocation strategy for the graph backing arrays.
+     */
+    enum ALLOCSTRATEGY alloc;
+    /**
+     * @brief Allocator for the graph's internal structures, or NULL for malloc()/free().
+     *
+     * The allocator functions are copied into the graph at creation.  ALLOC_MALLOC backing arrays are taken from this
+     * allocator; the mapped strategies (ALLOC_MMAP and stronger) always come directly from the operating system.
+     */
+    const struct graphallocator_t *allocator;
+    /**
+     * @brief Concurrency mode for the graph operations.
+     */
+    enum CONCURRENCY concurrency;
+    /**
+     * @brief Number of lock stripes for CONCURRENCY_STRIPED (rounded up to a power of two); 0 for the default.
+     */
+    size_t lockstripes;
+    /**
+     * @brief Memory ordering of the atomic value operations
+     */
+    enum MEMORDER memorder;
+    /**
+     * @brief Whether the graph operations keep statistics
+     */
+    enum GRAPHSTATS stats;
+    /**
+     * @brief Whether the graph may change implementation as it is used
+     */
+    enum ADAPTMODE adapt;
+    /**
+     * @brief Node count at which an ADAPT_AUTO graph moves from LINKED to HASHED; 0 for the default.
+     */
+    size_t adaptnodes;
+    /**
+     * @brief File holding the tiles of a SHARED_MMAP graph.  Only read while the graph is created.
+     */
+    const char *mmappath;
+    /**
+     * @brief Side of the cubic tiles of a SHARED_MMAP graph, in nodes; 0 for the default.
+     */
+    size_t tileside;
+    /**
+     * @brief Number of tiles a SHARED_MMAP graph keeps mapped at a time; 0 for the default.
+     */
+    size_t tilecache;
+};
+
 /**
  * @brief Feature/attribute structure for a graph item.
  *
  * Features hold attribute values for the associated graph structure member (node, edge).  This structure can be used
- * to store additional information or computation results.
+ * to store additional information or computation results.  When the same feature is needed for every node or edge, the
+ * columnar store in util/attrstore.h (graph_t.attrs) holds it as one dense array instead.
  */
 struct feature_t {
     /**
      * @brief identifier for the feature type
      *
      * Feature identifier, unique for a feature type.  Basic concept is a hash of the feature name, though other implementations
-     * are possible.
+     * are possible.  Ids from graphFeatureId() (util/interntable.h) are small integers, and are searched for with
+     * findFeature().
      */
     size_t hashid;
     /**
@@ -183,6 +432,11 @@ struct edge_t {
 
 
 
+/**
+ * @brief Reciprocal multiplier for dividing by one dimension (see util/cartesian.h)
+ */
+struct dimdivisor_t;
+
 /**
  * @brief Structure to hold values for dimensional graphs
  *
@@ -197,6 +451,31 @@ struct dimensions_t {
      * Array pointer containing the upper dimensional boundary values (width, height, depth, etc).
      */
     size_t *dimarr;
+    /**
+     * Order of the node ids over the coordinates; set with setDimensionOrder().
+     */
+    enum NODEORDER order;
+    /**
+     * Side of the tiles, for ORDER_TILED.
+     */
+    size_t tileside;
+    /**
+     * Bits of the node id holding each coordinate (dimcount entries), for ORDER_MORTON; otherwise, NULL.
+     */
+    size_t *ordermask;
+    /**
+     * Row-major stride of each dimension, followed by the product of all of them (dimcount + 1 entries).
+     */
+    size_t *stride;
+    /**
+     * Number of ids over the dimensions in their order, as returned by cartesianIndexLength().
+     */
+    size_t indexlen;
+    /**
+     * Reciprocal multipliers for dividing by each dimension (dimcount entries), when every row-major id fits in 32 bits;
+     * otherwise, NULL.
+     */
+    struct dimdivisor_t *divisor;
 };
 
 
@@ -220,6 +499,14 @@ struct labels_t {
 
 
 
+struct attrstore_t;
+struct interntable_t;
+struct graphsync_t;
+struct snapshotstate_t;
+struct statsstate_t;
+struct adaptstate_t;
+struct partview_t;
+
 /**
  * @brief Structure containing the backing data for the graph representation.
  *
@@ -248,6 +535,52 @@ struct graph_t {
      */
     struct labels_t *labels;
 
+    /**
+     * @brief Settings the graph was created with.  Owned by the graph.
+     */
+    struct graphconfig_t *config;
+
+    /**
+     * @brief Allocator used for all of the graph's internal structures, including the graph_t itself.
+     */
+    struct graphallocator_t allocator;
+
+    /**
+     * @brief Columnar attribute store (see util/attrstore.h).  NULL until the first column is created.
+     */
+    struct attrstore_t *attrs;
+
+    /**
+     * @brief Feature name intern table (see util/interntable.h).  NULL until the first name is interned.
+     */
+    struct interntable_t *features;
+
+    /**
+     * @brief Locking state for CONCURRENCY_STRIPED graphs (see util/syncops.h); NULL otherwise.
+     */
+    struct graphsync_t *sync;
+
+    /**
+     * @brief Snapshot bookkeeping (see util/snapshot.h): the versions shared with snapshots of a live graph, or the
+     * origin of a snapshot view.  NULL until the first snapshot is taken.
+     */
+    struct snapshotstate_t *snapshots;
+
+    /**
+     * @brief Operation statistics for STATS_ON graphs (see util/graphstats.h); NULL otherwise.
+     */
+    struct statsstate_t *stats;
+
+    /**
+     * @brief Implementation selection state for ADAPT_AUTO graphs (see util/adaptive.h); NULL otherwise.
+     */
+    struct adaptstate_t *adapt;
+
+    /**
+     * @brief View state for partition views (see util/partition.h); NULL otherwise.
+     */
+    struct partview_t *partview;
+
     /**
      * @brief Implementation-specific pointer to metadata for graph structure.
      */
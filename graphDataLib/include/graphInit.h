@@ -28,6 +28,40 @@
  */
 struct graph_t * initGraph(enum GRAPHDOMAIN typeflags, size_t lblcount, struct dimensions_t *dims);
 
+/**
+ * @brief Initialize a graph according to the flags set in the GRAPHDOMAIN value, with the given creation settings.
+ *
+ * Same as initGraph(), with control over how the graph is stored.  The settings are copied, so the cfg structure may be
+ * released or reused after the call.
+ *
+ * @param gtype Type of graph implementation to be created. Flag values set underlying structures and metadata.
+ * @param lblcount Number of label nodes to be used within the graph.  Required for LABELED flag; ignored for all others.
+ * @param dims Dimensional parameters structure.  Required for ARRAY graphs; otherwise, may be NULL.
+ * @param cfg Creation settings.  If NULL, the defaults from initConfig() are used.
+ * @return If successful and valid, initialized graph structure, according to the flags.  Otherwise, a NULL pointer.
+ */
+struct graph_t * initGraphWithConfig(enum GRAPHDOMAIN typeflags, size_t lblcount, struct dimensions_t *dims,
+                                     const struct graphconfig_t *cfg);
+
+/**
+ * @brief Create a copy of a graph
+ *
+ * The clone has the same type, labels and configuration as the original, and refers to the same dimensions structure.
+ * ARRAY backing arrays are copied in parallel chunks; LINKED node and edge lists are copied in a single pass.  With
+ * CLONE_FULL, features and attribute columns are copied as well.  With CLONE_STRUCTURE, the clone starts with zeroed
+ * capacities and flows, which makes it a cheap per-worker copy for many solves over the same topology (see
+ * CLONE_STRUCTURE for the restrictions on ARRAY clones).
+ *
+ * A snapshot view can be cloned, which gives a modifiable LINKED graph.  Tiled SHARED_MMAP graphs cannot be cloned,
+ * since the copy would need a file of its own; copy the file and open it with another graph instead.
+ *
+ * @param g Graph to be copied
+ * @param flags Clone options
+ * @return Pointer to the new graph, if successful; otherwise, a NULL pointer.  Release with clearGraph() and
+ * destroyGraph().
+ */
+struct graph_t * cloneGraph(const struct graph_t *g, enum CLONEFLAGS flags);
+
 /**
  * @brief Create and fill the graphOps_t structure that handles basic operations for the graph
  *
@@ -40,13 +74,26 @@ struct graph_t * initGraph(enum GRAPHDOMAIN typeflags, size_t lblcount, struct d
  */
 struct graphops_t * getOperations(struct graph_t *g);
 
+/**
+ * @brief Fill a graphops_t with the unwrapped operations of an implementation
+ *
+ * Used by getOperations(), and by wrappers that switch a graph between implementations.  The graph pointer of the
+ * structure is left as it was.
+ *
+ * @param gops Operations structure to be filled
+ * @param imptype Implementation flag (ARRAY, LINKED or HASHED)
+ * @return 1 if successful; 0 if the implementation has no operations.
+ */
+int setImplementationOps(struct graphops_t *gops, enum GRAPHDOMAIN imptype);
+
 /**
  * @brief Clear out the graph's underlying structures, and null out the memory
  *
- * All underlying graph structures will be cleared and the associated memory to the structures freed.
+ * All underlying graph structures will be cleared and the associated memory to the structures freed.  A graph with
+ * unreleased snapshots (see util/snapshot.h) is left untouched.
  *
  * @param g Graph to be cleared
- * @return 1 if successful; otherwise, 0.
+ * @return 1 if successful; otherwise, 0 (including for a graph with unreleased snapshots).
  */
 int clearGraph(struct graph_t *g);
 
@@ -285,6 +285,17 @@ struct graphops_t {
      */
     funcAddFlow addFlow;
 
+    /**
+     * @brief Adjust the capacity of an edge with a single atomic update, so that concurrent adjustments to the same
+     * edge are never lost.  Uses the memory ordering of graph_t.config->memorder.
+     * Expected to be NULL where edge values cannot be updated atomically.
+     */
+    funcAddCapacity atomicAddCapacity;
+
+    /**
+     * @brief Adjust the flow value of an edge with a single atomic update (see atomicAddCapacity).
+     */
+    funcAddFlow atomicAddFlow;
 
     /**
      * @brief Reset the graph to an initial state, according to implementation logic
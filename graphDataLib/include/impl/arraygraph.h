@@ -15,6 +15,37 @@
 
 #include <graphData.h>
 
+/**
+ * @brief Layer id returned when a layer could not be found or created.
+ */
+#define LAYER_NONE ((size_t)-1)
+
+/**
+ * @brief One set of capacity and flow values over the topology of an ARRAY graph
+ */
+struct valuelayer_t {
+    /**
+     * @brief Feature id of the layer name, from graphFeatureId(); INTERN_NONE for the base layer
+     */
+    size_t nameid;
+    /**
+     * @brief Capacity array of the layer
+     */
+    double *cap;
+    /**
+     * @brief Flow array of the layer
+     */
+    double *flow;
+    /**
+     * @brief Allocation strategy actually used for the capacity array
+     */
+    enum ALLOCSTRATEGY capalloc;
+    /**
+     * @brief Allocation strategy actually used for the flow array
+     */
+    enum ALLOCSTRATEGY flowalloc;
+};
+
 /**
  * @brief Metadata structure for array graphs
  */
@@ -38,6 +69,56 @@ struct arraydata_t {
      * This length is actually nodecount * degree for the ARRAY implementation
      */
     size_t arraylen;
+
+    /**
+     * @brief NUMA placement policy the backing arrays were allocated with
+     */
+    enum NUMAPOLICY numa;
+
+    /**
+     * @brief Allocation strategy requested for the backing arrays
+     */
+    enum ALLOCSTRATEGY alloc;
+    /**
+     * @brief Allocation strategy actually used for the node array
+     */
+    enum ALLOCSTRATEGY nodealloc;
+    /**
+     * @brief Allocation strategy actually used for the capacity array
+     */
+    enum ALLOCSTRATEGY capalloc;
+    /**
+     * @brief Allocation strategy actually used for the flow array
+     */
+    enum ALLOCSTRATEGY flowalloc;
+
+    /**
+     * @brief Metadata of the graph whose node array this graph shares (CLONE_STRUCTURE clones); NULL if the node array
+     * is owned.
+     */
+    struct arraydata_t *topology;
+    /**
+     * @brief Number of CLONE_STRUCTURE clones sharing this graph's node array (updated atomically).  While it is
+     * non-zero, the topology cannot change and the arrays cannot be freed.
+     */
+    size_t clones;
+
+    /**
+     * @brief Number of value layers; 0 until the first named layer is added.
+     */
+    size_t layercount;
+    /**
+     * @brief Number of layers allocated
+     */
+    size_t layercap;
+    /**
+     * @brief Value layers, indexed by layer id.  Layer 0 is the base layer the graph was created with.
+     */
+    struct valuelayer_t *layers;
+    /**
+     * @brief Id of the layer currently in graph_t.capImpl and graph_t.flowImpl
+     */
+    size_t activelayer;
 };
 
 /**
@@ -57,4 +138,77 @@ int arrayGraphInit(struct graph_t *g);
  */
 int arrayGraphFree(struct graph_t *g);
 
+/**
+ * @brief Fill in the array backing data of a clone
+ *
+ * The capacity and flow arrays are copied in parallel chunks (CLONE_FULL), or created zeroed (CLONE_STRUCTURE).  The
+ * node array is copied, or shared with the original for CLONE_STRUCTURE.  CLONE_FULL copies every value layer and
+ * keeps the active one; CLONE_STRUCTURE clones have only a base layer, zeroed.
+ *
+ * @param g Original graph
+ * @param ng Clone, with its type, dimensions, labels and configuration already set
+ * @param flags Clone options
+ * @return 1 if successful; otherwise, 0.
+ */
+int arrayGraphClone(const struct graph_t *g, struct graph_t *ng, enum CLONEFLAGS flags);
+
+/**
+ * @brief Add a named layer of capacity and flow values over the same topology, or find the existing one.
+ *
+ * Every layer shares the node array, so K layers cost K capacity and flow arrays rather than K graphs.  The base layer
+ * (id 0) holds the values the graph was created with.  New layers start zeroed.  Adding a layer does not change the
+ * active layer.
+ *
+ * @param g ARRAY graph
+ * @param name Layer name
+ * @return Layer id, if successful; otherwise, LAYER_NONE.
+ */
+size_t arrayAddLayer(struct graph_t *g, const char *name);
+
+/**
+ * @brief Find a named layer
+ * @param g ARRAY graph
+ * @param name Layer name
+ * @return Layer id, if found; otherwise, LAYER_NONE.
+ */
+size_t arrayFindLayer(const struct graph_t *g, const char *name);
+
+/**
+ * @brief Number of value layers of the graph
+ * @param g ARRAY graph
+ * @return Number of layers, including the base layer
+ */
+size_t arrayLayerCount(const struct graph_t *g);
+
+/**
+ * @brief Make a layer the active one.
+ *
+ * All value operations (getCapacity, addFlow, resetGraph, ...) work on the active layer.  Switching swaps the value
+ * arrays of the graph, so it must not happen while other threads use the graph.
+ *
+ * @param g ARRAY graph
+ * @param layer Layer id
+ * @return 1 if successful; 0 if the layer id is not valid.
+ */
+int arraySelectLayer(struct graph_t *g, size_t layer);
+
+/**
+ * @brief Id of the active layer
+ * @param g ARRAY graph
+ * @return Layer id
+ */
+size_t arrayActiveLayer(const struct graph_t *g);
+
+/**
+ * @brief Run a function once per layer, with each layer active in turn.
+ *
+ * The active layer is restored afterwards.  Iteration stops at the first call that returns 0.
+ *
+ * @param g ARRAY graph
+ * @param fn Function to be run; receives the graph, the layer id and the context
+ * @param ctx Context passed through to fn
+ * @return 1 if every call returned 1; otherwise, 0.
+ */
+int arrayForEachLayer(struct graph_t *g, int (*fn)(struct graph_t *g, size_t layer, void *ctx), void *ctx);
+
 #endif //GRAPHDATA_ARRAYGRAPH_H
@@ -110,6 +110,7 @@ int arrayAddNode(const size_t *nodeid, struct graph_t *g);
 /**
  * @brief Implementation to add an edge to a given graph.
  * Not all implementations may use this (for example, fixed-size ARRAY implementations representing a set domain of nodes and relationships).
+ * A slot holding node 0 marks an empty slot, so DIRECTED edges into node 0 (and a loop on node 0) are refused.
  * @param uid identifer for start of edge
  * @param vid identifier for end of edge
  * @param cap capacity value to be assigned
@@ -180,6 +181,57 @@ int arraySetFlow(const size_t *uid, const size_t *vid, const double *flow, struc
  */
 int arrayAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g);
 
+/**
+ * @brief Function to atomically add (adjust) the capacity for an edge by a given amount.
+ *
+ * Concurrent calls on the same edge are never lost, without taking any locks.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int arrayAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g);
+
+/**
+ * @brief Function to atomically adjust the flow value of a given edge.
+ *
+ * Concurrent calls on the same edge are never lost, without taking any locks.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int arrayAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g);
+
+/**
+ * @brief Retrieve the capacity and flow of an edge in every value layer, with a single edge lookup.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param caps Set to the capacity in each layer (arrayLayerCount() entries); may be NULL
+ * @param flows Set to the flow in each layer (arrayLayerCount() entries); may be NULL
+ * @param g Graph structure in question
+ * @return 1 if the edge was found; otherwise, 0.
+ */
+int arrayGetLayerValues(const size_t *uid, const size_t *vid, double *caps, double *flows, const struct graph_t *g);
+
+/**
+ * @brief Adjust the capacity and flow of an edge in every value layer, with a single edge lookup.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param caps Amount added to the capacity in each layer (arrayLayerCount() entries); may be NULL
+ * @param flows Amount added to the flow in each layer (arrayLayerCount() entries); may be NULL
+ * @param g Graph structure in question
+ * @return 1 if the edge was found; otherwise, 0.
+ */
+int arrayAddLayerValues(const size_t *uid, const size_t *vid, const double *caps, const double *flows,
+                        struct graph_t *g);
+
 
 /**
  * @brief Implementation to "reset" the graph according to the given argument pointer.
@@ -1,12 +1,46 @@
-//
-// Created by david on 11/18/17.
-//
+/**
+ * @brief Hashtable implementation of the graph structure.
+ *
+ * HASHED graphs hold the same node and edge lists as LINKED graphs (node_t and edge_t structures, with each node
+ * owning its outgoing edges), with an open-addressing index from node id to node_t on top.  Node lookups are O(1)
+ * rather than a walk of the node list, new nodes are appended through a tail pointer, and new edges are inserted at
+ * the head of their node's edge list.
+ *
+ * Because the lists are shared with LINKED, a graph can be moved between the two implementations in place by
+ * building or dropping the index (see migrateGraph() in util/adaptive.h).
+ */
 
 #ifndef GRAPHDATA_HASHGRAPH_H
 #define GRAPHDATA_HASHGRAPH_H
 
 #include <graphData.h>
 
+/**
+ * @brief Metadata structure for hashed graphs
+ */
+struct hashdata_t {
+    /**
+     * @brief Index slots, holding node pointers (NULL for an empty slot)
+     */
+    struct node_t **slots;
+    /**
+     * @brief Number of index slots (a power of two, at least twice the node count)
+     */
+    size_t slotcount;
+    /**
+     * @brief Number of nodes in the graph
+     */
+    size_t nodecount;
+    /**
+     * @brief Number of edges in the graph (updated atomically)
+     */
+    size_t edgecount;
+    /**
+     * @brief Last node of the node list, where new nodes are appended
+     */
+    struct node_t *tail;
+};
+
 /**
  * @brief Initialize the graph using the hashtable adjacency list structure.
  *
@@ -15,5 +49,68 @@
  */
 int hashGraphInit(struct graph_t *g);
 
+/**
+ * @brief Clear out the underlying data structures for the given HASHED graph.
+ *
+ * @param g Graph to be cleared and memory deallocated
+ * @return 1 if the operation as a success; otherwise, 0.
+ */
+int hashGraphFree(struct graph_t *g);
+
+/**
+ * @brief Copy the node and edge lists of a HASHED graph into a clone, and index the copy.
+ *
+ * @param g Original graph
+ * @param ng Clone, with its type and configuration already set
+ * @param flags Clone options
+ * @return 1 if successful; otherwise, 0.
+ */
+int hashGraphClone(const struct graph_t *g, struct graph_t *ng, enum CLONEFLAGS flags);
+
+/**
+ * @brief Build the node index over the node list already held in nodeImpl.
+ *
+ * Any existing index is replaced.  The lists themselves are not copied or changed.
+ *
+ * @param g Graph whose node list is to be indexed
+ * @return 1 if successful; otherwise, 0 (the graph is left as it was).
+ */
+int hashGraphIndex(struct graph_t *g);
+
+/**
+ * @brief Release the node index, leaving the node and edge lists in place.
+ *
+ * @param g Graph whose index is to be released
+ * @return 1 if successful; otherwise, 0.
+ */
+int hashGraphDropIndex(struct graph_t *g);
+
+/**
+ * @brief Find a node in the index
+ *
+ * @param g HASHED graph
+ * @param nodeid Identifier of the node
+ * @param depth Set to the number of slots examined
+ * @return pointer to the node structure, if found; otherwise, pointer to NULL
+ */
+struct node_t * hashIndexFind(const struct graph_t *g, size_t nodeid, size_t *depth);
+
+/**
+ * @brief Add a node to the index, doubling the slots first if the index would become more than half full
+ *
+ * @param g HASHED graph
+ * @param n Node to be indexed (not already in the index)
+ * @return 1 if successful; otherwise, 0.
+ */
+int hashIndexInsert(struct graph_t *g, struct node_t *n);
+
+/**
+ * @brief Remove a node from the index
+ *
+ * @param g HASHED graph
+ * @param nodeid Identifier of the node
+ * @return 1 if the node was in the index; otherwise, 0.
+ */
+int hashIndexRemove(struct graph_t *g, size_t nodeid);
 
 #endif //GRAPHDATA_HASHGRAPH_H
@@ -30,4 +30,17 @@ int linkGraphInit(struct graph_t *g);
  */
 int linkGraphFree(struct graph_t *g);
 
+/**
+ * @brief Copy the node and edge lists of a LINKED graph into a clone, in a single pass.
+ *
+ * LINKED edges hold their own values, so CLONE_STRUCTURE copies the lists with zeroed capacities and flows and without
+ * features, rather than sharing them.
+ *
+ * @param g Original graph (may be a snapshot view)
+ * @param ng Clone, with its type and configuration already set
+ * @param flags Clone options
+ * @return 1 if successful; otherwise, 0.
+ */
+int linkGraphClone(const struct graph_t *g, struct graph_t *ng, enum CLONEFLAGS flags);
+
 #endif //GRAPHDATA_LINKGRAPH_H
@@ -184,6 +184,33 @@ int linkSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct
  */
 int linkAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g);
 
+/**
+ * @brief Function to atomically add (adjust) the capacity for an edge by a given amount.
+ *
+ * The update itself is atomic, but finding the edge walks the edge list, so the list must not be changed at the same
+ * time (or the graph must use CONCURRENCY_STRIPED).
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int linkAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g);
+
+/**
+ * @brief Function to atomically adjust the flow value of a given edge.
+ *
+ * Same restrictions as linkAtomicAddCapacity().
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int linkAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g);
+
 /**
  * @brief Function pointer to "reset" the graph according to the given argument pointer.
  *
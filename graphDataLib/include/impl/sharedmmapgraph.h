@@ -1,8 +1,215 @@
-//
-// Created by david on 10/21/23.
-//
+/**
+ * @brief Out-of-core ARRAY graphs, stored in tiles of a memory-mapped file.
+ *
+ * A SHARED_MMAP | ARRAY | SPATIAL graph has the same topology and operations as an ARRAY graph (fixed degree of
+ * dimcount, undirected edges stored from the smaller node, 0 marking an unused slot), but its node, capacity and flow
+ * arrays live in the file named by graphconfig_t.mmappath rather than in memory, so the graph can be larger than RAM.
+ *
+ * The grid is cut into cubic tiles of tileside nodes along every dimension.  Each tile holds the node slots, then the
+ * capacities, then the flows of its nodes (in row-major order within the tile), rounded up to whole pages, so one
+ * tile is one mapping.  Only graphconfig_t.tilecache tiles are mapped at a time; the least recently used tile is
+ * unmapped to make room for the next, and its pages are written back by the kernel.  Each time a tile is mapped, the
+ * kernel is asked to read ahead the next tile in row-major tile order, which is the order a solver sweeping the nodes
+ * by id reaches them in.  Such a sweep works through one layer of tiles at a time (all but the last dimension), so the
+ * cache should hold at least that many tiles.
+ *
+ * Node ids are the usual row-major indices (util/cartesian.h), so code that works through graphops_t works unchanged.
+ * arrayMaxFlow() and flow workspaces (util/maxflow.h) read and write the tiles through mmapNodeSlots(), with the
+ * residual network in memory; other code that reads the backing arrays of an ARRAY graph directly (region max-flow,
+ * partitioning, layers, clones) does not accept SHARED_MMAP graphs.  The file is kept when the graph is destroyed, and a later graph with the same dimensions,
+ * direction and tile side reopens it with its values.
+ *
+ * Every operation holds the tile cache lock while it works in a tile, so operations can be called from several threads,
+ * but they are serialized.
+ */
 
 #ifndef GRAPHDATA_SHAREDMMAPGRAPH_H
 #define GRAPHDATA_SHAREDMMAPGRAPH_H
 
+#include <graphData.h>
+
+/**
+ * @brief Default tile side, in nodes
+ */
+#define MMAP_DEFAULT_TILESIDE 16
+
+/**
+ * @brief Default number of tiles kept mapped
+ */
+#define MMAP_DEFAULT_TILES 64
+
+/**
+ * @brief Largest number of dimensions a tiled file can describe
+ */
+#define MMAP_MAX_DIMS 8
+
+/**
+ * @brief Tile cache state (opaque)
+ */
+struct tilecache_t;
+
+/**
+ * @brief Metadata structure for SHARED_MMAP graphs
+ */
+struct mmapdata_t {
+    /**
+     * @brief Number of nodes
+     */
+    size_t nodelen;
+    /**
+     * @brief Reported edge count, as for ARRAY graphs
+     */
+    size_t edgelen;
+    /**
+     * @brief Degree of the nodes--the number of (possible) edges coming out of each node.
+     */
+    size_t degree;
+    /**
+     * @brief Side of the tiles, in nodes
+     */
+    size_t tileside;
+    /**
+     * @brief Nodes per tile (tileside to the power of dimcount)
+     */
+    size_t tilenodes;
+    /**
+     * @brief Number of tiles
+     */
+    size_t tilecount;
+    /**
+     * @brief Size of one tile in the file, rounded up to whole pages
+     */
+    size_t tilebytes;
+    /**
+     * @brief Number of tiles per dimension
+     */
+    size_t tilesper[MMAP_MAX_DIMS];
+    /**
+     * @brief Tile lookups that found the tile mapped
+     */
+    size_t hits;
+    /**
+     * @brief Tile lookups that had to map the tile
+     */
+    size_t misses;
+    /**
+     * @brief Tiles unmapped to make room for others
+     */
+    size_t evictions;
+    /**
+     * @brief Tile cache
+     */
+    struct tilecache_t *cache;
+};
+
+/**
+ * @brief Node slots of one node, inside its mapped tile
+ *
+ * The pointers stay valid only while the tile cache lock is held.
+ */
+struct mmapslots_t {
+    /**
+     * @brief Neighbor ids (degree entries)
+     */
+    size_t *nodes;
+    /**
+     * @brief Capacities (degree entries)
+     */
+    double *cap;
+    /**
+     * @brief Flows (degree entries)
+     */
+    double *flow;
+};
+
+/**
+ * @brief Set up a graph with tiled, file-backed array data
+ *
+ * Needs an UNLABELED SPATIAL graph of at most MMAP_MAX_DIMS dimensions with row-major ids, and a configuration with
+ * mmappath set.  An existing file is reopened if its layout matches the graph; a file with another layout is left alone
+ * and the call fails.  A new file is created sparse, so its nodes start with no edges.
+ *
+ * @param g Graph structure
+ * @return 1 if successful; 0 if an error
+ */
+int mmapGraphInit(struct graph_t *g);
+
+/**
+ * @brief Unmap every tile and close the file of a SHARED_MMAP graph; the file itself is kept.
+ * @param g graph_t with tiled structures to be released
+ * @return 1 if successful; otherwise, 0.
+ */
+int mmapGraphFree(struct graph_t *g);
+
+/**
+ * @brief Write the mapped tiles of a SHARED_MMAP graph back to its file, and wait for the writes to finish.
+ * @param g SHARED_MMAP graph
+ * @return 1 if successful; otherwise, 0.
+ */
+int mmapGraphSync(struct graph_t *g);
+
+/**
+ * @brief Determine whether a graph is stored in a tiled file
+ * @param g Graph in question
+ * @return 1 for SHARED_MMAP graphs; otherwise, 0.
+ */
+int isMmapGraph(const struct graph_t *g);
+
+/**
+ * @brief Take the tile cache lock of a SHARED_MMAP graph
+ * @param g SHARED_MMAP graph
+ */
+void mmapCacheLock(const struct graph_t *g);
+
+/**
+ * @brief Release the tile cache lock of a SHARED_MMAP graph
+ * @param g SHARED_MMAP graph
+ */
+void mmapCacheUnlock(const struct graph_t *g);
+
+/**
+ * @brief Find the slots of a node, mapping its tile if needed
+ *
+ * The tile cache lock must be held, and the slots are only valid until it is released.
+ *
+ * @param g SHARED_MMAP graph
+ * @param nodeid Node identifier
+ * @param slots Set to the slots of the node
+ * @return 1 if successful; 0 if the node id is out of range or its tile could not be mapped.
+ */
+int mmapNodeSlots(const struct graph_t *g, size_t nodeid, struct mmapslots_t *slots);
+
+/**
+ * @brief Visit every edge of a SHARED_MMAP graph, one tile at a time
+ *
+ * The tile cache lock is held during the walk, so fn must not call the graph's operations.
+ *
+ * @param g SHARED_MMAP graph
+ * @param fn Function called with the start, end and capacity of each edge; returns 0 to stop
+ * @param ctx Context passed through to fn
+ * @return 1 if every edge was visited; otherwise, 0.
+ */
+int mmapForEachEdge(const struct graph_t *g, int (*fn)(size_t u, size_t v, double cap, void *ctx), void *ctx);
+
+/**
+ * @brief Set the capacities and flows of every tile of a SHARED_MMAP graph to 0.0
+ * @param g SHARED_MMAP graph
+ * @return 1 if successful; otherwise, 0.
+ */
+int mmapZeroValues(struct graph_t *g);
+
+/**
+ * @brief Bytes of the file currently mapped by a SHARED_MMAP graph
+ * @param g SHARED_MMAP graph
+ * @return Mapped size in bytes; 0 for other graphs.
+ */
+size_t mmapMappedBytes(const struct graph_t *g);
+
+/**
+ * @brief Bytes allocated for the tile cache tables of a SHARED_MMAP graph (not counting the mapped tiles)
+ * @param g SHARED_MMAP graph
+ * @return Size in bytes; 0 for other graphs.
+ */
+size_t mmapCacheBytes(const struct graph_t *g);
+
 #endif //GRAPHDATA_SHAREDMMAPGRAPH_H
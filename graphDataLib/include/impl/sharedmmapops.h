@@ -5,4 +5,202 @@
 #ifndef GRAPHDATA_SHAREDMMAPOPS_H
 #define GRAPHDATA_SHAREDMMAPOPS_H
 
+#include <graphData.h>
+
+//Read functions to extract data
+/**
+ * @brief Function pointer definition for getting the node count;
+ * @param g Graph structure in question
+ * @return Count of nodes, if graph is not null; otherwise, return 0
+ */
+size_t mmapNodeCount(struct graph_t *g);
+
+/**
+ * @brief Function pointer to extract count of edges
+ * @param g Graph structure in question
+ * @return Count of edges, if graph is not null; otherwise, return 0
+ */
+size_t mmapEdgeCount(struct graph_t *g);
+
+/**
+ * @brief Function pointer to retrieve a node structure reference.
+ *
+ * The returned structure is a copy; consumers must use free() when finished.
+ *
+ * @param nodeid Identifier of the node to be retrieved
+ * @param g Graph structure in question
+ * @return pointer to the node structure, if found; otherwise, pointer to NULL
+ */
+struct node_t * mmapGetNode(const size_t *nodeid, const struct graph_t *g);
+
+/**
+ * @brief Function pointer to retrieve a edge structure reference.
+ *
+ * The returned structure is a copy; consumers must use free() when finished.
+ *
+ * @param u nodeid of the starting edge.
+ * @param v nodeid of the ending edge.
+ * @param g Graph structure in question
+ * @return pointer to the edge structure, if found; otherwise, pointer to NULL.
+ */
+struct edge_t * mmapGetEdge(const size_t *u, const size_t *v, const struct graph_t *g);
+
+/**
+ * @brief Function pointer to retrieve linked-list of nodes that are currently defined as neighbors to the given node.
+ *
+ * Returned linked-list is distinct from the graph structure, and consumers must use free() when finished.
+ * @param nodeid Identifier of the node in question
+ * @param g Graph structure in question
+ * @return linked-list of node references, if found; otherwise, pointer to NULL.
+ */
+struct node_t * mmapGetNeighbors(const size_t *nodeid, const struct graph_t *g);
+
+/**
+ * @brief Function pointer to retrieve linked-list of edges from a given node.
+ * Returned linked-list is distinct from the graph structure, and consumers must use free() when finished.
+ * @param nodeid Identifier of the node in question
+ * @param g Graph structure in question
+ * @return linked-list of edges starting from the given node, if found; otherwise, pointer to NULL.
+ */
+struct edge_t * mmapGetEdges(const size_t *nodeid, const struct graph_t *g);
+
+/**
+ * @brief Function pointer to retrieve the current capacity value for a given edge.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param cap Capacity value pointer to store the value
+ * @param g Graph structure in question
+ * @return 0 if there was a problem retrieving the value (such as the edge not existing); otherwise, 1 for a successful
+ * retrieval
+ */
+int mmapGetCapacity(const size_t *uid, const size_t *vid, double *cap, const struct graph_t *g);
+
+/**
+ * @brief Function pointer to retrieve the current flow value for a given edge.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param flow Flow value pointer to store the result
+ * @param g Graph structure in question
+ * @return 0 if there was a problem retrieving the value (such as the edge not existing); otherwise, 1 for a successful
+ * retrieval
+ */
+int mmapGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct graph_t *g);
+
+//Write functions to modify graph
+/**
+ * @brief Add a node to the graph.
+ * NOOP implementation for tiled graphs--the node counts are fixed at creation.
+ * @param nodeid Node identifier to be added
+ * @param g Graph structure to add the node
+ * @return 0, always
+ */
+int mmapAddNode(const size_t *nodeid, struct graph_t *g);
+
+/**
+ * @brief Remove a node from the graph.
+ * NOOP implementation for tiled graphs--the node counts are fixed at creation.
+ * @param nodeid Node id to be removed.
+ * @param g Graph structure in question
+ * @return 0, always
+ */
+int mmapRemoveNode(const size_t *nodeid, struct graph_t *g);
+
+/**
+ * @brief Add an edge to the graph, in the first free slot of its starting node.
+ *
+ * @param uid identifer for start of edge
+ * @param vid identifier for end of edge
+ * @param cap capacity value to be assigned
+ * @param g graph structure in question
+ * @return 0 if there was an error; 1 if the edge was successfully added.
+ */
+int mmapAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_t *g);
+
+/**
+ * @brief Remove an edge from the graph.
+ *
+ * @param uid Identifier for the edge start
+ * @param vid Identifier for the edge end.
+ * @param g Graph structure in question
+ * @return 0 if there was an error (e.g. the edge was not found); otherwise, 1 if the edge was removed.
+ */
+int mmapRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g);
+
+/**
+ * @brief Set the capacity (cost, weight, etc.) of an edge.
+ * @param uid identifier of the edge start
+ * @param vid identifier of the edge ending.
+ * @param cap capacity value to be set
+ * @param g Graph structure in question
+ * @return 0 if there was an error; 1 if the capacity was successfully set
+ */
+int mmapSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g);
+
+/**
+ * @brief Add (adjust) the capacity of an edge by a given amount.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int mmapAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g);
+
+/**
+ * @brief Set the flow value of an edge.
+ *
+ * @param uid Identifier of the edge start.
+ * @param vid Identifier of the edge end.
+ * @param flow Value to be set for the flow.
+ * @param g Graph structure in question
+ * @return 0 of there was an error (edge not found, for example); otherwise, 1 if the flow value as successfully set.
+ */
+int mmapSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g);
+
+/**
+ * @brief Adjust the flow value of an edge.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int mmapAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g);
+
+/**
+ * @brief Atomically add (adjust) the capacity of an edge by a given amount.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int mmapAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g);
+
+/**
+ * @brief Atomically adjust the flow value of an edge.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int mmapAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g);
+
+/**
+ * @brief "Reset" the graph: the capacities and flows of every tile are set to 0.0 again.
+ *
+ * @param g Graph structure to be zeroed
+ * @param args Ignored
+ * @param callback Ignored
+ * @return 0 if there was an error during the reset; 1 if the reset completed;
+ */
+int mmapResetGraph(struct graph_t *g, void *args, void (*callback)(void));
+
 #endif //GRAPHDATA_SHAREDMMAPOPS_H
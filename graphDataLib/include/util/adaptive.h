@@ -0,0 +1,104 @@
+/**
+ * @brief Automatic choice between the LINKED and HASHED implementations.
+ *
+ * LINKED graphs are the lightest structure, but find nodes by walking the node list, so lookups and node insertion
+ * slow down linearly as the graph grows.  HASHED graphs hold the same lists with a node index on top.  A graph created
+ * with ADAPT_AUTO in its graphconfig_t starts with the implementation it was created with, and moves between the two
+ * as it is used:
+ *
+ * - LINKED to HASHED once the node count reaches graphconfig_t.adaptnodes (ADAPT_DEFAULT_NODES if 0), or once the
+ *   lookups since the last move reach ADAPT_LOOKUP_FACTOR times the node count on a graph of at least ADAPT_MIN_NODES
+ *   nodes (by then the list walks have cost more than building the index would);
+ * - HASHED to LINKED once node removals bring the count down to a quarter of adaptnodes.
+ *
+ * A move builds or drops the node index in one pass over the node list; nodes and edges are not copied, so pointers
+ * returned by getNode() and getEdge() stay valid across moves (edge writes on a snapshotted graph still move edges; see
+ * util/snapshot.h).  The operations returned by getOperations() dispatch through a table pointer that is swapped
+ * (with release ordering) once the new index is in place, so the same graphops_t keeps working across moves.
+ *
+ * Moves are made from within addNode and removeNode, and also from addEdge and removeEdge for graphs without
+ * CONCURRENCY_STRIPED, since those are the operations that already have the graph to themselves.  Graphs with
+ * snapshots (see util/snapshot.h) move like any other; each view keeps the implementation it was taken with.
+ */
+
+#ifndef GRAPHDATA_ADAPTIVE_H
+#define GRAPHDATA_ADAPTIVE_H
+
+#include <graphData.h>
+#include <graphOps.h>
+
+/**
+ * @brief Default node count at which an ADAPT_AUTO graph moves from LINKED to HASHED
+ */
+#define ADAPT_DEFAULT_NODES 64
+
+/**
+ * @brief Smallest graph moved to HASHED because of its lookups alone
+ */
+#define ADAPT_MIN_NODES 16
+
+/**
+ * @brief Lookups per node, since the last move, after which a LINKED graph moves to HASHED
+ */
+#define ADAPT_LOOKUP_FACTOR 4
+
+/**
+ * @brief Create the implementation selection state of a graph, according to its configuration.
+ *
+ * Called by initGraphWithConfig() and cloneGraph() when the configuration asks for ADAPT_AUTO.  ARRAY graphs are left
+ * as they are.
+ *
+ * @param g Graph in question
+ * @return 1 if successful (or nothing was needed); 0 if the state could not be created.
+ */
+int graphAdaptInit(struct graph_t *g);
+
+/**
+ * @brief Replace the operations of a graph with dispatchers to its current implementation.
+ *
+ * Called by getOperations() for ADAPT_AUTO graphs, before any locking or statistics wrappers.
+ *
+ * @param gops Operations structure for a graph with selection state
+ * @return 1 if successful; 0 if the graph has no selection state.
+ */
+int graphAdaptWrap(struct graphops_t *gops);
+
+/**
+ * @brief Move a graph between the LINKED and HASHED implementations.
+ *
+ * Works on any LINKED or HASHED graph, whether ADAPT_AUTO or not; other operations must not run on the graph during
+ * the call.  The operations of ADAPT_AUTO graphs follow the move; for other graphs, operations structures from before
+ * the move must be replaced with a new one from getOperations().
+ *
+ * @param g Graph to be moved
+ * @param imptype LINKED or HASHED
+ * @return 1 if the graph now has the given implementation; 0 if it cannot be moved (ARRAY graphs and snapshot views)
+ * or the index could not be built.
+ */
+int migrateGraph(struct graph_t *g, enum GRAPHDOMAIN imptype);
+
+/**
+ * @brief Number of moves an ADAPT_AUTO graph has made between implementations
+ * @param g Graph in question
+ * @return Count of moves; 0 for graphs without selection state.
+ */
+size_t getGraphMigrations(const struct graph_t *g);
+
+/**
+ * @brief Clear out the implementation selection state of a graph
+ *
+ * The graph's adapt pointer will be changed to NULL.  Called by destroyGraph().
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if there was no state.
+ */
+int destroyGraphAdapt(struct graph_t *g);
+
+/**
+ * @brief Memory held by the implementation selection state of a graph
+ * @param g Graph in question
+ * @return Size in bytes; 0 for graphs without selection state.
+ */
+size_t graphAdaptMemory(const struct graph_t *g);
+
+#endif //GRAPHDATA_ADAPTIVE_H
@@ -0,0 +1,227 @@
+/**
+ * @brief Columnar attribute storage for graphs.
+ *
+ * The feature_t lists hung off each node_t and edge_t are convenient for individual items, but reading one feature for
+ * every node means walking a list per node.  The attribute store keeps one dense double column per feature name,
+ * indexed by node id (ATTR_NODE) or edge index (ATTR_EDGE), so the same feature across the whole graph is a single
+ * contiguous array.
+ *
+ * For ARRAY graphs, edge indexes are the offsets into the backing arrays (nodeid * degree + dimension), and columns are
+ * created at full length.  For other graphs, columns grow as values are set.
+ *
+ * Column names are interned in the graph's feature name table (graph_t.features), so a column is identified by its
+ * feature id and domain.  Columns are taken from the graph's allocator, and are released with the graph.
+ */
+
+#ifndef GRAPHDATA_ATTRSTORE_H
+#define GRAPHDATA_ATTRSTORE_H
+
+#include <graphData.h>
+
+/**
+ * @brief Column id returned when a column could not be found or created.
+ */
+#define ATTR_NONE ((size_t)-1)
+
+/**
+ * @brief Graph elements an attribute column is indexed by.
+ */
+enum ATTRDOMAIN {
+    /**
+     * @brief Column indexed by node id
+     */
+    ATTR_NODE = 0,
+    /**
+     * @brief Column indexed by edge index
+     */
+    ATTR_EDGE = 1
+};
+
+/**
+ * @brief Single dense attribute column
+ */
+struct attrcolumn_t {
+    /**
+     * @brief Feature id of the column name, from graphFeatureId()
+     */
+    size_t featureid;
+    /**
+     * @brief Elements the column is indexed by
+     */
+    enum ATTRDOMAIN domain;
+    /**
+     * @brief Value of entries that have not been set
+     */
+    double fill;
+    /**
+     * @brief Number of entries in vals
+     */
+    size_t len;
+    /**
+     * @brief Column values
+     */
+    double *vals;
+};
+
+/**
+ * @brief Set of attribute columns belonging to a graph
+ */
+struct attrstore_t {
+    /**
+     * @brief Number of columns in use
+     */
+    size_t colcount;
+    /**
+     * @brief Number of columns allocated
+     */
+    size_t colcap;
+    /**
+     * @brief Column array; column ids are indexes into this array.
+     */
+    struct attrcolumn_t *cols;
+    /**
+     * @brief Allocator of the owning graph
+     */
+    const struct graphallocator_t *allocator;
+};
+
+/**
+ * @brief Find the column with the given name and domain, creating it if necessary.
+ *
+ * New columns are filled with the fill value.  If the column already exists, the fill value is ignored.  Column ids are
+ * stable for the life of the graph, so callers should look a column up once and use the id for individual access.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @param fill Value of entries that have not been set
+ * @return Column id, if successful; otherwise, ATTR_NONE.
+ */
+size_t attrColumnId(struct graph_t *g, const char *name, enum ATTRDOMAIN domain, double fill);
+
+/**
+ * @brief Find the column for the given feature id and domain, creating it if necessary.
+ *
+ * Same as attrColumnId(), for callers that already hold the feature id.
+ *
+ * @param g Graph the column belongs to
+ * @param featureid Feature id from graphFeatureId()
+ * @param domain Elements the column is indexed by
+ * @param fill Value of entries that have not been set
+ * @return Column id, if successful; otherwise, ATTR_NONE.
+ */
+size_t attrFeatureColumn(struct graph_t *g, size_t featureid, enum ATTRDOMAIN domain, double fill);
+
+/**
+ * @brief Find an existing column with the given name and domain.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @return Column id, if found; otherwise, ATTR_NONE.
+ */
+size_t attrFindColumn(const struct graph_t *g, const char *name, enum ATTRDOMAIN domain);
+
+/**
+ * @brief Set a single attribute value.
+ *
+ * For non-ARRAY graphs, the column is grown (and filled) as needed to hold idx.
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param idx Node id or edge index
+ * @param val Value to be stored
+ * @return 1 if successful; 0 if the column or index is invalid, or the column could not grow.
+ */
+int setAttr(struct graph_t *g, size_t colid, size_t idx, double val);
+
+/**
+ * @brief Retrieve a single attribute value.
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param idx Node id or edge index
+ * @param val Set to the stored value, or the column fill value if the entry has never been set.
+ * @return 1 if successful; 0 if the column id is invalid.
+ */
+int getAttr(const struct graph_t *g, size_t colid, size_t idx, double *val);
+
+/**
+ * @brief Set a single attribute value by column name, creating the column (filled with 0.0) if necessary.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @param idx Node id or edge index
+ * @param val Value to be stored
+ * @return 1 if successful; otherwise, 0.
+ */
+int setAttrByName(struct graph_t *g, const char *name, enum ATTRDOMAIN domain, size_t idx, double val);
+
+/**
+ * @brief Retrieve a single attribute value by column name.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @param idx Node id or edge index
+ * @param val Set to the stored value
+ * @return 1 if successful; 0 if the column does not exist.
+ */
+int getAttrByName(const struct graph_t *g, const char *name, enum ATTRDOMAIN domain, size_t idx, double *val);
+
+/**
+ * @brief Direct access to a dense column, for bulk reads and writes.
+ *
+ * The pointer remains valid until the column grows (setAttr() past the end, or attrColumnReserve()).  For ARRAY graphs,
+ * columns never grow.
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param len Set to the number of entries in the column
+ * @return Pointer to the column values, or NULL if the column id is invalid or the column is empty.
+ */
+double * attrColumn(struct graph_t *g, size_t colid, size_t *len);
+
+/**
+ * @brief Grow a column to hold at least len entries
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param len Number of entries required
+ * @return 1 if successful; otherwise, 0.
+ */
+int attrColumnReserve(struct graph_t *g, size_t colid, size_t len);
+
+/**
+ * @brief Set every entry of a column to the given value
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param val Value to be stored
+ * @return 1 if successful; 0 if the column id is invalid.
+ */
+int attrColumnFill(struct graph_t *g, size_t colid, double val);
+
+/**
+ * @brief Clear out the attribute store of a graph and all of its columns
+ *
+ * The graph's store pointer will be changed to NULL.  Called by destroyGraph().
+ *
+ * @param g Graph owning the store
+ * @return 1 if successful; 0 if there was no store.
+ */
+int destroyAttrStore(struct graph_t *g);
+
+/**
+ * @brief Copy every attribute column of a graph into a clone
+ *
+ * Column ids are kept, so the clone must hold a copy of the original's feature name table.
+ *
+ * @param g Original graph
+ * @param ng Clone, without an attribute store
+ * @return 1 if successful (including when there are no columns); otherwise, 0.
+ */
+int cloneAttrStore(const struct graph_t *g, struct graph_t *ng);
+
+#endif //GRAPHDATA_ATTRSTORE_H
@@ -6,11 +6,63 @@
 #define GRAPHDATA_SPATIAL_H
 
 #include <graphData.h>
+#include <stdint.h>
+
+/**
+ * @brief Tile side used for ORDER_TILED when none is given
+ */
+#define CARTESIAN_DEFAULT_TILESIDE 8
+
+/**
+ * @brief Reciprocal multiplier for dividing 32-bit ids by one dimension
+ *
+ * For a dimension d of 2 or more, with l = ceil(log2(d)), n / d is ((t + ((n - t) >> 1)) >> shift), where t is the
+ * high half of magic * n.  The result is exact for every n below 2^32, and needs only a 32x32-bit multiply, so it maps
+ * onto SIMD lanes as well as scalar code.
+ */
+struct dimdivisor_t {
+    /**
+     * @brief floor(2^32 * (2^l - d) / d) + 1
+     */
+    uint32_t magic;
+    /**
+     * @brief l - 1
+     */
+    uint32_t shift;
+};
+
+/**
+ * @brief Precompute the strides, id count and reciprocal multipliers of a set of dimensions
+ *
+ * Called by createDimensions() and setDimensionOrder(); call it again if dimarr is changed afterwards.
+ *
+ * @param dims Dimensions to be prepared
+ * @return 0 if successful; -1 if the values passed are not valid, or the tables could not be allocated.
+ */
+int cartesianPrepare(struct dimensions_t *dims);
+
+/**
+ * @brief Select the order of the node ids over a set of dimensions
+ *
+ * The order applies to every graph created on the dimensions afterwards, and to the conversions below, so ARRAY storage
+ * and the coordinate helpers always agree.  It must be set before a graph is created on the dimensions.  Morton and
+ * tiled orders pad the dimensions (to powers of two, or to whole tiles), so cartesianIndexLength() grows to cover the
+ * unused ids; those ids are never produced by indexFromCartesian() and are rejected by cartesianFromIndex().
+ *
+ * Morton conversions use the BMI2 pdep/pext instructions when the library is built for a CPU that has them.
+ *
+ * @param dims Dimensions to be ordered
+ * @param order Order of the ids
+ * @param tileside Side of the tiles for ORDER_TILED; 0 for CARTESIAN_DEFAULT_TILESIDE.  Ignored for other orders.
+ * @return 0 if successful; 1 if the padded ids would not fit in a size_t; -1 if there is a problem with the values passed.
+ */
+int setDimensionOrder(struct dimensions_t *dims, enum NODEORDER order, size_t tileside);
 
 /**
  * @brief Sets array index value of the given set of dimensions, when calculated against the given dimensional array.
  *
  * This is function is used to provide transform between zero-based coordinates to a zero-based array index, for example.
+ * The index follows the order of the dimensions (setDimensionOrder()).
  *
  * @param dims Dimensions to be use for index calculation
  * @param idx size_t reference to be set
@@ -25,11 +77,13 @@ int indexFromCartesian(struct dimensions_t *dims, size_t *idx, size_t *coords);
  * the given spatial dimensions
  *
  * This function is used to transform between zero-based coordinates to a zero-based array index, for example.
+ * The index follows the order of the dimensions (setDimensionOrder()).
  *
  * @param idx Index value to be used
  * @param coords Array to hold the result
  * @param dims Dimensional value to be calculated against
- * @return 0 if successful, 1 if the index is outside the bounds of the dimensions.
+ * @return 0 if successful, 1 if the index is outside the bounds of the dimensions (including the unused ids of padded
+ * orders).
  */
 int cartesianFromIndex(size_t *idx, size_t *coords, struct dimensions_t *dims);
 
@@ -38,11 +92,56 @@ int cartesianFromIndex(size_t *idx, size_t *coords, struct dimensions_t *dims);
  *
  * This function multiplies the given dimensions and returns the size of an array that would be necessary to
  * hold all possible dimension values.  This is provided both as a consistent check and a means to consistently
- * return the proper value.
+ * return the proper value.  For Morton and tiled orders, the padded dimensions are multiplied instead.
  *
  * @param dims Dimensions to be checked
  * @return Size of index calculation.
  */
 size_t cartesianIndexLength(struct dimensions_t *dims);
 
+/**
+ * @brief Finds the index of the next node along one dimension
+ *
+ * Stencil code can walk the neighbors of a node this way in any order, without converting to coordinates and back.
+ *
+ * @param dims Dimensions to be used for the calculation
+ * @param idx Index of the starting node
+ * @param dim Dimension to step along
+ * @param next Set to the index of the node one step further along dim
+ * @return 0 if successful; 1 if the node is the last one along dim, or the index is outside the bounds of the
+ * dimensions; -1 if there is a problem with the values passed.
+ */
+int cartesianStep(struct dimensions_t *dims, size_t *idx, size_t dim, size_t *next);
+
+/**
+ * @brief Converts an array of indexes to coordinates
+ *
+ * Gives the same coordinates as calling cartesianFromIndex() on each index, without its per-call setup.  Row-major
+ * indexes below 2^32 are divided with the reciprocal multipliers of the dimensions, four at a time with AVX2 where the
+ * library is built for it.
+ *
+ * @param dims Dimensions to be calculated against
+ * @param idx Indexes to be converted
+ * @param count Number of indexes
+ * @param coords Array of count * dims->dimcount entries to hold the coordinates, one node after another.  The entries
+ * of indexes outside the bounds are not specified.
+ * @return 0 if successful; 1 if any index is outside the bounds of the dimensions; -1 if there is a problem with the
+ * values passed.
+ */
+int cartesianFromIndices(struct dimensions_t *dims, const size_t *idx, size_t count, size_t *coords);
+
+/**
+ * @brief Converts an array of coordinates to indexes
+ *
+ * Gives the same indexes as calling indexFromCartesian() on each set of coordinates, using the precomputed strides.
+ *
+ * @param dims Dimensions to be used for index calculation
+ * @param coords Coordinates to be converted, count * dims->dimcount entries, one node after another
+ * @param count Number of nodes
+ * @param idx Array of count entries to hold the indexes
+ * @return 0 if successful; 1 if any coordinates are outside the bounds of the dimensions; -1 if there is a problem with
+ * the values passed.
+ */
+int indicesFromCartesian(struct dimensions_t *dims, const size_t *coords, size_t count, size_t *idx);
+
 #endif //GRAPHDATA_SPATIAL_H
@@ -31,6 +31,10 @@
  * @brief Selector for labels
  */
 #define LABELSELECT LABELED | UNLABELED
+/**
+ * @brief Selector for storage flags, kept alongside the other selections
+ */
+#define STORESELECT SHARED_MMAP
 /**
  * @brief Check for no flags passed--return default
  */
@@ -44,7 +48,7 @@
  * @brief Parse the flag values passed, and write the evaluation into the separate references
  *
  * Parses out the separate possibilities for the flags. If the flag are empty, the default values
- * are written back to the tflags reference.
+ * are written back to the tflags reference.  Storage flags (STORESELECT) are written back unchanged.
  *
  * @param tflags Flag values passed to be evaluated
  * @param dirflag Directionality result of the operation
@@ -57,6 +61,95 @@ int parseTypeFlags(enum GRAPHDOMAIN *tflags, enum GRAPHDOMAIN *dirflag, enum GRA
                    enum GRAPHDOMAIN *lblflag, enum GRAPHDOMAIN *domflag);
 
 
+//Allocator operations
+
+/**
+ * @brief Retrieve the default allocator, which wraps malloc(), realloc() and free()
+ * @return Pointer to the (static) default allocator
+ */
+const struct graphallocator_t * defaultAllocator();
+
+/**
+ * @brief Check whether the given allocator is the default malloc()-based allocator (or NULL)
+ * @param a Allocator to be checked
+ * @return 1 if the allocator is the default; otherwise, 0.
+ */
+int isDefaultAllocator(const struct graphallocator_t *a);
+
+/**
+ * @brief Set a limit on the memory all graphs together may hold.
+ *
+ * Memory taken through a graph's allocator (graphAlloc(), graphRealloc() and allocArray() with a non-NULL allocator)
+ * counts against the limit.  Once it is reached, those allocations fail, so initGraph(), addNode(), addEdge() and the
+ * other operations that allocate return their usual failure values instead of exhausting the host.  Scratch lists
+ * handed to callers (NULL allocator) are not counted.
+ *
+ * @param bytes Limit in bytes; 0 removes the limit
+ */
+void setGraphMemoryLimit(size_t bytes);
+
+/**
+ * @brief Current limit on graph memory
+ * @return Limit in bytes; 0 if there is no limit.
+ */
+size_t getGraphMemoryLimit();
+
+/**
+ * @brief Memory currently held by all graphs
+ * @return Bytes allocated through graph allocators and not yet released
+ */
+size_t graphMemoryInUse();
+
+/**
+ * @brief Account for memory about to be allocated through a graph allocator, within the memory limit.
+ *
+ * Only needed by code that allocates graph memory without graphAlloc() (see allocArray()).
+ *
+ * @param a Allocator the memory will come from; NULL (scratch memory handed to callers) is not accounted
+ * @param size Number of bytes
+ * @return 1 if the memory may be allocated; 0 if it would exceed the limit.
+ */
+int graphMemReserve(const struct graphallocator_t *a, size_t size);
+
+/**
+ * @brief Account for memory released to a graph allocator
+ * @param a Allocator the memory came from; NULL is not accounted
+ * @param size Number of bytes, as reserved with graphMemReserve()
+ */
+void graphMemRelease(const struct graphallocator_t *a, size_t size);
+
+/**
+ * @brief Allocate memory from the given allocator
+ *
+ * Fails if the memory would exceed the limit set with setGraphMemoryLimit().
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param size Number of bytes
+ * @return Pointer to the memory, or NULL on failure
+ */
+void * graphAlloc(const struct graphallocator_t *a, size_t size);
+
+/**
+ * @brief Resize memory from the given allocator
+ *
+ * Allocators without a realloc function are handled with alloc, copy and free.
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ptr Block to be resized (may be NULL)
+ * @param oldsize Current size of the block
+ * @param newsize Requested size of the block
+ * @return Pointer to the resized block, or NULL on failure (ptr is left valid)
+ */
+void * graphRealloc(const struct graphallocator_t *a, void *ptr, size_t oldsize, size_t newsize);
+
+/**
+ * @brief Release memory to the given allocator
+ * @param a Allocator the memory came from; NULL for the default
+ * @param ptr Block to be released (may be NULL)
+ * @param size Size of the block, as passed to graphAlloc()
+ */
+void graphFree(const struct graphallocator_t *a, void *ptr, size_t size);
+
 //Creation operations
 
 /**
@@ -65,11 +158,22 @@ int parseTypeFlags(enum GRAPHDOMAIN *tflags, enum GRAPHDOMAIN *dirflag, enum GRA
  */
 struct graph_t * basicGraphInit();
 
+/**
+ * @brief Utility method to create and preset graph structure, using the given allocator
+ *
+ * The allocator is copied into graph_t.allocator, and used for all of the graph's internal structures.
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @return A pointer to a graph_t structure, if successful; otherwise, a pointer to NULL
+ */
+struct graph_t * basicGraphInitWith(const struct graphallocator_t *a);
+
 /**
  * @brief Create a dimension structure containing the given values in order (x, y, z, etc)
  *
  * This is used to initialize (and contain) the ordered size of the spatial dimensions given.  Consumers are responsible
- * for calling free() on the structure, or passing it to a standard clearing function
+ * for calling free() on the structure, or passing it to a standard clearing function.  Node ids over the dimensions are
+ * row-major; setDimensionOrder() (util/cartesian.h) selects another order before a graph is created on them.
  *
  * @param dimval First dimension in the ordered list of dimension limits
  * @param ... Additional dimension values passed
@@ -85,6 +189,41 @@ struct dimensions_t * createDimensions(size_t dimval, ...);
  */
 struct labels_t * initLabels(size_t lblcount);
 
+/**
+ * @brief Create a raw label structure of the given size, using the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @param lblcount Number of labels required
+ * @return Label structure properly initialized with a size_t array of the given size, if successful; otherwise, a NULL
+ * pointer.
+ */
+struct labels_t * initLabelsWith(const struct graphallocator_t *a, size_t lblcount);
+
+
+/**
+ * @brief Create a graph configuration structure holding the default settings
+ *
+ * Consumers are responsible for calling free() on the structure, or passing it to destroyConfig().
+ *
+ * @return Pointer to a graphconfig_t with default values, if successful; otherwise, a NULL pointer.
+ */
+struct graphconfig_t * initConfig();
+
+/**
+ * @brief Create a copy of the given graph configuration
+ *
+ * @param ocfg Configuration to be copied.  If NULL, the copy holds the default settings (same as initConfig()).
+ * @return Pointer to the new configuration, if successful; otherwise, a NULL pointer.
+ */
+struct graphconfig_t * copyConfig(const struct graphconfig_t *ocfg);
+
+/**
+ * @brief Create a copy of the given graph configuration, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ocfg Configuration to be copied.  If NULL, the copy holds the default settings (same as initConfig()).
+ * @return Pointer to the new configuration, if successful; otherwise, a NULL pointer.
+ */
+struct graphconfig_t * copyConfigWith(const struct graphallocator_t *a, const struct graphconfig_t *ocfg);
 
 /**
  * @brief Raw initializer for graphops_t structure
@@ -102,6 +241,13 @@ struct graphops_t * initGraphops();
  */
 struct edge_t * initEdge();
 
+/**
+ * @brief Allocate and initialize an edge, using the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @return pointer to new edge_t memory, if successful; otherwise, NULL.
+ */
+struct edge_t * initEdgeWith(const struct graphallocator_t *a);
+
 /**
  * @brief Allocate and initialize a node
  *
@@ -109,12 +255,26 @@ struct edge_t * initEdge();
  */
 struct node_t * initNode();
 
+/**
+ * @brief Allocate and initialize a node, using the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @return pointer to new node_t memory, if successful; otherwise, NULL.
+ */
+struct node_t * initNodeWith(const struct graphallocator_t *a);
+
 /**
  * @brief Allocate and initialize a feature structure
  * @return pointer to new feature_t memory, if successful; otherwise, NULL.
  */
 struct feature_t * initFeature();
 
+/**
+ * @brief Allocate and initialize a feature structure, using the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @return pointer to new feature_t memory, if successful; otherwise, NULL.
+ */
+struct feature_t * initFeatureWith(const struct graphallocator_t *a);
+
 //Clone operations
 
 /**
@@ -128,6 +288,15 @@ struct feature_t * initFeature();
  */
 struct node_t * cloneNode(const struct node_t *onode);
 
+/**
+ * @brief Create a copy of the given node, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param onode Original structure to be copied
+ * @return pointer to the cloned data, if successful; otherwise, a pointer to NULL
+ */
+struct node_t * cloneNodeWith(const struct graphallocator_t *a, const struct node_t *onode);
+
 /**
  * @brief Create a copy of the given edge
  *
@@ -139,6 +308,15 @@ struct node_t * cloneNode(const struct node_t *onode);
  */
 struct edge_t * cloneEdge(const struct edge_t *oedge);
 
+/**
+ * @brief Create a copy of the given edge, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param oedge Original structure to be copied
+ * @return pointer to the cloned data, if successful; otherwise, a pointer to NULL
+ */
+struct edge_t * cloneEdgeWith(const struct graphallocator_t *a, const struct edge_t *oedge);
+
 /**
  * @brief Create a copy of the given feature data
  *
@@ -147,18 +325,59 @@ struct edge_t * cloneEdge(const struct edge_t *oedge);
  */
 struct feature_t * cloneFeature(const struct feature_t *ofeat);
 
+/**
+ * @brief Create a copy of the given feature data, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ofeat Original structure to be copied
+ * @return pointer to the cloned data, if successful; otherwise, a pointer to NULL
+ */
+struct feature_t * cloneFeatureWith(const struct graphallocator_t *a, const struct feature_t *ofeat);
+
+/**
+ * @brief Create a copy of an entire feature list, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ofeat Head of the original list
+ * @param nfeat Set to the head of the copy (NULL for an empty list)
+ * @return 1 if successful; otherwise, 0 (and nothing is left allocated).
+ */
+int cloneFeaturesWith(const struct graphallocator_t *a, const struct feature_t *ofeat, struct feature_t **nfeat);
+
 
 //Free operations.
 /**
  * @brief Clear the graph and all underlying structures
  *
- * The pointer itself will be changed to NULL
+ * The pointer itself will be changed to NULL.  A graph with unreleased snapshots (see util/snapshot.h) is left
+ * untouched, since the snapshots still use its bookkeeping.
  *
  * @param gptr Graph structure to be cleared
- * @return 1 if success; 0 if error
+ * @return 1 if success; 0 if error (including for a graph with unreleased snapshots)
  */
 int destroyGraph(void** gptr);
 
+/**
+ * @brief Clear out a graph configuration structure
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param cfgptr Configuration structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyConfig(void** cfgptr);
+
+/**
+ * @brief Clear out a graph configuration structure created with the given allocator
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param a Allocator the structure came from; NULL for the default
+ * @param cfgptr pointer-to-pointer for the structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyConfigWith(const struct graphallocator_t *a, void** cfgptr);
+
 /**
  * @brief Clear out the dimensions and all underlying structures
  * @param dimptr Dimensions structure to be cleared
@@ -173,6 +392,17 @@ int destroyDimensions(void** dimptr);
  */
 int destroyLabels(void** lblptr);
 
+/**
+ * @brief Clear out a label structure created with the given allocator
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param a Allocator the structure came from; NULL for the default
+ * @param lblptr pointer-to-pointer for the structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyLabelsWith(const struct graphallocator_t *a, void** lblptr);
+
 /**
  * @brief Clear an edge structure and any linked edges (use on single or a path)
  *
@@ -183,6 +413,17 @@ int destroyLabels(void** lblptr);
  */
 int destroyEdges(void** eptr);
 
+/**
+ * @brief Clear out a edge or edge list created with the given allocator
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param a Allocator the structure came from; NULL for the default
+ * @param eptr pointer-to-pointer for the structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyEdgesWith(const struct graphallocator_t *a, void** eptr);
+
 /**
  * @brief Clear a graphops_t structure.
  * The graph itself will not be cleared, only the reference to it.  The pointer itself will be changed to NULL
@@ -202,6 +443,17 @@ int destroyGraphops(void** opsptr);
  */
 int destroyNodes(void** nptr);
 
+/**
+ * @brief Clear out a node or node list created with the given allocator
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param a Allocator the structure came from; NULL for the default
+ * @param nptr pointer-to-pointer for the structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyNodesWith(const struct graphallocator_t *a, void** nptr);
+
 /**
  * @brief Clear a feature or feature list (use on single or multiple attributes)
  *
@@ -212,4 +464,15 @@ int destroyNodes(void** nptr);
  */
 int destroyFeatures(void** fptr);
 
+/**
+ * @brief Clear out a feature or feature list created with the given allocator
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param a Allocator the structure came from; NULL for the default
+ * @param fptr pointer-to-pointer for the structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyFeaturesWith(const struct graphallocator_t *a, void** fptr);
+
 #endif //GRAPHDATA_CRUDOPS_H
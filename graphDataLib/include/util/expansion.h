@@ -0,0 +1,59 @@
+/**
+ * @brief Multi-label energy minimization on LABELED ARRAY graphs (alpha-expansion).
+ *
+ * The energy of a labeling l is
+ *
+ *     E(l) = sum_p D(p, l_p) + sum_(p,q) w_pq * V(l_p, l_q)
+ *
+ * where the data costs D are given per node and label, the pairwise weights w_pq are the capacities of the graph's
+ * edges, and V is a metric on the labels (the Potts model, V = [l_p != l_q], when none is given).  Each expansion move
+ * lets every node either keep its label or switch to label alpha, and finds the best such move with one binary max-flow
+ * over the graph's topology.  The flow workspace is allocated once and refilled for every move.
+ */
+
+#ifndef GRAPHDATA_EXPANSION_H
+#define GRAPHDATA_EXPANSION_H
+
+#include <graphData.h>
+
+/**
+ * @brief Distance between two labels, used as the pairwise cost V(a, b).
+ *
+ * For expansion moves to be optimal, the function must be a metric: V(a, a) = 0, V(a, b) = V(b, a) >= 0, and
+ * V(a, c) <= V(a, b) + V(b, c).
+ */
+typedef double (*funcLabelCost)(size_t a, size_t b, void *ctx);
+
+/**
+ * @brief Compute the energy of a labeling
+ *
+ * @param g LABELED ARRAY graph
+ * @param datacost Data costs, indexed label * nodecount + node (the node layout of LABELED ARRAY graphs)
+ * @param pairwise Label distance; NULL for the Potts model
+ * @param ctx Passed through to the pairwise function
+ * @param labeling Label of each node (nodecount entries)
+ * @return Energy of the labeling
+ */
+double labelingEnergy(const struct graph_t *g, const double *datacost, funcLabelCost pairwise, void *ctx,
+                      const size_t *labeling);
+
+/**
+ * @brief Minimize the labeling energy with alpha-expansion moves.
+ *
+ * The graph's label count gives the number of labels L, and its nodes [0, nodelen / L) are the ones being labeled; the
+ * edges among them carry the pairwise weights.  Cycles through all labels run until no move lowers the energy, or
+ * maxcycles is reached.
+ *
+ * @param g LABELED ARRAY graph
+ * @param datacost Data costs, indexed label * nodecount + node
+ * @param pairwise Label distance; NULL for the Potts model
+ * @param ctx Passed through to the pairwise function
+ * @param labeling Starting label of each node; set to the result (nodecount entries)
+ * @param maxcycles Maximum number of cycles through the labels; 0 for no limit
+ * @param energy Set to the energy of the resulting labeling; may be NULL
+ * @return 1 if successful; otherwise, 0.
+ */
+int alphaExpansion(const struct graph_t *g, const double *datacost, funcLabelCost pairwise, void *ctx,
+                   size_t *labeling, size_t maxcycles, double *energy);
+
+#endif //GRAPHDATA_EXPANSION_H
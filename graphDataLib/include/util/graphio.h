@@ -0,0 +1,92 @@
+/**
+ * @brief Streaming import and export of edge lists and DIMACS max-flow files.
+ *
+ * Readers work through a fixed-size buffer, so files of any size can be loaded without holding them in memory; only the
+ * graph itself grows.  Numbers are parsed by hand (eight digits at a time where the input allows it), without locale
+ * lookups or per-token copies, and parsed edges are inserted in batches through the graph's operations, so any backend
+ * can be loaded.  For LINKED and HASHED graphs, nodes are created as they are first seen; other backends must already
+ * have every node referenced by the file.
+ *
+ * Edge list format: one edge per line, "u v [capacity]", separated by spaces or tabs.  The capacity defaults to 1.
+ * Empty lines, and lines starting with '#' or '%', are skipped.
+ *
+ * DIMACS format: "c" comment lines, one "p max <nodes> <arcs>" line, "n <id> s" and "n <id> t" terminal lines, and
+ * "a <u> <v> <capacity>" arc lines.  DIMACS ids start at 1, and are one more than the graph ids.
+ *
+ * For UNDIRECTED graphs, the DIMACS writer emits each edge in both directions (as DIMACS tools expect), and the
+ * readers skip an edge that is already present.
+ *
+ * ARRAY graphs mark an empty slot with node 0, so a DIRECTED ARRAY graph cannot hold an edge into node 0 (DIMACS node
+ * 1).  Such an edge is a failed insert: the readers stop at its line and report it through errline.
+ */
+
+#ifndef GRAPHDATA_GRAPHIO_H
+#define GRAPHDATA_GRAPHIO_H
+
+#include <graphData.h>
+#include <stdio.h>
+
+/**
+ * @brief Size of the read buffer; also the longest line the readers accept.
+ */
+#define GRAPHIO_BUFSIZE 65536
+
+/**
+ * @brief Number of parsed edges inserted at a time
+ */
+#define GRAPHIO_BATCH 4096
+
+/**
+ * @brief Node id reported when a DIMACS file has no source or sink line
+ */
+#define GRAPHIO_NONE ((size_t)-1)
+
+/**
+ * @brief Read an edge list into a graph
+ *
+ * @param g Graph to be loaded
+ * @param in Stream to read from
+ * @param edgecount Set to the number of edges added; may be NULL
+ * @param errline Set to the line number of the first malformed line or failed insert, or 0; may be NULL
+ * @return 1 if the whole stream was read; otherwise, 0.
+ */
+int importEdgeList(struct graph_t *g, FILE *in, size_t *edgecount, size_t *errline);
+
+/**
+ * @brief Read a DIMACS max-flow file into a graph
+ *
+ * DIMACS node ids start at 1, so DIMACS node i becomes graph node i - 1.  Id 0 is rejected as malformed.
+ *
+ * @param g Graph to be loaded
+ * @param in Stream to read from
+ * @param source Set to the source node, or GRAPHIO_NONE; may be NULL
+ * @param sink Set to the sink node, or GRAPHIO_NONE; may be NULL
+ * @param edgecount Set to the number of edges added; may be NULL
+ * @param errline Set to the line number of the first malformed line or failed insert, or 0; may be NULL
+ * @return 1 if the whole stream was read; otherwise, 0.
+ */
+int importDimacs(struct graph_t *g, FILE *in, size_t *source, size_t *sink, size_t *edgecount, size_t *errline);
+
+/**
+ * @brief Write the edges of a graph as an edge list
+ *
+ * @param g Graph to be written (ARRAY, LINKED or HASHED)
+ * @param out Stream to write to
+ * @return 1 if successful; otherwise, 0.
+ */
+int exportEdgeList(const struct graph_t *g, FILE *out);
+
+/**
+ * @brief Write the edges of a graph as a DIMACS max-flow file
+ *
+ * Graph node i is written as DIMACS node i + 1, and the node count in the problem line is the highest id written.
+ *
+ * @param g Graph to be written (ARRAY, LINKED or HASHED)
+ * @param out Stream to write to
+ * @param source Source node
+ * @param sink Sink node
+ * @return 1 if successful; otherwise, 0.
+ */
+int exportDimacs(const struct graph_t *g, FILE *out, size_t source, size_t sink);
+
+#endif //GRAPHDATA_GRAPHIO_H
@@ -0,0 +1,205 @@
+/**
+ * @brief Per-graph operation statistics.
+ *
+ * A graph created with STATS_ON in its graphconfig_t has the operations returned by getOperations() wrapped to count
+ * calls, record latencies in log-linear (HDR-style) histograms, and total the probe lengths reported by the backends:
+ * slots scanned by ARRAY edge lookups, list nodes walked by LINKED node and edge lookups, and index slots and edges
+ * examined by HASHED lookups.
+ *
+ * Each thread records into its own shard of counters, so recording takes no locks and shares no cache lines between
+ * threads; getGraphStats() adds the shards up.  Reads may run while other threads record, and see each counter either
+ * before or after any one update.
+ *
+ * All of this is compiled in only when the library is built with GRAPHDATA_STATS (the CMake option of the same name).
+ * Otherwise STATS_ON is ignored, the backends carry no probe counting, and getGraphStats() reports nothing.
+ */
+
+#ifndef GRAPHDATA_GRAPHSTATS_H
+#define GRAPHDATA_GRAPHSTATS_H
+
+#include <graphData.h>
+#include <graphOps.h>
+#include <stdint.h>
+
+/**
+ * @brief Histogram buckets per power of two (as a bit count)
+ */
+#define STATS_SUB_BITS 3
+
+/**
+ * @brief Largest power of two with its own buckets; longer latencies go in STATS_OVERFLOW_BUCKET
+ */
+#define STATS_MAX_EXP 39
+
+/**
+ * @brief Bucket for latencies of 2^(STATS_MAX_EXP + 1) ns and longer, after the buckets of STATS_MAX_EXP
+ */
+#define STATS_OVERFLOW_BUCKET ((STATS_MAX_EXP - STATS_SUB_BITS + 2) << STATS_SUB_BITS)
+
+/**
+ * @brief Number of histogram buckets
+ */
+#define STATS_BUCKETS (STATS_OVERFLOW_BUCKET + 1)
+
+/**
+ * @brief Operations with statistics, one per graphops_t entry
+ */
+enum GRAPHSTATOP {
+    STATOP_NODECOUNT = 0,
+    STATOP_EDGECOUNT,
+    STATOP_GETNODE,
+    STATOP_GETEDGE,
+    STATOP_GETNEIGHBORS,
+    STATOP_GETEDGES,
+    STATOP_GETCAPACITY,
+    STATOP_GETFLOW,
+    STATOP_ADDNODE,
+    STATOP_REMOVENODE,
+    STATOP_ADDEDGE,
+    STATOP_REMOVEEDGE,
+    STATOP_SETCAPACITY,
+    STATOP_ADDCAPACITY,
+    STATOP_SETFLOW,
+    STATOP_ADDFLOW,
+    STATOP_ATOMICADDCAPACITY,
+    STATOP_ATOMICADDFLOW,
+    STATOP_RESETGRAPH,
+    /**
+     * @brief Number of operations
+     */
+    STATOP_COUNT
+};
+
+/**
+ * @brief Statistics of one operation
+ */
+struct opstats_t {
+    /**
+     * @brief Number of calls
+     */
+    uint64_t calls;
+    /**
+     * @brief Total probe length over all calls
+     */
+    uint64_t probes;
+    /**
+     * @brief Longest probe of a single call
+     */
+    uint64_t maxprobe;
+    /**
+     * @brief Total latency over all calls, in nanoseconds
+     */
+    uint64_t totalns;
+    /**
+     * @brief Latency histogram (see graphStatsBucketLimit())
+     */
+    uint64_t hist[STATS_BUCKETS];
+};
+
+/**
+ * @brief Statistics of a graph
+ */
+struct graphstats_t {
+    struct opstats_t ops[STATOP_COUNT];
+};
+
+/**
+ * @brief Statistics bookkeeping of a graph (opaque)
+ */
+struct statsstate_t;
+
+/**
+ * @brief Add up the statistics of a graph.
+ *
+ * @param g Graph in question
+ * @param stats Set to the totals over all threads
+ * @return 1 if successful; 0 if the graph keeps no statistics (including builds without GRAPHDATA_STATS).
+ */
+int getGraphStats(const struct graph_t *g, struct graphstats_t *stats);
+
+/**
+ * @brief Zero the statistics of a graph.
+ *
+ * Updates recorded by other threads during the reset may be lost.
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if the graph keeps no statistics.
+ */
+int resetGraphStats(struct graph_t *g);
+
+/**
+ * @brief Name of an operation, as used in reports
+ * @param op Operation
+ * @return Name of the operation (e.g. "addEdge"), or NULL if the operation is not valid
+ */
+const char * graphStatOpName(enum GRAPHSTATOP op);
+
+/**
+ * @brief Largest latency counted in a histogram bucket
+ * @param bucket Bucket index
+ * @return Upper limit of the bucket, in nanoseconds
+ */
+uint64_t graphStatsBucketLimit(size_t bucket);
+
+/**
+ * @brief Estimate a latency percentile from a histogram
+ * @param op Operation statistics
+ * @param pct Percentile (0-100)
+ * @return Upper limit of the bucket holding the percentile, in nanoseconds; 0 if there were no calls.
+ */
+uint64_t graphStatsPercentile(const struct opstats_t *op, double pct);
+
+/**
+ * @brief Create the statistics bookkeeping of a graph, according to its configuration.
+ *
+ * Called by initGraphWithConfig() and cloneGraph() when the configuration asks for STATS_ON.
+ *
+ * @param g Graph in question
+ * @return 1 if successful, or if the build has no statistics; 0 if the bookkeeping could not be created.
+ */
+int graphStatsInit(struct graph_t *g);
+
+/**
+ * @brief Replace the operations of a graph with recording wrappers.
+ *
+ * The originals are kept in the graph's statistics bookkeeping.  Called by getOperations() for graphs with statistics,
+ * after any locking wrappers, so recorded latencies include lock waits.
+ *
+ * @param gops Operations structure for a graph with statistics
+ * @return 1 if successful; 0 if the graph keeps no statistics.
+ */
+int graphStatsWrap(struct graphops_t *gops);
+
+/**
+ * @brief Clear out the statistics bookkeeping of a graph
+ *
+ * The graph's stats pointer will be changed to NULL.  Called by destroyGraph().
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if there was no bookkeeping.
+ */
+int destroyGraphStats(struct graph_t *g);
+
+/**
+ * @brief Memory held by the statistics bookkeeping of a graph, including every thread's shard
+ * @param g Graph in question
+ * @return Size in bytes; 0 if the graph keeps no statistics.
+ */
+size_t graphStatsMemory(const struct graph_t *g);
+
+/**
+ * @brief Add to the probe length of the operation running on this thread.  Use GRAPHSTATS_PROBE() in the backends.
+ * @param depth Slots or list nodes examined
+ */
+void graphStatsProbe(size_t depth);
+
+#ifdef GRAPHDATA_STATS
+/**
+ * @brief Report a probe length from a backend lookup; compiled out without GRAPHDATA_STATS.
+ */
+#define GRAPHSTATS_PROBE(g, depth) do { if ((g)->stats != NULL) graphStatsProbe(depth); } while (0)
+#else
+#define GRAPHSTATS_PROBE(g, depth) do { } while (0)
+#endif
+
+#endif //GRAPHDATA_GRAPHSTATS_H
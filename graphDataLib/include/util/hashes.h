@@ -6,6 +6,7 @@
 #define GRAPHDATA_HASHES_H
 
 #include <stdio.h>
+#include <stdint.h>
 
 /**
  * Calculate a unique hash for the char data.
@@ -16,15 +17,80 @@
  */
 size_t SuperFastHash (const char * data, int len);
 
+/**
+ * @brief Default seed for WyHash64() and WyHash64Batch()
+ */
+#define HASH_SEED64 0x9e3779b97f4a7c15ULL
+
+/**
+ * @brief Calculate a 64-bit hash of the char data.
+ *
+ * wyhash-style multiply-mix hash: the input is consumed 8 bytes at a time through 64x64->128 bit multiplies, so it is
+ * much faster than SuperFastHash() on long keys, and keys of 16 bytes or less take a single multiply round.  The
+ * result depends on the byte order of the platform.
+ *
+ * @param data character data to be hashed
+ * @param len Length of the character data
+ * @param seed Hash seed (HASH_SEED64, unless independent hash functions are needed)
+ * @return hash value of the character data, if not null and not empty; otherwise, zero.
+ */
+uint64_t WyHash64(const char *data, size_t len, uint64_t seed);
+
+/**
+ * @brief Calculate the 64-bit hashes of a batch of keys.
+ *
+ * Gives the same results as calling WyHash64() for each key.  Keys are processed in groups whose hash states are
+ * independent, so the multiplies of neighbouring keys overlap rather than waiting on one another, and the hashes are
+ * written to a contiguous output array ready for bucket calculations.
+ *
+ * @param keys Array of n key pointers (entries may be NULL)
+ * @param lens Array of n key lengths
+ * @param n Number of keys
+ * @param seed Hash seed
+ * @param out Array of n hashes to be filled
+ */
+void WyHash64Batch(const char *const *keys, const size_t *lens, size_t n, uint64_t seed, uint64_t *out);
+
 /**
  * @brief Using the Sieve of Eratosthenes, calculate the max prime value below the given value
  *
- * Quick and dirty (not necessarily computationally quick) way to get the max prime number below the given
- * value.
+ * Same as maxPrimeBelow(), which it now calls.
  *
  * @param idx Size value to search the max prime number below
  * @return Max prime number within the range given by the input, if successful; otherwise 0
  */
 size_t maxEratosthenesPrime(size_t *idx);
 
+/**
+ * @brief Calculate the max prime value below the given value
+ *
+ * Up to 2^32, searches downward from idx with a segmented sieve: one sieve of the base primes up to sqrt(idx) (at most
+ * 64 KB) and one 4 KB window below idx at a time.  Above 2^32, candidates are tested with isPrime() instead, so no
+ * more than about 68 KB is used for any idx.
+ *
+ * @param idx Value to search the max prime number below
+ * @return Largest prime strictly less than idx, if there is one; otherwise 0
+ */
+size_t maxPrimeBelow(size_t idx);
+
+/**
+ * @brief Deterministic primality test (Miller-Rabin with a base set that is exact for 64-bit values)
+ *
+ * @param n Value to be tested
+ * @return 1 if n is prime; otherwise, 0.
+ */
+int isPrime(size_t n);
+
+/**
+ * @brief Choose a prime bucket count for a hash table of at least the given size
+ *
+ * Answers come from a precomputed table holding the largest prime below each power of two, so the lookup is a short
+ * scan with no prime computation--rehashing never waits on a sieve.  Growing a table by passing twice its current
+ * bucket count steps through the table one entry at a time.
+ *
+ * @param minsize Minimum number of buckets
+ * @return Smallest tabled prime that is at least minsize, or 0 if minsize is beyond the table
+ */
+size_t primeTableSize(size_t minsize);
+
 #endif //GRAPHDATA_HASHES_H
@@ -0,0 +1,96 @@
+/**
+ * @brief Image and volume ingestion into SPATIAL ARRAY graphs.
+ *
+ * The loaders read PGM/PPM images (P2, P3, P5, P6; 8 or 16 bits per sample) and raw 8/16-bit volumes into an
+ * UNDIRECTED ARRAY SPATIAL graph with one node per pixel or voxel, and wire up the grid stencil with boundary-term
+ * capacities.  Sample values are kept, unscaled, in an intensity array alongside the graph.
+ *
+ * arrayBoundaryWeights() writes the whole stencil directly into the backing arrays in one pass over the nodes, rather
+ * than through per-edge addEdge()/setCapacity() calls.  Slot k of node p holds the neighbor one step along dimension k,
+ * which is the layout addEdge() would have produced, so the regular operations work on the result.
+ */
+
+#ifndef GRAPHDATA_IMAGEIO_H
+#define GRAPHDATA_IMAGEIO_H
+
+#include <graphData.h>
+#include <stdio.h>
+
+/**
+ * @brief Graph built from an image or volume, with the data it was built from.
+ */
+struct imagegraph_t {
+    /**
+     * @brief UNDIRECTED ARRAY SPATIAL graph, one node per pixel or voxel
+     */
+    struct graph_t *g;
+    /**
+     * @brief Dimensions of the graph (width, height[, depth]), owned by this structure
+     */
+    struct dimensions_t *dims;
+    /**
+     * @brief Samples per pixel (1 for gray, 3 for RGB)
+     */
+    size_t channels;
+    /**
+     * @brief Largest possible sample value (255 or 65535 for raw volumes; the header value for PGM/PPM)
+     */
+    size_t maxval;
+    /**
+     * @brief Sample values, node-major and channel-interleaved (nodecount * channels)
+     */
+    double *intensity;
+};
+
+/**
+ * @brief Compute the grid stencil of a SPATIAL ARRAY graph with boundary-term capacities.
+ *
+ * Every node p is connected to its next neighbor q along each dimension, with capacity
+ * exp(-|I_p - I_q|^2 / (2 sigma^2)), where |.| is the Euclidean distance over the channels.  Any edges the nodes
+ * already had are replaced, and flows are zeroed.
+ *
+ * @param g UNDIRECTED ARRAY graph with dimensions
+ * @param intensity Sample values, node-major and channel-interleaved
+ * @param channels Samples per node
+ * @param sigma Intensity scale of the boundary term; must be positive
+ * @return 1 if successful; otherwise, 0.
+ */
+int arrayBoundaryWeights(struct graph_t *g, const double *intensity, size_t channels, double sigma);
+
+/**
+ * @brief Load a PGM or PPM image into a graph.
+ *
+ * @param in Stream positioned at the start of the image
+ * @param sigma Intensity scale of the boundary term
+ * @return Pointer to the image graph, if successful; otherwise, NULL.  Release with destroyImageGraph().
+ */
+struct imagegraph_t * loadPNM(FILE *in, double sigma);
+
+/**
+ * @brief Load a raw volume of 8- or 16-bit samples into a graph.
+ *
+ * Samples are in x-fastest order, with no header.  A depth of 1 gives a two-dimensional graph.
+ *
+ * @param in Stream positioned at the first sample
+ * @param width Samples along x
+ * @param height Samples along y
+ * @param depth Samples along z
+ * @param bytesper Bytes per sample (1 or 2)
+ * @param bigendian Nonzero if 16-bit samples are stored most significant byte first
+ * @param sigma Intensity scale of the boundary term
+ * @return Pointer to the image graph, if successful; otherwise, NULL.  Release with destroyImageGraph().
+ */
+struct imagegraph_t * loadRawVolume(FILE *in, size_t width, size_t height, size_t depth, size_t bytesper,
+                                    int bigendian, double sigma);
+
+/**
+ * @brief Clear out an image graph, including its graph, dimensions and samples
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param igptr pointer-to-pointer for the image graph
+ * @return 1 if successful; 0 if error
+ */
+int destroyImageGraph(void **igptr);
+
+#endif //GRAPHDATA_IMAGEIO_H
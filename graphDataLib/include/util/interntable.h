@@ -0,0 +1,140 @@
+/**
+ * @brief Interning of feature names to small integer ids.
+ *
+ * Feature names are hashed once, when they are interned.  After that, a feature is identified by its id, so comparing
+ * features is an integer compare rather than a string hash and compare.  Ids are dense (0, 1, 2, ...) in order of first
+ * use, so they can index arrays directly.
+ *
+ * The table uses open addressing with linear probing, and keeps the hash of each name so that growing the table never
+ * rehashes the strings.
+ */
+
+#ifndef GRAPHDATA_INTERNTABLE_H
+#define GRAPHDATA_INTERNTABLE_H
+
+#include <graphData.h>
+
+/**
+ * @brief Id returned when a name is not (and could not be) interned.
+ */
+#define INTERN_NONE ((size_t)-1)
+
+/**
+ * @brief Single interned name
+ */
+struct internentry_t {
+    /**
+     * @brief Interned name (owned by the table)
+     */
+    char *name;
+    /**
+     * @brief Cached hash of the name
+     */
+    size_t hash;
+};
+
+/**
+ * @brief Name-to-id intern table
+ */
+struct interntable_t {
+    /**
+     * @brief Number of names interned
+     */
+    size_t count;
+    /**
+     * @brief Number of hash slots (always a power of two)
+     */
+    size_t slotcount;
+    /**
+     * @brief Hash slots, each holding id + 1, or 0 if empty
+     */
+    size_t *slots;
+    /**
+     * @brief Number of entries allocated
+     */
+    size_t entrycap;
+    /**
+     * @brief Interned names, indexed by id
+     */
+    struct internentry_t *entries;
+    /**
+     * @brief Allocator the table was created with
+     */
+    const struct graphallocator_t *allocator;
+};
+
+/**
+ * @brief Create an empty intern table
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @return Pointer to the new table, if successful; otherwise, NULL.  Release with destroyInternTable().
+ */
+struct interntable_t * initInternTable(const struct graphallocator_t *a);
+
+/**
+ * @brief Retrieve the id of the given name, interning it if necessary
+ *
+ * @param t Intern table
+ * @param name Name to be interned
+ * @return Id of the name, if successful; otherwise, INTERN_NONE.
+ */
+size_t internName(struct interntable_t *t, const char *name);
+
+/**
+ * @brief Retrieve the id of a name already in the table
+ *
+ * @param t Intern table
+ * @param name Name to be found
+ * @return Id of the name, if found; otherwise, INTERN_NONE.
+ */
+size_t internLookup(const struct interntable_t *t, const char *name);
+
+/**
+ * @brief Retrieve the name for the given id
+ *
+ * @param t Intern table
+ * @param id Id returned by internName()
+ * @return The interned name (owned by the table), or NULL if the id is not valid.
+ */
+const char * internedName(const struct interntable_t *t, size_t id);
+
+/**
+ * @brief Clear out an intern table and all of its names
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param tptr pointer-to-pointer for the table
+ * @return 1 if successful; 0 if error
+ */
+int destroyInternTable(void **tptr);
+
+/**
+ * @brief Create a copy of an intern table, keeping every id
+ *
+ * @param a Allocator to be used for the copy; NULL for the default
+ * @param t Table to be copied
+ * @return Pointer to the new table, if successful; otherwise, NULL.  Release with destroyInternTable().
+ */
+struct interntable_t * cloneInternTable(const struct graphallocator_t *a, const struct interntable_t *t);
+
+/**
+ * @brief Retrieve the feature id for the given name in the graph's feature name table, interning it if necessary.
+ *
+ * The id is meant to be stored in feature_t.hashid, so feature lists can be searched with findFeature().
+ *
+ * @param g Graph in question
+ * @param name Feature name
+ * @return Feature id, if successful; otherwise, INTERN_NONE.
+ */
+size_t graphFeatureId(struct graph_t *g, const char *name);
+
+/**
+ * @brief Find the feature with the given id in a feature list
+ *
+ * @param attrs Feature list (node_t.attrs or edge_t.attrs)
+ * @param featureid Id from graphFeatureId()
+ * @return Pointer to the feature, if found; otherwise, NULL.
+ */
+struct feature_t * findFeature(struct feature_t *attrs, size_t featureid);
+
+#endif //GRAPHDATA_INTERNTABLE_H
@@ -0,0 +1,149 @@
+/**
+ * @brief Max-flow / min-cut over the topology of ARRAY graphs.
+ *
+ * The solver works directly on the node array of an ARRAY graph: every used slot (u, v) of the node array is an arc
+ * pair u->v / v->u, and every node can have a capacity from the source and to the sink.  All residual capacities live
+ * in a workspace that is allocated once and can be refilled for any number of solves over the same topology, which is
+ * what iterative optimizers (e.g. alpha-expansion) need.
+ *
+ * The algorithm is Dinic's (BFS level graph plus blocking flow), with an explicit stack so that long augmenting paths
+ * on large grids do not recurse.
+ *
+ * regionMaxFlow() solves the same problem for graphs too large for one process to work through: the nodes are split
+ * by a partition (util/partition.h), and each part is solved by its own worker process with region push-relabel.  The
+ * residual network lives in shared memory, and each worker only touches the nodes of its part and the arcs leaving
+ * them; between rounds, the workers exchange just the flows pushed over boundary arcs and the labels of the nodes at
+ * either end.
+ */
+
+#ifndef GRAPHDATA_MAXFLOW_H
+#define GRAPHDATA_MAXFLOW_H
+
+#include <graphData.h>
+
+/**
+ * @brief Push rounds regionMaxFlow() runs between exact relabels of the whole graph
+ */
+#define FLOW_RELABEL_ROUNDS 8
+
+struct partition_t;
+
+/**
+ * @brief Residual network for repeated max-flow solves over one ARRAY topology (opaque)
+ */
+struct flowworkspace_t;
+
+/**
+ * @brief Create a workspace for the first nodecount nodes of an ARRAY graph.
+ *
+ * Slots whose neighbor is outside [0, nodecount) are ignored.  The workspace refers to the node array of the graph, so
+ * the topology must not change while the workspace is in use.  For tiled SHARED_MMAP graphs, the node slots are copied
+ * into the workspace tile by tile instead.
+ *
+ * @param g ARRAY or SHARED_MMAP graph
+ * @param nodecount Number of nodes taking part; 0 for all nodes of the graph
+ * @return Pointer to the workspace, if successful; otherwise, NULL.  Release with destroyFlowWorkspace().
+ */
+struct flowworkspace_t * initFlowWorkspace(const struct graph_t *g, size_t nodecount);
+
+/**
+ * @brief Clear out a workspace
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param wsptr pointer-to-pointer for the workspace
+ * @return 1 if successful; 0 if error
+ */
+int destroyFlowWorkspace(void **wsptr);
+
+/**
+ * @brief Zero every capacity of the workspace
+ * @param ws Workspace
+ */
+void flowReset(struct flowworkspace_t *ws);
+
+/**
+ * @brief Add capacity to the arc between the node of a slot and its neighbor.
+ *
+ * @param ws Workspace
+ * @param slot Index into the node array (nodeid * degree + dimension)
+ * @param forward Capacity added from the slot's node to its neighbor
+ * @param backward Capacity added from the neighbor to the slot's node
+ */
+void flowAddArc(struct flowworkspace_t *ws, size_t slot, double forward, double backward);
+
+/**
+ * @brief Add terminal capacities to a node
+ *
+ * @param ws Workspace
+ * @param nodeid Node id
+ * @param source Capacity added from the source (paid when the node ends up on the sink side)
+ * @param sink Capacity added to the sink (paid when the node ends up on the source side)
+ */
+void flowAddTerminal(struct flowworkspace_t *ws, size_t nodeid, double source, double sink);
+
+/**
+ * @brief Compute the maximum flow with the current capacities
+ *
+ * The residual capacities are consumed; refill the workspace (flowReset() and the add functions) before solving again.
+ *
+ * @param ws Workspace
+ * @return Value of the maximum flow (equal to the cost of the minimum cut)
+ */
+double flowSolve(struct flowworkspace_t *ws);
+
+/**
+ * @brief Side of the minimum cut a node ended up on, after flowSolve()
+ * @param ws Workspace
+ * @param nodeid Node id
+ * @return 1 if the node is on the sink side; 0 if it is on the source side.
+ */
+int flowSinkSide(const struct flowworkspace_t *ws, size_t nodeid);
+
+/**
+ * @brief Flow through the arc of a slot, after flowSolve()
+ * @param ws Workspace
+ * @param slot Index into the node array
+ * @return Net flow from the slot's node to its neighbor (negative if the flow runs the other way)
+ */
+double flowArcFlow(const struct flowworkspace_t *ws, size_t slot);
+
+/**
+ * @brief Compute the maximum flow of an ARRAY graph, using the edge capacities as arc capacities.
+ *
+ * For UNDIRECTED graphs, each edge can carry its capacity in either direction.  The resulting net flow of each edge is
+ * written to the flow array of the graph.  Tiled SHARED_MMAP graphs are solved too: their capacities are read and
+ * their flows written one tile at a time, but the residual network (about three words per slot) is held in memory.
+ *
+ * @param g ARRAY or SHARED_MMAP graph
+ * @param source Capacity from the source to each node (nodelen entries)
+ * @param sink Capacity from each node to the sink (nodelen entries)
+ * @param sinkside Set to 1 for the nodes on the sink side of the minimum cut, 0 otherwise (nodelen entries); may be
+ * NULL
+ * @param flow Set to the value of the maximum flow
+ * @return 1 if successful; otherwise, 0.
+ */
+int arrayMaxFlow(struct graph_t *g, const double *source, const double *sink, unsigned char *sinkside, double *flow);
+
+/**
+ * @brief Compute the maximum flow of an ARRAY graph with one worker process per part of a partition.
+ *
+ * Gives the same flow value and minimum cut as arrayMaxFlow(), and writes a maximum flow to the flow array of the
+ * graph; the flows of individual edges may differ where the maximum flow is not unique.  Worker 0 runs in the calling
+ * process, and the others are forked from it, so they see the graph and the partition without copying; the residual
+ * network is placed in anonymous shared mappings that the workers fill in for their own parts.  The graph's topology
+ * and capacities must not change during the call.  On systems without fork(), the graph is solved by arrayMaxFlow().
+ *
+ * @param g ARRAY graph
+ * @param p Partition of g, from partitionGraph()
+ * @param source Capacity from the source to each node (nodelen entries)
+ * @param sink Capacity from each node to the sink (nodelen entries)
+ * @param sinkside Set to 1 for the nodes on the sink side of the minimum cut, 0 otherwise (nodelen entries); may be
+ * NULL
+ * @param flow Set to the value of the maximum flow
+ * @return 1 if successful; otherwise, 0 (including when a worker cannot be started or exits abnormally).
+ */
+int regionMaxFlow(struct graph_t *g, const struct partition_t *p, const double *source, const double *sink,
+                  unsigned char *sinkside, double *flow);
+
+#endif //GRAPHDATA_MAXFLOW_H
@@ -0,0 +1,156 @@
+/**
+ * @brief Bulk memory operations for the large backing arrays of graph implementations.
+ *
+ * ARRAY graphs can hold gigabytes of node, capacity and flow data.  The functions here provide the allocation, zeroing
+ * and partitioning primitives used to create and reset those arrays without walking them element-by-element on a
+ * single thread.
+ *
+ * The partitioning given by memChunkRange() is the standard split of array work across threads for the library.  The
+ * same split is used for resets, so that each worker re-touches the pages it first touched (NUMA first-touch placement).
+ */
+
+#ifndef GRAPHDATA_MEMOPS_H
+#define GRAPHDATA_MEMOPS_H
+
+#include <stdlib.h>
+#include <graphData.h>
+
+/**
+ * @brief Minimum number of bytes handed to a single worker thread for bulk operations.
+ *
+ * Below this size, the cost of starting a thread outweighs the memory bandwidth gained.
+ */
+#define MEM_MIN_CHUNK (4UL * 1024UL * 1024UL)
+
+/**
+ * @brief Huge page size used for alignment of ALLOC_ALIGNED, ALLOC_THP and ALLOC_HUGETLB arrays.
+ */
+#define MEM_HUGE_PAGE (2UL * 1024UL * 1024UL)
+
+/**
+ * @brief Allocate a zeroed array of count elements of the given size.
+ *
+ * Uses calloc(), so large arrays are backed by the zero pages of fresh mmap() regions and are not touched until used.
+ * Physical placement of each page is therefore decided by the first thread that writes to it.
+ *
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return Pointer to the zeroed memory, if successful; otherwise, NULL (including on count * size overflow).
+ */
+void * allocZeroed(size_t count, size_t size);
+
+/**
+ * @brief Allocate a zeroed array of count elements of the given size, using the given allocation strategy.
+ *
+ * If the strategy cannot be satisfied, the next weaker strategy is tried (HUGETLB, THP, MMAP, MALLOC), except that
+ * ALLOC_ALIGNED falls back directly to ALLOC_MALLOC.  The strategy that was actually used is written to *used, and must
+ * be passed to freeArray().
+ *
+ * Mapped arrays (ALLOC_MMAP and stronger) are page-aligned, so they can have a NUMA policy bound to them.  Only
+ * ALLOC_MALLOC arrays are taken from the given allocator; the other strategies always go to the system directly.  Either
+ * way, the array counts against the graph memory limit (see setGraphMemoryLimit()) when an allocator is given.
+ *
+ * @param a Allocator used for ALLOC_MALLOC arrays; NULL for the default
+ * @param count Number of elements
+ * @param size Size of each element
+ * @param strategy Requested allocation strategy
+ * @param used Set to the strategy actually used
+ * @return Pointer to the zeroed memory, if successful; otherwise, NULL.
+ */
+void * allocArray(const struct graphallocator_t *a, size_t count, size_t size, enum ALLOCSTRATEGY strategy,
+                  enum ALLOCSTRATEGY *used);
+
+/**
+ * @brief Release an array created with allocArray()
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param a Allocator the array was created with; NULL for the default
+ * @param count Number of elements the array was allocated with
+ * @param size Element size the array was allocated with
+ * @param used Strategy reported by allocArray()
+ * @param arrptr pointer-to-pointer for the array
+ * @return 1 if successful; 0 if error
+ */
+int freeArray(const struct graphallocator_t *a, size_t count, size_t size, enum ALLOCSTRATEGY used, void **arrptr);
+
+/**
+ * @brief Memory actually taken by an array created with allocArray(), including the rounding to whole pages
+ * @param count Number of elements the array was allocated with
+ * @param size Element size the array was allocated with
+ * @param used Strategy reported by allocArray()
+ * @return Size in bytes
+ */
+size_t arrayFootprint(size_t count, size_t size, enum ALLOCSTRATEGY used);
+
+/**
+ * @brief Page size backing memory allocated with the given strategy.
+ * @param used Strategy reported by allocArray()
+ * @return Page size in bytes
+ */
+size_t memPageSize(enum ALLOCSTRATEGY used);
+
+/**
+ * @brief Calculate the number of worker threads to be used for a bulk operation over the given number of bytes.
+ *
+ * @param bytes Total size of the operation
+ * @return Number of workers (including the calling thread); always at least 1.
+ */
+size_t memThreadCount(size_t bytes);
+
+/**
+ * @brief Calculate the [start, end) range of the given part when len elements are split into parts.
+ *
+ * Ranges are contiguous and as equal as possible; the first (len % parts) ranges hold one extra element.
+ *
+ * @param len Number of elements to be split
+ * @param parts Number of parts
+ * @param part Zero-based part number
+ * @param start Set to the first element of the part
+ * @param end Set to one past the last element of the part
+ * @return 1 if successful; 0 if parts is zero or part is out of range.
+ */
+int memChunkRange(size_t len, size_t parts, size_t part, size_t *start, size_t *end);
+
+/**
+ * @brief Zero the given memory using all available workers and streaming (non-temporal) stores.
+ *
+ * The memory is split with memChunkRange() over the element size given, so element boundaries are never split
+ * between workers.  Streaming stores bypass the cache, so resetting an array much larger than the cache does not
+ * evict the working set of other threads.
+ *
+ * @param base Start of the memory to be zeroed
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return 1 if successful; 0 if base is NULL.
+ */
+int parallelZero(void *base, size_t count, size_t size);
+
+/**
+ * @brief Copy memory using all available workers.
+ *
+ * The memory is split with memChunkRange() over the element size given, the same as parallelZero(), so each page of
+ * the destination is first touched by the worker that later resets it.
+ *
+ * @param dst Destination of the copy (must not overlap the source)
+ * @param src Source of the copy
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return 1 if successful; 0 if either pointer is NULL.
+ */
+int parallelCopy(void *dst, const void *src, size_t count, size_t size);
+
+/**
+ * @brief Atomically add a value to a double.
+ *
+ * Implemented as a compare-and-swap loop on the 64-bit pattern of the double, since there is no hardware atomic
+ * floating-point add.  The slot must be 8-byte aligned.
+ *
+ * @param slot Value to be adjusted
+ * @param delta Amount to be added
+ * @param order Memory ordering of the update
+ * @return Value of the slot after the update
+ */
+double atomicAddDouble(double *slot, double delta, enum MEMORDER order);
+
+#endif //GRAPHDATA_MEMOPS_H
@@ -0,0 +1,71 @@
+/**
+ * @brief Memory footprint of graphs.
+ *
+ * graphMemoryUsage() walks a graph and reports the bytes it holds, split by what they are for.  The figures are the
+ * sizes requested from the allocator, plus an estimate of what the allocator adds on top: the rounding of mmap and
+ * aligned arrays to whole pages, and the block headers of heap allocations made through the default allocator.
+ * Custom allocators are assumed to add nothing.
+ *
+ * Dimensions are not counted, since graphs only refer to them.  Memory shared with another graph (the node array of a
+ * CLONE_STRUCTURE clone, the edges a snapshot view shares with the live graph) is counted once, by the graph owning it.
+ *
+ * The global limit on graph memory is set with setGraphMemoryLimit() (see util/crudops.h).
+ */
+
+#ifndef GRAPHDATA_MEMUSAGE_H
+#define GRAPHDATA_MEMUSAGE_H
+
+#include <graphData.h>
+
+/**
+ * @brief Memory held by a graph, in bytes
+ */
+struct graphmemory_t {
+    /**
+     * @brief Graph structure: the ARRAY node array, or the LINKED and HASHED node and edge structures (less their
+     * values) and node index
+     */
+    size_t topology;
+    /**
+     * @brief Capacity values, over every value layer
+     */
+    size_t capacities;
+    /**
+     * @brief Flow values, over every value layer
+     */
+    size_t flows;
+    /**
+     * @brief Feature name table, attribute columns and feature lists
+     */
+    size_t features;
+    /**
+     * @brief Label structure and label array
+     */
+    size_t labels;
+    /**
+     * @brief The graph_t, configuration, backend metadata, locking, snapshot, statistics and implementation selection
+     * state
+     */
+    size_t bookkeeping;
+    /**
+     * @brief Estimated allocator overhead: page rounding and heap block headers
+     */
+    size_t overhead;
+    /**
+     * @brief Sum of all of the above
+     */
+    size_t total;
+};
+
+/**
+ * @brief Report the memory held by a graph
+ *
+ * The graph must not be modified during the call.
+ *
+ * @param g Graph in question
+ * @param report Filled in with the breakdown
+ * @return 1 if successful; 0 if the graph or report is NULL.
+ */
+int graphMemoryUsage(const struct graph_t *g, struct graphmemory_t *report);
+
+#endif //GRAPHDATA_MEMUSAGE_H
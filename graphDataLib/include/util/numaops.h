@@ -0,0 +1,132 @@
+/**
+ * @brief NUMA placement for graph backing arrays.
+ *
+ * Arrays placed with a NUMAPOLICY other than NUMA_DEFAULT must be mapped directly (rather than taken from the heap) so
+ * that a memory policy can be bound to page ranges.  On platforms without NUMA support, the policy is silently ignored.
+ */
+
+#ifndef GRAPHDATA_NUMAOPS_H
+#define GRAPHDATA_NUMAOPS_H
+
+#include <graphData.h>
+
+/**
+ * @brief Placement of one slice of graph nodes.
+ */
+struct numaslice_t {
+    /**
+     * @brief First graph node in the slice
+     */
+    size_t firstnode;
+    /**
+     * @brief One past the last graph node in the slice
+     */
+    size_t endnode;
+    /**
+     * @brief NUMA node the slice is bound to, or -1 if the policy does not bind slices.
+     */
+    int numanode;
+    /**
+     * @brief Number of pages (across the node, capacity and flow arrays) that back the slice
+     */
+    size_t pages;
+    /**
+     * @brief Number of those pages currently resident in memory
+     */
+    size_t resident;
+    /**
+     * @brief Resident page count per NUMA node, indexed by NUMA node id (length numareport_t.numanodes)
+     */
+    size_t *nodepages;
+};
+
+/**
+ * @brief Report of the physical placement of a graph's backing arrays.
+ */
+struct numareport_t {
+    /**
+     * @brief Policy the graph was created with
+     */
+    enum NUMAPOLICY policy;
+    /**
+     * @brief Highest online NUMA node id + 1 (length of numaslice_t.nodepages)
+     */
+    size_t numanodes;
+    /**
+     * @brief Number of slices in the report (one per online NUMA node)
+     */
+    size_t slicecount;
+    /**
+     * @brief Array of slice placements
+     */
+    struct numaslice_t *slices;
+};
+
+/**
+ * @brief Parse a kernel node list (ranges such as "0-1,3") into ascending node ids.
+ *
+ * @param list Node list to be parsed
+ * @param ids Array that receives the node ids
+ * @param maxids Length of ids
+ * @return Number of node ids written to ids
+ */
+size_t numaParseNodeList(const char *list, int *ids, size_t maxids);
+
+/**
+ * @brief Ids of the online NUMA nodes, in ascending order.
+ *
+ * Node ids may be sparse (e.g. "0,2" when node 1 is offline); placement only ever uses the listed nodes.
+ *
+ * @param ids Array that receives the node ids
+ * @param maxids Length of ids
+ * @return Number of node ids written to ids; on systems without NUMA support, a single node 0.
+ */
+size_t numaOnlineNodes(int *ids, size_t maxids);
+
+/**
+ * @brief Number of NUMA nodes available on the system.
+ * @return Number of online NUMA nodes; 1 on systems without NUMA support.
+ */
+size_t numaNodeCount();
+
+/**
+ * @brief Bind a placement policy to an array of rows.
+ *
+ * For NUMA_PARTITION, rows are split with memChunkRange() into numaNodeCount() slices, and slice i is bound to the
+ * i-th online NUMA node (see numaOnlineNodes()).  Slice boundaries are rounded to the nearest page boundary.  For
+ * NUMA_DEFAULT, nothing is done.
+ *
+ * The array must be page-aligned and must not share pages with other data (a mapped allocArray() strategy).  Binding
+ * only affects pages that have not yet been touched.
+ *
+ * @param arr Array to be placed
+ * @param rows Number of rows (graph nodes)
+ * @param rowsize Size in bytes of each row (degree * element size)
+ * @param policy Placement policy
+ * @param pagesize Size of the pages backing the array
+ * @return 1 if the policy was applied (or there was nothing to apply); otherwise, 0.
+ */
+int numaBind(void *arr, size_t rows, size_t rowsize, enum NUMAPOLICY policy, size_t pagesize);
+
+/**
+ * @brief Create a report of where the backing arrays of the graph currently reside.
+ *
+ * Only ARRAY graphs are supported.  Pages that have never been touched are counted in numaslice_t.pages, but not in
+ * numaslice_t.resident.
+ *
+ * @param g Graph to be inspected
+ * @return Pointer to a new report, if successful; otherwise, NULL.  Release with destroyNumaReport().
+ */
+struct numareport_t * graphNumaReport(const struct graph_t *g);
+
+/**
+ * @brief Clear out a NUMA report and all underlying structures
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param rptr pointer-to-pointer for the report
+ * @return 1 if successful; 0 if error
+ */
+int destroyNumaReport(void **rptr);
+
+#endif //GRAPHDATA_NUMAOPS_H
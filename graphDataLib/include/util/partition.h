@@ -0,0 +1,232 @@
+/**
+ * @brief Graph partitioning and domain decomposition.
+ *
+ * partitionGraph() splits the nodes of a graph into parts for parallel or out-of-core work.  SPATIAL ARRAY graphs can
+ * be split geometrically over their dimensions:
+ *
+ * - PART_SLAB cuts the slowest-varying dimension into slabs, so every part is a contiguous range of node ids;
+ * - PART_BLOCK cuts every dimension, into a grid of near-cubic blocks with the least surface between them;
+ * - PART_BISECT recursively halves the longest side of the box (recursive coordinate bisection), and works for any
+ *   number of parts.
+ *
+ * PART_MULTILEVEL works on any graph, in the style of METIS: the graph is coarsened by heavy-edge matching, the
+ * coarsest graph is split by greedy region growing, and the split is projected back level by level with boundary
+ * refinement at each step.  Parts are kept within PART_IMBALANCE percent of the average size.
+ *
+ * Each part lists its nodes, its halo (the nodes of other parts within halowidth edges of it), and its boundary
+ * edges (edges with exactly one end in the part).  partitionView() gives a graph_t over one part that shares the
+ * backing data of the original: reads reach the part and its halo, value updates reach the edges the part owns (those
+ * whose starting node, or smaller node for UNDIRECTED graphs, is in the part), and the structure cannot be changed.
+ * Views of different parts can therefore update values from different threads without locks.
+ */
+
+#ifndef GRAPHDATA_PARTITION_H
+#define GRAPHDATA_PARTITION_H
+
+#include <graphData.h>
+#include <graphOps.h>
+
+/**
+ * @brief Largest part size allowed by PART_MULTILEVEL, as a percentage of the average part size
+ */
+#define PART_IMBALANCE 103
+
+/**
+ * @brief Part number returned for nodes that are not in the partition
+ */
+#define PART_NONE ((size_t)-1)
+
+/**
+ * @brief Partitioning scheme
+ */
+enum PARTSCHEME {
+    /**
+     * @brief Slabs along the slowest-varying dimension (SPATIAL ARRAY graphs)
+     */
+    PART_SLAB           = 0,
+    /**
+     * @brief Grid of blocks over every dimension (SPATIAL ARRAY graphs)
+     */
+    PART_BLOCK          = 1,
+    /**
+     * @brief Recursive coordinate bisection (SPATIAL ARRAY graphs)
+     */
+    PART_BISECT         = 2,
+    /**
+     * @brief Multilevel graph partitioning (any graph)
+     */
+    PART_MULTILEVEL     = 3
+};
+
+/**
+ * @brief One part of a partition
+ */
+struct graphpart_t {
+    /**
+     * @brief Number of nodes in the part
+     */
+    size_t nodecount;
+    /**
+     * @brief Node ids of the part, ascending
+     */
+    size_t *nodes;
+    /**
+     * @brief Number of halo nodes
+     */
+    size_t halocount;
+    /**
+     * @brief Node ids of other parts within the halo width of the part, ascending
+     */
+    size_t *halo;
+    /**
+     * @brief Number of boundary edges
+     */
+    size_t boundarycount;
+    /**
+     * @brief Boundary edges, two ids each: the end in the part, then the end outside it
+     */
+    size_t *boundary;
+    /**
+     * @brief Number of edges owned by the part (starting at one of its nodes, or at the smaller node if UNDIRECTED)
+     */
+    size_t edgecount;
+    /**
+     * @brief For the geometric schemes, the box of the part: dimcount lower bounds, then dimcount upper bounds
+     * (exclusive).  NULL for PART_MULTILEVEL.
+     */
+    size_t *box;
+};
+
+/**
+ * @brief Partition of the nodes of a graph
+ */
+struct partition_t {
+    /**
+     * @brief Scheme the partition was made with
+     */
+    enum PARTSCHEME scheme;
+    /**
+     * @brief Number of parts
+     */
+    size_t partcount;
+    /**
+     * @brief Halo width, in edges
+     */
+    size_t halowidth;
+    /**
+     * @brief Number of nodes partitioned
+     */
+    size_t nodecount;
+    /**
+     * @brief Node ids, ascending, for graphs whose ids are not simply 0 to nodecount - 1; NULL for ARRAY graphs
+     */
+    size_t *ids;
+    /**
+     * @brief Part of each node, by position (node id for ARRAY graphs, index into ids otherwise)
+     */
+    size_t *owner;
+    /**
+     * @brief Number of edges between different parts
+     */
+    size_t cutedges;
+    /**
+     * @brief The parts
+     */
+    struct graphpart_t *parts;
+    /**
+     * @brief Graph that was partitioned
+     */
+    struct graph_t *g;
+    /**
+     * @brief Allocator of the graph, used for all partition memory
+     */
+    const struct graphallocator_t *allocator;
+};
+
+/**
+ * @brief Partition a graph
+ *
+ * The graph's structure must not change while the partition or any of its views exist, and the partition must be
+ * destroyed before the graph.
+ *
+ * @param g Graph to be partitioned
+ * @param scheme Partitioning scheme; the geometric schemes need an UNLABELED SPATIAL ARRAY graph
+ * @param partcount Number of parts, at least 1 and at most the number of nodes
+ * @param halowidth Width of the halos, in edges; 0 for none
+ * @return Pointer to the partition, if successful; otherwise, NULL.
+ */
+struct partition_t * partitionGraph(struct graph_t *g, enum PARTSCHEME scheme, size_t partcount, size_t halowidth);
+
+/**
+ * @brief Clear out a partition
+ *
+ * Views made from the partition must be destroyed first.  The pointer itself will be changed to NULL.
+ *
+ * @param pptr pointer-to-pointer for the partition
+ * @return 1 if successful; 0 if the pointer is NULL.
+ */
+int destroyPartition(void **pptr);
+
+/**
+ * @brief Find the part holding a node
+ * @param p Partition
+ * @param nodeid Node identifier
+ * @return Part number; PART_NONE if the node is not in the partition.
+ */
+size_t partOwner(const struct partition_t *p, size_t nodeid);
+
+/**
+ * @brief Create a view of one part, sharing the backing data of the partitioned graph.
+ *
+ * The view is released with destroyGraph(); clearGraph() leaves the shared data alone.  Its operations (from
+ * getOperations()) have no addNode, removeNode, addEdge, removeEdge or resetGraph.
+ *
+ * Lifetime: the view holds no pointers into the backing data.  Each operation reaches it through the partitioned
+ * graph at call time, so a view stays usable across migrateGraph(), arraySelectLayer() and changes to the node list
+ * of the original; these must still not run while the view is in use on another thread.  The partition is not
+ * updated, though: nodes added afterwards are outside every part, and removed nodes read as missing.  The view must
+ * be destroyed before its partition, and the partition before the graph.  The view's graph_t has no backing data of
+ * its own, so functions that read the implementation directly (arrayMaxFlow(), exportEdgeList(), ...) find nothing
+ * through it; call them on the partitioned graph.
+ *
+ * @param p Partition
+ * @param part Part number
+ * @return Pointer to the view, if successful; otherwise, NULL.
+ */
+struct graph_t * partitionView(struct partition_t *p, size_t part);
+
+/**
+ * @brief Determine whether a graph is a partition view
+ * @param g Graph in question
+ * @return 1 if g was created by partitionView(); otherwise, 0.
+ */
+int isPartitionView(const struct graph_t *g);
+
+/**
+ * @brief Replace the operations of a partition view with ones restricted to its part.
+ *
+ * Called by getOperations() for partition views.
+ *
+ * @param gops Operations structure for a partition view
+ * @return 1 if successful; 0 if the graph is not a partition view.
+ */
+int partitionViewWrap(struct graphops_t *gops);
+
+/**
+ * @brief Clear out the view state of a partition view
+ *
+ * The graph's partview pointer will be changed to NULL.  Called by destroyGraph().
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if the graph is not a partition view.
+ */
+int destroyPartitionView(struct graph_t *g);
+
+/**
+ * @brief Memory held by the view state of a partition view
+ * @param g Graph in question
+ * @return Size in bytes; 0 for other graphs.
+ */
+size_t partitionViewMemory(const struct graph_t *g);
+
+#endif //GRAPHDATA_PARTITION_H
@@ -0,0 +1,109 @@
+/**
+ * @brief Copy-on-write snapshots of LINKED and HASHED graphs.
+ *
+ * snapshotGraph() returns a read-only view of the graph as it was at the time of the call.  The view has its own node
+ * headers (and, for HASHED graphs, its own node index), but shares every edge list with the live graph.  When the live
+ * graph is about to change the edge list of a node that a snapshot still shares, the list is copied first and the copy
+ * becomes the live version; the old version stays with the snapshots that can see it, and is released when the last of
+ * them is released.  Only the adjacency of the nodes that actually change is ever copied.
+ *
+ * POINTER INVALIDATION: while a graph has snapshots, edge pointers into the live graph are NOT stable.  The first write
+ * to a node's edges after a snapshot (addEdge, removeEdge, any capacity or flow setter, resetGraph) moves that node's
+ * live edges to new edge_t structures.  An edge_t pointer obtained from getEdge() on the live graph before that write
+ * then points at the version the snapshots see: writes through it change the snapshots rather than the live graph, and
+ * it dangles once the last snapshot that sees it is released.  Look edges up again after writing to a snapshotted
+ * graph.  This overrides the pointer stability promised in util/syncops.h and util/adaptive.h.  Node pointers and the
+ * pointers returned from a view are not affected.
+ *
+ * Snapshots cover the node set, edges, and edge values (capacity, flow, and edge features).  Node features are not part
+ * of the view.
+ *
+ * Threading: a snapshot may be read and released from any thread while the live graph is being updated, but
+ * snapshotGraph() itself must not run concurrently with updates to the live graph.  All snapshots must be released
+ * before the live graph is cleared or destroyed; clearGraph() and destroyGraph() fail on a graph with unreleased
+ * snapshots (see snapshotCount()).
+ */
+
+#ifndef GRAPHDATA_SNAPSHOT_H
+#define GRAPHDATA_SNAPSHOT_H
+
+#include <graphData.h>
+
+/**
+ * @brief Take a read-only snapshot of a LINKED or HASHED graph.
+ *
+ * The view works with the read operations of getOperations(); its modifying operations are NULL.  The view keeps the
+ * implementation the graph had when it was taken, even if the live graph later moves (see util/adaptive.h).
+ *
+ * @param g Live graph
+ * @return Pointer to the snapshot view, if successful; otherwise, NULL (including for graphs that are neither LINKED
+ * nor HASHED, and for snapshots).  Release with releaseSnapshot() or destroyGraph().
+ */
+struct graph_t * snapshotGraph(struct graph_t *g);
+
+/**
+ * @brief Release a snapshot view, and any old edge lists that no other snapshot can see.
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param snapptr pointer-to-pointer for the snapshot
+ * @return 1 if successful; 0 if the pointer is NULL or is not a snapshot.
+ */
+int releaseSnapshot(void **snapptr);
+
+/**
+ * @brief Number of snapshots of a live graph that have not been released
+ * @param g Live graph
+ * @return Count of active snapshots; 0 for snapshot views and graphs never snapshotted.
+ */
+size_t snapshotCount(const struct graph_t *g);
+
+/**
+ * @brief Determine whether a graph is a snapshot view
+ * @param g Graph in question
+ * @return 1 if g was created by snapshotGraph(); otherwise, 0.
+ */
+int isSnapshot(const struct graph_t *g);
+
+/**
+ * @brief Give a node of the live graph an edge list that no snapshot shares, copying it if necessary.
+ *
+ * Called by the LINKED and HASHED operations before they change a node's edge list or edge values in place.  If a copy
+ * is made, edge pointers previously taken from the node's live list now refer to the snapshot version.
+ *
+ * @param g Live graph
+ * @param n Node about to be modified
+ * @return 1 if the node's edge list can be modified; 0 if a copy was needed but could not be made.
+ */
+int snapshotPrepareWrite(struct graph_t *g, struct node_t *n);
+
+/**
+ * @brief Hand the edge list of a node being removed to the snapshots that share it.
+ *
+ * Called by the LINKED and HASHED operations when a node is removed.  If a snapshot shares the list, the list is retired (and
+ * released with the snapshots) and the node's edge pointer is set to NULL.
+ *
+ * @param g Live graph
+ * @param n Node being removed
+ * @return 1 if the list was retired; 0 if no snapshot shares it, and the caller must release it.
+ */
+int snapshotRetireEdges(struct graph_t *g, struct node_t *n);
+
+/**
+ * @brief Clear out the snapshot bookkeeping of a live graph, including all retired edge lists.
+ *
+ * The graph's snapshot pointer will be changed to NULL.  Called by destroyGraph().
+ *
+ * @param g Live graph
+ * @return 1 if successful; 0 if there was no bookkeeping.
+ */
+int destroySnapshotState(struct graph_t *g);
+
+/**
+ * @brief Memory held by the snapshot bookkeeping of a graph, including the retired edge lists of a live graph
+ * @param g Live graph or snapshot view
+ * @return Size in bytes; 0 if there is no bookkeeping.
+ */
+size_t snapshotMemory(const struct graph_t *g);
+
+#endif //GRAPHDATA_SNAPSHOT_H
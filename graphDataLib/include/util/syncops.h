@@ -0,0 +1,70 @@
+/**
+ * @brief Striped locking for graphs shared between threads.
+ *
+ * A graph initialized with CONCURRENCY_STRIPED in its graphconfig_t gets a set of mutexes ("stripes"), and the
+ * operations returned by getOperations() are wrapped to take them.  Each edge belongs to one node--u for DIRECTED
+ * graphs, and the smaller of u and v otherwise--and edge operations lock only that node's stripe, so threads working on
+ * different parts of the graph rarely contend.
+ *
+ * ARRAY graphs have fixed structure, so reads are lock-free and only the mutators lock.  LINKED and HASHED graphs also
+ * hold a reader-writer lock over the list structure: most operations share it, and only the operations that unlink or
+ * re-link whole lists (node insertion and removal, edge removal, edge counts, reset) take it exclusively.
+ *
+ * The atomic value operations (graphops_t.atomicAddCapacity and atomicAddFlow) never take a stripe.
+ *
+ * Node and edge pointers returned by a wrapped getter stay valid until the item is removed (edge pointers of a graph
+ * with snapshots are the exception; see util/snapshot.h); callers that remove items concurrently with readers must
+ * coordinate that themselves.  A custom graphallocator_t must be safe to call from
+ * several threads at once.
+ */
+
+#ifndef GRAPHDATA_SYNCOPS_H
+#define GRAPHDATA_SYNCOPS_H
+
+#include <graphData.h>
+#include <graphOps.h>
+
+/**
+ * @brief Default number of lock stripes
+ */
+#define SYNC_DEFAULT_STRIPES 64
+
+/**
+ * @brief Create the locking state for a graph, according to its configuration.
+ *
+ * Called by initGraphWithConfig() when the configuration asks for CONCURRENCY_STRIPED.
+ *
+ * @param g Graph to be shared between threads
+ * @return 1 if successful; 0 if the locks could not be created, or the library was built without thread support.
+ */
+int graphSyncInit(struct graph_t *g);
+
+/**
+ * @brief Replace the operations of a graph with locking wrappers.
+ *
+ * The operations must already be set for the graph's implementation; the originals are kept in the graph's locking
+ * state.  Called by getOperations() for graphs with locking state.
+ *
+ * @param gops Operations structure for a graph with locking state
+ * @return 1 if successful; 0 if the graph has no locking state.
+ */
+int graphSyncWrap(struct graphops_t *gops);
+
+/**
+ * @brief Clear out the locking state of a graph
+ *
+ * The graph's sync pointer will be changed to NULL.  Called by destroyGraph().
+ *
+ * @param g Graph owning the locking state
+ * @return 1 if successful; 0 if there was no locking state.
+ */
+int destroyGraphSync(struct graph_t *g);
+
+/**
+ * @brief Memory held by the locking state of a graph
+ * @param g Graph in question
+ * @return Size in bytes; 0 if there is no locking state.
+ */
+size_t graphSyncMemory(const struct graph_t *g);
+
+#endif //GRAPHDATA_SYNCOPS_H
@@ -6,11 +6,20 @@
 
 #include <stdlib.h>
 #include <util/crudops.h>
+#include <util/syncops.h>
+#include <util/graphstats.h>
+#include <util/adaptive.h>
+#include <util/partition.h>
+#include <util/snapshot.h>
+#include <util/interntable.h>
+#include <util/attrstore.h>
+#include <string.h>
 #include <impl/arraygraph.h>
 #include <impl/arrayops.h>
 #include <impl/linkgraph.h>
 #include <impl/linkops.h>
 #include <impl/hashgraph.h>
+#include <impl/hashops.h>
 #include <impl/sharedmemgraph.h>
 #include <impl/sharedmemops.h>
 #include <impl/sharedmmapgraph.h>
@@ -40,12 +49,43 @@ static void setArrayOps(struct graphops_t *gops) {
     gops->setFlow = arraySetFlow;
     gops->addFlow = arrayAddFlow;
     gops->getFlow = arrayGetFlow;
+    gops->atomicAddCapacity = arrayAtomicAddCapacity;
+    gops->atomicAddFlow = arrayAtomicAddFlow;
 
     //Reset operations
     gops->resetGraph = arrayResetGraph;
 
 }
 
+static void setMmapOps(struct graphops_t *gops) {
+    //Node operations
+    gops->addNode = mmapAddNode;
+    gops->getNode = mmapGetNode;
+    gops->nodeCount = mmapNodeCount;
+    gops->getNeighbors = mmapGetNeighbors;
+    gops->removeNode = mmapRemoveNode;
+
+    //Edge operations
+    gops->addEdge = mmapAddEdge;
+    gops->getEdge = mmapGetEdge;
+    gops->getEdges = mmapGetEdges;
+    gops->removeEdge = mmapRemoveEdge;
+    gops->edgeCount = mmapEdgeCount;
+
+    //Value operations
+    gops->setCapacity = mmapSetCapacity;
+    gops->addCapacity = mmapAddCapacity;
+    gops->getCapacity = mmapGetCapacity;
+    gops->setFlow = mmapSetFlow;
+    gops->addFlow = mmapAddFlow;
+    gops->getFlow = mmapGetFlow;
+    gops->atomicAddCapacity = mmapAtomicAddCapacity;
+    gops->atomicAddFlow = mmapAtomicAddFlow;
+
+    //Reset operations
+    gops->resetGraph = mmapResetGraph;
+}
+
 static void setLinkOps(struct graphops_t *gops) {
     //Node operations
     gops->addNode = linkAddNode;
@@ -68,11 +108,89 @@ static void setLinkOps(struct graphops_t *gops) {
     gops->setFlow = linkSetFlow;
     gops->addFlow = linkAddFlow;
     gops->getFlow = linkGetFlow;
+    gops->atomicAddCapacity = linkAtomicAddCapacity;
+    gops->atomicAddFlow = linkAtomicAddFlow;
 
     //Reset operations
     gops->resetGraph = linkResetGraph;
 }
 
+static void setHashOps(struct graphops_t *gops) {
+    //Node operations
+    gops->addNode = hashAddNode;
+    gops->getNode = hashGetNode;
+    gops->nodeCount = hashNodeCount;
+    gops->getNeighbors = hashGetNeighbors;
+    gops->removeNode = hashRemoveNode;
+
+    //Edge operations
+    gops->addEdge = hashAddEdge;
+    gops->getEdge = hashGetEdge;
+    gops->getEdges = hashGetEdges;
+    gops->removeEdge = hashRemoveEdge;
+    gops->edgeCount = hashEdgeCount;
+
+    //Value operations
+    gops->setCapacity = hashSetCapacity;
+    gops->addCapacity = hashAddCapacity;
+    gops->getCapacity = hashGetCapacity;
+    gops->setFlow = hashSetFlow;
+    gops->addFlow = hashAddFlow;
+    gops->getFlow = hashGetFlow;
+    gops->atomicAddCapacity = hashAtomicAddCapacity;
+    gops->atomicAddFlow = hashAtomicAddFlow;
+
+    //Reset operations
+    gops->resetGraph = hashResetGraph;
+}
+
+/**
+ * @brief Fill a graphops_t with the unwrapped operations of an implementation
+ *
+ * @param gops Operations structure to be filled
+ * @param imptype Implementation flag (ARRAY, LINKED or HASHED), or SHARED_MMAP for tiled ARRAY graphs
+ * @return 1 if successful; 0 if the implementation has no operations.
+ */
+int setImplementationOps(struct graphops_t *gops, enum GRAPHDOMAIN imptype) {
+    int retval = 1;
+    switch (imptype) {
+        case ARRAY:
+            setArrayOps(gops);
+            break;
+        case LINKED:
+            setLinkOps(gops);
+            break;
+        case HASHED:
+            setHashOps(gops);
+            break;
+        case SHARED_MMAP:
+            setMmapOps(gops);
+            break;
+        default:
+            //TODO:  Do the other implementations
+            retval = 0;
+            break;
+    }
+    return retval;
+}
+
+/**
+ * @brief Remove the modifying operations, for read-only graphs (snapshot views)
+ * @param gops Operations structure to be restricted
+ */
+static void setReadOnlyOps(struct graphops_t *gops) {
+    gops->addNode = NULL;
+    gops->removeNode = NULL;
+    gops->addEdge = NULL;
+    gops->removeEdge = NULL;
+    gops->setCapacity = NULL;
+    gops->addCapacity = NULL;
+    gops->setFlow = NULL;
+    gops->addFlow = NULL;
+    gops->atomicAddCapacity = NULL;
+    gops->atomicAddFlow = NULL;
+    gops->resetGraph = NULL;
+}
 
 /**
  * @brief Initialize a graph according to the flags set in the GRAPHDOMAIN value.
@@ -92,6 +210,23 @@ static void setLinkOps(struct graphops_t *gops) {
  * @return If successful and valied, initialized graph structure, according to the flags.  Otherwise, a NULL pointer.
  */
 struct graph_t * initGraph(enum GRAPHDOMAIN typeflags, size_t lblcount, struct dimensions_t *dims) {
+    return initGraphWithConfig(typeflags, lblcount, dims, NULL);
+}
+
+/**
+ * @brief Initialize a graph according to the flags set in the GRAPHDOMAIN value, with the given creation settings.
+ *
+ * Same as initGraph(), with control over how the graph is stored.  The settings are copied, so the cfg structure may be
+ * released or reused after the call.
+ *
+ * @param gtype Type of graph implementation to be created. Flag values set underlying structures and metadata.
+ * @param lblcount Number of label nodes to be used within the graph.  Required for LABELED flag; ignored for all others.
+ * @param dims Dimensional parameters structure.  Required for ARRAY graphs; otherwise, may be NULL.
+ * @param cfg Creation settings.  If NULL, the defaults from initConfig() are used.
+ * @return If successful and valid, initialized graph structure, according to the flags.  Otherwise, a NULL pointer.
+ */
+struct graph_t * initGraphWithConfig(enum GRAPHDOMAIN typeflags, size_t lblcount, struct dimensions_t *dims,
+                                     const struct graphconfig_t *cfg) {
 
     struct graph_t *g = NULL;
 
@@ -110,27 +245,50 @@ struct graph_t * initGraph(enum GRAPHDOMAIN typeflags, size_t lblcount, struct d
             return NULL;
         }
 
-        g = basicGraphInit();
+        //tiled files hold UNLABELED ARRAY grids only
+        if ((typeflags & SHARED_MMAP) == SHARED_MMAP && (imptype != ARRAY || labtype == LABELED)) {
+            return NULL;
+        }
+
+        g = basicGraphInitWith(cfg != NULL ? cfg->allocator : NULL);
         if (g != NULL) {
             struct labels_t *labels = NULL;
             if (labtype == LABELED) {
-                labels = initLabels(lblcount);
+                labels = initLabelsWith(&g->allocator, lblcount);
             }
 
             g->gtype = typeflags;
             g->dims = dims;
             g->labels = labels;
+            g->config = copyConfigWith(&g->allocator, cfg);
             int initSuccess = 0;
-            switch(imptype) {
-                case ARRAY:
-                    initSuccess = arrayGraphInit(g);
-                    break;
-                case HASHED:
-                    initSuccess = hashGraphInit(g);
-                    break;
-                default:
-                    initSuccess = linkGraphInit(g);
-                    break;
+            if (g->config != NULL && (labtype != LABELED || labels != NULL)) {
+                //the graph holds its own copy of the allocator, which outlives the caller's
+                g->config->allocator = &g->allocator;
+                switch(imptype) {
+                    case ARRAY:
+                        if ((typeflags & SHARED_MMAP) == SHARED_MMAP) {
+                            initSuccess = mmapGraphInit(g);
+                        } else {
+                            initSuccess = arrayGraphInit(g);
+                        }
+                        break;
+                    case HASHED:
+                        initSuccess = hashGraphInit(g);
+                        break;
+                    default:
+                        initSuccess = linkGraphInit(g);
+                        break;
+                }
+                if (initSuccess && g->config->concurrency != CONCURRENCY_NONE) {
+                    initSuccess = graphSyncInit(g);
+                }
+                if (initSuccess && g->config->stats == STATS_ON) {
+                    initSuccess = graphStatsInit(g);
+                }
+                if (initSuccess && g->config->adapt == ADAPT_AUTO) {
+                    initSuccess = graphAdaptInit(g);
+                }
             }
             if (!initSuccess) {
                 //something went wrong--clean up
@@ -145,6 +303,77 @@ struct graph_t * initGraph(enum GRAPHDOMAIN typeflags, size_t lblcount, struct d
 }
 
 
+/**
+ * @brief Create a copy of a graph
+ *
+ * @param g Graph to be copied
+ * @param flags Clone options
+ * @return Pointer to the new graph, if successful; otherwise, a NULL pointer.
+ */
+struct graph_t * cloneGraph(const struct graph_t *g, enum CLONEFLAGS flags) {
+    struct graph_t *ng = NULL;
+    if (g != NULL) {
+        enum GRAPHDOMAIN dirtype, imptype, labtype, domaintype;
+        enum GRAPHDOMAIN gflags = g->gtype;
+        if (parseTypeFlags(&gflags, &dirtype, &imptype, &labtype, &domaintype) == 0) return NULL;
+        ng = basicGraphInitWith(&g->allocator);
+        if (ng != NULL) {
+            int cloneSuccess = 1;
+            ng->gtype = gflags;
+            ng->dims = g->dims;
+            if (g->labels != NULL) {
+                ng->labels = initLabelsWith(&ng->allocator, g->labels->labelcount);
+                cloneSuccess = (ng->labels != NULL);
+                if (cloneSuccess) {
+                    memcpy(ng->labels->labelarr, g->labels->labelarr, g->labels->labelcount * sizeof(size_t));
+                }
+            }
+            ng->config = copyConfigWith(&ng->allocator, g->config);
+            if (ng->config == NULL) {
+                cloneSuccess = 0;
+            } else {
+                ng->config->allocator = &ng->allocator;
+            }
+            if (cloneSuccess) {
+                switch (imptype) {
+                    case ARRAY:
+                        //tiled graphs would need a second file, and the copy is left to the caller
+                        cloneSuccess = !isMmapGraph(g) && arrayGraphClone(g, ng, flags);
+                        break;
+                    case LINKED:
+                        cloneSuccess = linkGraphClone(g, ng, flags);
+                        break;
+                    case HASHED:
+                        cloneSuccess = hashGraphClone(g, ng, flags);
+                        break;
+                    default:
+                        cloneSuccess = 0;
+                        break;
+                }
+            }
+            if (cloneSuccess && flags != CLONE_STRUCTURE && g->features != NULL) {
+                ng->features = cloneInternTable(&ng->allocator, g->features);
+                cloneSuccess = (ng->features != NULL) && cloneAttrStore(g, ng);
+            }
+            if (cloneSuccess && ng->config->concurrency != CONCURRENCY_NONE) {
+                cloneSuccess = graphSyncInit(ng);
+            }
+            if (cloneSuccess && ng->config->stats == STATS_ON) {
+                cloneSuccess = graphStatsInit(ng);
+            }
+            if (cloneSuccess && ng->config->adapt == ADAPT_AUTO) {
+                cloneSuccess = graphAdaptInit(ng);
+            }
+            if (!cloneSuccess) {
+                clearGraph(ng);
+                destroyGraph((void **)&ng);
+            }
+        }
+    }
+    return ng;
+}
+
+
 /**
  * @brief Create and fill the graphops_t structure that handles basic operations for the graph
  *
@@ -165,16 +394,21 @@ struct graphops_t * getOperations(struct graph_t *g) {
         if (parseTypeFlags(&gflags, &dirtype, &imptype, &labtype, &domaintype)) {
             gops = initGraphops();
             gops->g = g;
-            switch (imptype) {
-                case ARRAY:
-                    setArrayOps(gops);
-                    break;
-                case LINKED:
-                    setLinkOps(gops);
-                    break;
-                default:
-                    //TODO:  Do the other implementations
-                    break;
+            setImplementationOps(gops, ((gflags & SHARED_MMAP) == SHARED_MMAP) ? SHARED_MMAP : imptype);
+            if (g->adapt != NULL) {
+                graphAdaptWrap(gops);
+            }
+            if (g->partview != NULL) {
+                partitionViewWrap(gops);
+            }
+            if (g->sync != NULL) {
+                graphSyncWrap(gops);
+            }
+            if (g->stats != NULL) {
+                graphStatsWrap(gops);
+            }
+            if (isSnapshot(g)) {
+                setReadOnlyOps(gops);
             }
         }
     }
@@ -192,20 +426,27 @@ struct graphops_t * getOperations(struct graph_t *g) {
  */
 int clearGraph(struct graph_t *g) {
     int retval = 1;
-    if (g != NULL) {
+    //snapshot views own only their node headers, which are released with the view; partition views own nothing
+    //the edge lists of a graph with snapshots are still being read through them
+    if (snapshotCount(g) > 0) return 0;
+    if (g != NULL && !isSnapshot(g) && !isPartitionView(g)) {
         enum GRAPHDOMAIN dirtype, imptype, labtype, domaintype;
         enum GRAPHDOMAIN gflags = g->gtype;
         if (parseTypeFlags(&gflags, &dirtype, &imptype, &labtype, &domaintype)) {
 
             switch (imptype) {
                 case ARRAY:
-                    retval = retval & arrayGraphFree(g);
+                    if ((gflags & SHARED_MMAP) == SHARED_MMAP) {
+                        retval = retval & mmapGraphFree(g);
+                    } else {
+                        retval = retval & arrayGraphFree(g);
+                    }
                     break;
                 case LINKED:
                     retval = retval & linkGraphFree(g);
                     break;
                 case HASHED:
-                    //TODO:  implement clearing operations
+                    retval = retval & hashGraphFree(g);
                     break;
                 default:
                     break;
@@ -11,37 +11,55 @@
 #include <impl/arraygraph.h>
 #include <util/cartesian.h>
 #include <stdlib.h>
+#include <string.h>
 #include <impl/arrayops.h>
 #include <util/crudops.h>
+#include <util/memops.h>
+#include <util/numaops.h>
+#include <util/interntable.h>
 
 /**
  * @brief Utility function to create array-graph metatdata
+ * @param a Allocator to be used
  * @return Pointer to new metadata structure, if successful; NULL pointer, otherwise
  */
-static struct arraydata_t * initArrayMeta() {
+static struct arraydata_t * initArrayMeta(const struct graphallocator_t *a) {
     struct arraydata_t *ameta = NULL;
-    ameta = (struct arraydata_t *)malloc(sizeof(struct arraydata_t));
+    ameta = (struct arraydata_t *)graphAlloc(a, sizeof(struct arraydata_t));
     if (ameta != NULL) {
         ameta->nodelen = 0;
         ameta->edgelen = 0;
         ameta->degree = 0;
+        ameta->arraylen = 0;
+        ameta->numa = NUMA_DEFAULT;
+        ameta->alloc = ALLOC_MALLOC;
+        ameta->nodealloc = ALLOC_MALLOC;
+        ameta->capalloc = ALLOC_MALLOC;
+        ameta->flowalloc = ALLOC_MALLOC;
+        ameta->topology = NULL;
+        ameta->clones = 0;
+        ameta->layercount = 0;
+        ameta->layercap = 0;
+        ameta->layers = NULL;
+        ameta->activelayer = 0;
     }
     return ameta;
 }
 
 /**
  * @brief Utilty function to free up allocated memory for array-graph metadata
+ * @param a Allocator the metadata came from
  * @param metaptr pointer-to-pointer for metadata
  * @return 1 if successful; 0 if error.
  */
-static int freeArrayMeta(void** metaptr) {
+static int freeArrayMeta(const struct graphallocator_t *a, void** metaptr) {
     int retval = 0;
     if (*metaptr != NULL) {
-        struct arraydata_t *mptr = (struct arraydata_t *)metaptr;
+        struct arraydata_t *mptr = (struct arraydata_t *)*metaptr;
         mptr->degree = 0;
         mptr->edgelen = 0;
         mptr->nodelen = 0;
-        free(*metaptr);
+        graphFree(a, *metaptr, sizeof(struct arraydata_t));
         *metaptr = NULL;
         retval = 1;
     }
@@ -49,43 +67,41 @@ static int freeArrayMeta(void** metaptr) {
 }
 
 /**
- * @brief Utility method to create a size_t **array, returned as a void *
- * @param alen Length of base array (nodes)
- * @param conlen Connectivity count (how many neighbors, or dimensionality of the array)
- * @return size_t **array as a void *.
+ * @brief Utility function to create a zeroed backing array, allocated and placed according to the graph metadata
+ *
+ * NUMA placement needs arrays that own whole pages, so heap strategies are raised to ALLOC_MMAP when a NUMA policy is
+ * set.
+ * @param g Graph the array belongs to
+ * @param meta Array graph metadata
+ * @param elemsize Size of each array element
+ * @param used Set to the allocation strategy actually used
+ * @return Zeroed array of meta->nodelen * meta->degree elements, or NULL on failure
  */
-static void * createNodeArray(size_t alen, size_t conlen) {
-    size_t arrlen = alen * conlen;
-    void *arrbase = malloc(sizeof(size_t *)*arrlen);
-    if (arrbase != NULL) {
-        size_t *arrvals = (size_t *) arrbase;
-        for (size_t *p = arrvals; p < arrvals+arrlen;p++) {
-            *p = 0;
-        }
+static void * createBackingArray(const struct graph_t *g, const struct arraydata_t *meta, size_t elemsize,
+                                 enum ALLOCSTRATEGY *used) {
+    enum ALLOCSTRATEGY strategy = meta->alloc;
+    if (meta->numa != NUMA_DEFAULT && strategy < ALLOC_MMAP) {
+        strategy = ALLOC_MMAP;
+    }
+    void *arr = allocArray(&g->allocator, meta->nodelen * meta->degree, elemsize, strategy, used);
+    if (arr != NULL && *used >= ALLOC_MMAP) {
+        numaBind(arr, meta->nodelen, meta->degree * elemsize, meta->numa, memPageSize(*used));
     }
-    return arrbase;
+    return arr;
 }
 
 /**
- * @brief Utility function to create a double **array, returned as a void *
- *
- * Returns a double **array initialized to zeroes, returned as a void *
- * @param alen Length of base array (nodes)
- * @param conlen Connectivity count (how many neighbors, or dimensionality of the array)
- * @return double **array as a void *.
- *
+ * @brief Utility function to release a backing array created with createBackingArray()
+ * @param g Graph the array belongs to
+ * @param meta Array graph metadata
+ * @param elemsize Size of each array element
+ * @param used Allocation strategy the array was created with
+ * @param arrptr pointer-to-pointer for the array
+ * @return 1 if successful; 0 if error
  */
-static void * createDoubleArray(size_t alen, size_t conlen) {
-    size_t arrlen = alen*conlen;
-    void *arrbase = malloc(sizeof(double *)*arrlen);
-    if (arrbase != NULL) {
-        double *arrvals = (double *) arrbase;
-        for (double *p = arrvals; p<arrvals+arrlen;p++) {
-            //TODO:  Would calloc() or some other method be better?
-            *p = 0.0;
-        }
-     }
-    return arrbase;
+static int freeBackingArray(const struct graph_t *g, const struct arraydata_t *meta, size_t elemsize,
+                            enum ALLOCSTRATEGY used, void **arrptr) {
+    return freeArray(&g->allocator, meta->nodelen * meta->degree, elemsize, used, arrptr);
 }
 
 /**
@@ -114,17 +130,23 @@ int arrayGraphInit(struct graph_t *g) {
     }
 
     if (arrlen > 0) {
-        struct arraydata_t *arrmeta = initArrayMeta();
+        struct arraydata_t *arrmeta = initArrayMeta(&g->allocator);
+        if (arrmeta == NULL) return 0;
         arrmeta->nodelen = arrlen;
         arrmeta->edgelen = arrlen;
         //undirected graphs use min-to-max pair connectivity
         arrmeta->degree = g->dims->dimcount;
+        arrmeta->arraylen = arrlen * arrmeta->degree;
+        if (g->config != NULL) {
+            arrmeta->numa = g->config->numa;
+            arrmeta->alloc = g->config->alloc;
+        }
         //Create the supporting arrays
-        g->nodeImpl = createNodeArray(arrmeta->nodelen, arrmeta->degree);
+        g->nodeImpl = createBackingArray(g, arrmeta, sizeof(size_t), &arrmeta->nodealloc);
         //In this implementation, the node array also holds the edges, so we don't need the extra memory
         g->edgeImpl = NULL;
-        g->capImpl = createDoubleArray(arrmeta->edgelen, arrmeta->degree);
-        g->flowImpl = createDoubleArray(arrmeta->edgelen, arrmeta->degree);
+        g->capImpl = createBackingArray(g, arrmeta, sizeof(double), &arrmeta->capalloc);
+        g->flowImpl = createBackingArray(g, arrmeta, sizeof(double), &arrmeta->flowalloc);
         g->metaImpl = (void *)arrmeta;
         if (g->nodeImpl != NULL && g->capImpl != NULL && g->flowImpl != NULL)
             retval = 1;
@@ -141,15 +163,266 @@ int arrayGraphInit(struct graph_t *g) {
  */
 int arrayGraphFree(struct graph_t *g) {
     int retval = 0;
-    if (NULL != g) {
+    if (NULL != g && NULL != g->metaImpl) {
         //First, use the arrayMeta to clean up the graph arrays
         struct arraydata_t *arrmeta = (struct arraydata_t *)g->metaImpl;
-        freeGraphArray(arrmeta->nodelen, &(g->nodeImpl));
-        freeGraphArray(arrmeta->edgelen, &(g->flowImpl));
-        freeGraphArray(arrmeta->edgelen, &(g->capImpl));
+        //structure-only clones still read the node array
+        if (__atomic_load_n(&arrmeta->clones, __ATOMIC_ACQUIRE) > 0) return 0;
+        if (arrmeta->topology == NULL) {
+            freeBackingArray(g, arrmeta, sizeof(size_t), arrmeta->nodealloc, &(g->nodeImpl));
+        } else {
+            //shared with the original graph
+            __atomic_fetch_sub(&arrmeta->topology->clones, 1, __ATOMIC_RELEASE);
+            arrmeta->topology = NULL;
+            g->nodeImpl = NULL;
+        }
+        if (arrmeta->layers != NULL) {
+            //the layer table owns every value array, including the active ones
+            for (size_t l = 0; l < arrmeta->layercount; l++) {
+                struct valuelayer_t *layer = arrmeta->layers + l;
+                freeBackingArray(g, arrmeta, sizeof(double), layer->flowalloc, (void **)&layer->flow);
+                freeBackingArray(g, arrmeta, sizeof(double), layer->capalloc, (void **)&layer->cap);
+            }
+            graphFree(&g->allocator, arrmeta->layers, arrmeta->layercap * sizeof(struct valuelayer_t));
+            arrmeta->layers = NULL;
+            g->flowImpl = NULL;
+            g->capImpl = NULL;
+        } else {
+            freeBackingArray(g, arrmeta, sizeof(double), arrmeta->flowalloc, &(g->flowImpl));
+            freeBackingArray(g, arrmeta, sizeof(double), arrmeta->capalloc, &(g->capImpl));
+        }
         //Lastly, free up the arraydata_t memory
-        freeArrayMeta(&(g->metaImpl));
+        freeArrayMeta(&g->allocator, &(g->metaImpl));
+        retval = 1;
+    }
+    return retval;
+}
+/**
+ * @brief Copy the value layers of a graph into its clone, keeping the layer ids and the active layer
+ *
+ * The clone's capImpl and flowImpl, already copied from the active layer, become that layer of the clone.  Layer names
+ * are feature ids, which stay valid since the clone's feature table is a copy of the original's.
+ *
+ * @param ng Clone
+ * @param ometa Metadata of the original
+ * @param arrmeta Metadata of the clone
+ * @return 1 if successful; otherwise, 0 (the layers made so far are released with the clone).
+ */
+static int cloneLayers(struct graph_t *ng, const struct arraydata_t *ometa, struct arraydata_t *arrmeta) {
+    size_t len = arrmeta->nodelen * arrmeta->degree;
+    arrmeta->layers = (struct valuelayer_t *)graphAlloc(&ng->allocator, ometa->layercap * sizeof(struct valuelayer_t));
+    if (arrmeta->layers == NULL) return 0;
+    memset(arrmeta->layers, 0, ometa->layercap * sizeof(struct valuelayer_t));
+    arrmeta->layercap = ometa->layercap;
+    arrmeta->layercount = ometa->layercount;
+    arrmeta->activelayer = ometa->activelayer;
+    int retval = 1;
+    for (size_t l = 0; l < ometa->layercount; l++) {
+        struct valuelayer_t *layer = arrmeta->layers + l;
+        const struct valuelayer_t *olayer = ometa->layers + l;
+        layer->nameid = olayer->nameid;
+        if (l == ometa->activelayer) {
+            layer->cap = (double *)ng->capImpl;
+            layer->flow = (double *)ng->flowImpl;
+            layer->capalloc = arrmeta->capalloc;
+            layer->flowalloc = arrmeta->flowalloc;
+        } else if (retval) {
+            layer->cap = (double *)createBackingArray(ng, arrmeta, sizeof(double), &layer->capalloc);
+            layer->flow = (double *)createBackingArray(ng, arrmeta, sizeof(double), &layer->flowalloc);
+            retval = layer->cap != NULL && layer->flow != NULL
+                     && parallelCopy(layer->cap, olayer->cap, len, sizeof(double))
+                     && parallelCopy(layer->flow, olayer->flow, len, sizeof(double));
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Fill in the array backing data of a clone
+ *
+ * @param g Original graph
+ * @param ng Clone, with its type, dimensions, labels and configuration already set
+ * @param flags Clone options
+ * @return 1 if successful; otherwise, 0.
+ */
+int arrayGraphClone(const struct graph_t *g, struct graph_t *ng, enum CLONEFLAGS flags) {
+    int retval = 0;
+    if (g == NULL || ng == NULL || g->metaImpl == NULL) return 0;
+    const struct arraydata_t *ometa = (const struct arraydata_t *)g->metaImpl;
+    struct arraydata_t *arrmeta = initArrayMeta(&ng->allocator);
+    if (arrmeta == NULL) return 0;
+    arrmeta->nodelen = ometa->nodelen;
+    arrmeta->edgelen = ometa->edgelen;
+    arrmeta->degree = ometa->degree;
+    arrmeta->arraylen = ometa->arraylen;
+    arrmeta->numa = ometa->numa;
+    arrmeta->alloc = ometa->alloc;
+    ng->metaImpl = (void *)arrmeta;
+    size_t len = arrmeta->nodelen * arrmeta->degree;
+
+    if (flags == CLONE_STRUCTURE) {
+        //share the topology--clones of clones share the original's array
+        arrmeta->topology = (ometa->topology != NULL) ? ometa->topology : (struct arraydata_t *)ometa;
+        __atomic_fetch_add(&arrmeta->topology->clones, 1, __ATOMIC_RELAXED);
+        arrmeta->nodealloc = ometa->nodealloc;
+        ng->nodeImpl = g->nodeImpl;
+    } else {
+        ng->nodeImpl = createBackingArray(ng, arrmeta, sizeof(size_t), &arrmeta->nodealloc);
+        parallelCopy(ng->nodeImpl, g->nodeImpl, len, sizeof(size_t));
+    }
+    ng->edgeImpl = NULL;
+    ng->capImpl = createBackingArray(ng, arrmeta, sizeof(double), &arrmeta->capalloc);
+    ng->flowImpl = createBackingArray(ng, arrmeta, sizeof(double), &arrmeta->flowalloc);
+    if (ng->nodeImpl != NULL && ng->capImpl != NULL && ng->flowImpl != NULL) {
         retval = 1;
+        if (flags != CLONE_STRUCTURE) {
+            retval = parallelCopy(ng->capImpl, g->capImpl, len, sizeof(double))
+                     & parallelCopy(ng->flowImpl, g->flowImpl, len, sizeof(double));
+            if (retval && ometa->layers != NULL) retval = cloneLayers(ng, ometa, arrmeta);
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Metadata of an ARRAY graph, for the layer functions
+ * @param g Graph in question
+ * @return Metadata, or NULL if g is not an initialized ARRAY graph
+ */
+static struct arraydata_t * layerMeta(const struct graph_t *g) {
+    if (g == NULL || (g->gtype & (ARRAY | SHARED_MMAP)) != ARRAY) return NULL;
+    return (struct arraydata_t *)g->metaImpl;
+}
+
+/**
+ * @brief Create the layer table, with the current value arrays as the base layer
+ * @param g Graph in question
+ * @param meta Metadata of the graph
+ * @return 1 if successful; otherwise, 0.
+ */
+static int requireLayers(struct graph_t *g, struct arraydata_t *meta) {
+    if (meta->layers != NULL) return 1;
+    meta->layers = (struct valuelayer_t *)graphAlloc(&g->allocator, 2 * sizeof(struct valuelayer_t));
+    if (meta->layers == NULL) return 0;
+    meta->layercap = 2;
+    meta->layercount = 1;
+    meta->activelayer = 0;
+    meta->layers[0].nameid = INTERN_NONE;
+    meta->layers[0].cap = (double *)g->capImpl;
+    meta->layers[0].flow = (double *)g->flowImpl;
+    meta->layers[0].capalloc = meta->capalloc;
+    meta->layers[0].flowalloc = meta->flowalloc;
+    return 1;
+}
+
+/**
+ * @brief Find a named layer
+ * @param g ARRAY graph
+ * @param name Layer name
+ * @return Layer id, if found; otherwise, LAYER_NONE.
+ */
+size_t arrayFindLayer(const struct graph_t *g, const char *name) {
+    const struct arraydata_t *meta = layerMeta(g);
+    if (meta == NULL || meta->layers == NULL) return LAYER_NONE;
+    size_t nameid = internLookup(g->features, name);
+    if (nameid == INTERN_NONE) return LAYER_NONE;
+    for (size_t l = 1; l < meta->layercount; l++) {
+        if (meta->layers[l].nameid == nameid) return l;
+    }
+    return LAYER_NONE;
+}
+
+/**
+ * @brief Add a named layer of capacity and flow values over the same topology, or find the existing one.
+ *
+ * @param g ARRAY graph
+ * @param name Layer name
+ * @return Layer id, if successful; otherwise, LAYER_NONE.
+ */
+size_t arrayAddLayer(struct graph_t *g, const char *name) {
+    struct arraydata_t *meta = layerMeta(g);
+    if (meta == NULL || name == NULL) return LAYER_NONE;
+    size_t existing = arrayFindLayer(g, name);
+    if (existing != LAYER_NONE) return existing;
+    size_t nameid = graphFeatureId(g, name);
+    if (nameid == INTERN_NONE || !requireLayers(g, meta)) return LAYER_NONE;
+    if (meta->layercount == meta->layercap) {
+        struct valuelayer_t *nlayers = (struct valuelayer_t *)graphRealloc(&g->allocator, meta->layers,
+                meta->layercap * sizeof(struct valuelayer_t), 2 * meta->layercap * sizeof(struct valuelayer_t));
+        if (nlayers == NULL) return LAYER_NONE;
+        meta->layers = nlayers;
+        meta->layercap *= 2;
+    }
+    struct valuelayer_t *layer = meta->layers + meta->layercount;
+    layer->nameid = nameid;
+    layer->cap = (double *)createBackingArray(g, meta, sizeof(double), &layer->capalloc);
+    layer->flow = (double *)createBackingArray(g, meta, sizeof(double), &layer->flowalloc);
+    if (layer->cap == NULL || layer->flow == NULL) {
+        freeBackingArray(g, meta, sizeof(double), layer->capalloc, (void **)&layer->cap);
+        freeBackingArray(g, meta, sizeof(double), layer->flowalloc, (void **)&layer->flow);
+        return LAYER_NONE;
+    }
+    return meta->layercount++;
+}
+
+/**
+ * @brief Number of value layers of the graph
+ * @param g ARRAY graph
+ * @return Number of layers, including the base layer
+ */
+size_t arrayLayerCount(const struct graph_t *g) {
+    const struct arraydata_t *meta = layerMeta(g);
+    if (meta == NULL) return 0;
+    return (meta->layers == NULL) ? 1 : meta->layercount;
+}
+
+/**
+ * @brief Make a layer the active one.
+ *
+ * @param g ARRAY graph
+ * @param layer Layer id
+ * @return 1 if successful; 0 if the layer id is not valid.
+ */
+int arraySelectLayer(struct graph_t *g, size_t layer) {
+    struct arraydata_t *meta = layerMeta(g);
+    if (meta == NULL) return 0;
+    if (meta->layers == NULL) return layer == 0;
+    if (layer >= meta->layercount) return 0;
+    meta->activelayer = layer;
+    g->capImpl = meta->layers[layer].cap;
+    g->flowImpl = meta->layers[layer].flow;
+    meta->capalloc = meta->layers[layer].capalloc;
+    meta->flowalloc = meta->layers[layer].flowalloc;
+    return 1;
+}
+
+/**
+ * @brief Id of the active layer
+ * @param g ARRAY graph
+ * @return Layer id
+ */
+size_t arrayActiveLayer(const struct graph_t *g) {
+    const struct arraydata_t *meta = layerMeta(g);
+    return (meta == NULL) ? 0 : meta->activelayer;
+}
+
+/**
+ * @brief Run a function once per layer, with each layer active in turn.
+ *
+ * @param g ARRAY graph
+ * @param fn Function to be run; receives the graph, the layer id and the context
+ * @param ctx Context passed through to fn
+ * @return 1 if every call returned 1; otherwise, 0.
+ */
+int arrayForEachLayer(struct graph_t *g, int (*fn)(struct graph_t *g, size_t layer, void *ctx), void *ctx) {
+    if (layerMeta(g) == NULL || fn == NULL) return 0;
+    size_t active = arrayActiveLayer(g);
+    size_t count = arrayLayerCount(g);
+    int retval = 1;
+    for (size_t l = 0; l < count && retval; l++) {
+        arraySelectLayer(g, l);
+        retval = fn(g, l, ctx);
     }
+    arraySelectLayer(g, active);
     return retval;
-}
\ No newline at end of file
+}
@@ -7,6 +7,8 @@
 #include <impl/arraygraph.h>
 #include <impl/arrayops.h>
 #include <util/graphcomp.h>
+#include <util/graphstats.h>
+#include <util/memops.h>
 #include <stdlib.h>
 
 /**
@@ -26,7 +28,8 @@ static int findEdgeOffset(const size_t *u, const size_t *v, size_t *index, size_
     size_t *nodearr = (size_t *)g->nodeImpl;
     size_t conn = gmeta->degree;
     size_t idx = *u * conn;
-    for (size_t i = 0; i < conn;i++) {
+    size_t i;
+    for (i = 0; i < conn;i++) {
         if (*(nodearr+idx+i) == *v) {
             *index = idx;
             *offset = i;
@@ -34,19 +37,39 @@ static int findEdgeOffset(const size_t *u, const size_t *v, size_t *index, size_
             break;
         }
     }
+    GRAPHSTATS_PROBE(g, found ? i + 1 : conn);
     return found;
 }
 
+/**
+ * @brief Zero the given edge value array, splitting the work across the standard memops partition.
+ * @param ecount Number of edge entries
+ * @param conncount Connectivity count (degree)
+ * @param darr Array to be zeroed
+ * @return 1 if successful; 0 if the array is NULL
+ */
 static int zeroDoubleArray(size_t ecount, size_t conncount, double *darr) {
-    int retval = 0;
-    if (darr != NULL) {
-        //TODO:  Prevent overwriting outside array?
-        for (size_t i = 0;i<ecount*conncount;i++) {
-            *(darr + i) = 0;
+    return parallelZero(darr, ecount * conncount, sizeof(double));
+}
+
+/**
+ * @brief Zero the capacity and flow of one edge slot, in every value layer of the graph.
+ *
+ * Slots are reused by later edges, so a value left in an inactive layer would show up on the next edge in the slot.
+ * @param g Graph structure data
+ * @param slot Index of the slot in the value arrays
+ */
+static void zeroSlot(struct graph_t *g, size_t slot) {
+    const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+    if (meta->layers != NULL) {
+        for (size_t l = 0; l < meta->layercount; l++) {
+            if (meta->layers[l].cap != NULL) meta->layers[l].cap[slot] = 0.0;
+            if (meta->layers[l].flow != NULL) meta->layers[l].flow[slot] = 0.0;
         }
-        retval = 1;
+    } else {
+        if (g->capImpl != NULL) ((double *)g->capImpl)[slot] = 0.0;
+        if (g->flowImpl != NULL) ((double *)g->flowImpl)[slot] = 0.0;
     }
-    return retval;
 }
 
 //Read functions to extract data
@@ -144,7 +167,7 @@ struct edge_t * arrayGetEdge(const size_t *u, const size_t *v, const struct grap
 
         }
     }
-    return NULL;
+    return edge;
 }
 
 /**
@@ -173,14 +196,15 @@ struct node_t * arrayGetNeighbors(const size_t *nodeid, const struct graph_t *g)
                         neighbor->next = NULL;
                         neighbor->nodeid = *(nodarr + nidx + nOffset);
                         neighbor->attrs = NULL;
+                        neighbor->edges = NULL;
                         if (curr != NULL) {
                             curr->next = neighbor;
                         }
                         curr = neighbor;
                         if (nlist == NULL) nlist = curr;
-                        nOffset++;
                     }
                 }
+                nOffset++;
             }
         }
     }
@@ -209,7 +233,7 @@ struct edge_t * arrayGetEdges(const size_t *nodeid, const struct graph_t *g) {
                 size_t nOffset = 0;
                 while (nOffset < meta->degree) {
                     if (*(nodarr + nidx + nOffset) != 0) {
-                        struct edge_t *edge = malloc(sizeof(struct node_t));
+                        struct edge_t *edge = malloc(sizeof(struct edge_t));
                         if (edge != NULL) {
                             edge->prev = curr;
                             edge->next = NULL;
@@ -223,15 +247,15 @@ struct edge_t * arrayGetEdges(const size_t *nodeid, const struct graph_t *g) {
                             }
                             curr = edge;
                             if (elist == NULL) elist = curr;
-                            nOffset++;
                         }
                     }
+                    nOffset++;
                 }
             }
         }
     }
 
-    return NULL;
+    return elist;
 }
 
 /**
@@ -252,7 +276,7 @@ int arrayGetCapacity(const size_t *uid, const size_t *vid, double *cap, const st
     size_t eIdx = 0;
     const size_t *u = uid;
     const size_t *v = vid;
-    if (g->gtype == UNDIRECTED) {
+    if ((g->gtype & DIRECTED) != DIRECTED) {
         u = minNode((size_t *)uid, (size_t *)vid);
         v = maxNode((size_t *)uid, (size_t *)vid);
     }
@@ -286,7 +310,7 @@ int arrayGetFlow(const size_t *uid, const size_t *vid, double *flow, const struc
     size_t eIdx = 0;
     const size_t *u = uid;
     const size_t *v = vid;
-    if (g->gtype == UNDIRECTED) {
+    if ((g->gtype & DIRECTED) != DIRECTED) {
         u = minNode((size_t *)uid, (size_t *)vid);
         v = maxNode((size_t *)uid, (size_t *)vid);
     }
@@ -345,21 +369,28 @@ int arrayAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph
     if (g != NULL) {
         if (g->metaImpl != NULL) {
             struct arraydata_t *meta = (struct arraydata_t *)g->metaImpl;
-            const size_t *u = minNode((size_t *)uid, (size_t *)vid);
-            const size_t *v = maxNode((size_t *)uid, (size_t *)vid);
+            const size_t *u = uid;
+            const size_t *v = vid;
+            if ((g->gtype & DIRECTED) != DIRECTED) {
+                u = minNode((size_t *)uid, (size_t *)vid);
+                v = maxNode((size_t *)uid, (size_t *)vid);
+            }
             size_t nidx = *u * meta->degree;
             size_t *nodarr = (size_t *)g->nodeImpl;
             double *caparr = (double *)g->capImpl;
-            double *farr = (double *)g->flowImpl;
-            if (*u < meta->nodelen) {
+            //clones sharing their topology cannot change it, nor can the graph they share it with; a slot holding
+            //node 0 reads as empty, so an edge stored with 0 as its end would be lost
+            if (*u < meta->nodelen && *v != 0 && meta->topology == NULL && __atomic_load_n(&meta->clones, __ATOMIC_ACQUIRE) == 0) {
                 size_t offset = 0;
                 while (!added && offset < meta->degree) {
                     if (*(nodarr + nidx + offset) == 0) {
                         *(nodarr + nidx + offset) = *v;
+                        //the new edge starts empty in the other layers
+                        zeroSlot(g, nidx + offset);
                         *(caparr + nidx + offset) = *cap;
-                        *(farr + nidx + offset) = 0.0;
                         added = 1;
                     }
+                    offset++;
                 }
 
             }
@@ -386,23 +417,17 @@ int arrayRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
     size_t eIdx = 0;
     const size_t *u = uid;
     const size_t *v = vid;
-    if (g->gtype == UNDIRECTED) {
+    if ((g->gtype & DIRECTED) != DIRECTED) {
         u = minNode((size_t *)uid, (size_t *)vid);
         v = maxNode((size_t *)uid, (size_t *)vid);
     }
 
-    if (g->metaImpl != NULL) {
+    const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+    if (meta != NULL && meta->topology == NULL && __atomic_load_n(&meta->clones, __ATOMIC_ACQUIRE) == 0) {
         if (findEdgeOffset(u, v, &eIdx, &eOffset, g)) {
             size_t *narr = (size_t *)g->nodeImpl;
             *(narr + eIdx + eOffset) = 0;
-            if (g->capImpl != NULL) {
-                double *caparr = (double *)g->capImpl;
-                *(caparr + eIdx + eOffset) = 0.0;
-            }
-            if (g->flowImpl != NULL) {
-                double *farr = (double *)g->flowImpl;
-                *(farr + eIdx + eOffset) = 0.0;
-            }
+            zeroSlot(g, eIdx + eOffset);
             removed = 1;
         }
     }
@@ -423,7 +448,7 @@ int arraySetCapacity(const size_t *uid, const size_t *vid, const double *cap, st
     size_t eIdx = 0;
     const size_t *u = uid;
     const size_t *v = vid;
-    if (g->gtype == UNDIRECTED) {
+    if ((g->gtype & DIRECTED) != DIRECTED) {
         u = minNode((size_t *)uid, (size_t *)vid);
         v = maxNode((size_t *)uid, (size_t *)vid);
     }
@@ -457,7 +482,7 @@ int arrayAddCapacity(const size_t *uid, const size_t *vid, const double *cap, st
     size_t eOffset = 0;
     const size_t *u = uid;
     const size_t *v = vid;
-    if (g->gtype == UNDIRECTED) {
+    if ((g->gtype & DIRECTED) != DIRECTED) {
         u = minNode((size_t *)uid, (size_t *)vid);
         v = maxNode((size_t *) uid, (size_t *)vid);
     }
@@ -488,7 +513,7 @@ int arraySetFlow(const size_t *uid, const size_t *vid, const double *flow, struc
     size_t eIdx = 0;
     const size_t *u = uid;
     const size_t *v = vid;
-    if (g->gtype == UNDIRECTED) {
+    if ((g->gtype & DIRECTED) != DIRECTED) {
         u = minNode((size_t *)uid, (size_t *)vid);
         v = maxNode((size_t *)uid, (size_t *)vid);
     }
@@ -521,7 +546,7 @@ int arrayAddFlow(const size_t *uid, const size_t *vid, const double *flow, struc
     size_t eOffset = 0;
     const size_t *u = uid;
     const size_t *v = vid;
-    if (g->gtype == UNDIRECTED) {
+    if ((g->gtype & DIRECTED) != DIRECTED) {
         u = minNode((size_t *)uid, (size_t *)vid);
         v = maxNode((size_t *) uid, (size_t *)vid);
     }
@@ -535,6 +560,144 @@ int arrayAddFlow(const size_t *uid, const size_t *vid, const double *flow, struc
     return retval;
 }
 
+/**
+ * @brief Atomically adjust the value of an edge in one of the edge value arrays
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end
+ * @param arr Edge value array (capacity or flow)
+ * @param delta Value to be added
+ * @param g Graph structure in question
+ * @return 0 if the edge was not found; otherwise, 1.
+ */
+static int atomicAdjust(const size_t *uid, const size_t *vid, double *arr, double delta, const struct graph_t *g) {
+    int retval = 0;
+    size_t eIdx = 0;
+    size_t eOffset = 0;
+    const size_t *u = uid;
+    const size_t *v = vid;
+    if ((g->gtype & DIRECTED) != DIRECTED) {
+        u = minNode((size_t *)uid, (size_t *)vid);
+        v = maxNode((size_t *) uid, (size_t *)vid);
+    }
+    if (arr != NULL && g->metaImpl != NULL) {
+        if (findEdgeOffset(u, v, &eIdx, &eOffset, g)) {
+            atomicAddDouble(arr + eIdx + eOffset, delta, g->config != NULL ? g->config->memorder : MEMORDER_SEQCST);
+            retval = 1;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Function to atomically add (adjust) the capacity for an edge by a given amount.
+ *
+ * Concurrent calls on the same edge are never lost, without taking any locks.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int arrayAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    return atomicAdjust(uid, vid, (double *)g->capImpl, *cap, g);
+}
+
+/**
+ * @brief Function to atomically adjust the flow value of a given edge.
+ *
+ * Concurrent calls on the same edge are never lost, without taking any locks.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int arrayAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    return atomicAdjust(uid, vid, (double *)g->flowImpl, *flow, g);
+}
+
+
+/**
+ * @brief Capacity and flow arrays of a layer
+ * @param g Graph structure in question
+ * @param layer Layer id
+ * @param cap Set to the capacity array
+ * @param flow Set to the flow array
+ */
+static void layerArrays(const struct graph_t *g, size_t layer, double **cap, double **flow) {
+    const struct arraydata_t *gmeta = (const struct arraydata_t *)g->metaImpl;
+    if (gmeta->layers == NULL) {
+        *cap = (double *)g->capImpl;
+        *flow = (double *)g->flowImpl;
+    } else {
+        *cap = gmeta->layers[layer].cap;
+        *flow = gmeta->layers[layer].flow;
+    }
+}
+
+/**
+ * @brief Retrieve the capacity and flow of an edge in every value layer, with a single edge lookup.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param caps Set to the capacity in each layer (arrayLayerCount() entries); may be NULL
+ * @param flows Set to the flow in each layer (arrayLayerCount() entries); may be NULL
+ * @param g Graph structure in question
+ * @return 1 if the edge was found; otherwise, 0.
+ */
+int arrayGetLayerValues(const size_t *uid, const size_t *vid, double *caps, double *flows, const struct graph_t *g) {
+    size_t eIdx = 0;
+    size_t eOffset = 0;
+    const size_t *u = uid;
+    const size_t *v = vid;
+    if ((g->gtype & DIRECTED) != DIRECTED) {
+        u = minNode((size_t *)uid, (size_t *)vid);
+        v = maxNode((size_t *)uid, (size_t *)vid);
+    }
+    if (g->metaImpl == NULL || !findEdgeOffset(u, v, &eIdx, &eOffset, g)) return 0;
+    size_t count = arrayLayerCount(g);
+    for (size_t l = 0; l < count; l++) {
+        double *caparr, *farr;
+        layerArrays(g, l, &caparr, &farr);
+        if (caps != NULL) caps[l] = *(caparr + eIdx + eOffset);
+        if (flows != NULL) flows[l] = *(farr + eIdx + eOffset);
+    }
+    return 1;
+}
+
+/**
+ * @brief Adjust the capacity and flow of an edge in every value layer, with a single edge lookup.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param caps Amount added to the capacity in each layer (arrayLayerCount() entries); may be NULL
+ * @param flows Amount added to the flow in each layer (arrayLayerCount() entries); may be NULL
+ * @param g Graph structure in question
+ * @return 1 if the edge was found; otherwise, 0.
+ */
+int arrayAddLayerValues(const size_t *uid, const size_t *vid, const double *caps, const double *flows,
+                        struct graph_t *g) {
+    size_t eIdx = 0;
+    size_t eOffset = 0;
+    const size_t *u = uid;
+    const size_t *v = vid;
+    if ((g->gtype & DIRECTED) != DIRECTED) {
+        u = minNode((size_t *)uid, (size_t *)vid);
+        v = maxNode((size_t *)uid, (size_t *)vid);
+    }
+    if (g->metaImpl == NULL || !findEdgeOffset(u, v, &eIdx, &eOffset, g)) return 0;
+    size_t count = arrayLayerCount(g);
+    for (size_t l = 0; l < count; l++) {
+        double *caparr, *farr;
+        layerArrays(g, l, &caparr, &farr);
+        if (caps != NULL) *(caparr + eIdx + eOffset) += caps[l];
+        if (flows != NULL) *(farr + eIdx + eOffset) += flows[l];
+    }
+    return 1;
+}
+
 
 /**
  * @brief Implementation to "reset" the graph according to the given argument pointer.
@@ -3,6 +3,36 @@
 //
 #include <graphData.h>
 #include <impl/hashgraph.h>
+#include <impl/linkgraph.h>
+#include <util/crudops.h>
+#include <util/hashes.h>
+#include <string.h>
+
+/**
+ * @brief Smallest number of index slots
+ */
+#define HASH_INIT_SLOTS 16
+
+/**
+ * @brief Number of index slots for the given node count: a power of two, keeping the load at or below one half
+ * @param nodecount Number of nodes to be indexed
+ * @return Slot count
+ */
+static size_t slotsFor(size_t nodecount) {
+    size_t count = HASH_INIT_SLOTS;
+    while (count < 2 * nodecount) count <<= 1;
+    return count;
+}
+
+/**
+ * @brief Home slot of a node id
+ * @param nodeid Node identifier
+ * @param mask Slot count less one
+ * @return Slot index
+ */
+static size_t homeSlot(size_t nodeid, size_t mask) {
+    return (size_t)WyHash64((const char *)&nodeid, sizeof(size_t), HASH_SEED64) & mask;
+}
 
 /**
  * @brief Initialize the graph using the hashtable adjacency list structure.
@@ -11,6 +41,194 @@
  * @returns 1 if successful; 0 of there was a problem.
  */
 int hashGraphInit(struct graph_t *g) {
-    return 0;
+    return hashGraphIndex(g);
 }
 
+/**
+ * @brief Clear out the underlying data structures for the given HASHED graph.
+ *
+ * @param g Graph to be cleared and memory deallocated
+ * @return 1 if the operation as a success; otherwise, 0.
+ */
+int hashGraphFree(struct graph_t *g) {
+    int retval = 1;
+    if (g != NULL && (g->gtype & HASHED) == HASHED) {
+        for (struct node_t *n = (struct node_t *)g->nodeImpl; n != NULL; n = n->next) {
+            if (n->edges != NULL) retval = retval & destroyEdgesWith(&g->allocator, (void **)&n->edges);
+        }
+        if (g->nodeImpl != NULL) retval = retval & destroyNodesWith(&g->allocator, &(g->nodeImpl));
+        retval = retval & hashGraphDropIndex(g);
+    }
+    return retval;
+}
+
+/**
+ * @brief Copy the node and edge lists of a HASHED graph into a clone, and index the copy.
+ *
+ * The lists have the same layout as LINKED lists, so they are copied by linkGraphClone().
+ *
+ * @param g Original graph
+ * @param ng Clone, with its type and configuration already set
+ * @param flags Clone options
+ * @return 1 if successful; otherwise, 0.
+ */
+int hashGraphClone(const struct graph_t *g, struct graph_t *ng, enum CLONEFLAGS flags) {
+    return linkGraphClone(g, ng, flags) && hashGraphIndex(ng);
+}
+
+/**
+ * @brief Build the node index over the node list already held in nodeImpl.
+ *
+ * @param g Graph whose node list is to be indexed
+ * @return 1 if successful; otherwise, 0 (the graph is left as it was).
+ */
+int hashGraphIndex(struct graph_t *g) {
+    if (g == NULL) return 0;
+    size_t nodecount = 0;
+    size_t edgecount = 0;
+    struct node_t *tail = NULL;
+    for (struct node_t *n = (struct node_t *)g->nodeImpl; n != NULL; n = n->next) {
+        nodecount++;
+        for (const struct edge_t *e = n->edges; e != NULL; e = e->next) edgecount++;
+        tail = n;
+    }
+
+    struct hashdata_t *meta = (struct hashdata_t *)g->metaImpl;
+    int fresh = (meta == NULL);
+    if (fresh) {
+        meta = (struct hashdata_t *)graphAlloc(&g->allocator, sizeof(struct hashdata_t));
+        if (meta == NULL) return 0;
+        memset(meta, 0, sizeof(struct hashdata_t));
+    }
+    size_t slotcount = slotsFor(nodecount);
+    struct node_t **slots = (struct node_t **)graphAlloc(&g->allocator, slotcount * sizeof(struct node_t *));
+    if (slots == NULL) {
+        if (fresh) graphFree(&g->allocator, meta, sizeof(struct hashdata_t));
+        return 0;
+    }
+    memset(slots, 0, slotcount * sizeof(struct node_t *));
+    size_t mask = slotcount - 1;
+    for (struct node_t *n = (struct node_t *)g->nodeImpl; n != NULL; n = n->next) {
+        size_t pos = homeSlot(n->nodeid, mask);
+        while (slots[pos] != NULL) pos = (pos + 1) & mask;
+        slots[pos] = n;
+    }
+
+    graphFree(&g->allocator, meta->slots, meta->slotcount * sizeof(struct node_t *));
+    meta->slots = slots;
+    meta->slotcount = slotcount;
+    meta->nodecount = nodecount;
+    meta->edgecount = edgecount;
+    meta->tail = tail;
+    g->metaImpl = meta;
+    return 1;
+}
+
+/**
+ * @brief Release the node index, leaving the node and edge lists in place.
+ *
+ * @param g Graph whose index is to be released
+ * @return 1 if successful; otherwise, 0.
+ */
+int hashGraphDropIndex(struct graph_t *g) {
+    if (g == NULL) return 0;
+    struct hashdata_t *meta = (struct hashdata_t *)g->metaImpl;
+    if (meta != NULL) {
+        graphFree(&g->allocator, meta->slots, meta->slotcount * sizeof(struct node_t *));
+        graphFree(&g->allocator, meta, sizeof(struct hashdata_t));
+        g->metaImpl = NULL;
+    }
+    return 1;
+}
+
+/**
+ * @brief Find a node in the index
+ *
+ * @param g HASHED graph
+ * @param nodeid Identifier of the node
+ * @param depth Set to the number of slots examined
+ * @return pointer to the node structure, if found; otherwise, pointer to NULL
+ */
+struct node_t * hashIndexFind(const struct graph_t *g, size_t nodeid, size_t *depth) {
+    const struct hashdata_t *meta = (const struct hashdata_t *)g->metaImpl;
+    *depth = 0;
+    if (meta == NULL) return NULL;
+    size_t mask = meta->slotcount - 1;
+    size_t pos = homeSlot(nodeid, mask);
+    struct node_t *n;
+    while ((n = meta->slots[pos]) != NULL) {
+        (*depth)++;
+        if (n->nodeid == nodeid) return n;
+        pos = (pos + 1) & mask;
+    }
+    (*depth)++;
+    return NULL;
+}
+
+/**
+ * @brief Add a node to the index, doubling the slots first if the index would become more than half full
+ *
+ * @param g HASHED graph
+ * @param n Node to be indexed (not already in the index)
+ * @return 1 if successful; otherwise, 0.
+ */
+int hashIndexInsert(struct graph_t *g, struct node_t *n) {
+    struct hashdata_t *meta = (struct hashdata_t *)g->metaImpl;
+    if (meta == NULL) return 0;
+    if (2 * (meta->nodecount + 1) > meta->slotcount) {
+        size_t nslotcount = meta->slotcount * 2;
+        struct node_t **nslots = (struct node_t **)graphAlloc(&g->allocator, nslotcount * sizeof(struct node_t *));
+        if (nslots == NULL) return 0;
+        memset(nslots, 0, nslotcount * sizeof(struct node_t *));
+        size_t nmask = nslotcount - 1;
+        for (size_t i = 0; i < meta->slotcount; i++) {
+            if (meta->slots[i] == NULL) continue;
+            size_t pos = homeSlot(meta->slots[i]->nodeid, nmask);
+            while (nslots[pos] != NULL) pos = (pos + 1) & nmask;
+            nslots[pos] = meta->slots[i];
+        }
+        graphFree(&g->allocator, meta->slots, meta->slotcount * sizeof(struct node_t *));
+        meta->slots = nslots;
+        meta->slotcount = nslotcount;
+    }
+    size_t mask = meta->slotcount - 1;
+    size_t pos = homeSlot(n->nodeid, mask);
+    while (meta->slots[pos] != NULL) pos = (pos + 1) & mask;
+    meta->slots[pos] = n;
+    meta->nodecount++;
+    return 1;
+}
+
+/**
+ * @brief Remove a node from the index
+ *
+ * Later entries of the probe run are shifted back into the hole, so lookups never need tombstones.
+ *
+ * @param g HASHED graph
+ * @param nodeid Identifier of the node
+ * @return 1 if the node was in the index; otherwise, 0.
+ */
+int hashIndexRemove(struct graph_t *g, size_t nodeid) {
+    struct hashdata_t *meta = (struct hashdata_t *)g->metaImpl;
+    if (meta == NULL) return 0;
+    size_t mask = meta->slotcount - 1;
+    size_t hole = homeSlot(nodeid, mask);
+    while (meta->slots[hole] != NULL && meta->slots[hole]->nodeid != nodeid) hole = (hole + 1) & mask;
+    if (meta->slots[hole] == NULL) return 0;
+    size_t pos = hole;
+    for (;;) {
+        pos = (pos + 1) & mask;
+        struct node_t *n = meta->slots[pos];
+        if (n == NULL) break;
+        size_t home = homeSlot(n->nodeid, mask);
+        //move n back unless its home lies cyclically in (hole, pos]
+        int stays = (hole <= pos) ? (hole < home && home <= pos) : (hole < home || home <= pos);
+        if (!stays) {
+            meta->slots[hole] = n;
+            hole = pos;
+        }
+    }
+    meta->slots[hole] = NULL;
+    meta->nodecount--;
+    return 1;
+}
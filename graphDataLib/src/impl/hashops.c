@@ -1,4 +1,507 @@
-//
-// Created by david on 11/18/17.
-//
+/**
+ * @brief Operations for a hashtable graph structure.
+ *
+ * The node and edge lists are the same as for LINKED graphs, so the operations mirror the linkops semantics.  Nodes are
+ * found through the index in the hashdata_t (see impl/hashgraph.h) rather than by walking the node list, and new edges
+ * are put at the head of their node's edge list rather than walking to its end.
+ *
+ * As with LINKED graphs, writes first give the node an edge list no snapshot shares (see util/snapshot.h).
+ */
 
+#include <impl/hashops.h>
+#include <impl/hashgraph.h>
+#include <util/crudops.h>
+#include <util/graphcomp.h>
+#include <util/graphstats.h>
+#include <util/memops.h>
+#include <util/snapshot.h>
+
+/**
+ * @brief Find the node owning an edge, and the edge in its list
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param owner Set to the owning node, if found
+ * @param g Graph structure in question
+ * @return pointer to the edge structure, if found; otherwise, pointer to NULL.
+ */
+static struct edge_t * findEdge(const size_t *uid, const size_t *vid, struct node_t **owner, const struct graph_t *g) {
+    size_t eu = *uid;
+    size_t ev = *vid;
+    if ((g->gtype & DIRECTED) != DIRECTED) {
+        eu = *(minNode((size_t *)uid, (size_t *)vid));
+        ev = *(maxNode((size_t *)uid, (size_t *)vid));
+    }
+    struct node_t *node = hashGetNode(&eu, g);
+    if (owner != NULL) *owner = node;
+    if (node == NULL) return NULL;
+    struct edge_t *curr = node->edges;
+    size_t depth = 0;
+    while (curr != NULL) {
+        depth++;
+        if (curr->v == ev) break;
+        curr = curr->next;
+    }
+    GRAPHSTATS_PROBE(g, depth);
+    return curr;
+}
+
+/**
+ * @brief Find an edge for modification, first giving its owning node an edge list no snapshot shares.
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param owner Set to the owning node, if found
+ * @param g Graph structure in question
+ * @return pointer to the edge structure, if found and writable; otherwise, pointer to NULL.
+ */
+static struct edge_t * writableEdge(const size_t *uid, const size_t *vid, struct node_t **owner, struct graph_t *g) {
+    struct node_t *node = NULL;
+    struct edge_t *e = findEdge(uid, vid, &node, g);
+    if (owner != NULL) *owner = node;
+    if (e == NULL || g->snapshots == NULL) return e;
+    if (!snapshotPrepareWrite(g, node)) return NULL;
+    //the list may have been copied, so find the edge in the live version
+    return findEdge(uid, vid, owner, g);
+}
+
+//Read functions to extract data
+/**
+ * @brief Function pointer definition for getting the node count
+ * @param g Graph structure in question
+ * @return Count of nodes, if graph is not null; otherwise, return 0
+ */
+size_t hashNodeCount(struct graph_t *g) {
+    size_t ncount = 0;
+    if ((g->gtype & HASHED) == HASHED && g->metaImpl != NULL) {
+        ncount = ((const struct hashdata_t *)g->metaImpl)->nodecount;
+    }
+    return ncount;
+}
+
+/**
+ * @brief Function pointer to extract count of edges
+ * @param g Graph structure in question
+ * @return Count of edges, if graph is not null; otherwise, return 0
+ */
+size_t hashEdgeCount(struct graph_t *g) {
+    size_t ecount = 0;
+    if ((g->gtype & HASHED) == HASHED && g->metaImpl != NULL) {
+        ecount = __atomic_load_n(&((struct hashdata_t *)g->metaImpl)->edgecount, __ATOMIC_RELAXED);
+    }
+    return ecount;
+}
+
+/**
+ * @brief Function pointer to retrieve a node structure reference.
+ *
+ * The node is part of the graph structure, and must not be released by the caller.
+ *
+ * @param nodeid Identifier of the node to be retrieved
+ * @param g Graph structure in question
+ * @return pointer to the node structure, if found; otherwise, pointer to NULL
+ */
+struct node_t * hashGetNode(const size_t *nodeid, const struct graph_t *g) {
+    struct node_t *n = NULL;
+    if ((g->gtype & HASHED) == HASHED) {
+        size_t depth = 0;
+        n = hashIndexFind(g, *nodeid, &depth);
+        GRAPHSTATS_PROBE(g, depth);
+    }
+    return n;
+}
+
+/**
+ * @brief Function pointer to retrieve a edge structure reference.
+ *
+ * @param u nodeid of the starting edge.
+ * @param v nodeid of the ending edge.
+ * @param g Graph structure in question
+ * @return pointer to the edge structure, if found; otherwise, pointer to NULL.
+ */
+struct edge_t * hashGetEdge(const size_t *u, const size_t *v, const struct graph_t *g) {
+    struct edge_t *found = NULL;
+    if ((g->gtype & HASHED) == HASHED) {
+        found = findEdge(u, v, NULL, g);
+    }
+    return found;
+}
+
+/**
+ * @brief Function pointer to retrieve linked-list of nodes that are currently defined as neighbors to the given node.
+ *
+ * Returned linked-list is distinct from the graph structure, and consumers must use free() when finished.  The edges returned
+ * are outgoing neighbors (in the case of a DIRECTED graph).
+ *
+ * @param nodeid Identifier of the node in question
+ * @param g Graph structure in question
+ * @return linked-list of node references, if found; otherwise, pointer to NULL.
+ */
+struct node_t * hashGetNeighbors(const size_t *nodeid, const struct graph_t *g) {
+    struct node_t *neighbors = NULL;
+    if ((g->gtype & HASHED) == HASHED) {
+        struct node_t *n = hashGetNode(nodeid, g);
+        struct node_t *currnode = NULL;
+        for (struct edge_t *curredge = (n != NULL) ? n->edges : NULL; curredge != NULL; curredge = curredge->next) {
+            struct node_t *p = initNode();
+            if (p == NULL) break;
+            p->nodeid = curredge->v;
+            if (neighbors == NULL) {
+                neighbors = p;
+            } else {
+                p->prev = currnode;
+                currnode->next = p;
+            }
+            currnode = p;
+        }
+    }
+    return neighbors;
+}
+
+/**
+ * @brief Function pointer to retrieve linked-list of edges from a given node.
+ *
+ * Returned linked-list is distinct from the graph structure, and consumers must use free() when finished.
+ *
+ * @param nodeid Identifier of the node in question
+ * @param g Graph structure in question
+ * @return linked-list of edges starting from the given node, if found; otherwise, pointer to NULL.
+ */
+struct edge_t * hashGetEdges(const size_t *nodeid, const struct graph_t *g) {
+    struct edge_t *elist = NULL;
+    if ((g->gtype & HASHED) == HASHED) {
+        struct node_t *n = hashGetNode(nodeid, g);
+        struct edge_t *currclone = NULL;
+        for (struct edge_t *curr = (n != NULL) ? n->edges : NULL; curr != NULL; curr = curr->next) {
+            struct edge_t *eseg = cloneEdge(curr);
+            if (eseg == NULL) break;
+            if (elist == NULL) {
+                elist = eseg;
+            } else {
+                eseg->prev = currclone;
+                currclone->next = eseg;
+            }
+            currclone = eseg;
+        }
+    }
+    return elist;
+}
+
+/**
+ * @brief Function pointer to retrieve the current capacity value for a given edge.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param cap Capacity value pointer to store the value
+ * @param g Graph structure in question
+ * @return 0 if there was a problem retrieving the value (such as the edge not existing); otherwise, 1 for a successful
+ * retrieval
+ */
+int hashGetCapacity(const size_t *uid, const size_t *vid, double *cap, const struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = hashGetEdge(uid, vid, g);
+    if (e != NULL) {
+        *cap = e->cap;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Function pointer to retrieve the current flow value for a given edge.
+ *
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param flow Flow value pointer to store the result
+ * @param g Graph structure in question
+ * @return 0 if there was a problem retrieving the value (such as the edge not existing); otherwise, 1 for a successful
+ * retrieval
+ */
+int hashGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = hashGetEdge(uid, vid, g);
+    if (e != NULL) {
+        *flow = e->flow;
+        retval = 1;
+    }
+    return retval;
+}
+
+//Write functions to modify graph
+/**
+ * @brief Function pointer to add a node to a given graph.
+ *
+ * Add a new node to the end of the node list, and to the index.
+ *
+ * @param nodeid Node identifier to be added
+ * @param g Graph structure to add the node
+ * @return 0 if there was an error, 1 if the node was successfully added
+ */
+int hashAddNode(const size_t *nodeid, struct graph_t *g) {
+    int retval = 0;
+    if ((g->gtype & HASHED) == HASHED && !isSnapshot(g) && g->metaImpl != NULL && hashGetNode(nodeid, g) == NULL) {
+        struct hashdata_t *meta = (struct hashdata_t *)g->metaImpl;
+        struct node_t *nnode = initNodeWith(&g->allocator);
+        if (nnode == NULL) return 0;
+        nnode->nodeid = *nodeid;
+        if (!hashIndexInsert(g, nnode)) {
+            destroyNodesWith(&g->allocator, (void **)&nnode);
+            return 0;
+        }
+        if (meta->tail == NULL) {
+            g->nodeImpl = nnode;
+        } else {
+            meta->tail->next = nnode;
+            nnode->prev = meta->tail;
+        }
+        meta->tail = nnode;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Remove a node from the graph.
+ *
+ * As with LINKED graphs, the reverse of each outgoing edge is removed along with the node's own edges.
+ *
+ * @param nodeid Node id to be removed.
+ * @param g Graph structure in question
+ * @return 0 if there was an error (node not found); otherwise, 1 if successful.
+ */
+int hashRemoveNode(const size_t *nodeid, struct graph_t *g) {
+    int retval = 0;
+    if ((g->gtype & HASHED) == HASHED && !isSnapshot(g)) {
+        struct node_t *rnode = hashGetNode(nodeid, g);
+        if (rnode != NULL) {
+            struct hashdata_t *meta = (struct hashdata_t *)g->metaImpl;
+            struct edge_t *curredge = rnode->edges;
+            struct edge_t *nextedge = NULL;
+            while (curredge != NULL) {
+                nextedge = curredge->next;
+                hashRemoveEdge(&(curredge->v), nodeid, g);
+                curredge = nextedge;
+            }
+            size_t ecount = 0;
+            for (const struct edge_t *e = rnode->edges; e != NULL; e = e->next) ecount++;
+            //Clear outgoing edges, unless a snapshot still holds them
+            if (!snapshotRetireEdges(g, rnode) && rnode->edges != NULL) {
+                destroyEdgesWith(&g->allocator, (void **)&(rnode->edges));
+            }
+            __atomic_fetch_sub(&meta->edgecount, ecount, __ATOMIC_RELAXED);
+
+            hashIndexRemove(g, *nodeid);
+            if (rnode->prev != NULL) rnode->prev->next = rnode->next;
+            if (rnode->next != NULL) rnode->next->prev = rnode->prev;
+            if (g->nodeImpl == rnode) g->nodeImpl = rnode->next;
+            if (meta->tail == rnode) meta->tail = rnode->prev;
+            rnode->prev = NULL;
+            rnode->next = NULL;
+            destroyNodesWith(&g->allocator, (void **)&rnode);
+            retval = 1;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Function pointer to add an edge to a given graph.
+ *
+ * The edge is put at the head of the edge list of its starting node.
+ *
+ * @param uid identifer for start of edge
+ * @param vid identifier for end of edge
+ * @param cap capacity value to be assigned
+ * @param g graph structure in question
+ * @return 0 if there was an error; 1 if the edge was successfully added.
+ */
+int hashAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_t *g) {
+    int retval = 0;
+    if ((g->gtype & HASHED) == HASHED) {
+        size_t u = *uid;
+        size_t v = *vid;
+        if ((g->gtype & DIRECTED) != DIRECTED) {
+            u = *(minNode((size_t *)uid, (size_t *)vid));
+            v = *(maxNode((size_t *)uid, (size_t *)vid));
+        }
+        struct node_t *n = hashGetNode(&u, g);
+        if (n != NULL) {
+            if (!snapshotPrepareWrite(g, n)) return 0;
+            struct edge_t *nedge = initEdgeWith(&g->allocator);
+            if (nedge == NULL) return 0;
+            nedge->u = u;
+            nedge->v = v;
+            nedge->cap = *cap;
+            nedge->next = n->edges;
+            if (n->edges != NULL) n->edges->prev = nedge;
+            n->edges = nedge;
+            __atomic_fetch_add(&((struct hashdata_t *)g->metaImpl)->edgecount, 1, __ATOMIC_RELAXED);
+            retval = 1;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Function pointer to remove an edge from the given graph.
+ *
+ * @param uid Identifier for the edge start
+ * @param vid Identifier for the edge end.
+ * @param g Graph structure in question
+ * @return 0 if there was an error (e.g. the edge was not found); otherwise, 1 if the edge was removed.
+ */
+int hashRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
+    int retval = 0;
+    if ((g->gtype & HASHED) == HASHED) {
+        struct node_t *owner = NULL;
+        struct edge_t *redge = writableEdge(uid, vid, &owner, g);
+        if (redge != NULL) {
+            if (redge->prev != NULL) redge->prev->next = redge->next;
+            if (redge->next != NULL) redge->next->prev = redge->prev;
+            if (owner->edges == redge) owner->edges = redge->next;
+            redge->prev = NULL;
+            redge->next = NULL;
+            destroyEdgesWith(&g->allocator, (void **)&redge);
+            __atomic_fetch_sub(&((struct hashdata_t *)g->metaImpl)->edgecount, 1, __ATOMIC_RELAXED);
+            retval = 1;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Function pointer to set the capacity (cost, weight, etc.) of an edge in the given graph.
+ * @param uid identifier of the edge start
+ * @param vid identifier of the edge ending.
+ * @param cap capacity value to be set
+ * @param g Graph structure in question
+ * @return 0 if there was an error; 1 if the capacity was successfully set
+ */
+int hashSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = writableEdge(uid, vid, NULL, g);
+    if (e != NULL) {
+        e->cap = *cap;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Function to add (adjust) the capacity for an edge by a given amount.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int hashAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = writableEdge(uid, vid, NULL, g);
+    if (e != NULL) {
+        e->cap += *cap;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Function to set the flow value for an edge (amount of capacity currently "used")
+ *
+ * @param uid Identifier of the edge start.
+ * @param vid Identifier of the edge end.
+ * @param flow Value to be set for the flow.
+ * @param g Graph structure in question
+ * @return 0 of there was an error (edge not found, for example); otherwise, 1 if the flow value as successfully set.
+ */
+int hashSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = writableEdge(uid, vid, NULL, g);
+    if (e != NULL) {
+        e->flow = *flow;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Function to adjust the flow value of a given edge.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int hashAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = writableEdge(uid, vid, NULL, g);
+    if (e != NULL) {
+        e->flow += *flow;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Function to atomically add (adjust) the capacity for an edge by a given amount.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int hashAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = writableEdge(uid, vid, NULL, g);
+    if (e != NULL) {
+        atomicAddDouble(&e->cap, *cap, g->config != NULL ? g->config->memorder : MEMORDER_SEQCST);
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Function to atomically adjust the flow value of a given edge.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int hashAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    int retval = 0;
+    struct edge_t *e = writableEdge(uid, vid, NULL, g);
+    if (e != NULL) {
+        atomicAddDouble(&e->flow, *flow, g->config != NULL ? g->config->memorder : MEMORDER_SEQCST);
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Function pointer to "reset" the graph according to the given argument pointer.
+ *
+ * Walk the edges and set capacities and flows to zero.
+ *
+ * @param g Graph structure to be zeroed or modified according to reset logic
+ * @param args Arguments to be used in the reset process, if necessary
+ * @param callback Callback to be executed when graph has been reset.
+ * @return 0 if there was an error during the reset; 1 if the reset completed;
+ */
+int hashResetGraph(struct graph_t *g, void *args, void (*callback)(void)) {
+    int retval = 0;
+    if ((g->gtype & HASHED) == HASHED) {
+        retval = 1;
+        for (struct node_t *n = (struct node_t *)g->nodeImpl; n != NULL && retval; n = n->next) {
+            retval = snapshotPrepareWrite(g, n);
+            for (struct edge_t *e = retval ? n->edges : NULL; e != NULL; e = e->next) {
+                e->flow = 0.0;
+                e->cap = 0.0;
+            }
+        }
+    }
+    if (callback != NULL) callback();
+    return retval;
+}
@@ -39,12 +39,65 @@ int linkGraphFree(struct graph_t *g) {
         if ((g->gtype & LINKED) == LINKED) {
             struct node_t *currnode = (struct node_t *)g->nodeImpl;
             while (currnode != NULL) {
-                retval = retval & destroyEdges((void **)&currnode->edges);
+                //nodes without edges are fine--only a failed release counts as an error
+                if (currnode->edges != NULL) {
+                    retval = retval & destroyEdgesWith(&g->allocator, (void **)&currnode->edges);
+                }
                 currnode = currnode->next;
             }
             //now clear out nodes
-            retval = retval & destroyNodes(&(g->nodeImpl));
+            if (g->nodeImpl != NULL) {
+                retval = retval & destroyNodesWith(&g->allocator, &(g->nodeImpl));
+            }
         }
     }
     return retval;
-}
\ No newline at end of file
+}
+/**
+ * @brief Copy the node and edge lists of a LINKED graph into a clone, in a single pass.
+ *
+ * @param g Original graph (may be a snapshot view)
+ * @param ng Clone, with its type and configuration already set
+ * @param flags Clone options
+ * @return 1 if successful; otherwise, 0.
+ */
+int linkGraphClone(const struct graph_t *g, struct graph_t *ng, enum CLONEFLAGS flags) {
+    if (g == NULL || ng == NULL) return 0;
+    const struct graphallocator_t *a = &ng->allocator;
+    int full = (flags != CLONE_STRUCTURE);
+    struct node_t *ntail = NULL;
+    for (const struct node_t *n = (const struct node_t *)g->nodeImpl; n != NULL; n = n->next) {
+        struct node_t *nn = initNodeWith(a);
+        if (nn == NULL) return 0;
+        nn->nodeid = n->nodeid;
+        //link first, so a failure part-way is released with the clone
+        if (ntail == NULL) {
+            ng->nodeImpl = nn;
+        } else {
+            ntail->next = nn;
+            nn->prev = ntail;
+        }
+        ntail = nn;
+        if (full && !cloneFeaturesWith(a, n->attrs, &nn->attrs)) return 0;
+
+        struct edge_t *etail = NULL;
+        for (const struct edge_t *e = n->edges; e != NULL; e = e->next) {
+            struct edge_t *ne = cloneEdgeWith(a, e);
+            if (ne == NULL) return 0;
+            if (etail == NULL) {
+                nn->edges = ne;
+            } else {
+                etail->next = ne;
+                ne->prev = etail;
+            }
+            etail = ne;
+            if (full) {
+                if (!cloneFeaturesWith(a, e->attrs, &ne->attrs)) return 0;
+            } else {
+                ne->cap = 0.0;
+                ne->flow = 0.0;
+            }
+        }
+    }
+    return 1;
+}
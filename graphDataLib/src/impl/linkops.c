@@ -13,6 +13,9 @@
 #include <impl/linkops.h>
 #include <util/crudops.h>
 #include <util/graphcomp.h>
+#include <util/graphstats.h>
+#include <util/memops.h>
+#include <util/snapshot.h>
 
 
 
@@ -71,13 +74,16 @@ struct node_t * linkGetNode(const size_t *nodeid, const struct graph_t *g) {
     struct node_t *n = NULL;
     if ((g->gtype & LINKED) == LINKED) {
         struct node_t *curr = (struct node_t *)g->nodeImpl;
+        size_t depth = 0;
         while (curr != NULL) {
+            depth++;
             if (curr->nodeid == *nodeid) {
                 n = curr;
                 break;
             }
             curr = curr->next;
         }
+        GRAPHSTATS_PROBE(g, depth);
     }
     return n;
 }
@@ -97,20 +103,23 @@ struct edge_t * linkGetEdge(const size_t *u, const size_t *v, const struct graph
     if ((g->gtype & LINKED) == LINKED) {
         size_t eu = *u;
         size_t ev = *v;
-        if ((g->gtype & UNDIRECTED) == UNDIRECTED) {
+        if ((g->gtype & DIRECTED) != DIRECTED) {
             eu = *(minNode((size_t *)u,(size_t *)v));
             ev = *(maxNode((size_t *)u,(size_t *)v));
         }
         struct node_t *node = linkGetNode(&eu,g);
         if (node != NULL) {
             struct edge_t *curr = node->edges;
+            size_t depth = 0;
             while (curr != NULL) {
+                depth++;
                 if (curr->v == ev) {
                     found = curr;
                     break;
                 }
                 curr = curr->next;
             }
+            GRAPHSTATS_PROBE(g, depth);
         }
     }
     return found;
@@ -230,6 +239,21 @@ int linkGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct
 }
 
 //Write functions to modify graph
+/**
+ * @brief Find an edge for modification, first giving its owning node an edge list no snapshot shares.
+ * @param uid Edge start identifier
+ * @param vid Edge end identifier
+ * @param g Graph structure in question
+ * @return pointer to the edge structure, if found and writable; otherwise, pointer to NULL.
+ */
+static struct edge_t * writableEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
+    size_t u = *uid;
+    if ((g->gtype & DIRECTED) != DIRECTED) u = *(minNode((size_t *)uid, (size_t *)vid));
+    struct node_t *owner = linkGetNode(&u, g);
+    if (owner == NULL || !snapshotPrepareWrite(g, owner)) return NULL;
+    return linkGetEdge(uid, vid, g);
+}
+
 /**
  * @brief Function pointer to add a node to a given graph.
  *
@@ -241,10 +265,11 @@ int linkGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct
  */
 int linkAddNode(const size_t *nodeid, struct graph_t *g) {
     int retval = 0;
-    if ((g->gtype & LINKED) == LINKED) {
+    if ((g->gtype & LINKED) == LINKED && !isSnapshot(g)) {
         struct node_t *exists = linkGetNode(nodeid, g);
         if (exists == NULL) {
-            struct node_t *nnode = initNode();
+            struct node_t *nnode = initNodeWith(&g->allocator);
+            if (nnode == NULL) return 0;
             nnode->nodeid = *nodeid;
             //start walking through to find the correct spot
             struct node_t *curr = (struct node_t *)g->nodeImpl;
@@ -273,7 +298,7 @@ int linkAddNode(const size_t *nodeid, struct graph_t *g) {
  */
 int linkRemoveNode(const size_t *nodeid, struct graph_t *g) {
     int retval = 0;
-    if ((g->gtype & LINKED) == LINKED) {
+    if ((g->gtype & LINKED) == LINKED && !isSnapshot(g)) {
         struct node_t *rnode = linkGetNode(nodeid, g);
         if (rnode != NULL) {
             struct node_t *prev = rnode->prev;
@@ -286,15 +311,15 @@ int linkRemoveNode(const size_t *nodeid, struct graph_t *g) {
                 linkRemoveEdge(&(curredge->v),nodeid, g);
                 curredge = nextedge;
             }
-            //Clear outgoing edges
-            destroyEdges((void **)&(rnode->edges));
-            destroyFeatures((void **)&(rnode->attrs));
+            //Clear outgoing edges, unless a snapshot still holds them
+            if (!snapshotRetireEdges(g, rnode)) destroyEdgesWith(&g->allocator, (void **)&(rnode->edges));
             //Cut out node and free memory
-            rnode->prev = NULL;
-            rnode->next = NULL;
-            free(rnode);
             if (prev != NULL) prev->next = next;
             if (next != NULL) next->prev = prev;
+            if (g->nodeImpl == rnode) g->nodeImpl = next;
+            rnode->prev = NULL;
+            rnode->next = NULL;
+            destroyNodesWith(&g->allocator, (void **)&rnode);
             retval = 1;
         }
     }
@@ -318,14 +343,16 @@ int linkAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_
         //Is there a node?
         size_t u = *uid;
         size_t v = *vid;
-        if ((g->gtype & UNDIRECTED) == UNDIRECTED) {
+        if ((g->gtype & DIRECTED) != DIRECTED) {
             u = *(minNode((size_t *)uid, (size_t *)vid));
             v = *(maxNode((size_t *)uid, (size_t *)vid));
         }
 
         struct node_t *n = linkGetNode(&u, g);
         if (n != NULL) {
-            struct edge_t *nedge = initEdge();
+            if (!snapshotPrepareWrite(g, n)) return 0;
+            struct edge_t *nedge = initEdgeWith(&g->allocator);
+            if (nedge == NULL) return 0;
             nedge->u = u;
             nedge->v = v;
             nedge->cap = *cap;
@@ -359,17 +386,21 @@ int linkAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_
 int linkRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
     int retval = 0;
     if ((g->gtype & LINKED) == LINKED) {
-        struct edge_t *redge = linkGetEdge(uid, vid, g);
+        struct edge_t *redge = writableEdge(uid, vid, g);
         if (redge != NULL) {
             struct edge_t *prev = redge->prev;
             struct edge_t *next = redge->next;
-            destroyFeatures((void **)&(redge->attrs));
+            if (prev != NULL) prev->next = next;
+            if (next != NULL) next->prev = prev;
+            if (prev == NULL) {
+                //head of the edge list--the owning node must point past it
+                struct node_t *owner = linkGetNode(&redge->u, g);
+                if (owner != NULL && owner->edges == redge) owner->edges = next;
+            }
             redge->prev = NULL;
             redge->next = NULL;
             redge->cap = 0.0;
-            free(redge);
-            if (prev != NULL) prev->next = next;
-            if (next != NULL) next->prev = prev;
+            destroyEdgesWith(&g->allocator, (void **)&redge);
             retval = 1;
         }
     }
@@ -386,7 +417,7 @@ int linkRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
  */
 int linkSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
     int retval = 0;
-    struct edge_t *e = linkGetEdge(uid, vid, g);
+    struct edge_t *e = writableEdge(uid, vid, g);
     if (e != NULL) {
         e->cap = *cap;
         retval = 1;
@@ -408,7 +439,7 @@ int linkSetCapacity(const size_t *uid, const size_t *vid, const double *cap, str
 int linkAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
     int retval = 0;
     if ((g->gtype & LINKED) == LINKED) {
-        struct edge_t *e = linkGetEdge(uid, vid, g);
+        struct edge_t *e = writableEdge(uid, vid, g);
         if (e != NULL) {
             e->cap += *cap;
             retval = 1;
@@ -431,7 +462,7 @@ int linkAddCapacity(const size_t *uid, const size_t *vid, const double *cap, str
 int linkSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
     int retval = 0;
     if ((g->gtype & LINKED) == LINKED) {
-        struct edge_t *e = linkGetEdge(uid, vid, g);
+        struct edge_t *e = writableEdge(uid, vid, g);
         if (e != NULL) {
             e->flow = *flow;
             retval = 1;
@@ -454,7 +485,7 @@ int linkSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct
 int linkAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
     int retval = 0;
     if ((g->gtype & LINKED) == LINKED) {
-        struct edge_t *e = linkGetEdge(uid, vid, g);
+        struct edge_t *e = writableEdge(uid, vid, g);
         if (e != NULL) {
             e->flow += *flow;
             retval = 1;
@@ -463,6 +494,53 @@ int linkAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct
     return retval;
 }
 
+/**
+ * @brief Function to atomically add (adjust) the capacity for an edge by a given amount.
+ *
+ * The update itself is atomic, but finding the edge walks the edge list, so the list must not be changed at the same
+ * time (or the graph must use CONCURRENCY_STRIPED).
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param cap Value to adjust the capacity
+ * @param g Graph structure in question
+ * @return 0 if there was an error (edge not found, for example); 1 of capacity was successfully adjusted
+ */
+int linkAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    int retval = 0;
+    if ((g->gtype & LINKED) == LINKED) {
+        struct edge_t *e = writableEdge(uid, vid, g);
+        if (e != NULL) {
+            atomicAddDouble(&e->cap, *cap, g->config != NULL ? g->config->memorder : MEMORDER_SEQCST);
+            retval = 1;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Function to atomically adjust the flow value of a given edge.
+ *
+ * Same restrictions as linkAtomicAddCapacity().
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end.
+ * @param flow The value to be added to adjust the flow value.
+ * @param g The graph structure in question
+ * @return 0 if there was an error (such as the edge not found); otherwise, 1 if the flow value was successfully adjusted.
+ */
+int linkAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    int retval = 0;
+    if ((g->gtype & LINKED) == LINKED) {
+        struct edge_t *e = writableEdge(uid, vid, g);
+        if (e != NULL) {
+            atomicAddDouble(&e->flow, *flow, g->config != NULL ? g->config->memorder : MEMORDER_SEQCST);
+            retval = 1;
+        }
+    }
+    return retval;
+}
+
 /**
  * @brief Function pointer to "reset" the graph according to the given argument pointer.
  *
@@ -478,8 +556,10 @@ int linkResetGraph(struct graph_t *g, void *args, void (*callback)(void)) {
     if ((g->gtype & LINKED) == LINKED) {
         struct node_t *currnode = (struct node_t *)g->nodeImpl;
         struct edge_t *curredge = NULL;
-        while (currnode != NULL) {
-            curredge = currnode->edges;
+        retval = 1;
+        while (currnode != NULL && retval) {
+            retval = snapshotPrepareWrite(g, currnode);
+            curredge = retval ? currnode->edges : NULL;
             while (curredge != NULL) {
                 curredge->flow = 0.0;
                 curredge->cap = 0.0;
@@ -487,7 +567,6 @@ int linkResetGraph(struct graph_t *g, void *args, void (*callback)(void)) {
             }
             currnode = currnode->next;
         }
-        retval = 1;
     }
     if (callback != NULL) callback();
     return retval;
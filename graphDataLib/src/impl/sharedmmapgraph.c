@@ -1,5 +1,516 @@
-//
-// Created by david on 10/21/23.
-//
+/**
+ * This is the implementation of the tiled, file-backed ARRAY graph structure.  The file holds a header page, then the
+ * tiles in row-major tile order; each tile is mapped on its own, on demand, through a small LRU cache of mappings.
+ *
+ * The node, capacity and flow arrays are not in memory, so graph_t->nodeImpl, capImpl, flowImpl and edgeImpl are NULL.
+ */
 
 #include <impl/sharedmmapgraph.h>
+#include <util/crudops.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef GRAPHDATA_PTHREADS
+#include <pthread.h>
+#endif
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Marks a tile that is not mapped, or a cache slot without a tile
+ */
+#define TILE_NONE ((size_t)-1)
+
+/**
+ * @brief Identifies a tiled graph file
+ */
+static const char tileMagic[8] = { 'G', 'D', 'T', 'I', 'L', 'E', 'S', '1' };
+
+/**
+ * @brief Layout of a tiled graph file, at the start of its header page
+ */
+struct tileheader_t {
+    char magic[8];
+    uint64_t directed;
+    uint64_t dimcount;
+    uint64_t tileside;
+    uint64_t degree;
+    uint64_t dims[MMAP_MAX_DIMS];
+};
+
+/**
+ * @brief One mapping of the tile cache, linked into the LRU list
+ */
+struct tileslot_t {
+    /**
+     * @brief Start of the mapping; NULL if the slot is empty
+     */
+    char *base;
+    /**
+     * @brief Tile mapped in the slot; TILE_NONE if empty
+     */
+    size_t tile;
+    /**
+     * @brief More recently used slot; TILE_NONE at the head
+     */
+    size_t prev;
+    /**
+     * @brief Less recently used slot; TILE_NONE at the tail
+     */
+    size_t next;
+};
+
+struct tilecache_t {
+    /**
+     * @brief Descriptor of the open file
+     */
+    int fd;
+    /**
+     * @brief Size of the header page
+     */
+    size_t headerbytes;
+    /**
+     * @brief Number of dimensions
+     */
+    size_t dimcount;
+    /**
+     * @brief Dimensions of the grid
+     */
+    size_t dims[MMAP_MAX_DIMS];
+    /**
+     * @brief Number of mapping slots
+     */
+    size_t slotcount;
+    /**
+     * @brief Number of slots taken so far; slots fill up in order before any is reused
+     */
+    size_t used;
+    /**
+     * @brief Most recently used slot
+     */
+    size_t head;
+    /**
+     * @brief Least recently used slot, the next to be reused
+     */
+    size_t tail;
+    /**
+     * @brief Mapping slots
+     */
+    struct tileslot_t *slots;
+    /**
+     * @brief Slot holding each tile, or TILE_NONE (tilecount entries)
+     */
+    size_t *tileslot;
+#ifdef GRAPHDATA_PTHREADS
+    /**
+     * @brief Guards the cache and the tiles it hands out
+     */
+    pthread_mutex_t lock;
+#endif
+};
+
+/**
+ * @brief Round a size up to a multiple of the page size
+ */
+static size_t roundToPage(size_t bytes, size_t page) {
+    return ((bytes + page - 1) / page) * page;
+}
+
+static struct mmapdata_t * mmapMeta(const struct graph_t *g) {
+    return isMmapGraph(g) ? (struct mmapdata_t *)g->metaImpl : NULL;
+}
+
+/**
+ * @brief Determine whether a graph is stored in a tiled file
+ * @param g Graph in question
+ * @return 1 for SHARED_MMAP graphs; otherwise, 0.
+ */
+int isMmapGraph(const struct graph_t *g) {
+    return g != NULL && (g->gtype & (SHARED_MMAP | ARRAY)) == (SHARED_MMAP | ARRAY) && g->metaImpl != NULL;
+}
+
+void mmapCacheLock(const struct graph_t *g) {
+#ifdef GRAPHDATA_PTHREADS
+    struct mmapdata_t *meta = mmapMeta(g);
+    if (meta != NULL) pthread_mutex_lock(&meta->cache->lock);
+#endif
+}
+
+void mmapCacheUnlock(const struct graph_t *g) {
+#ifdef GRAPHDATA_PTHREADS
+    struct mmapdata_t *meta = mmapMeta(g);
+    if (meta != NULL) pthread_mutex_unlock(&meta->cache->lock);
+#endif
+}
+
+/**
+ * @brief Take a slot out of the LRU list
+ */
+static void unlinkSlot(struct tilecache_t *c, size_t s) {
+    struct tileslot_t *slot = c->slots + s;
+    if (slot->prev != TILE_NONE) c->slots[slot->prev].next = slot->next; else c->head = slot->next;
+    if (slot->next != TILE_NONE) c->slots[slot->next].prev = slot->prev; else c->tail = slot->prev;
+    slot->prev = TILE_NONE;
+    slot->next = TILE_NONE;
+}
+
+/**
+ * @brief Put a slot at the head of the LRU list
+ */
+static void pushSlot(struct tilecache_t *c, size_t s) {
+    struct tileslot_t *slot = c->slots + s;
+    slot->prev = TILE_NONE;
+    slot->next = c->head;
+    if (c->head != TILE_NONE) c->slots[c->head].prev = s;
+    c->head = s;
+    if (c->tail == TILE_NONE) c->tail = s;
+}
+
+/**
+ * @brief Unmap the tile in a slot, if any
+ */
+static void dropSlot(const struct mmapdata_t *meta, struct tileslot_t *slot) {
+#ifdef __unix__
+    if (slot->base != NULL) munmap(slot->base, meta->tilebytes);
+#endif
+    if (slot->tile != TILE_NONE) meta->cache->tileslot[slot->tile] = TILE_NONE;
+    slot->base = NULL;
+    slot->tile = TILE_NONE;
+}
+
+/**
+ * @brief Find a tile in the cache, mapping it (in place of the least recently used tile) if needed
+ *
+ * A newly mapped tile also starts the read-ahead of the next tile in row-major tile order.
+ *
+ * @param meta Tiled graph metadata
+ * @param tile Tile number
+ * @return Start of the tile's mapping; NULL if it could not be mapped.
+ */
+static char * fetchTile(struct mmapdata_t *meta, size_t tile) {
+    struct tilecache_t *c = meta->cache;
+    size_t s = c->tileslot[tile];
+    if (s != TILE_NONE) {
+        meta->hits++;
+        if (c->head != s) {
+            unlinkSlot(c, s);
+            pushSlot(c, s);
+        }
+        return c->slots[s].base;
+    }
+    meta->misses++;
+    if (c->used < c->slotcount) {
+        s = c->used++;
+    } else {
+        s = c->tail;
+        unlinkSlot(c, s);
+        if (c->slots[s].tile != TILE_NONE) meta->evictions++;
+        dropSlot(meta, c->slots + s);
+    }
+    pushSlot(c, s);
+#ifdef __unix__
+    off_t offset = (off_t)(c->headerbytes + tile * meta->tilebytes);
+    void *base = mmap(NULL, meta->tilebytes, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, offset);
+    if (base == MAP_FAILED) return NULL;
+    c->slots[s].base = (char *)base;
+    c->slots[s].tile = tile;
+    c->tileslot[tile] = s;
+#ifdef POSIX_FADV_WILLNEED
+    if (tile + 1 < meta->tilecount && c->tileslot[tile + 1] == TILE_NONE) {
+        posix_fadvise(c->fd, offset + (off_t)meta->tilebytes, (off_t)meta->tilebytes, POSIX_FADV_WILLNEED);
+    }
+#endif
+#endif
+    return c->slots[s].base;
+}
+
+/**
+ * @brief Find the slots of a node, mapping its tile if needed
+ *
+ * @param g SHARED_MMAP graph
+ * @param nodeid Node identifier
+ * @param slots Set to the slots of the node
+ * @return 1 if successful; 0 if the node id is out of range or its tile could not be mapped.
+ */
+int mmapNodeSlots(const struct graph_t *g, size_t nodeid, struct mmapslots_t *slots) {
+    struct mmapdata_t *meta = mmapMeta(g);
+    if (meta == NULL || nodeid >= meta->nodelen) return 0;
+    const struct tilecache_t *c = meta->cache;
+    size_t rest = nodeid, tile = 0, cell = 0, tilestride = 1, cellstride = 1;
+    for (size_t d = 0; d < c->dimcount; d++) {
+        size_t coord = rest % c->dims[d];
+        rest /= c->dims[d];
+        tile += (coord / meta->tileside) * tilestride;
+        cell += (coord % meta->tileside) * cellstride;
+        tilestride *= meta->tilesper[d];
+        cellstride *= meta->tileside;
+    }
+    char *base = fetchTile(meta, tile);
+    if (base == NULL) return 0;
+    size_t slotcount = meta->tilenodes * meta->degree;
+    size_t first = cell * meta->degree;
+    slots->nodes = (size_t *)base + first;
+    slots->cap = (double *)(base + slotcount * sizeof(size_t)) + first;
+    slots->flow = (double *)(base + slotcount * (sizeof(size_t) + sizeof(double))) + first;
+    return 1;
+}
+
+/**
+ * @brief Visit every edge of a SHARED_MMAP graph, one tile at a time
+ *
+ * @param g SHARED_MMAP graph
+ * @param fn Function called with the start, end and capacity of each edge; returns 0 to stop
+ * @param ctx Context passed through to fn
+ * @return 1 if every edge was visited; otherwise, 0.
+ */
+int mmapForEachEdge(const struct graph_t *g, int (*fn)(size_t u, size_t v, double cap, void *ctx), void *ctx) {
+    struct mmapdata_t *meta = mmapMeta(g);
+    if (meta == NULL || fn == NULL) return 0;
+    const struct tilecache_t *c = meta->cache;
+    size_t slotcount = meta->tilenodes * meta->degree;
+    int retval = 1;
+    mmapCacheLock(g);
+    for (size_t tile = 0; tile < meta->tilecount && retval; tile++) {
+        char *base = fetchTile(meta, tile);
+        if (base == NULL) {
+            retval = 0;
+            break;
+        }
+        const size_t *nodes = (const size_t *)base;
+        const double *caps = (const double *)(base + slotcount * sizeof(size_t));
+        for (size_t cell = 0; cell < meta->tilenodes && retval; cell++) {
+            //node id of the cell, unless the cell is padding past the edge of the grid
+            size_t trest = tile, crest = cell, nodeid = 0, stride = 1;
+            int inside = 1;
+            for (size_t d = 0; d < c->dimcount; d++) {
+                size_t coord = (trest % meta->tilesper[d]) * meta->tileside + crest % meta->tileside;
+                trest /= meta->tilesper[d];
+                crest /= meta->tileside;
+                if (coord >= c->dims[d]) inside = 0;
+                nodeid += coord * stride;
+                stride *= c->dims[d];
+            }
+            for (size_t k = 0; inside && k < meta->degree && retval; k++) {
+                size_t s = cell * meta->degree + k;
+                if (nodes[s] != 0) retval = fn(nodeid, nodes[s], caps[s], ctx);
+            }
+        }
+    }
+    mmapCacheUnlock(g);
+    return retval;
+}
+
+/**
+ * @brief Set the capacities and flows of every tile of a SHARED_MMAP graph to 0.0
+ * @param g SHARED_MMAP graph
+ * @return 1 if successful; otherwise, 0.
+ */
+int mmapZeroValues(struct graph_t *g) {
+    struct mmapdata_t *meta = mmapMeta(g);
+    if (meta == NULL) return 0;
+    size_t slotcount = meta->tilenodes * meta->degree;
+    int retval = 1;
+    mmapCacheLock(g);
+    for (size_t tile = 0; tile < meta->tilecount && retval; tile++) {
+        char *base = fetchTile(meta, tile);
+        if (base == NULL) {
+            retval = 0;
+        } else {
+            memset(base + slotcount * sizeof(size_t), 0, 2 * slotcount * sizeof(double));
+        }
+    }
+    mmapCacheUnlock(g);
+    return retval;
+}
+
+/**
+ * @brief Open the file of a tiled graph, creating it if it is new or empty
+ * @param c Tile cache, with its dimensions set
+ * @param path File name
+ * @param header Header the file must have
+ * @param filebytes Size of the file
+ * @return 1 if the file is open with the expected layout; otherwise, 0.
+ */
+static int openTileFile(struct tilecache_t *c, const char *path, const struct tileheader_t *header, size_t filebytes) {
+#ifdef __unix__
+    c->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (c->fd < 0) return 0;
+    struct stat st;
+    if (fstat(c->fd, &st) != 0) return 0;
+    if (st.st_size == 0) {
+        return pwrite(c->fd, header, sizeof(struct tileheader_t), 0) == (ssize_t)sizeof(struct tileheader_t)
+               && ftruncate(c->fd, (off_t)filebytes) == 0;
+    }
+    struct tileheader_t existing;
+    if (pread(c->fd, &existing, sizeof(struct tileheader_t), 0) != (ssize_t)sizeof(struct tileheader_t)) return 0;
+    return memcmp(&existing, header, sizeof(struct tileheader_t)) == 0 && (size_t)st.st_size >= filebytes;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Release the tile cache of a graph, unmapping every tile and closing the file
+ */
+static void freeTileCache(const struct graph_t *g, struct mmapdata_t *meta) {
+    struct tilecache_t *c = meta->cache;
+    if (c == NULL) return;
+    if (c->slots != NULL) {
+        for (size_t s = 0; s < c->used; s++) dropSlot(meta, c->slots + s);
+        graphFree(&g->allocator, c->slots, c->slotcount * sizeof(struct tileslot_t));
+    }
+    if (c->tileslot != NULL) graphFree(&g->allocator, c->tileslot, meta->tilecount * sizeof(size_t));
+#ifdef __unix__
+    if (c->fd >= 0) close(c->fd);
+#endif
+#ifdef GRAPHDATA_PTHREADS
+    pthread_mutex_destroy(&c->lock);
+#endif
+    graphFree(&g->allocator, c, sizeof(struct tilecache_t));
+    meta->cache = NULL;
+}
+
+/**
+ * @brief Set up a graph with tiled, file-backed array data
+ *
+ * @param g Graph structure
+ * @return 1 if successful; 0 if an error
+ */
+int mmapGraphInit(struct graph_t *g) {
+#ifdef __unix__
+    if (g == NULL || g->dims == NULL || g->config == NULL || g->config->mmappath == NULL) return 0;
+    if ((g->gtype & SPATIAL) != SPATIAL || (g->gtype & LABELED) == LABELED) return 0;
+    //the tiles are laid out by coordinates, so the ids must be row-major
+    if (g->dims->order != ORDER_ROWMAJOR) return 0;
+    size_t dimcount = g->dims->dimcount;
+    if (dimcount == 0 || dimcount > MMAP_MAX_DIMS) return 0;
+    struct mmapdata_t *meta = (struct mmapdata_t *)graphAlloc(&g->allocator, sizeof(struct mmapdata_t));
+    if (meta == NULL) return 0;
+    memset(meta, 0, sizeof(struct mmapdata_t));
+    g->metaImpl = (void *)meta;
+    g->nodeImpl = NULL;
+    g->edgeImpl = NULL;
+    g->capImpl = NULL;
+    g->flowImpl = NULL;
+
+    struct tileheader_t header;
+    memset(&header, 0, sizeof(struct tileheader_t));
+    memcpy(header.magic, tileMagic, sizeof(tileMagic));
+    meta->degree = dimcount;
+    meta->tileside = (g->config->tileside > 0) ? g->config->tileside : MMAP_DEFAULT_TILESIDE;
+    meta->nodelen = 1;
+    meta->tilenodes = 1;
+    meta->tilecount = 1;
+    for (size_t d = 0; d < dimcount; d++) {
+        size_t dim = g->dims->dimarr[d];
+        if (dim == 0) return 0;
+        meta->nodelen *= dim;
+        meta->tilenodes *= meta->tileside;
+        meta->tilesper[d] = (dim + meta->tileside - 1) / meta->tileside;
+        meta->tilecount *= meta->tilesper[d];
+        header.dims[d] = dim;
+    }
+    meta->edgelen = meta->nodelen;
+    header.directed = ((g->gtype & DIRECTED) == DIRECTED);
+    header.dimcount = dimcount;
+    header.tileside = meta->tileside;
+    header.degree = meta->degree;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    meta->tilebytes = roundToPage(meta->tilenodes * meta->degree * (sizeof(size_t) + 2 * sizeof(double)), page);
+
+    struct tilecache_t *c = (struct tilecache_t *)graphAlloc(&g->allocator, sizeof(struct tilecache_t));
+    if (c == NULL) return 0;
+    memset(c, 0, sizeof(struct tilecache_t));
+    c->fd = -1;
+    meta->cache = c;
+#ifdef GRAPHDATA_PTHREADS
+    pthread_mutex_init(&c->lock, NULL);
+#endif
+    c->headerbytes = roundToPage(sizeof(struct tileheader_t), page);
+    c->dimcount = dimcount;
+    memcpy(c->dims, g->dims->dimarr, dimcount * sizeof(size_t));
+    c->slotcount = (g->config->tilecache > 0) ? g->config->tilecache : MMAP_DEFAULT_TILES;
+    if (c->slotcount > meta->tilecount) c->slotcount = meta->tilecount;
+    c->head = TILE_NONE;
+    c->tail = TILE_NONE;
+    c->slots = (struct tileslot_t *)graphAlloc(&g->allocator, c->slotcount * sizeof(struct tileslot_t));
+    c->tileslot = (size_t *)graphAlloc(&g->allocator, meta->tilecount * sizeof(size_t));
+    if (c->slots == NULL || c->tileslot == NULL) return 0;
+    for (size_t s = 0; s < c->slotcount; s++) {
+        c->slots[s].base = NULL;
+        c->slots[s].tile = TILE_NONE;
+        c->slots[s].prev = TILE_NONE;
+        c->slots[s].next = TILE_NONE;
+    }
+    for (size_t t = 0; t < meta->tilecount; t++) c->tileslot[t] = TILE_NONE;
+    return openTileFile(c, g->config->mmappath, &header, c->headerbytes + meta->tilecount * meta->tilebytes);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Unmap every tile and close the file of a SHARED_MMAP graph; the file itself is kept.
+ * @param g graph_t with tiled structures to be released
+ * @return 1 if successful; otherwise, 0.
+ */
+int mmapGraphFree(struct graph_t *g) {
+    struct mmapdata_t *meta = mmapMeta(g);
+    if (meta == NULL) return 0;
+    freeTileCache(g, meta);
+    graphFree(&g->allocator, meta, sizeof(struct mmapdata_t));
+    g->metaImpl = NULL;
+    return 1;
+}
+
+/**
+ * @brief Write the mapped tiles of a SHARED_MMAP graph back to its file, and wait for the writes to finish.
+ * @param g SHARED_MMAP graph
+ * @return 1 if successful; otherwise, 0.
+ */
+int mmapGraphSync(struct graph_t *g) {
+    struct mmapdata_t *meta = mmapMeta(g);
+    if (meta == NULL) return 0;
+    int retval = 1;
+#ifdef __unix__
+    mmapCacheLock(g);
+    for (size_t s = 0; s < meta->cache->used; s++) {
+        const struct tileslot_t *slot = meta->cache->slots + s;
+        if (slot->base != NULL && msync(slot->base, meta->tilebytes, MS_SYNC) != 0) retval = 0;
+    }
+    mmapCacheUnlock(g);
+#endif
+    return retval;
+}
+
+/**
+ * @brief Bytes of the file currently mapped by a SHARED_MMAP graph
+ * @param g SHARED_MMAP graph
+ * @return Mapped size in bytes; 0 for other graphs.
+ */
+size_t mmapMappedBytes(const struct graph_t *g) {
+    const struct mmapdata_t *meta = mmapMeta(g);
+    if (meta == NULL || meta->cache == NULL) return 0;
+    size_t mapped = 0;
+    for (size_t s = 0; s < meta->cache->used; s++) {
+        if (meta->cache->slots[s].base != NULL) mapped += meta->tilebytes;
+    }
+    return mapped;
+}
+
+/**
+ * @brief Bytes allocated for the tile cache tables of a SHARED_MMAP graph
+ * @param g SHARED_MMAP graph
+ * @return Size in bytes; 0 for other graphs.
+ */
+size_t mmapCacheBytes(const struct graph_t *g) {
+    const struct mmapdata_t *meta = mmapMeta(g);
+    if (meta == NULL || meta->cache == NULL) return 0;
+    return sizeof(struct tilecache_t) + meta->cache->slotcount * sizeof(struct tileslot_t)
+           + meta->tilecount * sizeof(size_t);
+}
@@ -1,3 +1,345 @@
-//
-// Created by david on 10/21/23.
-//
+/**
+ * @brief These are the implementations of the graphops_t operations for tiled, file-backed (SHARED_MMAP) graphs.
+ *
+ * They follow the ARRAY operations, with each node's slots found in its mapped tile.  Every operation works within the
+ * tile of a single node, under the tile cache lock.
+ */
+#include <impl/sharedmmapgraph.h>
+#include <impl/sharedmmapops.h>
+#include <util/graphcomp.h>
+#include <util/graphstats.h>
+#include <util/memops.h>
+#include <stdlib.h>
+
+/**
+ * @brief Find the slot of an edge, in the tile of its starting node.  The tile cache lock must be held.
+ *
+ * For UNDIRECTED graphs, the edge is looked up from the smaller node.
+ *
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end
+ * @param slots Set to the slots of the owning node
+ * @param offset Set to the slot of the edge
+ * @param g Graph structure in question
+ * @return 1 if the edge was found; otherwise, 0.
+ */
+static int findEdgeSlot(const size_t *uid, const size_t *vid, struct mmapslots_t *slots, size_t *offset,
+                        const struct graph_t *g) {
+    const size_t *u = uid;
+    const size_t *v = vid;
+    if ((g->gtype & DIRECTED) != DIRECTED) {
+        u = minNode((size_t *)uid, (size_t *)vid);
+        v = maxNode((size_t *)uid, (size_t *)vid);
+    }
+    if (!mmapNodeSlots(g, *u, slots)) return 0;
+    const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+    size_t i;
+    for (i = 0; i < meta->degree; i++) {
+        if (slots->nodes[i] == *v) {
+            *offset = i;
+            GRAPHSTATS_PROBE(g, i + 1);
+            return 1;
+        }
+    }
+    GRAPHSTATS_PROBE(g, meta->degree);
+    return 0;
+}
+
+/**
+ * @brief Which of the edge values an update works on
+ */
+enum EDGEVALUE {
+    EDGE_CAP,
+    EDGE_FLOW
+};
+
+/**
+ * @brief Read, set or adjust one value of an edge
+ * @param uid Identifier of the edge start
+ * @param vid Identifier of the edge end
+ * @param which Capacity or flow
+ * @param val Value to be set or added; set to the value when reading
+ * @param mode 0 to read, 1 to set, 2 to add, 3 to add atomically
+ * @param g Graph structure in question
+ * @return 1 if the edge was found; otherwise, 0.
+ */
+static int edgeValue(const size_t *uid, const size_t *vid, enum EDGEVALUE which, double *val, int mode,
+                     const struct graph_t *g) {
+    int retval = 0;
+    struct mmapslots_t slots;
+    size_t offset = 0;
+    mmapCacheLock(g);
+    if (findEdgeSlot(uid, vid, &slots, &offset, g)) {
+        double *ptr = ((which == EDGE_CAP) ? slots.cap : slots.flow) + offset;
+        switch (mode) {
+            case 0:
+                *val = *ptr;
+                break;
+            case 1:
+                *ptr = *val;
+                break;
+            case 2:
+                *ptr += *val;
+                break;
+            default:
+                atomicAddDouble(ptr, *val, g->config != NULL ? g->config->memorder : MEMORDER_SEQCST);
+                break;
+        }
+        retval = 1;
+    }
+    mmapCacheUnlock(g);
+    return retval;
+}
+
+//Read functions to extract data
+/**
+ * @brief Implementation for getting the node count;
+ * @param g Graph structure in question
+ * @return Count of nodes
+ */
+size_t mmapNodeCount(struct graph_t *g) {
+    return ((struct mmapdata_t *)g->metaImpl)->nodelen;
+}
+
+/**
+ * @brief Implementation to extract count of edges
+ * @param g Graph structure in question
+ * @return Count of edges
+ */
+size_t mmapEdgeCount(struct graph_t *g) {
+    return ((struct mmapdata_t *)g->metaImpl)->edgelen;
+}
+
+/**
+ * @brief Implementation to retrieve a node structure reference.
+ *
+ * @param nodeid Identifier of the node to be retrieved
+ * @param g Graph structure in question
+ * @return pointer to the node structure, if found; otherwise, pointer to NULL
+ */
+struct node_t * mmapGetNode(const size_t *nodeid, const struct graph_t *g) {
+    struct node_t *node = NULL;
+    const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+    if (meta != NULL && *nodeid < meta->nodelen) {
+        node = (struct node_t *)malloc(sizeof(struct node_t));
+        if (node != NULL) {
+            node->nodeid = *nodeid;
+            node->attrs = NULL;
+            node->edges = NULL;
+            node->next = NULL;
+            node->prev = NULL;
+        }
+    }
+    return node;
+}
+
+/**
+ * @brief Implementation to retrieve a edge structure reference.
+ *
+ * @param u nodeid of the starting edge.
+ * @param v nodeid of the ending edge.
+ * @param g Graph structure in question
+ * @return pointer to the edge structure, if found; otherwise, pointer to NULL.
+ */
+struct edge_t * mmapGetEdge(const size_t *u, const size_t *v, const struct graph_t *g) {
+    struct edge_t *edge = NULL;
+    struct mmapslots_t slots;
+    size_t offset = 0;
+    mmapCacheLock(g);
+    if (mmapNodeSlots(g, *u, &slots)) {
+        const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+        for (offset = 0; offset < meta->degree && slots.nodes[offset] != *v; offset++);
+        GRAPHSTATS_PROBE(g, offset < meta->degree ? offset + 1 : meta->degree);
+        if (offset < meta->degree) {
+            edge = (struct edge_t *)malloc(sizeof(struct edge_t));
+            if (edge != NULL) {
+                edge->u = *u;
+                edge->v = *v;
+                edge->cap = slots.cap[offset];
+                edge->flow = slots.flow[offset];
+                edge->attrs = NULL;
+                edge->prev = NULL;
+                edge->next = NULL;
+            }
+        }
+    }
+    mmapCacheUnlock(g);
+    return edge;
+}
+
+/**
+ * @brief Implementation to retrieve linked-list of nodes that are currently defined as neighbors to the given node.
+ *
+ * @param nodeid Identifier of the node in question
+ * @param g Graph structure in question
+ * @return linked-list of node references, if found; otherwise, pointer to NULL.
+ */
+struct node_t * mmapGetNeighbors(const size_t *nodeid, const struct graph_t *g) {
+    struct node_t *nlist = NULL;
+    struct mmapslots_t slots;
+    mmapCacheLock(g);
+    if (mmapNodeSlots(g, *nodeid, &slots)) {
+        const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+        struct node_t *curr = NULL;
+        for (size_t offset = 0; offset < meta->degree; offset++) {
+            if (slots.nodes[offset] == 0) continue;
+            struct node_t *neighbor = malloc(sizeof(struct node_t));
+            if (neighbor == NULL) continue;
+            neighbor->prev = curr;
+            neighbor->next = NULL;
+            neighbor->nodeid = slots.nodes[offset];
+            neighbor->attrs = NULL;
+            neighbor->edges = NULL;
+            if (curr != NULL) curr->next = neighbor;
+            curr = neighbor;
+            if (nlist == NULL) nlist = curr;
+        }
+    }
+    mmapCacheUnlock(g);
+    return nlist;
+}
+
+/**
+ * @brief Implementation to retrieve linked-list of edges from a given node.
+ * @param nodeid Identifier of the node in question
+ * @param g Graph structure in question
+ * @return linked-list of edges starting from the given node, if found; otherwise, pointer to NULL.
+ */
+struct edge_t * mmapGetEdges(const size_t *nodeid, const struct graph_t *g) {
+    struct edge_t *elist = NULL;
+    struct mmapslots_t slots;
+    mmapCacheLock(g);
+    if (mmapNodeSlots(g, *nodeid, &slots)) {
+        const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+        struct edge_t *curr = NULL;
+        for (size_t offset = 0; offset < meta->degree; offset++) {
+            if (slots.nodes[offset] == 0) continue;
+            struct edge_t *edge = malloc(sizeof(struct edge_t));
+            if (edge == NULL) continue;
+            edge->prev = curr;
+            edge->next = NULL;
+            edge->u = *nodeid;
+            edge->v = slots.nodes[offset];
+            edge->cap = slots.cap[offset];
+            edge->flow = slots.flow[offset];
+            edge->attrs = NULL;
+            if (curr != NULL) curr->next = edge;
+            curr = edge;
+            if (elist == NULL) elist = curr;
+        }
+    }
+    mmapCacheUnlock(g);
+    return elist;
+}
+
+int mmapGetCapacity(const size_t *uid, const size_t *vid, double *cap, const struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_CAP, cap, 0, g);
+}
+
+int mmapGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_FLOW, flow, 0, g);
+}
+
+//Write functions to modify graph
+int mmapAddNode(const size_t *nodeid, struct graph_t *g) {
+    return 0;
+}
+
+int mmapRemoveNode(const size_t *nodeid, struct graph_t *g) {
+    return 0;
+}
+
+/**
+ * @brief Implementation to add an edge to a given graph.
+ *
+ * @param uid identifer for start of edge
+ * @param vid identifier for end of edge
+ * @param cap capacity value to be assigned
+ * @param g graph structure in question
+ * @return 0 if there was an error; 1 if the edge was successfully added.
+ */
+int mmapAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_t *g) {
+    int added = 0;
+    const size_t *u = uid;
+    const size_t *v = vid;
+    if ((g->gtype & DIRECTED) != DIRECTED) {
+        u = minNode((size_t *)uid, (size_t *)vid);
+        v = maxNode((size_t *)uid, (size_t *)vid);
+    }
+    //a slot holding node 0 reads as empty
+    if (*v == 0) return 0;
+    struct mmapslots_t slots;
+    mmapCacheLock(g);
+    if (mmapNodeSlots(g, *u, &slots)) {
+        const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+        for (size_t offset = 0; !added && offset < meta->degree; offset++) {
+            if (slots.nodes[offset] == 0) {
+                slots.nodes[offset] = *v;
+                slots.cap[offset] = *cap;
+                slots.flow[offset] = 0.0;
+                added = 1;
+            }
+        }
+    }
+    mmapCacheUnlock(g);
+    return added;
+}
+
+/**
+ * @brief Implementation to remove an edge from the given graph.
+ *
+ * @param uid Identifier for the edge start
+ * @param vid Identifier for the edge end.
+ * @param g Graph structure in question
+ * @return 0 if there was an error (e.g. the edge was not found); otherwise, 1 if the edge was removed.
+ */
+int mmapRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
+    int removed = 0;
+    struct mmapslots_t slots;
+    size_t offset = 0;
+    mmapCacheLock(g);
+    if (findEdgeSlot(uid, vid, &slots, &offset, g)) {
+        slots.nodes[offset] = 0;
+        slots.cap[offset] = 0.0;
+        slots.flow[offset] = 0.0;
+        removed = 1;
+    }
+    mmapCacheUnlock(g);
+    return removed;
+}
+
+int mmapSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_CAP, (double *)cap, 1, g);
+}
+
+int mmapAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_CAP, (double *)cap, 2, g);
+}
+
+int mmapSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_FLOW, (double *)flow, 1, g);
+}
+
+int mmapAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_FLOW, (double *)flow, 2, g);
+}
+
+int mmapAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_CAP, (double *)cap, 3, g);
+}
+
+int mmapAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    return edgeValue(uid, vid, EDGE_FLOW, (double *)flow, 3, g);
+}
+
+/**
+ * @brief Implementation to "reset" the graph: the capacities and flows of every tile are set to 0.0 again.
+ *
+ * @param g Graph structure to be zeroed
+ * @param args Ignored
+ * @param callback Ignored
+ * @return 0 if there was an error during the reset; 1 if the reset completed;
+ */
+int mmapResetGraph(struct graph_t *g, void *args, void (*callback)(void)) {
+    return mmapZeroValues(g);
+}
@@ -0,0 +1,300 @@
+/**
+ * @brief Automatic choice between the LINKED and HASHED implementations.
+ */
+
+#include <util/adaptive.h>
+#include <util/crudops.h>
+#include <util/snapshot.h>
+#include <graphInit.h>
+#include <impl/hashgraph.h>
+#include <string.h>
+
+/**
+ * @brief Implementation selection state of a graph
+ */
+struct adaptstate_t {
+    /**
+     * @brief Unwrapped operations of the LINKED implementation
+     */
+    struct graphops_t linked;
+    /**
+     * @brief Unwrapped operations of the HASHED implementation
+     */
+    struct graphops_t hashed;
+    /**
+     * @brief Operations of the current implementation; swapped with release ordering after a move
+     */
+    const struct graphops_t *current;
+    /**
+     * @brief Node count, kept up to date by the dispatchers
+     */
+    size_t nodes;
+    /**
+     * @brief Lookups made since the last move (counted while LINKED only)
+     */
+    size_t lookups;
+    /**
+     * @brief Node count at which the graph moves to HASHED
+     */
+    size_t threshold;
+    /**
+     * @brief Number of moves made
+     */
+    size_t migrations;
+};
+
+/**
+ * @brief Operations of the current implementation
+ */
+static const struct graphops_t * currentOps(const struct adaptstate_t *s) {
+    return __atomic_load_n(&s->current, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Current operations, counting the call as a lookup if the graph is LINKED
+ *
+ * Only LINKED lookups are counted, so HASHED graphs do not share a counter between threads.
+ */
+static const struct graphops_t * lookupOps(const struct graph_t *g) {
+    struct adaptstate_t *s = g->adapt;
+    const struct graphops_t *ops = currentOps(s);
+    if (ops == &s->linked) __atomic_fetch_add(&s->lookups, 1, __ATOMIC_RELAXED);
+    return ops;
+}
+
+/**
+ * @brief Move the graph if its size or lookups call for it
+ *
+ * Only called from operations that have the graph to themselves.
+ *
+ * @param g Graph in question
+ * @param shrunk Nonzero after a node removal, the only time a HASHED graph can become small enough to move back
+ */
+static void adaptCheck(struct graph_t *g, int shrunk) {
+    struct adaptstate_t *s = g->adapt;
+    if (currentOps(s) == &s->linked) {
+        size_t lookups = __atomic_load_n(&s->lookups, __ATOMIC_RELAXED);
+        if (s->nodes >= s->threshold || (s->nodes >= ADAPT_MIN_NODES && lookups >= ADAPT_LOOKUP_FACTOR * s->nodes)) {
+            migrateGraph(g, HASHED);
+        }
+    } else if (shrunk && 4 * s->nodes <= s->threshold) {
+        migrateGraph(g, LINKED);
+    }
+}
+
+/*
+ * Dispatchers, one per graphops_t entry.  Each forwards to the current implementation.
+ */
+
+static size_t adaptNodeCount(struct graph_t *g) {
+    return currentOps(g->adapt)->nodeCount(g);
+}
+
+static size_t adaptEdgeCount(struct graph_t *g) {
+    return currentOps(g->adapt)->edgeCount(g);
+}
+
+static struct node_t * adaptGetNode(const size_t *nodeid, const struct graph_t *g) {
+    return lookupOps(g)->getNode(nodeid, g);
+}
+
+static struct edge_t * adaptGetEdge(const size_t *u, const size_t *v, const struct graph_t *g) {
+    return lookupOps(g)->getEdge(u, v, g);
+}
+
+static struct node_t * adaptGetNeighbors(const size_t *nodeid, const struct graph_t *g) {
+    return lookupOps(g)->getNeighbors(nodeid, g);
+}
+
+static struct edge_t * adaptGetEdges(const size_t *nodeid, const struct graph_t *g) {
+    return lookupOps(g)->getEdges(nodeid, g);
+}
+
+static int adaptGetCapacity(const size_t *uid, const size_t *vid, double *cap, const struct graph_t *g) {
+    return lookupOps(g)->getCapacity(uid, vid, cap, g);
+}
+
+static int adaptGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct graph_t *g) {
+    return lookupOps(g)->getFlow(uid, vid, flow, g);
+}
+
+static int adaptAddNode(const size_t *nodeid, struct graph_t *g) {
+    int retval = currentOps(g->adapt)->addNode(nodeid, g);
+    if (retval) {
+        g->adapt->nodes++;
+        adaptCheck(g, 0);
+    }
+    return retval;
+}
+
+static int adaptRemoveNode(const size_t *nodeid, struct graph_t *g) {
+    int retval = currentOps(g->adapt)->removeNode(nodeid, g);
+    if (retval) {
+        g->adapt->nodes--;
+        adaptCheck(g, 1);
+    }
+    return retval;
+}
+
+static int adaptAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_t *g) {
+    int retval = lookupOps(g)->addEdge(uid, vid, cap, g);
+    if (g->sync == NULL) adaptCheck(g, 0);
+    return retval;
+}
+
+static int adaptRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
+    int retval = lookupOps(g)->removeEdge(uid, vid, g);
+    if (g->sync == NULL) adaptCheck(g, 0);
+    return retval;
+}
+
+static int adaptSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    return lookupOps(g)->setCapacity(uid, vid, cap, g);
+}
+
+static int adaptAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    return lookupOps(g)->addCapacity(uid, vid, cap, g);
+}
+
+static int adaptSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    return lookupOps(g)->setFlow(uid, vid, flow, g);
+}
+
+static int adaptAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    return lookupOps(g)->addFlow(uid, vid, flow, g);
+}
+
+static int adaptAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    return lookupOps(g)->atomicAddCapacity(uid, vid, cap, g);
+}
+
+static int adaptAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    return lookupOps(g)->atomicAddFlow(uid, vid, flow, g);
+}
+
+static int adaptResetGraph(struct graph_t *g, void *args, void (*callback)(void)) {
+    return currentOps(g->adapt)->resetGraph(g, args, callback);
+}
+
+/**
+ * @brief Create the implementation selection state of a graph, according to its configuration.
+ *
+ * @param g Graph in question
+ * @return 1 if successful (or nothing was needed); 0 if the state could not be created.
+ */
+int graphAdaptInit(struct graph_t *g) {
+    if (g == NULL) return 0;
+    if (g->adapt != NULL || g->config == NULL || g->config->adapt != ADAPT_AUTO) return 1;
+    if ((g->gtype & (LINKED | HASHED)) == 0) return 1;
+    struct adaptstate_t *s = (struct adaptstate_t *)graphAlloc(&g->allocator, sizeof(struct adaptstate_t));
+    if (s == NULL) return 0;
+    memset(s, 0, sizeof(struct adaptstate_t));
+    setImplementationOps(&s->linked, LINKED);
+    setImplementationOps(&s->hashed, HASHED);
+    s->linked.g = g;
+    s->hashed.g = g;
+    s->threshold = (g->config->adaptnodes > 0) ? g->config->adaptnodes : ADAPT_DEFAULT_NODES;
+    s->current = ((g->gtype & HASHED) == HASHED) ? &s->hashed : &s->linked;
+    for (const struct node_t *n = (const struct node_t *)g->nodeImpl; n != NULL; n = n->next) s->nodes++;
+    g->adapt = s;
+    return 1;
+}
+
+/**
+ * @brief Replace the operations of a graph with dispatchers to its current implementation.
+ *
+ * @param gops Operations structure for a graph with selection state
+ * @return 1 if successful; 0 if the graph has no selection state.
+ */
+int graphAdaptWrap(struct graphops_t *gops) {
+    int retval = 0;
+    if (gops != NULL && gops->g != NULL && gops->g->adapt != NULL) {
+        gops->nodeCount = adaptNodeCount;
+        gops->edgeCount = adaptEdgeCount;
+        gops->getNode = adaptGetNode;
+        gops->getEdge = adaptGetEdge;
+        gops->getNeighbors = adaptGetNeighbors;
+        gops->getEdges = adaptGetEdges;
+        gops->getCapacity = adaptGetCapacity;
+        gops->getFlow = adaptGetFlow;
+        gops->addNode = adaptAddNode;
+        gops->removeNode = adaptRemoveNode;
+        gops->addEdge = adaptAddEdge;
+        gops->removeEdge = adaptRemoveEdge;
+        gops->setCapacity = adaptSetCapacity;
+        gops->addCapacity = adaptAddCapacity;
+        gops->setFlow = adaptSetFlow;
+        gops->addFlow = adaptAddFlow;
+        gops->atomicAddCapacity = adaptAtomicAddCapacity;
+        gops->atomicAddFlow = adaptAtomicAddFlow;
+        gops->resetGraph = adaptResetGraph;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Move a graph between the LINKED and HASHED implementations.
+ *
+ * The node index is built (or dropped) before the graph type and dispatch table change, so an operation that loads
+ * the new table always finds the structures it expects.
+ *
+ * @param g Graph to be moved
+ * @param imptype LINKED or HASHED
+ * @return 1 if the graph now has the given implementation; 0 if it cannot be moved.
+ */
+int migrateGraph(struct graph_t *g, enum GRAPHDOMAIN imptype) {
+    //views keep the implementation they were taken with; the live lists they share are not touched by a move
+    if (g == NULL || isSnapshot(g)) return 0;
+    if (imptype != LINKED && imptype != HASHED) return 0;
+    enum GRAPHDOMAIN current = g->gtype & (LINKED | HASHED);
+    if (current == 0) return 0;
+    if (current == imptype) return 1;
+    if (imptype == HASHED) {
+        if (!hashGraphIndex(g)) return 0;
+    } else {
+        hashGraphDropIndex(g);
+    }
+    g->gtype = (g->gtype & ~(LINKED | HASHED)) | imptype;
+    struct adaptstate_t *s = g->adapt;
+    if (s != NULL) {
+        __atomic_store_n(&s->lookups, 0, __ATOMIC_RELAXED);
+        s->migrations++;
+        __atomic_store_n(&s->current, (imptype == HASHED) ? &s->hashed : &s->linked, __ATOMIC_RELEASE);
+    }
+    return 1;
+}
+
+/**
+ * @brief Number of moves an ADAPT_AUTO graph has made between implementations
+ * @param g Graph in question
+ * @return Count of moves; 0 for graphs without selection state.
+ */
+size_t getGraphMigrations(const struct graph_t *g) {
+    return (g != NULL && g->adapt != NULL) ? g->adapt->migrations : 0;
+}
+
+/**
+ * @brief Clear out the implementation selection state of a graph
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if there was no state.
+ */
+int destroyGraphAdapt(struct graph_t *g) {
+    int retval = 0;
+    if (g != NULL && g->adapt != NULL) {
+        graphFree(&g->allocator, g->adapt, sizeof(struct adaptstate_t));
+        g->adapt = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Memory held by the implementation selection state of a graph
+ * @param g Graph in question
+ * @return Size in bytes; 0 for graphs without selection state.
+ */
+size_t graphAdaptMemory(const struct graph_t *g) {
+    return (g != NULL && g->adapt != NULL) ? sizeof(struct adaptstate_t) : 0;
+}
@@ -0,0 +1,335 @@
+/**
+ * @brief Columnar attribute storage for graphs.
+ */
+
+#include <util/attrstore.h>
+#include <util/crudops.h>
+#include <util/interntable.h>
+#include <impl/arraygraph.h>
+#include <impl/sharedmmapgraph.h>
+#include <string.h>
+
+/**
+ * @brief Initial column count for a new store
+ */
+#define ATTR_INIT_COLS 8
+/**
+ * @brief Initial length of a growable column
+ */
+#define ATTR_INIT_LEN 64
+
+/**
+ * @brief Fixed column length for the graph, if the graph has one
+ * @param g Graph in question
+ * @param domain Elements the column is indexed by
+ * @return Number of nodes (or edge slots) of an ARRAY graph; otherwise, 0.
+ */
+static size_t fixedLength(const struct graph_t *g, enum ATTRDOMAIN domain) {
+    size_t len = 0;
+    if (isMmapGraph(g)) {
+        const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+        len = (domain == ATTR_EDGE) ? meta->nodelen * meta->degree : meta->nodelen;
+    } else if ((g->gtype & ARRAY) == ARRAY && g->metaImpl != NULL) {
+        const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+        len = (domain == ATTR_EDGE) ? meta->nodelen * meta->degree : meta->nodelen;
+    }
+    return len;
+}
+
+/**
+ * @brief Retrieve the column for the given id
+ * @param g Graph in question
+ * @param colid Column id
+ * @return Pointer to the column, or NULL if the id is not valid
+ */
+static struct attrcolumn_t * getColumn(const struct graph_t *g, size_t colid) {
+    if (g == NULL || g->attrs == NULL || colid >= g->attrs->colcount) return NULL;
+    return g->attrs->cols + colid;
+}
+
+/**
+ * @brief Resize a column to the given length, filling new entries with the column fill value
+ * @param store Store owning the column
+ * @param col Column to be resized
+ * @param len New length
+ * @return 1 if successful; otherwise, 0.
+ */
+static int resizeColumn(const struct attrstore_t *store, struct attrcolumn_t *col, size_t len) {
+    if (len <= col->len) return 1;
+    if (len > ((size_t)-1) / sizeof(double)) return 0;
+    double *nvals = (double *)graphRealloc(store->allocator, col->vals, col->len * sizeof(double), len * sizeof(double));
+    if (nvals == NULL) return 0;
+    for (size_t i = col->len; i < len; i++) nvals[i] = col->fill;
+    col->vals = nvals;
+    col->len = len;
+    return 1;
+}
+
+/**
+ * @brief Find the column for the given feature id and domain
+ * @param store Attribute store
+ * @param featureid Feature id
+ * @param domain Elements the column is indexed by
+ * @return Column id, if found; otherwise, ATTR_NONE.
+ */
+static size_t findColumn(const struct attrstore_t *store, size_t featureid, enum ATTRDOMAIN domain) {
+    if (featureid == INTERN_NONE) return ATTR_NONE;
+    for (size_t c = 0; c < store->colcount; c++) {
+        if (store->cols[c].featureid == featureid && store->cols[c].domain == domain) return c;
+    }
+    return ATTR_NONE;
+}
+
+/**
+ * @brief Create the attribute store for the graph, if not already present
+ * @param g Graph in question
+ * @return Pointer to the store, or NULL on failure
+ */
+static struct attrstore_t * requireStore(struct graph_t *g) {
+    if (g->attrs == NULL) {
+        struct attrstore_t *store = (struct attrstore_t *)graphAlloc(&g->allocator, sizeof(struct attrstore_t));
+        if (store != NULL) {
+            store->allocator = &g->allocator;
+            store->colcount = 0;
+            store->colcap = ATTR_INIT_COLS;
+            store->cols = (struct attrcolumn_t *)graphAlloc(store->allocator,
+                                                            ATTR_INIT_COLS * sizeof(struct attrcolumn_t));
+            if (store->cols == NULL) {
+                graphFree(&g->allocator, store, sizeof(struct attrstore_t));
+                store = NULL;
+            }
+        }
+        g->attrs = store;
+    }
+    return g->attrs;
+}
+
+/**
+ * @brief Find an existing column with the given name and domain.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @return Column id, if found; otherwise, ATTR_NONE.
+ */
+size_t attrFindColumn(const struct graph_t *g, const char *name, enum ATTRDOMAIN domain) {
+    if (g == NULL || g->attrs == NULL) return ATTR_NONE;
+    return findColumn(g->attrs, internLookup(g->features, name), domain);
+}
+
+/**
+ * @brief Find the column with the given name and domain, creating it if necessary.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @param fill Value of entries that have not been set
+ * @return Column id, if successful; otherwise, ATTR_NONE.
+ */
+size_t attrColumnId(struct graph_t *g, const char *name, enum ATTRDOMAIN domain, double fill) {
+    if (g == NULL || name == NULL) return ATTR_NONE;
+    return attrFeatureColumn(g, graphFeatureId(g, name), domain, fill);
+}
+
+/**
+ * @brief Find the column for the given feature id and domain, creating it if necessary.
+ *
+ * @param g Graph the column belongs to
+ * @param featureid Feature id from graphFeatureId()
+ * @param domain Elements the column is indexed by
+ * @param fill Value of entries that have not been set
+ * @return Column id, if successful; otherwise, ATTR_NONE.
+ */
+size_t attrFeatureColumn(struct graph_t *g, size_t featureid, enum ATTRDOMAIN domain, double fill) {
+    if (g == NULL || internedName(g->features, featureid) == NULL) return ATTR_NONE;
+    struct attrstore_t *store = requireStore(g);
+    if (store == NULL) return ATTR_NONE;
+    size_t colid = findColumn(store, featureid, domain);
+    if (colid != ATTR_NONE) return colid;
+
+    if (store->colcount == store->colcap) {
+        struct attrcolumn_t *ncols = (struct attrcolumn_t *)graphRealloc(store->allocator, store->cols,
+                store->colcap * sizeof(struct attrcolumn_t), 2 * store->colcap * sizeof(struct attrcolumn_t));
+        if (ncols == NULL) return ATTR_NONE;
+        store->cols = ncols;
+        store->colcap *= 2;
+    }
+    struct attrcolumn_t *col = store->cols + store->colcount;
+    col->featureid = featureid;
+    col->domain = domain;
+    col->fill = fill;
+    col->len = 0;
+    col->vals = NULL;
+    size_t len = fixedLength(g, domain);
+    if (!resizeColumn(store, col, len > 0 ? len : ATTR_INIT_LEN)) return ATTR_NONE;
+    return store->colcount++;
+}
+
+/**
+ * @brief Set a single attribute value.
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param idx Node id or edge index
+ * @param val Value to be stored
+ * @return 1 if successful; 0 if the column or index is invalid, or the column could not grow.
+ */
+int setAttr(struct graph_t *g, size_t colid, size_t idx, double val) {
+    struct attrcolumn_t *col = getColumn(g, colid);
+    if (col == NULL) return 0;
+    if (idx >= col->len) {
+        //ARRAY columns are created at full length, so only growable columns get here
+        if (fixedLength(g, col->domain) > 0) return 0;
+        if (idx == (size_t)-1) return 0;
+        size_t nlen = col->len;
+        while (nlen <= idx) {
+            //past half the range doubling would wrap; ask for just enough, and let resizeColumn() refuse it
+            if (nlen > ((size_t)-1) / 2) {
+                nlen = idx + 1;
+                break;
+            }
+            nlen *= 2;
+        }
+        if (!resizeColumn(g->attrs, col, nlen)) return 0;
+    }
+    col->vals[idx] = val;
+    return 1;
+}
+
+/**
+ * @brief Retrieve a single attribute value.
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param idx Node id or edge index
+ * @param val Set to the stored value, or the column fill value if the entry has never been set.
+ * @return 1 if successful; 0 if the column id is invalid.
+ */
+int getAttr(const struct graph_t *g, size_t colid, size_t idx, double *val) {
+    const struct attrcolumn_t *col = getColumn(g, colid);
+    if (col == NULL) return 0;
+    *val = (idx < col->len) ? col->vals[idx] : col->fill;
+    return 1;
+}
+
+/**
+ * @brief Set a single attribute value by column name, creating the column (filled with 0.0) if necessary.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @param idx Node id or edge index
+ * @param val Value to be stored
+ * @return 1 if successful; otherwise, 0.
+ */
+int setAttrByName(struct graph_t *g, const char *name, enum ATTRDOMAIN domain, size_t idx, double val) {
+    return setAttr(g, attrColumnId(g, name, domain, 0.0), idx, val);
+}
+
+/**
+ * @brief Retrieve a single attribute value by column name.
+ *
+ * @param g Graph the column belongs to
+ * @param name Column name
+ * @param domain Elements the column is indexed by
+ * @param idx Node id or edge index
+ * @param val Set to the stored value
+ * @return 1 if successful; 0 if the column does not exist.
+ */
+int getAttrByName(const struct graph_t *g, const char *name, enum ATTRDOMAIN domain, size_t idx, double *val) {
+    return getAttr(g, attrFindColumn(g, name, domain), idx, val);
+}
+
+/**
+ * @brief Direct access to a dense column, for bulk reads and writes.
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param len Set to the number of entries in the column
+ * @return Pointer to the column values, or NULL if the column id is invalid or the column is empty.
+ */
+double * attrColumn(struct graph_t *g, size_t colid, size_t *len) {
+    struct attrcolumn_t *col = getColumn(g, colid);
+    if (col == NULL) {
+        *len = 0;
+        return NULL;
+    }
+    *len = col->len;
+    return col->vals;
+}
+
+/**
+ * @brief Grow a column to hold at least len entries
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param len Number of entries required
+ * @return 1 if successful; otherwise, 0.
+ */
+int attrColumnReserve(struct graph_t *g, size_t colid, size_t len) {
+    struct attrcolumn_t *col = getColumn(g, colid);
+    if (col == NULL) return 0;
+    if (len > col->len && fixedLength(g, col->domain) > 0) return 0;
+    return resizeColumn(g->attrs, col, len);
+}
+
+/**
+ * @brief Set every entry of a column to the given value
+ *
+ * @param g Graph the column belongs to
+ * @param colid Column id from attrColumnId()
+ * @param val Value to be stored
+ * @return 1 if successful; 0 if the column id is invalid.
+ */
+int attrColumnFill(struct graph_t *g, size_t colid, double val) {
+    struct attrcolumn_t *col = getColumn(g, colid);
+    if (col == NULL) return 0;
+    double *vals = col->vals;
+    for (size_t i = 0; i < col->len; i++) vals[i] = val;
+    return 1;
+}
+
+/**
+ * @brief Clear out the attribute store of a graph and all of its columns
+ *
+ * @param g Graph owning the store
+ * @return 1 if successful; 0 if there was no store.
+ */
+int destroyAttrStore(struct graph_t *g) {
+    int retval = 0;
+    if (g != NULL && g->attrs != NULL) {
+        struct attrstore_t *store = g->attrs;
+        const struct graphallocator_t *a = store->allocator;
+        for (size_t c = 0; c < store->colcount; c++) {
+            struct attrcolumn_t *col = store->cols + c;
+            graphFree(a, col->vals, col->len * sizeof(double));
+        }
+        graphFree(a, store->cols, store->colcap * sizeof(struct attrcolumn_t));
+        graphFree(a, store, sizeof(struct attrstore_t));
+        g->attrs = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Copy every attribute column of a graph into a clone
+ *
+ * @param g Original graph
+ * @param ng Clone, without an attribute store
+ * @return 1 if successful (including when there are no columns); otherwise, 0.
+ */
+int cloneAttrStore(const struct graph_t *g, struct graph_t *ng) {
+    if (g == NULL || ng == NULL || ng->attrs != NULL) return 0;
+    if (g->attrs == NULL) return 1;
+    const struct attrstore_t *store = g->attrs;
+    struct attrstore_t *nstore = requireStore(ng);
+    if (nstore == NULL) return 0;
+    for (size_t c = 0; c < store->colcount; c++) {
+        const struct attrcolumn_t *col = store->cols + c;
+        size_t colid = attrFeatureColumn(ng, col->featureid, col->domain, col->fill);
+        if (colid != c || !resizeColumn(nstore, nstore->cols + colid, col->len)) return 0;
+        memcpy(nstore->cols[colid].vals, col->vals, col->len * sizeof(double));
+    }
+    return 1;
+}
@@ -4,6 +4,216 @@
 
 #include <util/cartesian.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__BMI2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Scatter the low bits of a value to the set bits of a mask, lowest first
+ * @param val Value to be scattered
+ * @param mask Destination bits
+ * @return Scattered value
+ */
+static inline size_t depositBits(size_t val, size_t mask) {
+#if defined(__BMI2__) && SIZE_MAX == UINT64_MAX
+    return (size_t)_pdep_u64(val, mask);
+#else
+    size_t res = 0;
+    for (size_t bit = 1; mask != 0; bit <<= 1) {
+        if (val & bit) res |= mask & (~mask + 1);
+        mask &= mask - 1;
+    }
+    return res;
+#endif
+}
+
+/**
+ * @brief Gather the bits of a value under a mask into its low bits; the reverse of depositBits()
+ * @param val Value to be gathered
+ * @param mask Source bits
+ * @return Gathered value
+ */
+static inline size_t extractBits(size_t val, size_t mask) {
+#if defined(__BMI2__) && SIZE_MAX == UINT64_MAX
+    return (size_t)_pext_u64(val, mask);
+#else
+    size_t res = 0;
+    for (size_t bit = 1; mask != 0; bit <<= 1) {
+        if (val & mask & (~mask + 1)) res |= bit;
+        mask &= mask - 1;
+    }
+    return res;
+#endif
+}
+
+/**
+ * @brief Number of tiles along one dimension of a tiled order
+ */
+static inline size_t tilesAlong(const struct dimensions_t *dims, size_t k) {
+    return (dims->dimarr[k] + dims->tileside - 1) / dims->tileside;
+}
+
+/**
+ * @brief Number of nodes in one tile of a tiled order
+ */
+static size_t tileNodes(const struct dimensions_t *dims) {
+    size_t nodes = 1;
+    for (size_t k = 0; k < dims->dimcount; k++) nodes *= dims->tileside;
+    return nodes;
+}
+
+/**
+ * @brief Number of ids over a set of dimensions in their order
+ */
+static size_t orderedLength(const struct dimensions_t *dims) {
+    size_t retval = 0;
+    if (dims->order == ORDER_MORTON) {
+        //the masks share out the low bits of the id between them
+        for (size_t i = 0; i < dims->dimcount; i++) retval |= dims->ordermask[i];
+        retval += 1;
+    } else if (dims->order == ORDER_TILED) {
+        retval = tileNodes(dims);
+        for (size_t i = 0; i < dims->dimcount; i++) retval *= tilesAlong(dims, i);
+    } else {
+        retval = 1;
+        for (size_t i = 0; i < dims->dimcount; i++) retval *= dims->dimarr[i];
+    }
+    return retval;
+}
+
+/**
+ * @brief Divide a 32-bit id by a dimension with its reciprocal multiplier
+ * @param n Id, below 2^32
+ * @param div Multiplier of the dimension
+ * @param dim The dimension
+ * @return n / dim
+ */
+static inline size_t divideBy(size_t n, const struct dimdivisor_t *div, size_t dim) {
+    if (dim == 1) return n;
+    size_t t = (size_t)(((uint64_t)div->magic * n) >> 32);
+    return (t + ((n - t) >> 1)) >> div->shift;
+}
+
+/**
+ * @brief Row-major coordinates of a 32-bit id, by reciprocal multiplication
+ * @param dims Dimensions with their divisors
+ * @param n Id, below the id count
+ * @param coords Set to the coordinates
+ */
+static inline void divideCoords(const struct dimensions_t *dims, size_t n, size_t *coords) {
+    size_t last = dims->dimcount - 1;
+    for (size_t k = 0; k < last; k++) {
+        size_t q = divideBy(n, &dims->divisor[k], dims->dimarr[k]);
+        coords[k] = n - q * dims->dimarr[k];
+        n = q;
+    }
+    coords[last] = n;
+}
+
+/**
+ * @brief Precompute the strides, id count and reciprocal multipliers of a set of dimensions
+ *
+ * The multipliers are only kept when every row-major id fits in 32 bits, which is what they are exact for.
+ *
+ * @param dims Dimensions to be prepared
+ * @return 0 if successful; -1 if the values passed are not valid, or the tables could not be allocated.
+ */
+int cartesianPrepare(struct dimensions_t *dims) {
+    if (NULL == dims || (dims->dimcount > 0 && NULL == dims->dimarr)) return -1;
+    size_t d = dims->dimcount;
+    size_t *stride = (size_t *)malloc((d + 1) * sizeof(size_t));
+    if (NULL == stride) return -1;
+    int fits = d > 0;
+    stride[0] = 1;
+    for (size_t k = 0; k < d; k++) {
+        if (dims->dimarr[k] != 0 && stride[k] > SIZE_MAX / dims->dimarr[k]) fits = 0;
+        stride[k + 1] = stride[k] * dims->dimarr[k];
+    }
+    if (stride[d] == 0 || stride[d] > UINT32_MAX) fits = 0;
+    struct dimdivisor_t *divisor = NULL;
+    if (fits) {
+        divisor = (struct dimdivisor_t *)malloc(d * sizeof(struct dimdivisor_t));
+        if (NULL == divisor) {
+            free(stride);
+            return -1;
+        }
+        for (size_t k = 0; k < d; k++) {
+            uint64_t dim = dims->dimarr[k];
+            uint32_t l = 0;
+            while (((uint64_t)1 << l) < dim) l++;
+            divisor[k].magic = (dim < 2) ? 0 : (uint32_t)(((((uint64_t)1 << l) - dim) << 32) / dim + 1);
+            divisor[k].shift = (dim < 2) ? 0 : l - 1;
+        }
+    }
+    if (NULL != dims->stride) free(dims->stride);
+    if (NULL != dims->divisor) free(dims->divisor);
+    dims->stride = stride;
+    dims->divisor = divisor;
+    dims->indexlen = orderedLength(dims);
+    return 0;
+}
+
+/**
+ * @brief Selects the order of the node ids over a set of dimensions
+ *
+ * Morton masks hand out the bits of the id one level at a time, lowest first, to every dimension that still needs
+ * bits at that level, so dimensions of different lengths are padded only to their own power of two.
+ *
+ * @param dims Dimensions to be ordered
+ * @param order Order of the ids
+ * @param tileside Side of the tiles for ORDER_TILED; 0 for CARTESIAN_DEFAULT_TILESIDE.
+ * @return 0 if successful; 1 if the padded ids would not fit in a size_t; -1 if there is a problem with the values passed.
+ */
+int setDimensionOrder(struct dimensions_t *dims, enum NODEORDER order, size_t tileside) {
+    if (NULL == dims || NULL == dims->dimarr || dims->dimcount == 0) return -1;
+    for (size_t k = 0; k < dims->dimcount; k++) {
+        if (dims->dimarr[k] == 0) return -1;
+    }
+    size_t *masks = NULL;
+    switch (order) {
+        case ORDER_ROWMAJOR:
+            tileside = 0;
+            break;
+        case ORDER_MORTON: {
+            masks = (size_t *)calloc(dims->dimcount, sizeof(size_t));
+            if (NULL == masks) return -1;
+            size_t pos = 0;
+            for (size_t level = 0; level < 8 * sizeof(size_t); level++) {
+                for (size_t k = 0; k < dims->dimcount; k++) {
+                    if (((dims->dimarr[k] - 1) >> level) == 0) continue;
+                    //keep the top bit free, so the id count itself fits
+                    if (pos + 1 >= 8 * sizeof(size_t)) {
+                        free(masks);
+                        return 1;
+                    }
+                    masks[k] |= (size_t)1 << pos++;
+                }
+            }
+            tileside = 0;
+            break;
+        }
+        case ORDER_TILED: {
+            if (tileside == 0) tileside = CARTESIAN_DEFAULT_TILESIDE;
+            size_t span = 1;
+            for (size_t k = 0; k < dims->dimcount; k++) {
+                size_t padded = ((dims->dimarr[k] + tileside - 1) / tileside) * tileside;
+                if (padded < dims->dimarr[k] || span > SIZE_MAX / padded) return 1;
+                span *= padded;
+            }
+            break;
+        }
+        default:
+            return -1;
+    }
+    if (NULL != dims->ordermask) free(dims->ordermask);
+    dims->ordermask = masks;
+    dims->order = order;
+    dims->tileside = tileside;
+    return (cartesianPrepare(dims) == 0) ? 0 : -1;
+}
 
 /**
  * @brief Sets array index value of the given set of dimensions, when calculated against the given dimensional array.
@@ -18,15 +228,32 @@
  */
 int indexFromCartesian(struct dimensions_t *dims, size_t *idx, size_t *coords) {
     int retval = -1;
-    if (NULL != dims && NULL != idx && NULL != coords) {
+    if (NULL != dims && NULL != idx && NULL != coords && dims->order != ORDER_ROWMAJOR) {
+        size_t dxval = 0;
+        retval = 0;
+        if (dims->order == ORDER_MORTON) {
+            for (size_t i = 0; i < dims->dimcount; i++) {
+                if (coords[i] >= dims->dimarr[i]) retval = 1;
+                dxval |= depositBits(coords[i], dims->ordermask[i]);
+            }
+        } else {
+            size_t tile = 0, tilestride = 1, cell = 0, cellstride = 1;
+            for (size_t i = 0; i < dims->dimcount; i++) {
+                if (coords[i] >= dims->dimarr[i]) retval = 1;
+                tile += (coords[i] / dims->tileside) * tilestride;
+                tilestride *= tilesAlong(dims, i);
+                cell += (coords[i] % dims->tileside) * cellstride;
+                cellstride *= dims->tileside;
+            }
+            dxval = tile * cellstride + cell;
+        }
+        *idx = dxval;
+    } else if (NULL != dims && NULL != idx && NULL != coords) {
         size_t dxval = coords[0];
-        size_t dimmult = dims->dimarr[0];
         for (size_t i=1;i<dims->dimcount;i++) {
-            dxval += dimmult*coords[i];
-            dimmult *= dims->dimarr[i];
+            dxval += dims->stride[i]*coords[i];
         }
-        size_t dlen = cartesianIndexLength(dims);
-        if (dxval >= dlen) {
+        if (dxval >= dims->indexlen) {
             retval = 1;
         } else {
             retval = 0;
@@ -49,9 +276,30 @@ int indexFromCartesian(struct dimensions_t *dims, size_t *idx, size_t *coords) {
  */
 int cartesianFromIndex(size_t *idx, size_t *coords, struct dimensions_t *dims) {
     int retval = -1;
-    if (NULL != idx && NULL != coords && NULL != dims) {
-        size_t dimdiv = cartesianIndexLength(dims);
-        if (*idx < dimdiv) {
+    if (NULL != idx && NULL != coords && NULL != dims && dims->order != ORDER_ROWMAJOR) {
+        retval = (*idx < dims->indexlen) ? 0 : 1;
+        if (retval == 0 && dims->order == ORDER_MORTON) {
+            for (size_t i = 0; i < dims->dimcount; i++) {
+                coords[i] = extractBits(*idx, dims->ordermask[i]);
+                if (coords[i] >= dims->dimarr[i]) retval = 1;
+            }
+        } else if (retval == 0) {
+            size_t tilenodes = tileNodes(dims);
+            size_t tile = *idx / tilenodes, cell = *idx % tilenodes;
+            for (size_t i = 0; i < dims->dimcount; i++) {
+                size_t across = tilesAlong(dims, i);
+                coords[i] = (tile % across) * dims->tileside + cell % dims->tileside;
+                if (coords[i] >= dims->dimarr[i]) retval = 1;
+                tile /= across;
+                cell /= dims->tileside;
+            }
+        }
+    } else if (NULL != idx && NULL != coords && NULL != dims) {
+        size_t dimdiv = dims->indexlen;
+        if (*idx < dimdiv && NULL != dims->divisor) {
+            divideCoords(dims, *idx, coords);
+            retval = 0;
+        } else if (*idx < dimdiv) {
             size_t remval = *idx;
             if (dimdiv > 0) {
                 //we have a real coordinate system
@@ -77,15 +325,194 @@ int cartesianFromIndex(size_t *idx, size_t *coords, struct dimensions_t *dims) {
  * hold all possible dimension values.  This is provided both as a consistent check and a means to consistently
  * return the proper value.
  *
+ * The length is computed once, by cartesianPrepare().
+ *
  * @param dims Dimensions to be checked
  * @return Size of index calculation, or 0 if the dims pointer is NULL.
  */
 size_t cartesianIndexLength(struct dimensions_t *dims) {
-    size_t retval = 0;
-    if (NULL != dims) {
-        retval = 1;
-        for (int i=0;i<dims->dimcount;i++) {
-            retval *= dims->dimarr[i];
+    return (NULL != dims) ? dims->indexlen : 0;
+}
+
+/**
+ * @brief Finds the index of the next node along one dimension
+ *
+ * Row-major and tiled steps add the stride of the dimension (moving to the next tile at the edge of a tile); a Morton
+ * step adds one to the bits of the dimension, carrying through the bits of the others.
+ *
+ * @param dims Dimensions to be used for the calculation
+ * @param idx Index of the starting node
+ * @param dim Dimension to step along
+ * @param next Set to the index of the node one step further along dim
+ * @return 0 if successful; 1 if the node is the last one along dim, or the index is outside the bounds of the
+ * dimensions; -1 if there is a problem with the values passed.
+ */
+int cartesianStep(struct dimensions_t *dims, size_t *idx, size_t dim, size_t *next) {
+    if (NULL == dims || NULL == idx || NULL == next || dim >= dims->dimcount) return -1;
+    if (*idx >= cartesianIndexLength(dims)) return 1;
+    size_t coord = 0;
+    switch (dims->order) {
+        case ORDER_MORTON: {
+            for (size_t i = 0; i < dims->dimcount; i++) {
+                size_t c = extractBits(*idx, dims->ordermask[i]);
+                if (c >= dims->dimarr[i]) return 1;
+                if (i == dim) coord = c;
+            }
+            if (coord + 1 >= dims->dimarr[dim]) return 1;
+            size_t mask = dims->ordermask[dim];
+            *next = (((*idx | ~mask) + 1) & mask) | (*idx & ~mask);
+            return 0;
+        }
+        case ORDER_TILED: {
+            size_t tilenodes = tileNodes(dims);
+            size_t tile = *idx / tilenodes, cell = *idx % tilenodes;
+            size_t tilestride = 1, cellstride = 1, incell = 0;
+            for (size_t i = 0; i < dims->dimcount; i++) {
+                size_t across = tilesAlong(dims, i);
+                size_t c = (tile % across) * dims->tileside + cell % dims->tileside;
+                if (c >= dims->dimarr[i]) return 1;
+                if (i == dim) {
+                    coord = c;
+                    incell = cell % dims->tileside;
+                }
+                if (i < dim) {
+                    tilestride *= across;
+                    cellstride *= dims->tileside;
+                }
+                tile /= across;
+                cell /= dims->tileside;
+            }
+            if (coord + 1 >= dims->dimarr[dim]) return 1;
+            if (incell + 1 < dims->tileside) {
+                *next = *idx + cellstride;
+            } else {
+                *next = *idx - incell * cellstride + tilestride * tilenodes;
+            }
+            return 0;
+        }
+        default: {
+            size_t stride = dims->stride[dim];
+            coord = (*idx / stride) % dims->dimarr[dim];
+            if (coord + 1 >= dims->dimarr[dim]) return 1;
+            *next = *idx + stride;
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief Converts row-major indexes below 2^32 to coordinates with the reciprocal multipliers
+ *
+ * The AVX2 kernel keeps four indexes in the 64-bit lanes of a vector; their low halves feed the 32x32-bit multiplies.
+ * Lanes outside the bounds are only flagged, and their coordinates are not meaningful.
+ *
+ * @return 0 if every index is inside the bounds; otherwise, 1.
+ */
+static int divideIndices(const struct dimensions_t *dims, const size_t *idx, size_t count, size_t *coords) {
+    size_t d = dims->dimcount;
+    size_t i = 0;
+    int retval = 0;
+#if defined(__AVX2__) && SIZE_MAX == UINT64_MAX
+    //unsigned compare as signed, with the sign bits flipped
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i limit = _mm256_set1_epi64x((long long)((dims->indexlen - 1) ^ (size_t)INT64_MIN));
+    __m256i outside = _mm256_setzero_si256();
+    size_t lanes[4];
+    for (; i + 4 <= count; i += 4) {
+        __m256i n = _mm256_loadu_si256((const __m256i *)(idx + i));
+        outside = _mm256_or_si256(outside, _mm256_cmpgt_epi64(_mm256_xor_si256(n, sign), limit));
+        for (size_t k = 0; k + 1 < d; k++) {
+            __m256i q = n;
+            if (dims->dimarr[k] != 1) {
+                __m256i magic = _mm256_set1_epi64x(dims->divisor[k].magic);
+                __m256i t = _mm256_srli_epi64(_mm256_mul_epu32(n, magic), 32);
+                q = _mm256_add_epi64(t, _mm256_srli_epi64(_mm256_sub_epi64(n, t), 1));
+                q = _mm256_srl_epi64(q, _mm_cvtsi32_si128((int)dims->divisor[k].shift));
+            }
+            __m256i r = _mm256_sub_epi64(n, _mm256_mul_epu32(q, _mm256_set1_epi64x((long long)dims->dimarr[k])));
+            _mm256_storeu_si256((__m256i *)lanes, r);
+            for (size_t j = 0; j < 4; j++) coords[(i + j) * d + k] = lanes[j];
+            n = q;
+        }
+        _mm256_storeu_si256((__m256i *)lanes, n);
+        for (size_t j = 0; j < 4; j++) coords[(i + j) * d + d - 1] = lanes[j];
+    }
+    retval = !_mm256_testz_si256(outside, outside);
+#endif
+    for (; i < count; i++) {
+        if (idx[i] < dims->indexlen) {
+            divideCoords(dims, idx[i], coords + i * d);
+        } else {
+            retval = 1;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief Converts an array of indexes to coordinates
+ *
+ * Row-major indexes are divided with the reciprocal multipliers when the dimensions have them; other orders, and
+ * larger grids, convert one index at a time.
+ *
+ * @param dims Dimensions to be calculated against
+ * @param idx Indexes to be converted
+ * @param count Number of indexes
+ * @param coords Array of count * dims->dimcount entries to hold the coordinates, one node after another
+ * @return 0 if successful; 1 if any index is outside the bounds of the dimensions; -1 if there is a problem with the
+ * values passed.
+ */
+int cartesianFromIndices(struct dimensions_t *dims, const size_t *idx, size_t count, size_t *coords) {
+    if (NULL == dims || (count > 0 && (NULL == idx || NULL == coords))) return -1;
+    if (dims->dimcount == 0) return (count > 0) ? 1 : 0;
+    if (dims->order == ORDER_ROWMAJOR && NULL != dims->divisor) return divideIndices(dims, idx, count, coords);
+    int retval = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t n = idx[i];
+        if (cartesianFromIndex(&n, coords + i * dims->dimcount, dims) != 0) retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Converts an array of coordinates to indexes
+ *
+ * Row-major indexes are dot products with the stride table; Morton indexes are built with one deposit per coordinate.
+ *
+ * @param dims Dimensions to be used for index calculation
+ * @param coords Coordinates to be converted, count * dims->dimcount entries, one node after another
+ * @param count Number of nodes
+ * @param idx Array of count entries to hold the indexes
+ * @return 0 if successful; 1 if any coordinates are outside the bounds of the dimensions; -1 if there is a problem with
+ * the values passed.
+ */
+int indicesFromCartesian(struct dimensions_t *dims, const size_t *coords, size_t count, size_t *idx) {
+    if (NULL == dims || (count > 0 && (NULL == idx || NULL == coords))) return -1;
+    size_t d = dims->dimcount;
+    if (d == 0) return (count > 0) ? 1 : 0;
+    int retval = 0;
+    if (dims->order == ORDER_ROWMAJOR) {
+        const size_t *stride = dims->stride;
+        for (size_t i = 0; i < count; i++) {
+            const size_t *c = coords + i * d;
+            size_t dxval = c[0];
+            for (size_t k = 1; k < d; k++) dxval += stride[k] * c[k];
+            idx[i] = dxval;
+            retval |= (dxval >= dims->indexlen);
+        }
+    } else if (dims->order == ORDER_MORTON) {
+        for (size_t i = 0; i < count; i++) {
+            const size_t *c = coords + i * d;
+            size_t dxval = 0;
+            for (size_t k = 0; k < d; k++) {
+                retval |= (c[k] >= dims->dimarr[k]);
+                dxval |= depositBits(c[k], dims->ordermask[k]);
+            }
+            idx[i] = dxval;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            if (indexFromCartesian(dims, idx + i, (size_t *)(coords + i * d)) != 0) retval = 1;
         }
     }
     return retval;
@@ -3,7 +3,16 @@
 //
 
 #include <util/crudops.h>
+#include <util/attrstore.h>
+#include <util/interntable.h>
+#include <util/syncops.h>
+#include <util/graphstats.h>
+#include <util/adaptive.h>
+#include <util/partition.h>
+#include <util/snapshot.h>
+#include <util/cartesian.h>
 #include <stdarg.h>
+#include <string.h>
 
 
 
@@ -30,7 +39,7 @@ int parseTypeFlags(enum GRAPHDOMAIN *tflags, enum GRAPHDOMAIN *dirflag, enum GRA
     *domflag = domaintype;
 
     //write the cleaned-up values back to the reference
-    *tflags = dirtype | imptype | labtype | domaintype;
+    *tflags = dirtype | imptype | labtype | domaintype | ((STORESELECT) & *tflags);
 
     retval = 1;
 
@@ -38,23 +47,203 @@ int parseTypeFlags(enum GRAPHDOMAIN *tflags, enum GRAPHDOMAIN *dirflag, enum GRA
 }
 
 
+//Allocator operations
+static void * stdAlloc(size_t size, void *ctx) {
+    return malloc(size);
+}
+
+static void * stdRealloc(void *ptr, size_t oldsize, size_t newsize, void *ctx) {
+    return realloc(ptr, newsize);
+}
+
+static void stdFree(void *ptr, size_t size, void *ctx) {
+    free(ptr);
+}
+
+/**
+ * @brief Allocator wrapping malloc(), realloc() and free()
+ */
+static const struct graphallocator_t stdAllocator = { stdAlloc, stdRealloc, stdFree, NULL };
+
+/**
+ * @brief Retrieve the default allocator, which wraps malloc(), realloc() and free()
+ * @return Pointer to the (static) default allocator
+ */
+const struct graphallocator_t * defaultAllocator() {
+    return &stdAllocator;
+}
+
+/**
+ * @brief Check whether the given allocator is the default malloc()-based allocator (or NULL)
+ * @param a Allocator to be checked
+ * @return 1 if the allocator is the default; otherwise, 0.
+ */
+int isDefaultAllocator(const struct graphallocator_t *a) {
+    return a == NULL || a->alloc == NULL || (a->alloc == stdAlloc && a->free == stdFree);
+}
+
+/**
+ * @brief Global limit on graph memory, in bytes; 0 for no limit
+ */
+static size_t memLimit = 0;
+
+/**
+ * @brief Graph memory currently allocated, in bytes
+ */
+static size_t memInUse = 0;
+
+/**
+ * @brief Set a limit on the memory all graphs together may hold.
+ *
+ * @param bytes Limit in bytes; 0 removes the limit
+ */
+void setGraphMemoryLimit(size_t bytes) {
+    __atomic_store_n(&memLimit, bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Current limit on graph memory
+ * @return Limit in bytes; 0 if there is no limit.
+ */
+size_t getGraphMemoryLimit() {
+    return __atomic_load_n(&memLimit, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Memory currently held by all graphs
+ * @return Bytes allocated through graph allocators and not yet released
+ */
+size_t graphMemoryInUse() {
+    return __atomic_load_n(&memInUse, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Account for memory about to be allocated through a graph allocator, within the memory limit.
+ *
+ * @param a Allocator the memory will come from; NULL (scratch memory handed to callers) is not accounted
+ * @param size Number of bytes
+ * @return 1 if the memory may be allocated; 0 if it would exceed the limit.
+ */
+int graphMemReserve(const struct graphallocator_t *a, size_t size) {
+    if (a == NULL) return 1;
+    size_t limit = __atomic_load_n(&memLimit, __ATOMIC_RELAXED);
+    if (limit == 0) {
+        __atomic_add_fetch(&memInUse, size, __ATOMIC_RELAXED);
+        return 1;
+    }
+    size_t used = __atomic_load_n(&memInUse, __ATOMIC_RELAXED);
+    do {
+        if (size > limit || used > limit - size) return 0;
+    } while (!__atomic_compare_exchange_n(&memInUse, &used, used + size, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return 1;
+}
+
+/**
+ * @brief Account for memory released to a graph allocator
+ * @param a Allocator the memory came from; NULL is not accounted
+ * @param size Number of bytes, as reserved with graphMemReserve()
+ */
+void graphMemRelease(const struct graphallocator_t *a, size_t size) {
+    if (a != NULL) __atomic_sub_fetch(&memInUse, size, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Allocate memory from the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @param size Number of bytes
+ * @return Pointer to the memory, or NULL on failure
+ */
+void * graphAlloc(const struct graphallocator_t *a, size_t size) {
+    if (!graphMemReserve(a, size)) return NULL;
+    void *ptr = isDefaultAllocator(a) ? malloc(size) : a->alloc(size, a->ctx);
+    if (ptr == NULL) graphMemRelease(a, size);
+    return ptr;
+}
+
+/**
+ * @brief Resize memory from the given allocator
+ *
+ * Allocators without a realloc function are handled with alloc, copy and free.
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ptr Block to be resized (may be NULL)
+ * @param oldsize Current size of the block
+ * @param newsize Requested size of the block
+ * @return Pointer to the resized block, or NULL on failure (ptr is left valid)
+ */
+void * graphRealloc(const struct graphallocator_t *a, void *ptr, size_t oldsize, size_t newsize) {
+    if (isDefaultAllocator(a) || a->realloc != NULL) {
+        if (newsize > oldsize && !graphMemReserve(a, newsize - oldsize)) return NULL;
+        void *nptr = isDefaultAllocator(a) ? realloc(ptr, newsize) : a->realloc(ptr, oldsize, newsize, a->ctx);
+        if (nptr == NULL) {
+            if (newsize > oldsize) graphMemRelease(a, newsize - oldsize);
+        } else if (newsize < oldsize) {
+            graphMemRelease(a, oldsize - newsize);
+        }
+        return nptr;
+    }
+    void *nptr = graphAlloc(a, newsize);
+    if (nptr != NULL && ptr != NULL) {
+        memcpy(nptr, ptr, oldsize < newsize ? oldsize : newsize);
+        graphFree(a, ptr, oldsize);
+    }
+    return nptr;
+}
+
+/**
+ * @brief Release memory to the given allocator
+ * @param a Allocator the memory came from; NULL for the default
+ * @param ptr Block to be released (may be NULL)
+ * @param size Size of the block
+ */
+void graphFree(const struct graphallocator_t *a, void *ptr, size_t size) {
+    if (ptr == NULL) return;
+    graphMemRelease(a, size);
+    if (isDefaultAllocator(a)) {
+        free(ptr);
+    } else if (a->free != NULL) {
+        a->free(ptr, size, a->ctx);
+    }
+}
+
 //Create operations
 /**
  * @brief Utility method to create and preset graph structure.
  * @return A pointer to a graph_t structure.
  */
 struct graph_t * basicGraphInit() {
+    return basicGraphInitWith(NULL);
+}
+
+/**
+ * @brief Utility method to create and preset graph structure, using the given allocator
+ *
+ * The allocator is copied into the graph, and used for all of its internal structures.
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @return A pointer to a graph_t structure, if successful; otherwise, a pointer to NULL
+ */
+struct graph_t * basicGraphInitWith(const struct graphallocator_t *a) {
     struct graph_t *g;
-    g = (struct graph_t *) malloc(sizeof(struct graph_t));
-    if (g == NULL) {
-        //something went wrong
-        free(g);
-    } else {
+    if (a == NULL) a = defaultAllocator();
+    g = (struct graph_t *) graphAlloc(a, sizeof(struct graph_t));
+    if (g != NULL) {
         //set the initial values to null;
+        g->allocator = *a;
+        g->graphname = NULL;
+        g->dims = NULL;
         g->capImpl = NULL;
         g->edgeImpl = NULL;
         g->flowImpl = NULL;
         g->labels = NULL;
+        g->config = NULL;
+        g->attrs = NULL;
+        g->features = NULL;
+        g->sync = NULL;
+        g->snapshots = NULL;
+        g->stats = NULL;
+        g->adapt = NULL;
+        g->partview = NULL;
         g->metaImpl = NULL;
         g->nodeImpl = NULL;
     }
@@ -84,7 +273,16 @@ struct dimensions_t * createDimensions(size_t dimsz, ...) {
         }
         dims->dimcount = dimsz;
         dims->dimarr = dimarr;
+        dims->order = ORDER_ROWMAJOR;
+        dims->tileside = 0;
+        dims->ordermask = NULL;
+        dims->stride = NULL;
+        dims->divisor = NULL;
         va_end(dlist);
+        if (cartesianPrepare(dims) != 0) {
+            destroyDimensions((void **)&dims);
+            return NULL;
+        }
     }
     else {
         //something went wrong--free up the struct if necessary
@@ -102,23 +300,85 @@ struct dimensions_t * createDimensions(size_t dimsz, ...) {
  * pointer.
  */
 struct labels_t * initLabels(size_t lblcount) {
+    return initLabelsWith(NULL, lblcount);
+}
+
+/**
+ * @brief Create a raw label structure of the given size, using the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @param lblcount Number of labels required
+ * @return Label structure properly initialized with a size_t array of the given size, if successful; otherwise, a NULL
+ * pointer.
+ */
+struct labels_t * initLabelsWith(const struct graphallocator_t *a, size_t lblcount) {
     size_t *larr = NULL;
     struct labels_t *lbl = NULL;
-    larr = (size_t *)malloc(sizeof(size_t *) * lblcount);
+    larr = (size_t *)graphAlloc(a, sizeof(size_t) * lblcount);
     if (larr != NULL) {
-        lbl = (struct labels_t *)malloc(sizeof(struct labels_t));
+        lbl = (struct labels_t *)graphAlloc(a, sizeof(struct labels_t));
         if (lbl != NULL) {
             lbl->labelcount = lblcount;
             lbl->labelarr = larr;
         } else {
-            //malloc didn't work--free up
-            free(larr);
+            //allocation didn't work--free up
+            graphFree(a, larr, sizeof(size_t) * lblcount);
         }
     }
     return lbl;
 }
 
 
+/**
+ * @brief Create a graph configuration structure holding the default settings
+ *
+ * Consumers are responsible for calling free() on the structure, or passing it to destroyConfig().
+ *
+ * @return Pointer to a graphconfig_t with default values, if successful; otherwise, a NULL pointer.
+ */
+struct graphconfig_t * initConfig() {
+    return copyConfigWith(NULL, NULL);
+}
+
+/**
+ * @brief Create a copy of the given graph configuration
+ *
+ * @param ocfg Configuration to be copied.  If NULL, the copy holds the default settings (same as initConfig()).
+ * @return Pointer to the new configuration, if successful; otherwise, a NULL pointer.
+ */
+struct graphconfig_t * copyConfig(const struct graphconfig_t *ocfg) {
+    return copyConfigWith(NULL, ocfg);
+}
+
+/**
+ * @brief Create a copy of the given graph configuration, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ocfg Configuration to be copied.  If NULL, the copy holds the default settings (same as initConfig()).
+ * @return Pointer to the new configuration, if successful; otherwise, a NULL pointer.
+ */
+struct graphconfig_t * copyConfigWith(const struct graphallocator_t *a, const struct graphconfig_t *ocfg) {
+    struct graphconfig_t *cfg = (struct graphconfig_t *)graphAlloc(a, sizeof(struct graphconfig_t));
+    if (cfg != NULL) {
+        if (ocfg != NULL) {
+            *cfg = *ocfg;
+        } else {
+            cfg->numa = NUMA_DEFAULT;
+            cfg->alloc = ALLOC_MALLOC;
+            cfg->allocator = NULL;
+            cfg->concurrency = CONCURRENCY_NONE;
+            cfg->lockstripes = 0;
+            cfg->memorder = MEMORDER_SEQCST;
+            cfg->stats = STATS_OFF;
+            cfg->adapt = ADAPT_OFF;
+            cfg->adaptnodes = 0;
+            cfg->mmappath = NULL;
+            cfg->tileside = 0;
+            cfg->tilecache = 0;
+        }
+    }
+    return cfg;
+}
+
 
 /**
  * @brief Raw initializer for graphops_t structure with all NULL interior pointers
@@ -142,6 +402,15 @@ struct graphops_t * initGraphops() {
         gops->nodeCount = NULL;
         gops->resetGraph = NULL;
         gops->setCapacity = NULL;
+        gops->addCapacity = NULL;
+        gops->getCapacity = NULL;
+        gops->setFlow = NULL;
+        gops->addFlow = NULL;
+        gops->getFlow = NULL;
+        gops->removeEdge = NULL;
+        gops->removeNode = NULL;
+        gops->atomicAddCapacity = NULL;
+        gops->atomicAddFlow = NULL;
     }
     return gops;
 }
@@ -151,8 +420,17 @@ struct graphops_t * initGraphops() {
  * @return pointer to new edge_t memory, if successful; otherwise NULL.
  */
 struct edge_t * initEdge() {
+    return initEdgeWith(NULL);
+}
+
+/**
+ * @brief Allocate and initialize an edge, using the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @return pointer to new edge_t memory, if successful; otherwise NULL.
+ */
+struct edge_t * initEdgeWith(const struct graphallocator_t *a) {
     struct edge_t *edge;
-    edge = (struct edge_t *)malloc(sizeof(struct edge_t));
+    edge = (struct edge_t *)graphAlloc(a, sizeof(struct edge_t));
     if (edge != NULL) {
         edge->attrs = NULL;
         edge->next = NULL;
@@ -172,8 +450,18 @@ struct edge_t * initEdge() {
  * @return pointer to new node_t memory, if successful; otherwise, NULL.
  */
 struct node_t * initNode() {
+    return initNodeWith(NULL);
+}
+
+/**
+ * @brief Allocate and initialize a node, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @return pointer to new node_t memory, if successful; otherwise, NULL.
+ */
+struct node_t * initNodeWith(const struct graphallocator_t *a) {
     struct node_t *node = NULL;
-    node = (struct node_t *)malloc(sizeof(struct node_t));
+    node = (struct node_t *)graphAlloc(a, sizeof(struct node_t));
     if (node != NULL) {
         node->next = NULL;
         node->prev = NULL;
@@ -189,10 +477,20 @@ struct node_t * initNode() {
  * @return pointer to new feature_t memory, if successful; otherwise, NULL.
  */
 struct feature_t * initFeature() {
+    return initFeatureWith(NULL);
+}
+
+/**
+ * @brief Allocate and initialize a feature structure, using the given allocator
+ * @param a Allocator to be used; NULL for the default
+ * @return pointer to new feature_t memory, if successful; otherwise, NULL.
+ */
+struct feature_t * initFeatureWith(const struct graphallocator_t *a) {
     struct feature_t *f = NULL;
-    f = (struct feature_t *)malloc(sizeof(struct feature_t));
+    f = (struct feature_t *)graphAlloc(a, sizeof(struct feature_t));
     if (f != NULL) {
         f->val = 0.0;
+        f->featurename = NULL;
         f->hashid = 0;
         f->fdata = NULL;
         f->prev = NULL;
@@ -215,9 +513,20 @@ struct feature_t * initFeature() {
  * @return pointer to the cloned structure, if successful; otherwise, a pointer to NULL
  */
 struct node_t * cloneNode(const struct node_t *onode) {
+    return cloneNodeWith(NULL, onode);
+}
+
+/**
+ * @brief Create a copy of the given node, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param onode Original node_t to be cloned
+ * @return pointer to the cloned structure, if successful; otherwise, a pointer to NULL
+ */
+struct node_t * cloneNodeWith(const struct graphallocator_t *a, const struct node_t *onode) {
     struct node_t *nnode = NULL;
     if (onode != NULL) {
-        nnode = initNode();
+        nnode = initNodeWith(a);
         if (nnode != NULL) {
             nnode->nodeid = onode->nodeid;
         }
@@ -235,9 +544,20 @@ struct node_t * cloneNode(const struct node_t *onode) {
  * @return pointer to the cloned data, if successful; otherwise, a pointer to NULL
  */
 struct edge_t * cloneEdge(const struct edge_t *oedge) {
+    return cloneEdgeWith(NULL, oedge);
+}
+
+/**
+ * @brief Create a copy of the given edge, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param oedge Original edge_t structure to be cloned.
+ * @return pointer to the cloned data, if successful; otherwise, a pointer to NULL
+ */
+struct edge_t * cloneEdgeWith(const struct graphallocator_t *a, const struct edge_t *oedge) {
     struct edge_t *nedge = NULL;
     if (oedge != NULL) {
-        nedge = initEdge();
+        nedge = initEdgeWith(a);
         if (nedge != NULL) {
             nedge->u = oedge->u;
             nedge->v = oedge->v;
@@ -255,8 +575,20 @@ struct edge_t * cloneEdge(const struct edge_t *oedge) {
  * @return pointer to the cloned data, if successful; otherwise, a pointer to NULL
  */
 struct feature_t * cloneFeature(const struct feature_t *ofeat) {
+    return cloneFeatureWith(NULL, ofeat);
+}
+
+/**
+ * @brief Create a copy of the given feature data, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ofeat Original feature to be copied.
+ * @return pointer to the cloned data, if successful; otherwise, a pointer to NULL
+ */
+struct feature_t * cloneFeatureWith(const struct graphallocator_t *a, const struct feature_t *ofeat) {
     struct feature_t *nf = NULL;
-    nf = initFeature();
+    if (ofeat == NULL) return NULL;
+    nf = initFeatureWith(a);
     if (nf != NULL) {
         //TODO:  Explicitly state fdata and featurename refer to originals, or work on making copies?
         nf->fdata = ofeat->fdata;
@@ -267,6 +599,33 @@ struct feature_t * cloneFeature(const struct feature_t *ofeat) {
     return nf;
 }
 
+/**
+ * @brief Create a copy of an entire feature list, using the given allocator
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @param ofeat Head of the original list
+ * @param nfeat Set to the head of the copy (NULL for an empty list)
+ * @return 1 if successful; otherwise, 0 (and nothing is left allocated).
+ */
+int cloneFeaturesWith(const struct graphallocator_t *a, const struct feature_t *ofeat, struct feature_t **nfeat) {
+    struct feature_t *tail = NULL;
+    *nfeat = NULL;
+    for (const struct feature_t *f = ofeat; f != NULL; f = f->next) {
+        struct feature_t *nf = cloneFeatureWith(a, f);
+        if (nf == NULL) {
+            destroyFeaturesWith(a, (void **)nfeat);
+            return 0;
+        }
+        if (tail == NULL) {
+            *nfeat = nf;
+        } else {
+            tail->next = nf;
+        }
+        tail = nf;
+    }
+    return 1;
+}
+
 
 
 
@@ -283,13 +642,57 @@ struct feature_t * cloneFeature(const struct feature_t *ofeat) {
 int destroyGraph(void** gptr) {
     int retval = 0;
     if (NULL != *gptr) {
-        free(*gptr);
+        struct graph_t *g = *gptr;
+        if (isSnapshot(g)) return releaseSnapshot(gptr);
+        //the snapshots still hold the bookkeeping and the retired edge lists
+        if (snapshotCount(g) > 0) return 0;
+        //the graph holds its own allocator, so take a copy before releasing it
+        struct graphallocator_t a = g->allocator;
+        destroyGraphSync(g);
+        destroyGraphStats(g);
+        destroyGraphAdapt(g);
+        destroyPartitionView(g);
+        destroySnapshotState(g);
+        destroyAttrStore(g);
+        destroyInternTable((void **)&(g->features));
+        destroyConfigWith(&a, (void **)&(g->config));
+        destroyLabelsWith(&a, (void **)&(g->labels));
+        graphFree(&a, *gptr, sizeof(struct graph_t));
         *gptr = NULL;
         retval = 1;
     }
     return retval;
 }
 
+/**
+ * @brief Clear out a graph configuration structure
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param cfgptr pointer-to-pointer for graphconfig_t structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyConfig(void** cfgptr) {
+    return destroyConfigWith(NULL, cfgptr);
+}
+
+/**
+ * @brief Clear out a graph configuration structure created with the given allocator
+ *
+ * @param a Allocator the structure came from; NULL for the default
+ * @param cfgptr pointer-to-pointer for graphconfig_t structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyConfigWith(const struct graphallocator_t *a, void** cfgptr) {
+    int retval = 0;
+    if (NULL != *cfgptr) {
+        graphFree(a, *cfgptr, sizeof(struct graphconfig_t));
+        *cfgptr = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
 /**
  * @brief Clear out the dimensions and all underlying structures
  * @param dptr pointer-to-pointer for dimensions_t structure to be cleared
@@ -304,6 +707,18 @@ int destroyDimensions(void** dptr) {
             free(dimarr);
             dims->dimarr = NULL;
         }
+        if (NULL != dims->ordermask) {
+            free(dims->ordermask);
+            dims->ordermask = NULL;
+        }
+        if (NULL != dims->stride) {
+            free(dims->stride);
+            dims->stride = NULL;
+        }
+        if (NULL != dims->divisor) {
+            free(dims->divisor);
+            dims->divisor = NULL;
+        }
         dims->dimcount = 0;
         free(*dptr);
         *dptr = NULL;
@@ -318,16 +733,26 @@ int destroyDimensions(void** dptr) {
  * @return 1 if success; 0 if error
  */
 int destroyLabels(void** lptr) {
+    return destroyLabelsWith(NULL, lptr);
+}
+
+/**
+ * @brief Clear out a label structure created with the given allocator
+ * @param a Allocator the structure came from; NULL for the default
+ * @param labels pointer-to-pointer for labels_t structure to be cleared
+ * @return 1 if success; 0 if error
+ */
+int destroyLabelsWith(const struct graphallocator_t *a, void** lptr) {
     int retval = 0;
     if (NULL != *lptr) {
         struct labels_t *labels = *lptr;
         size_t *larr = labels->labelarr;
         if (NULL != larr) {
-            free(larr);
+            graphFree(a, larr, sizeof(size_t) * labels->labelcount);
             labels->labelarr = NULL;
         }
         labels->labelcount = 0;
-        free(*lptr);
+        graphFree(a, *lptr, sizeof(struct labels_t));
         *lptr = NULL;
         retval = 1;
     }
@@ -343,13 +768,27 @@ int destroyLabels(void** lptr) {
  * @return 1 if success; 0 if error.
  */
 int destroyEdges(void** eptr) {
+    return destroyEdgesWith(NULL, eptr);
+}
+
+/**
+ * @brief Clear an edge structure and any linked edges created with the given allocator
+ *
+ * The pointer itself will be changed to NULL.  Features attached to the edges are released as well.
+ *
+ * @param a Allocator the edges came from; NULL for the default
+ * @param eptr pointer-to-pointer for initial edge pointer
+ * @return 1 if success; 0 if error.
+ */
+int destroyEdgesWith(const struct graphallocator_t *a, void** eptr) {
     int retval = 0;
     if (*eptr != NULL) {
         struct edge_t *curr = (struct edge_t *)*eptr;
         struct edge_t *next;
         while (curr != NULL) {
             next = curr->next;
-            free(curr);
+            destroyFeaturesWith(a, (void **)&(curr->attrs));
+            graphFree(a, curr, sizeof(struct edge_t));
             curr = next;
         }
         *eptr = NULL;
@@ -398,13 +837,28 @@ int destroyGraphops(void** opsptr) {
  * @return 1 if successful; 0 if error
  */
 int destroyNodes(void** nptr) {
+    return destroyNodesWith(NULL, nptr);
+}
+
+/**
+ * @brief Clear a node or node list created with the given allocator
+ *
+ * The pointer itself will be changed to NULL.  Features attached to the nodes are released as well; attached edges
+ * are not.
+ *
+ * @param a Allocator the nodes came from; NULL for the default
+ * @param nptr pointer-to-pointer for initial node structure
+ * @return 1 if successful; 0 if error
+ */
+int destroyNodesWith(const struct graphallocator_t *a, void** nptr) {
     int retval = 0;
     if (*nptr != NULL) {
         struct node_t *curr = (struct node_t *)*nptr;
         struct node_t *next;
         while (curr != NULL) {
             next = curr->next;
-            free(curr);
+            destroyFeaturesWith(a, (void **)&(curr->attrs));
+            graphFree(a, curr, sizeof(struct node_t));
             curr = next;
         }
         *nptr = NULL;
@@ -423,13 +877,26 @@ int destroyNodes(void** nptr) {
  * @return 1 if successful; 0 if error
  */
 int destroyFeatures(void** fptr) {
+    return destroyFeaturesWith(NULL, fptr);
+}
+
+/**
+ * @brief Clear a feature or feature list created with the given allocator
+ *
+ * The pointer itself will be changed to NULL
+ *
+ * @param a Allocator the features came from; NULL for the default
+ * @param fptr pointer-to-pointer for initial feature structure
+ * @return 1 if successful; 0 if error
+ */
+int destroyFeaturesWith(const struct graphallocator_t *a, void** fptr) {
     int retval = 0;
     if (*fptr != NULL) {
         struct feature_t *curr = (struct feature_t *)*fptr;
         struct feature_t *next;
         while (curr != NULL) {
             next = curr->next;
-            free(curr);
+            graphFree(a, curr, sizeof(struct feature_t));
             curr = next;
         }
         *fptr = NULL;
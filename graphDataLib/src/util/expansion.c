@@ -0,0 +1,158 @@
+/**
+ * @brief Multi-label energy minimization on LABELED ARRAY graphs (alpha-expansion).
+ *
+ * In the binary problem of an expansion move, a node on the source side keeps its label and a node on the sink side
+ * takes label alpha.  Pairwise terms are built with the usual construction for submodular two-variable functions
+ * (Kolmogorov and Zabih), which applies whenever the label distance is a metric.
+ */
+
+#include <util/expansion.h>
+#include <util/maxflow.h>
+#include <util/crudops.h>
+#include <impl/arraygraph.h>
+#include <string.h>
+
+/**
+ * @brief Pairwise cost of two labels
+ */
+static double labelCost(funcLabelCost pairwise, void *ctx, size_t a, size_t b) {
+    if (pairwise == NULL) return (a != b) ? 1.0 : 0.0;
+    return pairwise(a, b, ctx);
+}
+
+/**
+ * @brief Number of labeled nodes of a LABELED ARRAY graph
+ * @param g Graph in question
+ * @return Node count, or 0 if the graph cannot be labeled
+ */
+static size_t labeledNodes(const struct graph_t *g) {
+    if (g == NULL || (g->gtype & ARRAY) != ARRAY || (g->gtype & LABELED) != LABELED || g->metaImpl == NULL
+        || g->labels == NULL || g->labels->labelcount == 0) return 0;
+    const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+    return meta->nodelen / g->labels->labelcount;
+}
+
+/**
+ * @brief Add the cost c * x for a binary node variable to the terminal arcs
+ */
+static void addUnary(struct flowworkspace_t *ws, size_t p, double c) {
+    if (c > 0.0) {
+        flowAddTerminal(ws, p, c, 0.0);
+    } else {
+        flowAddTerminal(ws, p, 0.0, -c);
+    }
+}
+
+/**
+ * @brief Compute the energy of a labeling
+ *
+ * @param g LABELED ARRAY graph
+ * @param datacost Data costs, indexed label * nodecount + node
+ * @param pairwise Label distance; NULL for the Potts model
+ * @param ctx Passed through to the pairwise function
+ * @param labeling Label of each node
+ * @return Energy of the labeling
+ */
+double labelingEnergy(const struct graph_t *g, const double *datacost, funcLabelCost pairwise, void *ctx,
+                      const size_t *labeling) {
+    size_t n = labeledNodes(g);
+    if (n == 0 || datacost == NULL || labeling == NULL) return 0.0;
+    const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+    const size_t *nodes = (const size_t *)g->nodeImpl;
+    const double *caparr = (const double *)g->capImpl;
+    double e = 0.0;
+    for (size_t p = 0; p < n; p++) {
+        e += datacost[labeling[p] * n + p];
+    }
+    for (size_t s = 0; s < n * meta->degree; s++) {
+        size_t q = nodes[s];
+        if (q == 0 || q >= n) continue;
+        e += caparr[s] * labelCost(pairwise, ctx, labeling[s / meta->degree], labeling[q]);
+    }
+    return e;
+}
+
+/**
+ * @brief Build the binary problem of one expansion move into the flow workspace
+ */
+static void buildExpansion(struct flowworkspace_t *ws, const struct graph_t *g, size_t n, size_t alpha,
+                           const double *datacost, funcLabelCost pairwise, void *ctx, const size_t *labeling) {
+    const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+    const size_t *nodes = (const size_t *)g->nodeImpl;
+    const double *caparr = (const double *)g->capImpl;
+    flowReset(ws);
+    for (size_t p = 0; p < n; p++) {
+        //keeping the label is paid on the sink arc, switching on the source arc
+        flowAddTerminal(ws, p, datacost[alpha * n + p], datacost[labeling[p] * n + p]);
+    }
+    for (size_t s = 0; s < n * meta->degree; s++) {
+        size_t q = nodes[s];
+        if (q == 0 || q >= n) continue;
+        size_t p = s / meta->degree;
+        double w = caparr[s];
+        //E(keep,keep) = A, E(keep,alpha) = B, E(alpha,keep) = C, E(alpha,alpha) = 0
+        double a = w * labelCost(pairwise, ctx, labeling[p], labeling[q]);
+        double b = w * labelCost(pairwise, ctx, labeling[p], alpha);
+        double c = w * labelCost(pairwise, ctx, alpha, labeling[q]);
+        addUnary(ws, p, c - a);
+        addUnary(ws, q, -c);
+        double cut = b + c - a;
+        //negative only when the distance is not a metric; the move is then approximate
+        flowAddArc(ws, s, cut > 0.0 ? cut : 0.0, 0.0);
+    }
+}
+
+/**
+ * @brief Minimize the labeling energy with alpha-expansion moves.
+ *
+ * @param g LABELED ARRAY graph
+ * @param datacost Data costs, indexed label * nodecount + node
+ * @param pairwise Label distance; NULL for the Potts model
+ * @param ctx Passed through to the pairwise function
+ * @param labeling Starting label of each node; set to the result
+ * @param maxcycles Maximum number of cycles through the labels; 0 for no limit
+ * @param energy Set to the energy of the resulting labeling; may be NULL
+ * @return 1 if successful; otherwise, 0.
+ */
+int alphaExpansion(const struct graph_t *g, const double *datacost, funcLabelCost pairwise, void *ctx,
+                   size_t *labeling, size_t maxcycles, double *energy) {
+    size_t n = labeledNodes(g);
+    if (n == 0 || datacost == NULL || labeling == NULL) return 0;
+    size_t labelcount = g->labels->labelcount;
+    for (size_t p = 0; p < n; p++) {
+        if (labeling[p] >= labelcount) return 0;
+    }
+    struct flowworkspace_t *ws = initFlowWorkspace(g, n);
+    if (ws == NULL) return 0;
+    const struct graphallocator_t *a = &g->allocator;
+    size_t *candidate = (size_t *)graphAlloc(a, n * sizeof(size_t));
+    if (candidate == NULL) {
+        destroyFlowWorkspace((void **)&ws);
+        return 0;
+    }
+
+    double current = labelingEnergy(g, datacost, pairwise, ctx, labeling);
+    for (size_t cycle = 0; maxcycles == 0 || cycle < maxcycles; cycle++) {
+        int improved = 0;
+        for (size_t alpha = 0; alpha < labelcount; alpha++) {
+            buildExpansion(ws, g, n, alpha, datacost, pairwise, ctx, labeling);
+            flowSolve(ws);
+            for (size_t p = 0; p < n; p++) {
+                candidate[p] = flowSinkSide(ws, p) ? alpha : labeling[p];
+            }
+            //only strict improvements are kept, which guarantees termination
+            double moved = labelingEnergy(g, datacost, pairwise, ctx, candidate);
+            if (moved < current - 1e-9 * (current > 0.0 ? current : -current)) {
+                memcpy(labeling, candidate, n * sizeof(size_t));
+                current = moved;
+                improved = 1;
+            }
+        }
+        if (!improved) break;
+    }
+    if (energy != NULL) *energy = current;
+
+    graphFree(a, candidate, n * sizeof(size_t));
+    destroyFlowWorkspace((void **)&ws);
+    return 1;
+}
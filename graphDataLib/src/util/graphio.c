@@ -0,0 +1,558 @@
+/**
+ * @brief Streaming import and export of edge lists and DIMACS max-flow files.
+ */
+
+#include <util/graphio.h>
+#include <util/crudops.h>
+#include <impl/arraygraph.h>
+#include <impl/sharedmmapgraph.h>
+#include <graphInit.h>
+#include <graphOps.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Longest numeric token handed to strtod() when the fast path does not apply
+ */
+#define GRAPHIO_TOKEN_MAX 64
+
+/**
+ * @brief Parsed edge waiting to be inserted
+ */
+struct edgerec_t {
+    size_t u;
+    size_t v;
+    double cap;
+    /**
+     * @brief Line the edge was read from, for error reports
+     */
+    size_t line;
+};
+
+/**
+ * @brief Batch of parsed edges and the graph they go into
+ */
+struct edgebatch_t {
+    struct graph_t *g;
+    struct graphops_t *gops;
+    struct edgerec_t *recs;
+    size_t count;
+    /**
+     * @brief Scratch space for the node ids of a batch (2 * GRAPHIO_BATCH)
+     */
+    size_t *ids;
+    size_t added;
+    size_t errline;
+    int undirected;
+    int linked;
+};
+
+/**
+ * @brief State of a DIMACS read
+ */
+struct dimacsstate_t {
+    struct edgebatch_t *batch;
+    size_t source;
+    size_t sink;
+    int seenproblem;
+};
+
+/**
+ * @brief Function called for each line of a stream
+ * @return 1 to continue; 0 to stop with an error
+ */
+typedef int (*funcLine)(const char *p, const char *end, size_t lineno, void *ctx);
+
+static const double pow10tab[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static int isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static int isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static const char * skipBlank(const char *p, const char *end) {
+    while (p < end && isBlank(*p)) p++;
+    return p;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/**
+ * @brief Check that all eight bytes of a word are ASCII digits
+ */
+static int isEightDigits(uint64_t x) {
+    return ((x & 0xF0F0F0F0F0F0F0F0ULL) | (((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+           == 0x3333333333333333ULL;
+}
+
+/**
+ * @brief Convert eight ASCII digits (first digit in the lowest byte) with three multiplies
+ */
+static uint64_t parseEightDigits(uint64_t x) {
+    x = ((x & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    x = ((x & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return ((x & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+#endif
+
+/**
+ * @brief Accumulate a run of digits into a 64-bit value
+ * @param p Start of the digits
+ * @param end End of the line
+ * @param val Value to accumulate into
+ * @param digits Incremented by the number of digits read
+ * @return Position after the digits
+ */
+static const char * readDigits(const char *p, const char *end, uint64_t *val, size_t *digits) {
+    uint64_t v = *val;
+    size_t count = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    //eight digits at a time, as long as they fit in 19
+    while (end - p >= 8 && count + *digits <= 11) {
+        uint64_t x;
+        memcpy(&x, p, sizeof(x));
+        if (!isEightDigits(x)) break;
+        v = v * 100000000ULL + parseEightDigits(x);
+        p += 8;
+        count += 8;
+    }
+#endif
+    //anything past 19 digits is left unread, for the caller to reject or hand to strtod()
+    while (p < end && isDigit(*p) && count + *digits < 19) {
+        v = v * 10 + (uint64_t)(*p - '0');
+        p++;
+        count++;
+    }
+    *val = v;
+    *digits += count;
+    return p;
+}
+
+/**
+ * @brief Parse an unsigned integer token
+ * @return Position after the token, or NULL if the token is not a valid id
+ */
+static const char * parseSize(const char *p, const char *end, size_t *out) {
+    p = skipBlank(p, end);
+    if (p == end || !isDigit(*p)) return NULL;
+    uint64_t v = 0;
+    size_t digits = 0;
+    p = readDigits(p, end, &v, &digits);
+    if (p < end && !isBlank(*p)) return NULL;
+    *out = (size_t)v;
+    return p;
+}
+
+/**
+ * @brief Parse a floating-point token
+ *
+ * Decimal values with up to 19 significant digits and small exponents are converted exactly from an integer mantissa
+ * and a power of ten; everything else goes through strtod().
+ *
+ * @return Position after the token, or NULL if the token is not a number
+ */
+static const char * parseDouble(const char *p, const char *end, double *out) {
+    p = skipBlank(p, end);
+    const char *start = p;
+    const char *tokend = p;
+    while (tokend < end && !isBlank(*tokend)) tokend++;
+    if (start == tokend) return NULL;
+
+    int neg = 0;
+    if (*p == '-' || *p == '+') {
+        neg = (*p == '-');
+        p++;
+    }
+    uint64_t mant = 0;
+    size_t digits = 0;
+    long exp10 = 0;
+    const char *q = readDigits(p, tokend, &mant, &digits);
+    int fast = (q > p);
+    if (q < tokend && *q == '.') {
+        const char *f = q + 1;
+        size_t before = digits;
+        q = readDigits(f, tokend, &mant, &digits);
+        exp10 = -(long)(digits - before);
+        fast = fast || (q > f);
+    }
+    if (fast && q == tokend && digits <= 19 && mant <= (1ULL << 53) && exp10 >= -22) {
+        double val = (double)mant;
+        val = (exp10 < 0) ? val / pow10tab[-exp10] : val;
+        *out = neg ? -val : val;
+        return tokend;
+    }
+
+    //exponents, long mantissas, inf and nan
+    char tmp[GRAPHIO_TOKEN_MAX];
+    size_t len = (size_t)(tokend - start);
+    if (len >= GRAPHIO_TOKEN_MAX) return NULL;
+    memcpy(tmp, start, len);
+    tmp[len] = '\0';
+    char *stop = NULL;
+    double val = strtod(tmp, &stop);
+    if (stop != tmp + len) return NULL;
+    *out = val;
+    return tokend;
+}
+
+static int compareIds(const void *a, const void *b) {
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Make sure a LINKED or HASHED node exists
+ */
+static int ensureNode(struct edgebatch_t *b, size_t id) {
+    if (!b->linked || b->gops->getNode(&id, b->g) != NULL) return 1;
+    return b->gops->addNode(&id, b->g);
+}
+
+/**
+ * @brief Insert the queued edges
+ *
+ * For LINKED and HASHED graphs, the node ids of the whole batch are sorted and deduplicated first, so each node is looked up once
+ * per batch rather than once per edge.
+ *
+ * @param b Batch
+ * @return 1 if successful; otherwise, 0 (with errline set).
+ */
+static int flushBatch(struct edgebatch_t *b) {
+    if (b->linked && b->count > 0) {
+        size_t idcount = 0;
+        for (size_t i = 0; i < b->count; i++) {
+            b->ids[idcount++] = b->recs[i].u;
+            b->ids[idcount++] = b->recs[i].v;
+        }
+        qsort(b->ids, idcount, sizeof(size_t), compareIds);
+        for (size_t i = 0; i < idcount; i++) {
+            if (i > 0 && b->ids[i] == b->ids[i - 1]) continue;
+            if (!ensureNode(b, b->ids[i])) {
+                b->errline = b->recs[0].line;
+                return 0;
+            }
+        }
+    }
+    for (size_t i = 0; i < b->count; i++) {
+        struct edgerec_t *r = &b->recs[i];
+        if (b->undirected) {
+            double existing;
+            if (b->gops->getCapacity(&r->u, &r->v, &existing, b->g)) continue;
+        }
+        if (!b->gops->addEdge(&r->u, &r->v, &r->cap, b->g)) {
+            b->errline = r->line;
+            b->count = 0;
+            return 0;
+        }
+        b->added++;
+    }
+    b->count = 0;
+    return 1;
+}
+
+/**
+ * @brief Queue an edge, inserting the batch when it is full
+ */
+static int queueEdge(struct edgebatch_t *b, size_t u, size_t v, double cap, size_t line) {
+    struct edgerec_t *r = &b->recs[b->count++];
+    r->u = u;
+    r->v = v;
+    r->cap = cap;
+    r->line = line;
+    return (b->count == GRAPHIO_BATCH) ? flushBatch(b) : 1;
+}
+
+/**
+ * @brief Set up a batch for the given graph
+ */
+static int initBatch(struct edgebatch_t *b, struct graph_t *g) {
+    memset(b, 0, sizeof(struct edgebatch_t));
+    b->g = g;
+    b->gops = getOperations(g);
+    b->recs = (struct edgerec_t *)graphAlloc(&g->allocator, GRAPHIO_BATCH * sizeof(struct edgerec_t));
+    b->ids = (size_t *)graphAlloc(&g->allocator, 2 * GRAPHIO_BATCH * sizeof(size_t));
+    b->undirected = ((g->gtype & DIRECTED) != DIRECTED);
+    b->linked = ((g->gtype & (LINKED | HASHED)) != 0);
+    return b->gops != NULL && b->gops->addEdge != NULL && b->recs != NULL && b->ids != NULL;
+}
+
+/**
+ * @brief Release the buffers of a batch
+ */
+static void freeBatch(struct edgebatch_t *b) {
+    graphFree(&b->g->allocator, b->recs, GRAPHIO_BATCH * sizeof(struct edgerec_t));
+    graphFree(&b->g->allocator, b->ids, 2 * GRAPHIO_BATCH * sizeof(size_t));
+    destroyGraphops((void **)&b->gops);
+}
+
+/**
+ * @brief Hand each line of a stream to a function, reading through a fixed-size buffer
+ *
+ * A partial line at the end of the buffer is moved to the front before the next read.
+ *
+ * @param a Allocator for the buffer
+ * @param in Stream to read
+ * @param fn Line function
+ * @param ctx Passed through to the line function
+ * @param lineno Set to the number of the last line handed out
+ * @return 1 if the stream was read to its end; otherwise, 0.
+ */
+static int streamLines(const struct graphallocator_t *a, FILE *in, funcLine fn, void *ctx, size_t *lineno) {
+    char *buf = (char *)graphAlloc(a, GRAPHIO_BUFSIZE);
+    if (buf == NULL) return 0;
+    int retval = 1;
+    size_t carry = 0;
+    *lineno = 0;
+    while (retval) {
+        size_t got = fread(buf + carry, 1, GRAPHIO_BUFSIZE - carry, in);
+        size_t total = carry + got;
+        const char *start = buf;
+        const char *bufend = buf + total;
+        const char *nl;
+        while (retval && (nl = (const char *)memchr(start, '\n', (size_t)(bufend - start))) != NULL) {
+            (*lineno)++;
+            retval = fn(start, nl, *lineno, ctx);
+            start = nl + 1;
+        }
+        if (!retval) break;
+        carry = (size_t)(bufend - start);
+        if (got == 0) {
+            //end of the stream--the last line may not have a newline
+            if (carry > 0) {
+                (*lineno)++;
+                retval = fn(start, bufend, *lineno, ctx);
+            }
+            if (ferror(in)) retval = 0;
+            break;
+        }
+        if (carry == GRAPHIO_BUFSIZE) {
+            //line longer than the buffer
+            (*lineno)++;
+            retval = 0;
+            break;
+        }
+        memmove(buf, start, carry);
+    }
+    graphFree(a, buf, GRAPHIO_BUFSIZE);
+    return retval;
+}
+
+/**
+ * @brief Handle one line of an edge list
+ */
+static int edgeListLine(const char *p, const char *end, size_t lineno, void *ctx) {
+    struct edgebatch_t *b = (struct edgebatch_t *)ctx;
+    p = skipBlank(p, end);
+    if (p == end || *p == '#' || *p == '%') return 1;
+    size_t u, v;
+    double cap = 1.0;
+    if ((p = parseSize(p, end, &u)) == NULL || (p = parseSize(p, end, &v)) == NULL) {
+        b->errline = lineno;
+        return 0;
+    }
+    p = skipBlank(p, end);
+    if (p < end && ((p = parseDouble(p, end, &cap)) == NULL || skipBlank(p, end) != end)) {
+        b->errline = lineno;
+        return 0;
+    }
+    return queueEdge(b, u, v, cap, lineno);
+}
+
+/**
+ * @brief Handle one line of a DIMACS file
+ */
+static int dimacsLine(const char *p, const char *end, size_t lineno, void *ctx) {
+    struct dimacsstate_t *st = (struct dimacsstate_t *)ctx;
+    struct edgebatch_t *b = st->batch;
+    p = skipBlank(p, end);
+    if (p == end || *p == 'c') return 1;
+    char kind = *p++;
+    if (p < end && !isBlank(*p)) kind = '?';
+    int ok = 0;
+    if (kind == 'p' && !st->seenproblem) {
+        size_t nodes, arcs;
+        p = skipBlank(p, end);
+        if (end - p >= 3 && memcmp(p, "max", 3) == 0 && (p = parseSize(p + 3, end, &nodes)) != NULL
+            && (p = parseSize(p, end, &arcs)) != NULL && skipBlank(p, end) == end) {
+            st->seenproblem = 1;
+            ok = 1;
+        }
+    } else if (kind == 'n' && st->seenproblem) {
+        size_t id;
+        //DIMACS ids start at 1; graph ids start at 0
+        if ((p = parseSize(p, end, &id)) != NULL && id > 0) {
+            p = skipBlank(p, end);
+            if (p < end && (*p == 's' || *p == 't') && skipBlank(p + 1, end) == end) {
+                if (*p == 's') st->source = id - 1; else st->sink = id - 1;
+                ok = ensureNode(b, id - 1);
+            }
+        }
+    } else if (kind == 'a' && st->seenproblem) {
+        size_t u, v;
+        double cap;
+        if ((p = parseSize(p, end, &u)) != NULL && (p = parseSize(p, end, &v)) != NULL
+            && (p = parseDouble(p, end, &cap)) != NULL && skipBlank(p, end) == end && u > 0 && v > 0) {
+            return queueEdge(b, u - 1, v - 1, cap, lineno);
+        }
+    }
+    if (!ok) b->errline = lineno;
+    return ok;
+}
+
+/**
+ * @brief Read an edge list into a graph
+ *
+ * @param g Graph to be loaded
+ * @param in Stream to read from
+ * @param edgecount Set to the number of edges added; may be NULL
+ * @param errline Set to the line number of the first malformed line or failed insert, or 0; may be NULL
+ * @return 1 if the whole stream was read; otherwise, 0.
+ */
+int importEdgeList(struct graph_t *g, FILE *in, size_t *edgecount, size_t *errline) {
+    if (g == NULL || in == NULL) return 0;
+    struct edgebatch_t b;
+    size_t lineno = 0;
+    int retval = initBatch(&b, g) && streamLines(&g->allocator, in, edgeListLine, &b, &lineno) && flushBatch(&b);
+    if (!retval && b.errline == 0) b.errline = lineno;
+    if (edgecount != NULL) *edgecount = b.added;
+    if (errline != NULL) *errline = b.errline;
+    freeBatch(&b);
+    return retval;
+}
+
+/**
+ * @brief Read a DIMACS max-flow file into a graph
+ *
+ * @param g Graph to be loaded
+ * @param in Stream to read from
+ * @param source Set to the source node, or GRAPHIO_NONE; may be NULL
+ * @param sink Set to the sink node, or GRAPHIO_NONE; may be NULL
+ * @param edgecount Set to the number of edges added; may be NULL
+ * @param errline Set to the line number of the first malformed line or failed insert, or 0; may be NULL
+ * @return 1 if the whole stream was read; otherwise, 0.
+ */
+int importDimacs(struct graph_t *g, FILE *in, size_t *source, size_t *sink, size_t *edgecount, size_t *errline) {
+    if (g == NULL || in == NULL) return 0;
+    struct edgebatch_t b;
+    struct dimacsstate_t st = { &b, GRAPHIO_NONE, GRAPHIO_NONE, 0 };
+    size_t lineno = 0;
+    int retval = initBatch(&b, g) && streamLines(&g->allocator, in, dimacsLine, &st, &lineno) && flushBatch(&b);
+    if (!retval && b.errline == 0) b.errline = lineno;
+    if (source != NULL) *source = st.source;
+    if (sink != NULL) *sink = st.sink;
+    if (edgecount != NULL) *edgecount = b.added;
+    if (errline != NULL) *errline = b.errline;
+    freeBatch(&b);
+    return retval;
+}
+
+/**
+ * @brief Function called for each edge of a graph
+ * @return 1 to continue; 0 to stop with an error
+ */
+typedef int (*funcEdge)(size_t u, size_t v, double cap, void *ctx);
+
+/**
+ * @brief Visit every edge of an ARRAY, SHARED_MMAP, LINKED or HASHED graph
+ * @return 1 if every edge was visited; otherwise, 0.
+ */
+static int forEachEdge(const struct graph_t *g, funcEdge fn, void *ctx) {
+    if (isMmapGraph(g)) {
+        return mmapForEachEdge(g, fn, ctx);
+    }
+    if ((g->gtype & ARRAY) == ARRAY) {
+        const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+        const size_t *nodes = (const size_t *)g->nodeImpl;
+        const double *caparr = (const double *)g->capImpl;
+        if (meta == NULL || nodes == NULL || caparr == NULL) return 0;
+        for (size_t s = 0; s < meta->nodelen * meta->degree; s++) {
+            if (nodes[s] != 0 && !fn(s / meta->degree, nodes[s], caparr[s], ctx)) return 0;
+        }
+        return 1;
+    }
+    if ((g->gtype & (LINKED | HASHED)) != 0) {
+        for (const struct node_t *n = (const struct node_t *)g->nodeImpl; n != NULL; n = n->next) {
+            for (const struct edge_t *e = n->edges; e != NULL; e = e->next) {
+                if (!fn(e->u, e->v, e->cap, ctx)) return 0;
+            }
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Totals gathered before writing a DIMACS header
+ */
+struct dimacscount_t {
+    size_t arcs;
+    size_t maxid;
+    int undirected;
+};
+
+static int countEdge(size_t u, size_t v, double cap, void *ctx) {
+    struct dimacscount_t *c = (struct dimacscount_t *)ctx;
+    c->arcs += c->undirected ? 2 : 1;
+    if (u > c->maxid) c->maxid = u;
+    if (v > c->maxid) c->maxid = v;
+    return 1;
+}
+
+static int writeListEdge(size_t u, size_t v, double cap, void *ctx) {
+    return fprintf((FILE *)ctx, "%zu %zu %.17g\n", u, v, cap) > 0;
+}
+
+/**
+ * @brief Stream and direction for DIMACS arcs
+ */
+struct dimacswrite_t {
+    FILE *out;
+    int undirected;
+};
+
+static int writeArc(size_t u, size_t v, double cap, void *ctx) {
+    struct dimacswrite_t *w = (struct dimacswrite_t *)ctx;
+    //DIMACS ids start at 1
+    if (fprintf(w->out, "a %zu %zu %.17g\n", u + 1, v + 1, cap) <= 0) return 0;
+    return !w->undirected || fprintf(w->out, "a %zu %zu %.17g\n", v + 1, u + 1, cap) > 0;
+}
+
+/**
+ * @brief Write the edges of a graph as an edge list
+ *
+ * @param g Graph to be written (ARRAY, LINKED or HASHED)
+ * @param out Stream to write to
+ * @return 1 if successful; otherwise, 0.
+ */
+int exportEdgeList(const struct graph_t *g, FILE *out) {
+    if (g == NULL || out == NULL) return 0;
+    return forEachEdge(g, writeListEdge, out) && !ferror(out);
+}
+
+/**
+ * @brief Write the edges of a graph as a DIMACS max-flow file
+ *
+ * @param g Graph to be written (ARRAY, LINKED or HASHED)
+ * @param out Stream to write to
+ * @param source Source node
+ * @param sink Sink node
+ * @return 1 if successful; otherwise, 0.
+ */
+int exportDimacs(const struct graph_t *g, FILE *out, size_t source, size_t sink) {
+    if (g == NULL || out == NULL) return 0;
+    int undirected = ((g->gtype & DIRECTED) != DIRECTED);
+    struct dimacscount_t c = { 0, 0, undirected };
+    if (!forEachEdge(g, countEdge, &c)) return 0;
+    if (source > c.maxid) c.maxid = source;
+    if (sink > c.maxid) c.maxid = sink;
+    fprintf(out, "p max %zu %zu\nn %zu s\nn %zu t\n", c.maxid + 1, c.arcs, source + 1, sink + 1);
+    struct dimacswrite_t w = { out, undirected };
+    return forEachEdge(g, writeArc, &w) && !ferror(out);
+}
@@ -0,0 +1,531 @@
+/**
+ * @brief Per-graph operation statistics.
+ *
+ * Statistics are only kept when the library is built with GRAPHDATA_STATS; otherwise, STATS_ON graphs are created
+ * without them and getGraphStats() reports nothing.
+ */
+
+#include <util/graphstats.h>
+#include <util/crudops.h>
+#include <string.h>
+
+#ifdef GRAPHDATA_STATS
+#include <time.h>
+
+/**
+ * @brief Graphs per thread whose shards are remembered without searching the shard list
+ */
+#define STATS_TLS_CACHE 4
+
+/**
+ * @brief Counters recorded by one thread
+ */
+struct statsshard_t {
+    /**
+     * @brief Counters; only written by the owning thread
+     */
+    struct graphstats_t stats;
+    /**
+     * @brief Owning thread (the address of its probe counter)
+     */
+    const void *owner;
+    /**
+     * @brief Next shard of the graph
+     */
+    struct statsshard_t *next;
+};
+
+/**
+ * @brief Statistics bookkeeping of a graph
+ */
+struct statsstate_t {
+    /**
+     * @brief Process-unique id, so that thread caches never confuse a destroyed graph with a new one
+     */
+    uint64_t id;
+    /**
+     * @brief Shards, one per recording thread; pushed without locks
+     */
+    struct statsshard_t *shards;
+    /**
+     * @brief Unwrapped operations for the graph's implementation
+     */
+    struct graphops_t base;
+};
+
+/**
+ * @brief Thread cache entry: the shard of this thread for one graph
+ */
+struct statscache_t {
+    uint64_t id;
+    struct statsshard_t *shard;
+};
+
+static uint64_t nextStatsId = 0;
+
+static _Thread_local size_t tlsProbe = 0;
+static _Thread_local struct statscache_t tlsCache[STATS_TLS_CACHE];
+static _Thread_local size_t tlsCacheNext = 0;
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Find or create the calling thread's shard for a graph
+ * @param g Graph in question
+ * @return Shard of the calling thread, or NULL if one could not be allocated
+ */
+static struct statsshard_t * threadShard(const struct graph_t *g) {
+    struct statsstate_t *s = g->stats;
+    for (size_t i = 0; i < STATS_TLS_CACHE; i++) {
+        if (tlsCache[i].id == s->id && tlsCache[i].shard != NULL) return tlsCache[i].shard;
+    }
+    const void *owner = &tlsProbe;
+    struct statsshard_t *shard = __atomic_load_n(&s->shards, __ATOMIC_ACQUIRE);
+    while (shard != NULL && shard->owner != owner) shard = shard->next;
+    if (shard == NULL) {
+        shard = (struct statsshard_t *)graphAlloc(&g->allocator, sizeof(struct statsshard_t));
+        if (shard == NULL) return NULL;
+        memset(shard, 0, sizeof(struct statsshard_t));
+        shard->owner = owner;
+        shard->next = __atomic_load_n(&s->shards, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&s->shards, &shard->next, shard, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+    tlsCache[tlsCacheNext].id = s->id;
+    tlsCache[tlsCacheNext].shard = shard;
+    tlsCacheNext = (tlsCacheNext + 1) % STATS_TLS_CACHE;
+    return shard;
+}
+
+/**
+ * @brief Histogram bucket of a latency
+ * @param ns Latency in nanoseconds
+ * @return Bucket index
+ */
+static size_t bucketOf(uint64_t ns) {
+    if (ns < ((uint64_t)1 << STATS_SUB_BITS)) return (size_t)ns;
+    size_t exp = 63 - (size_t)__builtin_clzll(ns);
+    if (exp > STATS_MAX_EXP) return STATS_OVERFLOW_BUCKET;
+    size_t sub = (size_t)(ns >> (exp - STATS_SUB_BITS)) & (((size_t)1 << STATS_SUB_BITS) - 1);
+    return ((exp - STATS_SUB_BITS + 1) << STATS_SUB_BITS) + sub;
+}
+
+/**
+ * @brief Add to a counter owned by the calling thread, so that readers never see a torn value
+ */
+static void bump(uint64_t *counter, uint64_t by) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + by, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Start timing an operation
+ * @param saved Set to the probe length of any enclosing operation
+ * @return Start time
+ */
+static uint64_t statsBegin(size_t *saved) {
+    *saved = tlsProbe;
+    tlsProbe = 0;
+    return nowNs();
+}
+
+/**
+ * @brief Record a finished operation
+ * @param g Graph in question
+ * @param op Operation
+ * @param start Start time from statsBegin()
+ * @param saved Probe length saved by statsBegin()
+ */
+static void statsEnd(const struct graph_t *g, enum GRAPHSTATOP op, uint64_t start, size_t saved) {
+    uint64_t ns = nowNs() - start;
+    size_t probes = tlsProbe;
+    tlsProbe = saved + probes;
+    struct statsshard_t *shard = threadShard(g);
+    if (shard != NULL) {
+        struct opstats_t *o = &shard->stats.ops[op];
+        bump(&o->calls, 1);
+        bump(&o->totalns, ns);
+        bump(&o->hist[bucketOf(ns)], 1);
+        if (probes > 0) {
+            bump(&o->probes, probes);
+            if (probes > o->maxprobe) __atomic_store_n(&o->maxprobe, (uint64_t)probes, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/*
+ * Recording wrappers, one per graphops_t entry.  Each times the unwrapped operation and records it in the calling
+ * thread's shard.
+ */
+
+static size_t statsNodeCount(struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    size_t count = g->stats->base.nodeCount(g);
+    statsEnd(g, STATOP_NODECOUNT, start, saved);
+    return count;
+}
+
+static size_t statsEdgeCount(struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    size_t count = g->stats->base.edgeCount(g);
+    statsEnd(g, STATOP_EDGECOUNT, start, saved);
+    return count;
+}
+
+static struct node_t * statsGetNode(const size_t *nodeid, const struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    struct node_t *n = g->stats->base.getNode(nodeid, g);
+    statsEnd(g, STATOP_GETNODE, start, saved);
+    return n;
+}
+
+static struct edge_t * statsGetEdge(const size_t *u, const size_t *v, const struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    struct edge_t *e = g->stats->base.getEdge(u, v, g);
+    statsEnd(g, STATOP_GETEDGE, start, saved);
+    return e;
+}
+
+static struct node_t * statsGetNeighbors(const size_t *nodeid, const struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    struct node_t *n = g->stats->base.getNeighbors(nodeid, g);
+    statsEnd(g, STATOP_GETNEIGHBORS, start, saved);
+    return n;
+}
+
+static struct edge_t * statsGetEdges(const size_t *nodeid, const struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    struct edge_t *e = g->stats->base.getEdges(nodeid, g);
+    statsEnd(g, STATOP_GETEDGES, start, saved);
+    return e;
+}
+
+static int statsGetCapacity(const size_t *uid, const size_t *vid, double *cap, const struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.getCapacity(uid, vid, cap, g);
+    statsEnd(g, STATOP_GETCAPACITY, start, saved);
+    return retval;
+}
+
+static int statsGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.getFlow(uid, vid, flow, g);
+    statsEnd(g, STATOP_GETFLOW, start, saved);
+    return retval;
+}
+
+static int statsAddNode(const size_t *nodeid, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.addNode(nodeid, g);
+    statsEnd(g, STATOP_ADDNODE, start, saved);
+    return retval;
+}
+
+static int statsRemoveNode(const size_t *nodeid, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.removeNode(nodeid, g);
+    statsEnd(g, STATOP_REMOVENODE, start, saved);
+    return retval;
+}
+
+static int statsAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.addEdge(uid, vid, cap, g);
+    statsEnd(g, STATOP_ADDEDGE, start, saved);
+    return retval;
+}
+
+static int statsRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.removeEdge(uid, vid, g);
+    statsEnd(g, STATOP_REMOVEEDGE, start, saved);
+    return retval;
+}
+
+static int statsSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.setCapacity(uid, vid, cap, g);
+    statsEnd(g, STATOP_SETCAPACITY, start, saved);
+    return retval;
+}
+
+static int statsAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.addCapacity(uid, vid, cap, g);
+    statsEnd(g, STATOP_ADDCAPACITY, start, saved);
+    return retval;
+}
+
+static int statsSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.setFlow(uid, vid, flow, g);
+    statsEnd(g, STATOP_SETFLOW, start, saved);
+    return retval;
+}
+
+static int statsAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.addFlow(uid, vid, flow, g);
+    statsEnd(g, STATOP_ADDFLOW, start, saved);
+    return retval;
+}
+
+static int statsAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.atomicAddCapacity(uid, vid, cap, g);
+    statsEnd(g, STATOP_ATOMICADDCAPACITY, start, saved);
+    return retval;
+}
+
+static int statsAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.atomicAddFlow(uid, vid, flow, g);
+    statsEnd(g, STATOP_ATOMICADDFLOW, start, saved);
+    return retval;
+}
+
+static int statsResetGraph(struct graph_t *g, void *args, void (*callback)(void)) {
+    size_t saved;
+    uint64_t start = statsBegin(&saved);
+    int retval = g->stats->base.resetGraph(g, args, callback);
+    statsEnd(g, STATOP_RESETGRAPH, start, saved);
+    return retval;
+}
+#endif
+
+/**
+ * @brief Add up the statistics of a graph.
+ *
+ * @param g Graph in question
+ * @param stats Set to the totals over all threads
+ * @return 1 if successful; 0 if the graph keeps no statistics (including builds without GRAPHDATA_STATS).
+ */
+int getGraphStats(const struct graph_t *g, struct graphstats_t *stats) {
+    int retval = 0;
+#ifdef GRAPHDATA_STATS
+    if (g != NULL && g->stats != NULL && stats != NULL) {
+        memset(stats, 0, sizeof(struct graphstats_t));
+        struct statsshard_t *shard = __atomic_load_n(&g->stats->shards, __ATOMIC_ACQUIRE);
+        for (; shard != NULL; shard = shard->next) {
+            for (size_t op = 0; op < STATOP_COUNT; op++) {
+                const struct opstats_t *from = &shard->stats.ops[op];
+                struct opstats_t *to = &stats->ops[op];
+                to->calls += __atomic_load_n(&from->calls, __ATOMIC_RELAXED);
+                to->probes += __atomic_load_n(&from->probes, __ATOMIC_RELAXED);
+                to->totalns += __atomic_load_n(&from->totalns, __ATOMIC_RELAXED);
+                uint64_t maxprobe = __atomic_load_n(&from->maxprobe, __ATOMIC_RELAXED);
+                if (maxprobe > to->maxprobe) to->maxprobe = maxprobe;
+                for (size_t b = 0; b < STATS_BUCKETS; b++) to->hist[b] += __atomic_load_n(&from->hist[b], __ATOMIC_RELAXED);
+            }
+        }
+        retval = 1;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Zero the statistics of a graph.
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if the graph keeps no statistics.
+ */
+int resetGraphStats(struct graph_t *g) {
+    int retval = 0;
+#ifdef GRAPHDATA_STATS
+    if (g != NULL && g->stats != NULL) {
+        struct statsshard_t *shard = __atomic_load_n(&g->stats->shards, __ATOMIC_ACQUIRE);
+        for (; shard != NULL; shard = shard->next) {
+            uint64_t *counters = (uint64_t *)&shard->stats;
+            for (size_t i = 0; i < sizeof(struct graphstats_t) / sizeof(uint64_t); i++) {
+                __atomic_store_n(&counters[i], 0, __ATOMIC_RELAXED);
+            }
+        }
+        retval = 1;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Name of an operation, as used in reports
+ * @param op Operation
+ * @return Name of the operation, or NULL if the operation is not valid
+ */
+const char * graphStatOpName(enum GRAPHSTATOP op) {
+    static const char *names[STATOP_COUNT] = {
+            "nodeCount", "edgeCount", "getNode", "getEdge", "getNeighbors", "getEdges", "getCapacity", "getFlow",
+            "addNode", "removeNode", "addEdge", "removeEdge", "setCapacity", "addCapacity", "setFlow", "addFlow",
+            "atomicAddCapacity", "atomicAddFlow", "resetGraph"
+    };
+    return ((size_t)op < STATOP_COUNT) ? names[op] : NULL;
+}
+
+/**
+ * @brief Largest latency counted in a histogram bucket
+ *
+ * Latencies below 2^STATS_SUB_BITS ns have a bucket each; above that, every power of two is split into
+ * 2^STATS_SUB_BITS equal buckets, for a relative error of at most 1/2^STATS_SUB_BITS.
+ *
+ * @param bucket Bucket index
+ * @return Upper limit of the bucket, in nanoseconds (UINT64_MAX for STATS_OVERFLOW_BUCKET)
+ */
+uint64_t graphStatsBucketLimit(size_t bucket) {
+    if (bucket < ((size_t)1 << STATS_SUB_BITS)) return (uint64_t)bucket;
+    if (bucket >= STATS_OVERFLOW_BUCKET) return UINT64_MAX;
+    size_t shift = (bucket >> STATS_SUB_BITS) - 1;
+    uint64_t sub = (uint64_t)(bucket & (((size_t)1 << STATS_SUB_BITS) - 1));
+    uint64_t lower = (((uint64_t)1 << STATS_SUB_BITS) + sub) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+/**
+ * @brief Estimate a latency percentile from a histogram
+ * @param op Operation statistics
+ * @param pct Percentile (0-100)
+ * @return Upper limit of the bucket holding the percentile, in nanoseconds; 0 if there were no calls.
+ */
+uint64_t graphStatsPercentile(const struct opstats_t *op, double pct) {
+    uint64_t total = 0;
+    if (op == NULL) return 0;
+    for (size_t b = 0; b < STATS_BUCKETS; b++) total += op->hist[b];
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(pct / 100.0 * (double)total + 0.5);
+    if (rank == 0) rank = 1;
+    if (rank > total) rank = total;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < STATS_BUCKETS; b++) {
+        seen += op->hist[b];
+        if (seen >= rank) return graphStatsBucketLimit(b);
+    }
+    return UINT64_MAX;
+}
+
+/**
+ * @brief Create the statistics bookkeeping of a graph, according to its configuration.
+ *
+ * @param g Graph in question
+ * @return 1 if successful, or if the build has no statistics; 0 if the bookkeeping could not be created.
+ */
+int graphStatsInit(struct graph_t *g) {
+    int retval = (g != NULL);
+#ifdef GRAPHDATA_STATS
+    if (g != NULL && g->stats == NULL) {
+        struct statsstate_t *s = (struct statsstate_t *)graphAlloc(&g->allocator, sizeof(struct statsstate_t));
+        if (s == NULL) return 0;
+        memset(s, 0, sizeof(struct statsstate_t));
+        s->id = __atomic_add_fetch(&nextStatsId, 1, __ATOMIC_RELAXED);
+        g->stats = s;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Replace the operations of a graph with recording wrappers.
+ *
+ * @param gops Operations structure for a graph with statistics
+ * @return 1 if successful; 0 if the graph keeps no statistics.
+ */
+int graphStatsWrap(struct graphops_t *gops) {
+    int retval = 0;
+#ifdef GRAPHDATA_STATS
+    if (gops != NULL && gops->g != NULL && gops->g->stats != NULL) {
+        gops->g->stats->base = *gops;
+        if (gops->nodeCount != NULL) gops->nodeCount = statsNodeCount;
+        if (gops->edgeCount != NULL) gops->edgeCount = statsEdgeCount;
+        if (gops->getNode != NULL) gops->getNode = statsGetNode;
+        if (gops->getEdge != NULL) gops->getEdge = statsGetEdge;
+        if (gops->getNeighbors != NULL) gops->getNeighbors = statsGetNeighbors;
+        if (gops->getEdges != NULL) gops->getEdges = statsGetEdges;
+        if (gops->getCapacity != NULL) gops->getCapacity = statsGetCapacity;
+        if (gops->getFlow != NULL) gops->getFlow = statsGetFlow;
+        if (gops->addNode != NULL) gops->addNode = statsAddNode;
+        if (gops->removeNode != NULL) gops->removeNode = statsRemoveNode;
+        if (gops->addEdge != NULL) gops->addEdge = statsAddEdge;
+        if (gops->removeEdge != NULL) gops->removeEdge = statsRemoveEdge;
+        if (gops->setCapacity != NULL) gops->setCapacity = statsSetCapacity;
+        if (gops->addCapacity != NULL) gops->addCapacity = statsAddCapacity;
+        if (gops->setFlow != NULL) gops->setFlow = statsSetFlow;
+        if (gops->addFlow != NULL) gops->addFlow = statsAddFlow;
+        if (gops->atomicAddCapacity != NULL) gops->atomicAddCapacity = statsAtomicAddCapacity;
+        if (gops->atomicAddFlow != NULL) gops->atomicAddFlow = statsAtomicAddFlow;
+        if (gops->resetGraph != NULL) gops->resetGraph = statsResetGraph;
+        retval = 1;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Clear out the statistics bookkeeping of a graph
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if there was no bookkeeping.
+ */
+int destroyGraphStats(struct graph_t *g) {
+    int retval = 0;
+#ifdef GRAPHDATA_STATS
+    if (g != NULL && g->stats != NULL) {
+        struct statsshard_t *shard = g->stats->shards;
+        while (shard != NULL) {
+            struct statsshard_t *next = shard->next;
+            graphFree(&g->allocator, shard, sizeof(struct statsshard_t));
+            shard = next;
+        }
+        graphFree(&g->allocator, g->stats, sizeof(struct statsstate_t));
+        g->stats = NULL;
+        retval = 1;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Memory held by the statistics bookkeeping of a graph, including every thread's shard
+ * @param g Graph in question
+ * @return Size in bytes; 0 if the graph keeps no statistics.
+ */
+size_t graphStatsMemory(const struct graph_t *g) {
+    size_t bytes = 0;
+#ifdef GRAPHDATA_STATS
+    if (g != NULL && g->stats != NULL) {
+        bytes = sizeof(struct statsstate_t);
+        struct statsshard_t *shard = __atomic_load_n(&g->stats->shards, __ATOMIC_ACQUIRE);
+        for (; shard != NULL; shard = shard->next) bytes += sizeof(struct statsshard_t);
+    }
+#endif
+    return bytes;
+}
+
+/**
+ * @brief Add to the probe length of the operation running on this thread.
+ * @param depth Slots or list nodes examined
+ */
+void graphStatsProbe(size_t depth) {
+#ifdef GRAPHDATA_STATS
+    tlsProbe += depth;
+#else
+    (void)depth;
+#endif
+}
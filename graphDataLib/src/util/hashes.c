@@ -9,6 +9,7 @@
 #include <util/hashes.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #undef get16bits
@@ -68,39 +69,357 @@ size_t SuperFastHash (const char * data, int len) {
 }
 
 /**
- * @brief Using the Sieve of Eratosthenes, calculate the max prime value below the given value
+ * @brief Mixing constants for WyHash64()
+ */
+static const uint64_t wyp[4] = { 0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+                                 0x4d5a2da51de1aa47ULL };
+
+/**
+ * @brief Number of keys hashed together by WyHash64Batch()
+ */
+#define HASH_BATCH_LANES 4
+
+/**
+ * @brief 64x64->128 bit multiply, leaving the low half in *a and the high half in *b
+ */
+static inline void wymum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+/**
+ * @brief Multiply and fold to 64 bits
+ */
+static inline uint64_t wymix(uint64_t a, uint64_t b) {
+    wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyr8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wyr4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t wyr3(const uint8_t *p, size_t k) {
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+/**
+ * @brief Load the two input words of a key of 16 bytes or less
+ * @param p Key data
+ * @param len Key length (1 to 16)
+ * @param a Set to the first word
+ * @param b Set to the second word
+ */
+static inline void wyshort(const uint8_t *p, size_t len, uint64_t *a, uint64_t *b) {
+    if (len >= 4) {
+        *a = (wyr4(p) << 32) | wyr4(p + ((len >> 3) << 2));
+        *b = (wyr4(p + len - 4) << 32) | wyr4(p + len - 4 - ((len >> 3) << 2));
+    } else {
+        *a = wyr3(p, len);
+        *b = 0;
+    }
+}
+
+/**
+ * @brief Final mixing round
+ */
+static inline uint64_t wyfinal(uint64_t a, uint64_t b, uint64_t seed, size_t len) {
+    a ^= wyp[1];
+    b ^= seed;
+    wymum(&a, &b);
+    return wymix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
+/**
+ * @brief Calculate a 64-bit hash of the char data.
  *
- * Quick and dirty (not necessarily computationally quick) way to get the max prime number below the given
- * value.
+ * @param data character data to be hashed
+ * @param len Length of the character data
+ * @param seed Hash seed
+ * @return hash value of the character data, if not null and not empty; otherwise, zero.
+ */
+uint64_t WyHash64(const char *data, size_t len, uint64_t seed) {
+    if (data == NULL || len == 0) return 0;
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t a, b;
+    seed ^= wymix(seed ^ wyp[0], wyp[1]);
+    if (len <= 16) {
+        wyshort(p, len, &a, &b);
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ wyp[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ wyp[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+    return wyfinal(a, b, seed, len);
+}
+
+/**
+ * @brief Calculate the 64-bit hashes of a batch of keys.
  *
- * Implementation based off example code at https://www.programminglogic.com/the-sieve-of-eratosthenes-implemented-in-c/
+ * Short keys (the common case for node and feature labels) are handled a group at a time: the loads, seed mixing and
+ * final rounds of each group are separate loops over independent lanes, which the compiler can unroll or vectorize.
+ * Long keys fall back to WyHash64().
  *
- * @param idx Size value to search the max prime number below
- * @return Prime number within the range given by the input, if successful; otherwise, returns 0
+ * @param keys Array of n key pointers (entries may be NULL)
+ * @param lens Array of n key lengths
+ * @param n Number of keys
+ * @param seed Hash seed
+ * @param out Array of n hashes to be filled
  */
-size_t maxEratosthenesPrime(size_t *idx) {
-    size_t mprime = 0;
-    size_t plen = *idx;
-    char *sieve = (char *)malloc(plen * sizeof(size_t));
-    if (sieve != NULL) {
-        //mark as possible
-        for (size_t i=2;i<plen;i++) *(sieve + i) = 1;
-
-        for (size_t i=2;i<plen;i++) {
-            if (sieve[i]) {
-                for (size_t j = i;i*j<plen;j++) {
-                    sieve[i*j] = 0;
-                }
-            }
+void WyHash64Batch(const char *const *keys, const size_t *lens, size_t n, uint64_t seed, uint64_t *out) {
+    if (keys == NULL || lens == NULL || out == NULL) return;
+    uint64_t lseed = seed ^ wymix(seed ^ wyp[0], wyp[1]);
+    size_t i = 0;
+    for (; i + HASH_BATCH_LANES <= n; i += HASH_BATCH_LANES) {
+        int shortkeys = 1;
+        for (size_t l = 0; l < HASH_BATCH_LANES; l++) {
+            if (keys[i + l] == NULL || lens[i + l] == 0 || lens[i + l] > 16) shortkeys = 0;
+        }
+        if (!shortkeys) {
+            for (size_t l = 0; l < HASH_BATCH_LANES; l++) out[i + l] = WyHash64(keys[i + l], lens[i + l], seed);
+            continue;
+        }
+        uint64_t a[HASH_BATCH_LANES], b[HASH_BATCH_LANES];
+        for (size_t l = 0; l < HASH_BATCH_LANES; l++) {
+            wyshort((const uint8_t *)keys[i + l], lens[i + l], a + l, b + l);
+        }
+        for (size_t l = 0; l < HASH_BATCH_LANES; l++) {
+            out[i + l] = wyfinal(a[l], b[l], lseed, lens[i + l]);
+        }
+    }
+    for (; i < n; i++) out[i] = WyHash64(keys[i], lens[i], seed);
+}
+
+/**
+ * @brief Largest prime below 2^k, for k from 2 to 64, written as 2^k - d
+ *
+ * PRIME_BELOW_POW2(k, d) gives 2^k - d without shifting past the width of the type.  Each entry is checked by the hash
+ * unit tests to be prime, with no prime between it and 2^k.
+ */
+#define PRIME_BELOW_POW2(k, d) ((UINT64_MAX >> (64 - (k))) - ((d) - 1))
+
+static const uint64_t pow2primes[] = {
+    PRIME_BELOW_POW2(2, 1),   PRIME_BELOW_POW2(3, 1),   PRIME_BELOW_POW2(4, 3),   PRIME_BELOW_POW2(5, 1),
+    PRIME_BELOW_POW2(6, 3),   PRIME_BELOW_POW2(7, 1),   PRIME_BELOW_POW2(8, 5),   PRIME_BELOW_POW2(9, 3),
+    PRIME_BELOW_POW2(10, 3),  PRIME_BELOW_POW2(11, 9),  PRIME_BELOW_POW2(12, 3),  PRIME_BELOW_POW2(13, 1),
+    PRIME_BELOW_POW2(14, 3),  PRIME_BELOW_POW2(15, 19), PRIME_BELOW_POW2(16, 15), PRIME_BELOW_POW2(17, 1),
+    PRIME_BELOW_POW2(18, 5),  PRIME_BELOW_POW2(19, 1),  PRIME_BELOW_POW2(20, 3),  PRIME_BELOW_POW2(21, 9),
+    PRIME_BELOW_POW2(22, 3),  PRIME_BELOW_POW2(23, 15), PRIME_BELOW_POW2(24, 3),  PRIME_BELOW_POW2(25, 39),
+    PRIME_BELOW_POW2(26, 5),  PRIME_BELOW_POW2(27, 39), PRIME_BELOW_POW2(28, 57), PRIME_BELOW_POW2(29, 3),
+    PRIME_BELOW_POW2(30, 35), PRIME_BELOW_POW2(31, 1),  PRIME_BELOW_POW2(32, 5),  PRIME_BELOW_POW2(33, 9),
+    PRIME_BELOW_POW2(34, 41), PRIME_BELOW_POW2(35, 31), PRIME_BELOW_POW2(36, 5),  PRIME_BELOW_POW2(37, 25),
+    PRIME_BELOW_POW2(38, 45), PRIME_BELOW_POW2(39, 7),  PRIME_BELOW_POW2(40, 87), PRIME_BELOW_POW2(41, 21),
+    PRIME_BELOW_POW2(42, 11), PRIME_BELOW_POW2(43, 57), PRIME_BELOW_POW2(44, 17), PRIME_BELOW_POW2(45, 55),
+    PRIME_BELOW_POW2(46, 21), PRIME_BELOW_POW2(47, 115), PRIME_BELOW_POW2(48, 59), PRIME_BELOW_POW2(49, 81),
+    PRIME_BELOW_POW2(50, 27), PRIME_BELOW_POW2(51, 129), PRIME_BELOW_POW2(52, 47), PRIME_BELOW_POW2(53, 111),
+    PRIME_BELOW_POW2(54, 33), PRIME_BELOW_POW2(55, 55), PRIME_BELOW_POW2(56, 5),  PRIME_BELOW_POW2(57, 13),
+    PRIME_BELOW_POW2(58, 27), PRIME_BELOW_POW2(59, 55), PRIME_BELOW_POW2(60, 93), PRIME_BELOW_POW2(61, 1),
+    PRIME_BELOW_POW2(62, 57), PRIME_BELOW_POW2(63, 25), PRIME_BELOW_POW2(64, 59)
+};
+
+/**
+ * @brief Size of each segmented sieve window
+ */
+#define PRIME_SEGMENT 4096
+
+/**
+ * @brief Largest value searched with the segmented sieve; base primes up to 2^16 (64 KB of flags) are sieved for it.
+ */
+#define PRIME_SIEVE_LIMIT ((uint64_t)1 << 32)
+
+/**
+ * @brief (a * b) mod m without overflow
+ */
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t m) {
+#if defined(__SIZEOF_INT128__)
+    return (uint64_t)(((__uint128_t)a * b) % m);
+#else
+    uint64_t r = 0;
+    a %= m;
+    while (b > 0) {
+        if (b & 1) r = (r >= m - a) ? r - (m - a) : r + a;
+        a = (a >= m - a) ? a - (m - a) : a + a;
+        b >>= 1;
+    }
+    return r;
+#endif
+}
+
+/**
+ * @brief (b ^ e) mod m
+ */
+static uint64_t powMod(uint64_t b, uint64_t e, uint64_t m) {
+    uint64_t r = 1;
+    b %= m;
+    while (e > 0) {
+        if (e & 1) r = mulMod(r, b, m);
+        b = mulMod(b, b, m);
+        e >>= 1;
+    }
+    return r;
+}
+
+/**
+ * @brief Deterministic primality test
+ *
+ * The first twelve primes as Miller-Rabin bases give an exact answer for every 64-bit value.
+ *
+ * @param n Value to be tested
+ * @return 1 if n is prime; otherwise, 0.
+ */
+int isPrime(size_t n) {
+    static const uint64_t bases[12] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    if (n < 2) return 0;
+    for (int i = 0; i < 12; i++) {
+        if (n % bases[i] == 0) return n == bases[i];
+    }
+    uint64_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+    for (int i = 0; i < 12; i++) {
+        uint64_t x = powMod(bases[i], d, n);
+        if (x == 1 || x == n - 1) continue;
+        int composite = 1;
+        for (int r = 1; r < s && composite; r++) {
+            x = mulMod(x, x, n);
+            if (x == n - 1) composite = 0;
         }
+        if (composite) return 0;
+    }
+    return 1;
+}
 
-        //scan for max
-        size_t ppos = 0;
-        for (size_t i=0;i<plen;i++) {
-            if (sieve[i] > 0) ppos = i;
+/**
+ * @brief Integer square root
+ */
+static uint64_t isqrt64(uint64_t n) {
+    uint64_t r = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > n) bit >>= 2;
+    while (bit != 0) {
+        if (n >= r + bit) {
+            n -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
         }
-        mprime = ppos;
+        bit >>= 2;
     }
-    free(sieve);
-    return mprime;
-}
\ No newline at end of file
+    return r;
+}
+
+/**
+ * @brief Calculate the max prime value below the given value
+ *
+ * @param idx Value to search the max prime number below
+ * @return Largest prime strictly less than idx, if there is one; otherwise 0
+ */
+size_t maxPrimeBelow(size_t idx) {
+    if (idx <= 2) return 0;
+    if ((uint64_t)idx > PRIME_SIEVE_LIMIT) {
+        //prime gaps are tiny next to idx, so a downward walk over odd candidates ends quickly
+        size_t c = idx - 1;
+        if ((c & 1) == 0) c--;
+        while (c > 2 && !isPrime(c)) c -= 2;
+        return c;
+    }
+    //base primes up to sqrt(idx - 1)
+    size_t root = (size_t)isqrt64(idx - 1);
+    char *base = (char *)malloc(root + 1);
+    char window[PRIME_SEGMENT];
+    size_t found = 0;
+    if (base == NULL) return 0;
+    memset(base, 1, root + 1);
+    for (size_t i = 2; i * i <= root; i++) {
+        if (base[i]) {
+            for (size_t j = i * i; j <= root; j += i) base[j] = 0;
+        }
+    }
+    size_t hi = idx;
+    while (found == 0 && hi > 2) {
+        size_t lo = (hi > PRIME_SEGMENT + 2) ? hi - PRIME_SEGMENT : 2;
+        memset(window, 1, hi - lo);
+        for (size_t p = 2; p <= root && p * p < hi; p++) {
+            if (!base[p]) continue;
+            size_t start = ((lo + p - 1) / p) * p;
+            if (start < p * p) start = p * p;
+            for (size_t j = start; j < hi; j += p) window[j - lo] = 0;
+        }
+        for (size_t j = hi; j > lo; j--) {
+            if (window[j - 1 - lo]) {
+                found = j - 1;
+                break;
+            }
+        }
+        hi = lo;
+    }
+    free(base);
+    return found;
+}
+
+/**
+ * @brief Choose a prime bucket count for a hash table of at least the given size
+ *
+ * @param minsize Minimum number of buckets
+ * @return Smallest tabled prime that is at least minsize, or 0 if minsize is beyond the table
+ */
+size_t primeTableSize(size_t minsize) {
+    size_t count = sizeof(pow2primes) / sizeof(pow2primes[0]);
+    for (size_t i = 0; i < count; i++) {
+        if (pow2primes[i] > (uint64_t)SIZE_MAX) break;
+        if (pow2primes[i] >= (uint64_t)minsize) return (size_t)pow2primes[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief Using the Sieve of Eratosthenes, calculate the max prime value below the given value
+ *
+ * Kept for existing callers; the work is done by maxPrimeBelow(), which sieves a small window at a time instead of
+ * the whole range.
+ *
+ * @param idx Size value to search the max prime number below
+ * @return Prime number within the range given by the input, if successful; otherwise, returns 0
+ */
+size_t maxEratosthenesPrime(size_t *idx) {
+    return (idx != NULL) ? maxPrimeBelow(*idx) : 0;
+}
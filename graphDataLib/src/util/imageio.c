@@ -0,0 +1,283 @@
+/**
+ * @brief Image and volume ingestion into SPATIAL ARRAY graphs.
+ */
+
+#include <util/imageio.h>
+#include <util/crudops.h>
+#include <util/cartesian.h>
+#include <impl/arraygraph.h>
+#include <graphInit.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Bytes of sample data converted at a time
+ */
+#define IMAGEIO_CHUNK 65536
+
+/**
+ * @brief Store the squared intensity distance between two nodes in an edge slot
+ * @param nodes Node slots of the graph
+ * @param caparr Capacity slots of the graph
+ * @param s Slot to be set
+ * @param ip Samples of the starting node
+ * @param q Ending node
+ * @param iq Samples of the ending node
+ * @param channels Samples per node
+ */
+static inline void stencilSlot(size_t *nodes, double *caparr, size_t s, const double *ip, size_t q, const double *iq,
+                               size_t channels) {
+    double dist2 = 0.0;
+    for (size_t c = 0; c < channels; c++) {
+        double diff = ip[c] - iq[c];
+        dist2 += diff * diff;
+    }
+    nodes[s] = q;
+    caparr[s] = dist2;
+}
+
+/**
+ * @brief Compute the grid stencil of a SPATIAL ARRAY graph with boundary-term capacities.
+ *
+ * The stencil pass walks the nodes in index order, keeping the coordinates as an odometer instead of dividing, and
+ * stores the squared intensity distance of each edge.  Grids with Morton or tiled ids are walked the same way, with
+ * the neighbors found by cartesianStep() and the unused ids left without edges.  A second, branch-free pass over the
+ * contiguous capacity array turns the distances into weights.
+ *
+ * @param g UNDIRECTED ARRAY graph with dimensions
+ * @param intensity Sample values, node-major and channel-interleaved
+ * @param channels Samples per node
+ * @param sigma Intensity scale of the boundary term; must be positive
+ * @return 1 if successful; otherwise, 0.
+ */
+int arrayBoundaryWeights(struct graph_t *g, const double *intensity, size_t channels, double sigma) {
+    if (g == NULL || intensity == NULL || channels == 0 || !(sigma > 0.0)) return 0;
+    if ((g->gtype & ARRAY) != ARRAY || (g->gtype & DIRECTED) == DIRECTED || g->dims == NULL) return 0;
+    struct arraydata_t *meta = (struct arraydata_t *)g->metaImpl;
+    if (meta == NULL || meta->topology != NULL || g->nodeImpl == NULL || g->capImpl == NULL) return 0;
+    //the node array is rewritten, so no structure-only clone may share it
+    if (__atomic_load_n(&meta->clones, __ATOMIC_ACQUIRE) > 0) return 0;
+    struct dimensions_t *dims = g->dims;
+    size_t d = dims->dimcount;
+    size_t n = cartesianIndexLength(g->dims);
+    if (d != meta->degree || n > meta->nodelen) return 0;
+
+    size_t *stride = (size_t *)graphAlloc(&g->allocator, 2 * d * sizeof(size_t));
+    if (stride == NULL) return 0;
+    size_t *coords = stride + d;
+    stride[0] = 1;
+    for (size_t k = 1; k < d; k++) stride[k] = stride[k - 1] * dims->dimarr[k - 1];
+    memset(coords, 0, d * sizeof(size_t));
+
+    size_t *nodes = (size_t *)g->nodeImpl;
+    double *caparr = (double *)g->capImpl;
+    for (size_t p = 0; p < n; p++) {
+        const double *ip = intensity + p * channels;
+        for (size_t k = 0; k < d; k++) {
+            size_t s = p * d + k;
+            size_t q = 0;
+            int inside = (dims->order == ORDER_ROWMAJOR) ? coords[k] + 1 < dims->dimarr[k]
+                                                         : cartesianStep(dims, &p, k, &q) == 0;
+            if (inside) {
+                if (dims->order == ORDER_ROWMAJOR) q = p + stride[k];
+                stencilSlot(nodes, caparr, s, ip, q, intensity + q * channels, channels);
+            } else {
+                nodes[s] = 0;
+                caparr[s] = 0.0;
+            }
+        }
+        for (size_t k = 0; k < d && ++coords[k] == dims->dimarr[k]; k++) coords[k] = 0;
+    }
+    graphFree(&g->allocator, stride, 2 * d * sizeof(size_t));
+
+    double scale = -1.0 / (2.0 * sigma * sigma);
+    for (size_t s = 0; s < n * d; s++) {
+        //empty slots hold 0 capacity; multiplying by the occupancy avoids a branch per slot
+        caparr[s] = exp(caparr[s] * scale) * (double)(nodes[s] != 0);
+    }
+    if (g->flowImpl != NULL) memset(g->flowImpl, 0, n * d * sizeof(double));
+    return 1;
+}
+
+/**
+ * @brief Number of samples in an image, checking that the sample buffer size fits in a size_t
+ * @param width Samples along x
+ * @param height Samples along y
+ * @param depth Samples along z (1 for images)
+ * @param channels Samples per node
+ * @param count Set to width * height * depth * channels
+ * @return 1 if the count and its buffer size fit; 0 if the product overflows.
+ */
+static int sampleCount(size_t width, size_t height, size_t depth, size_t channels, size_t *count) {
+    size_t limit = SIZE_MAX / sizeof(double);
+    if (height > limit / width) return 0;
+    size_t n = width * height;
+    if (depth > limit / n) return 0;
+    n *= depth;
+    if (channels > limit / n) return 0;
+    *count = n * channels;
+    return 1;
+}
+
+/**
+ * @brief Set up an image graph of the given size, with room for the samples
+ */
+static struct imagegraph_t * initImageGraph(struct dimensions_t *dims, size_t channels, size_t maxval) {
+    if (dims == NULL) return NULL;
+    struct imagegraph_t *ig = (struct imagegraph_t *)calloc(1, sizeof(struct imagegraph_t));
+    if (ig == NULL) {
+        destroyDimensions((void **)&dims);
+        return NULL;
+    }
+    ig->dims = dims;
+    ig->channels = channels;
+    ig->maxval = maxval;
+    ig->g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    if (ig->g != NULL) {
+        ig->intensity = (double *)graphAlloc(&ig->g->allocator,
+                                             cartesianIndexLength(dims) * channels * sizeof(double));
+    }
+    if (ig->g == NULL || ig->intensity == NULL) destroyImageGraph((void **)&ig);
+    return ig;
+}
+
+/**
+ * @brief Read samples in fixed-size chunks and convert them to doubles
+ * @param in Stream positioned at the first sample
+ * @param out Destination
+ * @param count Number of samples
+ * @param bytesper Bytes per sample (1 or 2)
+ * @param bigendian Nonzero for most-significant-byte-first 16-bit samples
+ * @return 1 if every sample was read; otherwise, 0.
+ */
+static int readSamples(FILE *in, double *out, size_t count, size_t bytesper, int bigendian) {
+    unsigned char buf[IMAGEIO_CHUNK];
+    size_t per = IMAGEIO_CHUNK / bytesper;
+    while (count > 0) {
+        size_t want = count < per ? count : per;
+        if (fread(buf, bytesper, want, in) != want) return 0;
+        if (bytesper == 1) {
+            for (size_t i = 0; i < want; i++) out[i] = (double)buf[i];
+        } else {
+            size_t hi = bigendian ? 0 : 1;
+            for (size_t i = 0; i < want; i++) {
+                out[i] = (double)(((unsigned)buf[2 * i + hi] << 8) | buf[2 * i + (1 - hi)]);
+            }
+        }
+        out += want;
+        count -= want;
+    }
+    return 1;
+}
+
+/**
+ * @brief Read an unsigned number from a PNM header or ASCII raster, skipping whitespace and comments
+ * @return 1 if a number was read; otherwise, 0.
+ */
+static int readPNMValue(FILE *in, size_t *val) {
+    int c = getc(in);
+    while (c != EOF && (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#')) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') c = getc(in);
+        }
+        c = getc(in);
+    }
+    if (c < '0' || c > '9') return 0;
+    size_t v = 0;
+    while (c >= '0' && c <= '9') {
+        v = v * 10 + (size_t)(c - '0');
+        c = getc(in);
+    }
+    //binary rasters start right after the single whitespace byte that ends the header
+    if (c != EOF && c != ' ' && c != '\t' && c != '\r' && c != '\n') return 0;
+    *val = v;
+    return 1;
+}
+
+/**
+ * @brief Load a PGM or PPM image into a graph.
+ *
+ * @param in Stream positioned at the start of the image
+ * @param sigma Intensity scale of the boundary term
+ * @return Pointer to the image graph, if successful; otherwise, NULL.
+ */
+struct imagegraph_t * loadPNM(FILE *in, double sigma) {
+    if (in == NULL || getc(in) != 'P') return NULL;
+    int kind = getc(in);
+    if (kind != '2' && kind != '3' && kind != '5' && kind != '6') return NULL;
+    size_t width, height, maxval;
+    if (!readPNMValue(in, &width) || !readPNMValue(in, &height) || !readPNMValue(in, &maxval)) return NULL;
+    if (width == 0 || height == 0 || maxval == 0 || maxval > 65535) return NULL;
+    size_t channels = (kind == '3' || kind == '6') ? 3 : 1;
+    size_t count;
+    if (!sampleCount(width, height, 1, channels, &count)) return NULL;
+
+    struct imagegraph_t *ig = initImageGraph(createDimensions(2, width, height), channels, maxval);
+    if (ig == NULL) return NULL;
+    int ok = 1;
+    if (kind == '5' || kind == '6') {
+        ok = readSamples(in, ig->intensity, count, maxval > 255 ? 2 : 1, 1);
+    } else {
+        for (size_t i = 0; ok && i < count; i++) {
+            size_t v = 0;
+            ok = readPNMValue(in, &v) && v <= maxval;
+            ig->intensity[i] = (double)v;
+        }
+    }
+    if (!ok || !arrayBoundaryWeights(ig->g, ig->intensity, channels, sigma)) destroyImageGraph((void **)&ig);
+    return ig;
+}
+
+/**
+ * @brief Load a raw volume of 8- or 16-bit samples into a graph.
+ *
+ * @param in Stream positioned at the first sample
+ * @param width Samples along x
+ * @param height Samples along y
+ * @param depth Samples along z
+ * @param bytesper Bytes per sample (1 or 2)
+ * @param bigendian Nonzero if 16-bit samples are stored most significant byte first
+ * @param sigma Intensity scale of the boundary term
+ * @return Pointer to the image graph, if successful; otherwise, NULL.
+ */
+struct imagegraph_t * loadRawVolume(FILE *in, size_t width, size_t height, size_t depth, size_t bytesper,
+                                    int bigendian, double sigma) {
+    if (in == NULL || width == 0 || height == 0 || depth == 0 || (bytesper != 1 && bytesper != 2)) return NULL;
+    size_t count;
+    if (!sampleCount(width, height, depth, 1, &count)) return NULL;
+    struct dimensions_t *dims = (depth == 1) ? createDimensions(2, width, height)
+                                             : createDimensions(3, width, height, depth);
+    struct imagegraph_t *ig = initImageGraph(dims, 1, bytesper == 1 ? 255 : 65535);
+    if (ig == NULL) return NULL;
+    if (!readSamples(in, ig->intensity, count, bytesper, bigendian)
+        || !arrayBoundaryWeights(ig->g, ig->intensity, 1, sigma)) {
+        destroyImageGraph((void **)&ig);
+    }
+    return ig;
+}
+
+/**
+ * @brief Clear out an image graph, including its graph, dimensions and samples
+ *
+ * @param igptr pointer-to-pointer for the image graph
+ * @return 1 if successful; 0 if error
+ */
+int destroyImageGraph(void **igptr) {
+    int retval = 0;
+    if (*igptr != NULL) {
+        struct imagegraph_t *ig = (struct imagegraph_t *)*igptr;
+        if (ig->g != NULL) {
+            graphFree(&ig->g->allocator, ig->intensity,
+                      cartesianIndexLength(ig->dims) * ig->channels * sizeof(double));
+            clearGraph(ig->g);
+            destroyGraph((void **)&ig->g);
+        }
+        destroyDimensions((void **)&ig->dims);
+        free(ig);
+        *igptr = NULL;
+        retval = 1;
+    }
+    return retval;
+}
@@ -0,0 +1,251 @@
+/**
+ * @brief Interning of feature names to small integer ids.
+ */
+
+#include <util/interntable.h>
+#include <util/crudops.h>
+#include <util/hashes.h>
+#include <string.h>
+
+/**
+ * @brief Initial number of hash slots
+ */
+#define INTERN_INIT_SLOTS 16
+
+/**
+ * @brief Hash a name for the table
+ * @param name Name to be hashed
+ * @param len Set to the length of the name
+ * @return Hash of the name
+ */
+static size_t hashName(const char *name, size_t *len) {
+    *len = strlen(name);
+    return (size_t)WyHash64(name, *len, HASH_SEED64);
+}
+
+/**
+ * @brief Find the slot holding the given name, or the empty slot where it belongs
+ * @param t Intern table
+ * @param name Name to be found
+ * @param hash Hash of the name
+ * @return Slot index
+ */
+static size_t probe(const struct interntable_t *t, const char *name, size_t hash) {
+    size_t mask = t->slotcount - 1;
+    size_t pos = hash & mask;
+    while (t->slots[pos] != 0) {
+        size_t id = t->slots[pos] - 1;
+        if (t->entries[id].hash == hash && strcmp(t->entries[id].name, name) == 0) break;
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+/**
+ * @brief Double the number of hash slots, using the cached hashes to reinsert the ids
+ * @param t Intern table
+ * @return 1 if successful; otherwise, 0.
+ */
+static int growSlots(struct interntable_t *t) {
+    size_t nslotcount = t->slotcount * 2;
+    size_t *nslots = (size_t *)graphAlloc(t->allocator, nslotcount * sizeof(size_t));
+    if (nslots == NULL) return 0;
+    memset(nslots, 0, nslotcount * sizeof(size_t));
+    size_t mask = nslotcount - 1;
+    for (size_t id = 0; id < t->count; id++) {
+        size_t pos = t->entries[id].hash & mask;
+        while (nslots[pos] != 0) pos = (pos + 1) & mask;
+        nslots[pos] = id + 1;
+    }
+    graphFree(t->allocator, t->slots, t->slotcount * sizeof(size_t));
+    t->slots = nslots;
+    t->slotcount = nslotcount;
+    return 1;
+}
+
+/**
+ * @brief Double the entry array
+ * @param t Intern table
+ * @return 1 if successful; otherwise, 0.
+ */
+static int growEntries(struct interntable_t *t) {
+    size_t ncap = t->entrycap * 2;
+    struct internentry_t *nentries = (struct internentry_t *)graphRealloc(t->allocator, t->entries,
+            t->entrycap * sizeof(struct internentry_t), ncap * sizeof(struct internentry_t));
+    if (nentries == NULL) return 0;
+    t->entries = nentries;
+    t->entrycap = ncap;
+    return 1;
+}
+
+/**
+ * @brief Create an empty intern table
+ *
+ * @param a Allocator to be used; NULL for the default
+ * @return Pointer to the new table, if successful; otherwise, NULL.
+ */
+struct interntable_t * initInternTable(const struct graphallocator_t *a) {
+    struct interntable_t *t = (struct interntable_t *)graphAlloc(a, sizeof(struct interntable_t));
+    if (t != NULL) {
+        t->allocator = a;
+        t->count = 0;
+        t->slotcount = INTERN_INIT_SLOTS;
+        t->entrycap = INTERN_INIT_SLOTS / 2;
+        t->slots = (size_t *)graphAlloc(a, t->slotcount * sizeof(size_t));
+        t->entries = (struct internentry_t *)graphAlloc(a, t->entrycap * sizeof(struct internentry_t));
+        if (t->slots == NULL || t->entries == NULL) {
+            destroyInternTable((void **)&t);
+        } else {
+            memset(t->slots, 0, t->slotcount * sizeof(size_t));
+        }
+    }
+    return t;
+}
+
+/**
+ * @brief Retrieve the id of the given name, interning it if necessary
+ *
+ * @param t Intern table
+ * @param name Name to be interned
+ * @return Id of the name, if successful; otherwise, INTERN_NONE.
+ */
+size_t internName(struct interntable_t *t, const char *name) {
+    if (t == NULL || name == NULL) return INTERN_NONE;
+    size_t len;
+    size_t hash = hashName(name, &len);
+    size_t pos = probe(t, name, hash);
+    if (t->slots[pos] != 0) return t->slots[pos] - 1;
+
+    //new name--keep the load factor at or below one half
+    if (2 * (t->count + 1) > t->slotcount) {
+        if (!growSlots(t)) return INTERN_NONE;
+        pos = probe(t, name, hash);
+    }
+    if (t->count == t->entrycap && !growEntries(t)) return INTERN_NONE;
+    char *copy = (char *)graphAlloc(t->allocator, len + 1);
+    if (copy == NULL) return INTERN_NONE;
+    memcpy(copy, name, len + 1);
+    size_t id = t->count++;
+    t->entries[id].name = copy;
+    t->entries[id].hash = hash;
+    t->slots[pos] = id + 1;
+    return id;
+}
+
+/**
+ * @brief Retrieve the id of a name already in the table
+ *
+ * @param t Intern table
+ * @param name Name to be found
+ * @return Id of the name, if found; otherwise, INTERN_NONE.
+ */
+size_t internLookup(const struct interntable_t *t, const char *name) {
+    if (t == NULL || name == NULL) return INTERN_NONE;
+    size_t len;
+    size_t pos = probe(t, name, hashName(name, &len));
+    return (t->slots[pos] != 0) ? t->slots[pos] - 1 : INTERN_NONE;
+}
+
+/**
+ * @brief Retrieve the name for the given id
+ *
+ * @param t Intern table
+ * @param id Id returned by internName()
+ * @return The interned name (owned by the table), or NULL if the id is not valid.
+ */
+const char * internedName(const struct interntable_t *t, size_t id) {
+    if (t == NULL || id >= t->count) return NULL;
+    return t->entries[id].name;
+}
+
+/**
+ * @brief Clear out an intern table and all of its names
+ *
+ * @param tptr pointer-to-pointer for the table
+ * @return 1 if successful; 0 if error
+ */
+int destroyInternTable(void **tptr) {
+    int retval = 0;
+    if (*tptr != NULL) {
+        struct interntable_t *t = (struct interntable_t *)*tptr;
+        const struct graphallocator_t *a = t->allocator;
+        if (t->entries != NULL) {
+            for (size_t id = 0; id < t->count; id++) {
+                graphFree(a, t->entries[id].name, strlen(t->entries[id].name) + 1);
+            }
+        }
+        graphFree(a, t->entries, t->entrycap * sizeof(struct internentry_t));
+        graphFree(a, t->slots, t->slotcount * sizeof(size_t));
+        graphFree(a, t, sizeof(struct interntable_t));
+        *tptr = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Create a copy of an intern table, keeping every id
+ *
+ * @param a Allocator to be used for the copy; NULL for the default
+ * @param t Table to be copied
+ * @return Pointer to the new table, if successful; otherwise, NULL.
+ */
+struct interntable_t * cloneInternTable(const struct graphallocator_t *a, const struct interntable_t *t) {
+    if (t == NULL) return NULL;
+    struct interntable_t *nt = (struct interntable_t *)graphAlloc(a, sizeof(struct interntable_t));
+    if (nt != NULL) {
+        nt->allocator = a;
+        nt->count = 0;
+        nt->slotcount = t->slotcount;
+        nt->entrycap = t->entrycap;
+        nt->slots = (size_t *)graphAlloc(a, t->slotcount * sizeof(size_t));
+        nt->entries = (struct internentry_t *)graphAlloc(a, t->entrycap * sizeof(struct internentry_t));
+        if (nt->slots == NULL || nt->entries == NULL) {
+            destroyInternTable((void **)&nt);
+            return NULL;
+        }
+        //same slot layout, so the slots are copied as they are
+        memcpy(nt->slots, t->slots, t->slotcount * sizeof(size_t));
+        for (size_t id = 0; id < t->count; id++) {
+            size_t len = strlen(t->entries[id].name);
+            char *copy = (char *)graphAlloc(a, len + 1);
+            if (copy == NULL) {
+                destroyInternTable((void **)&nt);
+                return NULL;
+            }
+            memcpy(copy, t->entries[id].name, len + 1);
+            nt->entries[id].name = copy;
+            nt->entries[id].hash = t->entries[id].hash;
+            nt->count++;
+        }
+    }
+    return nt;
+}
+
+/**
+ * @brief Retrieve the feature id for the given name in the graph's feature name table, interning it if necessary.
+ *
+ * @param g Graph in question
+ * @param name Feature name
+ * @return Feature id, if successful; otherwise, INTERN_NONE.
+ */
+size_t graphFeatureId(struct graph_t *g, const char *name) {
+    if (g == NULL) return INTERN_NONE;
+    if (g->features == NULL) {
+        g->features = initInternTable(&g->allocator);
+    }
+    return internName(g->features, name);
+}
+
+/**
+ * @brief Find the feature with the given id in a feature list
+ *
+ * @param attrs Feature list (node_t.attrs or edge_t.attrs)
+ * @param featureid Id from graphFeatureId()
+ * @return Pointer to the feature, if found; otherwise, NULL.
+ */
+struct feature_t * findFeature(struct feature_t *attrs, size_t featureid) {
+    struct feature_t *curr = attrs;
+    while (curr != NULL && curr->hashid != featureid) curr = curr->next;
+    return curr;
+}
@@ -0,0 +1,1266 @@
+/**
+ * @brief Max-flow / min-cut over the topology of ARRAY graphs.
+ *
+ * Arcs are numbered by slot: arc s (s < m) runs from the slot's node to its neighbor, and arc s + m is its reverse.
+ * Arcs entering a node from lower-numbered nodes are found through a CSR index of incoming slots built once per
+ * workspace.
+ *
+ * regionMaxFlow() runs push-relabel over the same arcs, one worker process per part.  The residual of an arc is only
+ * written by the owner of its tail, so the only data that crosses between parts are the flows pushed over boundary
+ * arcs and the labels of boundary nodes, held in small per-arc arrays of the shared mapping.
+ */
+
+#include <util/maxflow.h>
+#include <util/crudops.h>
+#include <util/partition.h>
+#include <impl/arraygraph.h>
+#include <impl/sharedmmapgraph.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __unix__
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Level of nodes not reached by the current BFS
+ */
+#define FLOW_UNREACHED ((size_t)-1)
+
+/**
+ * @brief Residual network for repeated max-flow solves over one ARRAY topology
+ */
+struct flowworkspace_t {
+    /**
+     * @brief Number of nodes taking part
+     */
+    size_t n;
+    /**
+     * @brief Slots per node
+     */
+    size_t d;
+    /**
+     * @brief Number of slots (n * d)
+     */
+    size_t m;
+    /**
+     * @brief Node array of the graph, or a copy of it for tiled graphs
+     */
+    const size_t *nodes;
+    /**
+     * @brief Nonzero if nodes is a copy owned by the workspace
+     */
+    int ownnodes;
+    /**
+     * @brief Residual arc capacities (2m)
+     */
+    double *res;
+    /**
+     * @brief Arc capacities added since the last flowReset() (2m), to work out the flow of each arc
+     */
+    double *arccap;
+    /**
+     * @brief Residual source capacities (n)
+     */
+    double *src;
+    /**
+     * @brief Residual sink capacities (n)
+     */
+    double *snk;
+    /**
+     * @brief Offsets of each node's incoming slots in inslot (n + 1)
+     */
+    size_t *inoff;
+    /**
+     * @brief Incoming slots, grouped by neighbor
+     */
+    size_t *inslot;
+    /**
+     * @brief BFS level of each node
+     */
+    size_t *level;
+    /**
+     * @brief Current arc of each node in the blocking-flow search
+     */
+    size_t *cur;
+    /**
+     * @brief BFS queue; reused as the arc stack of the blocking-flow search
+     */
+    size_t *queue;
+    /**
+     * @brief Nonzero if res, src and snk belong to the caller (the shared mapping of regionMaxFlow())
+     */
+    int external;
+    /**
+     * @brief Allocator of the graph
+     */
+    const struct graphallocator_t *allocator;
+};
+
+/**
+ * @brief Neighbor of a slot, if it takes part in the network
+ * @param ws Workspace
+ * @param slot Slot index
+ * @return Neighbor id, or FLOW_UNREACHED if the slot is empty or leads outside the network
+ */
+static size_t slotHead(const struct flowworkspace_t *ws, size_t slot) {
+    size_t v = ws->nodes[slot];
+    return (v == 0 || v >= ws->n) ? FLOW_UNREACHED : v;
+}
+
+/**
+ * @brief Number of arcs leaving a node (valid or not)
+ */
+static size_t arcCount(const struct flowworkspace_t *ws, size_t v) {
+    return ws->d + (ws->inoff[v + 1] - ws->inoff[v]);
+}
+
+/**
+ * @brief Arc id and head of the i-th arc leaving a node
+ * @param ws Workspace
+ * @param v Node id
+ * @param i Arc number, less than arcCount()
+ * @param head Set to the head of the arc, or FLOW_UNREACHED if the arc is not used
+ * @return Arc id
+ */
+static size_t arcAt(const struct flowworkspace_t *ws, size_t v, size_t i, size_t *head) {
+    if (i < ws->d) {
+        size_t slot = v * ws->d + i;
+        *head = slotHead(ws, slot);
+        return slot;
+    }
+    size_t slot = ws->inslot[ws->inoff[v] + (i - ws->d)];
+    *head = slot / ws->d;
+    return slot + ws->m;
+}
+
+/**
+ * @brief Tail of an arc
+ */
+static size_t arcTail(const struct flowworkspace_t *ws, size_t arc) {
+    return (arc < ws->m) ? arc / ws->d : ws->nodes[arc - ws->m];
+}
+
+/**
+ * @brief Copy the node slots of the first n nodes of a tiled graph, one tile at a time
+ * @param g SHARED_MMAP graph
+ * @param ws Workspace being created (n and d set)
+ * @return Pointer to the copy, if successful; otherwise, NULL.
+ */
+static size_t * copyTiledNodes(const struct graph_t *g, const struct flowworkspace_t *ws) {
+    size_t *nodes = (size_t *)graphAlloc(ws->allocator, (ws->m > 0 ? ws->m : 1) * sizeof(size_t));
+    if (nodes == NULL) return NULL;
+    int success = 1;
+    mmapCacheLock(g);
+    for (size_t v = 0; v < ws->n && success; v++) {
+        struct mmapslots_t slots;
+        success = mmapNodeSlots(g, v, &slots);
+        if (success) memcpy(nodes + v * ws->d, slots.nodes, ws->d * sizeof(size_t));
+    }
+    mmapCacheUnlock(g);
+    if (!success) {
+        graphFree(ws->allocator, nodes, (ws->m > 0 ? ws->m : 1) * sizeof(size_t));
+        nodes = NULL;
+    }
+    return nodes;
+}
+
+/**
+ * @brief Create a workspace, with its values (res, src and snk) either allocated or in the given block
+ *
+ * @param g ARRAY graph
+ * @param nodecount Number of nodes taking part; 0 for all nodes of the graph
+ * @param values Block of 2m + 2n doubles for the values, zeroed and owned by the caller; NULL to allocate them
+ * @return Pointer to the workspace, if successful; otherwise, NULL.
+ */
+static struct flowworkspace_t * newWorkspace(const struct graph_t *g, size_t nodecount, double *values) {
+    if (g == NULL || (g->gtype & ARRAY) != ARRAY || g->metaImpl == NULL) return NULL;
+    int tiled = isMmapGraph(g);
+    if (!tiled && g->nodeImpl == NULL) return NULL;
+    size_t nodelen = tiled ? ((const struct mmapdata_t *)g->metaImpl)->nodelen
+                           : ((const struct arraydata_t *)g->metaImpl)->nodelen;
+    size_t degree = tiled ? ((const struct mmapdata_t *)g->metaImpl)->degree
+                          : ((const struct arraydata_t *)g->metaImpl)->degree;
+    if (nodecount == 0 || nodecount > nodelen) nodecount = nodelen;
+    const struct graphallocator_t *a = &g->allocator;
+    struct flowworkspace_t *ws = (struct flowworkspace_t *)graphAlloc(a, sizeof(struct flowworkspace_t));
+    if (ws == NULL) return NULL;
+    memset(ws, 0, sizeof(struct flowworkspace_t));
+    ws->allocator = a;
+    ws->n = nodecount;
+    ws->d = degree;
+    ws->m = nodecount * degree;
+    if (tiled) {
+        ws->ownnodes = 1;
+        ws->nodes = copyTiledNodes(g, ws);
+        if (ws->nodes == NULL) {
+            destroyFlowWorkspace((void **)&ws);
+            return NULL;
+        }
+    } else {
+        ws->nodes = (const size_t *)g->nodeImpl;
+    }
+    if (values != NULL) {
+        ws->external = 1;
+        ws->res = values;
+        ws->src = values + 2 * ws->m;
+        ws->snk = values + 2 * ws->m + ws->n;
+    } else {
+        ws->res = (double *)graphAlloc(a, 2 * ws->m * sizeof(double));
+        ws->src = (double *)graphAlloc(a, ws->n * sizeof(double));
+        ws->snk = (double *)graphAlloc(a, ws->n * sizeof(double));
+    }
+    ws->arccap = (double *)graphAlloc(a, 2 * ws->m * sizeof(double));
+    ws->inoff = (size_t *)graphAlloc(a, (ws->n + 1) * sizeof(size_t));
+    ws->level = (size_t *)graphAlloc(a, ws->n * sizeof(size_t));
+    ws->cur = (size_t *)graphAlloc(a, ws->n * sizeof(size_t));
+    ws->queue = (size_t *)graphAlloc(a, ws->n * sizeof(size_t));
+    if (ws->res == NULL || ws->src == NULL || ws->snk == NULL || ws->arccap == NULL || ws->inoff == NULL || ws->level == NULL
+        || ws->cur == NULL || ws->queue == NULL) {
+        destroyFlowWorkspace((void **)&ws);
+        return NULL;
+    }
+
+    //index the incoming slots of every node, counting first and then filling
+    memset(ws->inoff, 0, (ws->n + 1) * sizeof(size_t));
+    for (size_t s = 0; s < ws->m; s++) {
+        size_t v = slotHead(ws, s);
+        if (v != FLOW_UNREACHED) ws->inoff[v + 1]++;
+    }
+    for (size_t v = 0; v < ws->n; v++) ws->inoff[v + 1] += ws->inoff[v];
+    ws->inslot = (size_t *)graphAlloc(a, (ws->inoff[ws->n] > 0 ? ws->inoff[ws->n] : 1) * sizeof(size_t));
+    if (ws->inslot == NULL) {
+        destroyFlowWorkspace((void **)&ws);
+        return NULL;
+    }
+    memcpy(ws->cur, ws->inoff, ws->n * sizeof(size_t));
+    for (size_t s = 0; s < ws->m; s++) {
+        size_t v = slotHead(ws, s);
+        if (v != FLOW_UNREACHED) ws->inslot[ws->cur[v]++] = s;
+    }
+    if (values == NULL) flowReset(ws); else memset(ws->arccap, 0, 2 * ws->m * sizeof(double));
+    return ws;
+}
+
+/**
+ * @brief Create a workspace for the first nodecount nodes of an ARRAY graph.
+ *
+ * @param g ARRAY graph
+ * @param nodecount Number of nodes taking part; 0 for all nodes of the graph
+ * @return Pointer to the workspace, if successful; otherwise, NULL.
+ */
+struct flowworkspace_t * initFlowWorkspace(const struct graph_t *g, size_t nodecount) {
+    return newWorkspace(g, nodecount, NULL);
+}
+
+/**
+ * @brief Clear out a workspace
+ *
+ * @param wsptr pointer-to-pointer for the workspace
+ * @return 1 if successful; 0 if error
+ */
+int destroyFlowWorkspace(void **wsptr) {
+    int retval = 0;
+    if (*wsptr != NULL) {
+        struct flowworkspace_t *ws = (struct flowworkspace_t *)*wsptr;
+        const struct graphallocator_t *a = ws->allocator;
+        if (!ws->external) {
+            graphFree(a, ws->res, 2 * ws->m * sizeof(double));
+            graphFree(a, ws->src, ws->n * sizeof(double));
+            graphFree(a, ws->snk, ws->n * sizeof(double));
+        }
+        graphFree(a, ws->arccap, 2 * ws->m * sizeof(double));
+        if (ws->inslot != NULL) {
+            graphFree(a, ws->inslot, (ws->inoff[ws->n] > 0 ? ws->inoff[ws->n] : 1) * sizeof(size_t));
+        }
+        graphFree(a, ws->inoff, (ws->n + 1) * sizeof(size_t));
+        graphFree(a, ws->level, ws->n * sizeof(size_t));
+        graphFree(a, ws->cur, ws->n * sizeof(size_t));
+        graphFree(a, ws->queue, ws->n * sizeof(size_t));
+        if (ws->ownnodes && ws->nodes != NULL) graphFree(a, (void *)ws->nodes, (ws->m > 0 ? ws->m : 1) * sizeof(size_t));
+        graphFree(a, ws, sizeof(struct flowworkspace_t));
+        *wsptr = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Zero every capacity of the workspace
+ * @param ws Workspace
+ */
+void flowReset(struct flowworkspace_t *ws) {
+    memset(ws->res, 0, 2 * ws->m * sizeof(double));
+    memset(ws->arccap, 0, 2 * ws->m * sizeof(double));
+    memset(ws->src, 0, ws->n * sizeof(double));
+    memset(ws->snk, 0, ws->n * sizeof(double));
+}
+
+/**
+ * @brief Add capacity to the arc between the node of a slot and its neighbor.
+ *
+ * @param ws Workspace
+ * @param slot Index into the node array (nodeid * degree + dimension)
+ * @param forward Capacity added from the slot's node to its neighbor
+ * @param backward Capacity added from the neighbor to the slot's node
+ */
+void flowAddArc(struct flowworkspace_t *ws, size_t slot, double forward, double backward) {
+    ws->res[slot] += forward;
+    ws->res[slot + ws->m] += backward;
+    ws->arccap[slot] += forward;
+    ws->arccap[slot + ws->m] += backward;
+}
+
+/**
+ * @brief Add terminal capacities to a node
+ *
+ * @param ws Workspace
+ * @param nodeid Node id
+ * @param source Capacity added from the source
+ * @param sink Capacity added to the sink
+ */
+void flowAddTerminal(struct flowworkspace_t *ws, size_t nodeid, double source, double sink) {
+    ws->src[nodeid] += source;
+    ws->snk[nodeid] += sink;
+}
+
+/**
+ * @brief Build the BFS level graph from the source
+ * @param ws Workspace
+ * @return Level of the sink, or FLOW_UNREACHED if the sink cannot be reached
+ */
+static size_t buildLevels(struct flowworkspace_t *ws) {
+    size_t head = 0, tail = 0;
+    size_t sinklevel = FLOW_UNREACHED;
+    for (size_t v = 0; v < ws->n; v++) {
+        ws->cur[v] = 0;
+        if (ws->src[v] > 0.0) {
+            ws->level[v] = 1;
+            ws->queue[tail++] = v;
+        } else {
+            ws->level[v] = FLOW_UNREACHED;
+        }
+    }
+    while (head < tail) {
+        size_t v = ws->queue[head++];
+        //nothing beyond the sink level can be on a shortest path
+        if (ws->level[v] + 1 >= sinklevel) continue;
+        if (ws->snk[v] > 0.0) {
+            sinklevel = ws->level[v] + 1;
+            continue;
+        }
+        size_t count = arcCount(ws, v);
+        for (size_t i = 0; i < count; i++) {
+            size_t w;
+            size_t arc = arcAt(ws, v, i, &w);
+            if (w != FLOW_UNREACHED && ws->res[arc] > 0.0 && ws->level[w] == FLOW_UNREACHED) {
+                ws->level[w] = ws->level[v] + 1;
+                ws->queue[tail++] = w;
+            }
+        }
+    }
+    return sinklevel;
+}
+
+/**
+ * @brief Push a blocking flow through the current level graph
+ * @param ws Workspace
+ * @param sinklevel Level of the sink
+ * @return Flow pushed
+ */
+static double blockingFlow(struct flowworkspace_t *ws, size_t sinklevel) {
+    double pushed = 0.0;
+    size_t *stack = ws->queue;
+    for (size_t p = 0; p < ws->n; p++) {
+        if (ws->level[p] != 1) continue;
+        size_t top = 0;
+        size_t v = p;
+        while (ws->src[p] > 0.0 && ws->level[p] == 1) {
+            if (ws->level[v] + 1 == sinklevel && ws->snk[v] > 0.0) {
+                //augment along the stack
+                double b = ws->src[p] < ws->snk[v] ? ws->src[p] : ws->snk[v];
+                for (size_t k = 0; k < top; k++) {
+                    if (ws->res[stack[k]] < b) b = ws->res[stack[k]];
+                }
+                ws->src[p] -= b;
+                ws->snk[v] -= b;
+                for (size_t k = 0; k < top; k++) {
+                    size_t arc = stack[k];
+                    ws->res[arc] -= b;
+                    ws->res[arc < ws->m ? arc + ws->m : arc - ws->m] += b;
+                }
+                pushed += b;
+                top = 0;
+                v = p;
+                continue;
+            }
+            //advance along the next admissible arc, if there is one
+            size_t count = arcCount(ws, v);
+            size_t w = FLOW_UNREACHED;
+            size_t arc = 0;
+            while (ws->cur[v] < count) {
+                arc = arcAt(ws, v, ws->cur[v], &w);
+                if (w != FLOW_UNREACHED && ws->res[arc] > 0.0 && ws->level[w] == ws->level[v] + 1
+                    && ws->level[w] < sinklevel) break;
+                w = FLOW_UNREACHED;
+                ws->cur[v]++;
+            }
+            if (w != FLOW_UNREACHED) {
+                stack[top++] = arc;
+                v = w;
+            } else {
+                //dead end--drop the node from this phase and retreat
+                ws->level[v] = FLOW_UNREACHED;
+                if (top == 0) break;
+                v = arcTail(ws, stack[--top]);
+                ws->cur[v]++;
+            }
+        }
+    }
+    return pushed;
+}
+
+/**
+ * @brief Compute the maximum flow with the current capacities
+ *
+ * @param ws Workspace
+ * @return Value of the maximum flow
+ */
+double flowSolve(struct flowworkspace_t *ws) {
+    double total = 0.0;
+    //flow straight from the source to the sink through a single node needs no search
+    for (size_t v = 0; v < ws->n; v++) {
+        double direct = ws->src[v] < ws->snk[v] ? ws->src[v] : ws->snk[v];
+        ws->src[v] -= direct;
+        ws->snk[v] -= direct;
+        total += direct;
+    }
+    size_t sinklevel;
+    while ((sinklevel = buildLevels(ws)) != FLOW_UNREACHED) {
+        total += blockingFlow(ws, sinklevel);
+    }
+    //the last BFS marks the source side of the minimum cut
+    return total;
+}
+
+/**
+ * @brief Side of the minimum cut a node ended up on, after flowSolve()
+ * @param ws Workspace
+ * @param nodeid Node id
+ * @return 1 if the node is on the sink side; 0 if it is on the source side.
+ */
+int flowSinkSide(const struct flowworkspace_t *ws, size_t nodeid) {
+    return ws->level[nodeid] == FLOW_UNREACHED;
+}
+
+/**
+ * @brief Flow through the arc of a slot, after flowSolve()
+ * @param ws Workspace
+ * @param slot Index into the node array
+ * @return Net flow from the slot's node to its neighbor
+ */
+double flowArcFlow(const struct flowworkspace_t *ws, size_t slot) {
+    //each direction's residual falls by what it carries and rises by what the other carries, so half the difference
+    //of the two drops is the net flow
+    double forward = ws->arccap[slot] - ws->res[slot];
+    double backward = ws->arccap[slot + ws->m] - ws->res[slot + ws->m];
+    return (forward - backward) / 2.0;
+}
+
+/**
+ * @brief Capacities and flows of the slots of one node, from the graph's arrays or from its mapped tile
+ *
+ * For tiled graphs the tile cache lock must be held, and the pointers are only valid until it is released.
+ *
+ * @param g ARRAY or SHARED_MMAP graph
+ * @param ws Workspace over g
+ * @param v Node id
+ * @param caparr Set to the capacities of the node's slots (d entries)
+ * @param farr Set to the flows of the node's slots (d entries)
+ * @return 1 if successful; 0 if the node's tile could not be mapped.
+ */
+static int nodeValues(struct graph_t *g, const struct flowworkspace_t *ws, size_t v, double **caparr, double **farr) {
+    if (isMmapGraph(g)) {
+        struct mmapslots_t slots;
+        if (!mmapNodeSlots(g, v, &slots)) return 0;
+        *caparr = slots.cap;
+        *farr = slots.flow;
+    } else {
+        *caparr = (double *)g->capImpl + v * ws->d;
+        *farr = (double *)g->flowImpl + v * ws->d;
+    }
+    return 1;
+}
+
+/**
+ * @brief Compute the maximum flow of an ARRAY graph, using the edge capacities as arc capacities.
+ *
+ * @param g ARRAY graph
+ * @param source Capacity from the source to each node (nodelen entries)
+ * @param sink Capacity from each node to the sink (nodelen entries)
+ * @param sinkside Set to 1 for the nodes on the sink side of the minimum cut (nodelen entries); may be NULL
+ * @param flow Set to the value of the maximum flow
+ * @return 1 if successful; otherwise, 0.
+ */
+int arrayMaxFlow(struct graph_t *g, const double *source, const double *sink, unsigned char *sinkside, double *flow) {
+    if (source == NULL || sink == NULL || flow == NULL) return 0;
+    struct flowworkspace_t *ws = initFlowWorkspace(g, 0);
+    if (ws == NULL) return 0;
+    int tiled = isMmapGraph(g);
+    int undirected = ((g->gtype & DIRECTED) != DIRECTED);
+    int success = 1;
+    if (tiled) mmapCacheLock(g);
+    for (size_t v = 0; v < ws->n && success; v++) {
+        double *caparr = NULL, *farr = NULL;
+        success = nodeValues(g, ws, v, &caparr, &farr);
+        for (size_t i = 0; success && i < ws->d; i++) {
+            size_t s = v * ws->d + i;
+            if (slotHead(ws, s) != FLOW_UNREACHED) flowAddArc(ws, s, caparr[i], undirected ? caparr[i] : 0.0);
+        }
+    }
+    if (tiled) mmapCacheUnlock(g);
+    if (!success) {
+        destroyFlowWorkspace((void **)&ws);
+        return 0;
+    }
+    for (size_t v = 0; v < ws->n; v++) flowAddTerminal(ws, v, source[v], sink[v]);
+    *flow = flowSolve(ws);
+    if (tiled) mmapCacheLock(g);
+    for (size_t v = 0; v < ws->n && success; v++) {
+        double *caparr = NULL, *farr = NULL;
+        success = nodeValues(g, ws, v, &caparr, &farr);
+        for (size_t i = 0; success && i < ws->d; i++) {
+            size_t s = v * ws->d + i;
+            farr[i] = (slotHead(ws, s) != FLOW_UNREACHED) ? flowArcFlow(ws, s) : 0.0;
+        }
+    }
+    if (tiled) mmapCacheUnlock(g);
+    if (success && sinkside != NULL) {
+        for (size_t v = 0; v < ws->n; v++) sinkside[v] = (unsigned char)flowSinkSide(ws, v);
+    }
+    destroyFlowWorkspace((void **)&ws);
+    return success;
+}
+
+/*
+ * Region push-relabel.  Labels are distances to the sink (label 0) in the residual network, or the node count plus
+ * the distance back to the source (label n) for nodes that can no longer reach the sink; top marks nodes that reach
+ * neither.  Within a round, each worker discharges its own nodes against a frozen copy of the labels of the nodes
+ * just across its boundary, and pushes over boundary arcs are only applied by the receiving worker after the round.
+ * Such pushes can leave labels that are no longer exact, so whenever the workers run out of work the labels are
+ * rebuilt exactly (a breadth-first search spread over the workers), and the solve ends only when the exact labels show
+ * no node with excess left.
+ */
+
+#ifdef __unix__
+
+/**
+ * @brief Reverse of an arc
+ */
+static size_t arcReverse(const struct flowworkspace_t *ws, size_t arc) {
+    return (arc < ws->m) ? arc + ws->m : arc - ws->m;
+}
+
+/**
+ * @brief Head of an arc
+ */
+static size_t arcHead(const struct flowworkspace_t *ws, size_t arc) {
+    return (arc < ws->m) ? ws->nodes[arc] : (arc - ws->m) / ws->d;
+}
+
+static int compareArcs(const void *a, const void *b) {
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Alignment of the arrays in the shared mapping
+ */
+#define REGION_ALIGN 64
+
+/**
+ * @brief Barrier spins between checks on the worker processes, made by worker 0
+ */
+#define REGION_POLL_SPINS 1024
+
+/**
+ * @brief Control block at the start of the shared mapping
+ */
+struct regioncontrol_t {
+    /**
+     * @brief Workers arrived at the current barrier
+     */
+    size_t arrived;
+    /**
+     * @brief Barrier generation, advanced by the last worker to arrive
+     */
+    size_t generation;
+    /**
+     * @brief Set when any worker fails; every worker then stops at its next barrier
+     */
+    int abort;
+};
+
+/**
+ * @brief State of a region solve
+ *
+ * Everything but the shared mapping is set up before the workers are forked, and is read-only afterwards.
+ */
+struct regionrun_t {
+    /**
+     * @brief Arc index of the graph; res and snk are in the shared mapping
+     */
+    struct flowworkspace_t *ws;
+    /**
+     * @brief Partition giving the nodes of each worker
+     */
+    const struct partition_t *p;
+    size_t parts;
+    /**
+     * @brief Label of nodes that reach neither terminal
+     */
+    size_t top;
+    const double *cap;
+    int undirected;
+    const double *source;
+    const double *sink;
+    /**
+     * @brief Start of the boundary arcs of each part in barc (parts + 1 entries)
+     */
+    size_t *boff;
+    /**
+     * @brief Boundary arcs (tail in the part, head outside it), ascending within each part
+     */
+    size_t *barc;
+    /**
+     * @brief Index in barc of the reverse of each boundary arc
+     */
+    size_t *bpeer;
+    size_t bcount;
+    /**
+     * @brief Process of each worker; 0 for worker 0 (the caller) and for workers that have been reaped
+     */
+    pid_t *pids;
+    /**
+     * @brief Set by worker 0 if another worker exited abnormally
+     */
+    int failed;
+    /**
+     * @brief Shared mapping of the workspace values (res, src and snk)
+     */
+    double *values;
+    size_t valueslen;
+    /**
+     * @brief Shared mapping of the node and boundary state below
+     */
+    void *map;
+    size_t maplen;
+    struct regioncontrol_t *ctl;
+    /**
+     * @brief Excess of each node
+     */
+    double *exc;
+    /**
+     * @brief Flow on the source arc of each node, which can still be pushed back
+     */
+    double *back;
+    size_t *label;
+    /**
+     * @brief Queue membership of each node (written by its worker only)
+     */
+    unsigned char *queued;
+    /**
+     * @brief Flow pushed over each boundary arc in the current round
+     */
+    double *sent;
+    /**
+     * @brief Label of the tail of each boundary arc, as of the last exchange
+     */
+    size_t *blabel;
+    /**
+     * @brief Per-worker votes (nodes still active, or labels still changing), in two sets used in turn
+     */
+    size_t *busy;
+    /**
+     * @brief Per-worker flow into the sink
+     */
+    double *sinkflow;
+};
+
+/**
+ * @brief Per-worker state
+ */
+struct regionworker_t {
+    struct regionrun_t *run;
+    size_t k;
+    const size_t *nodes;
+    size_t count;
+    /**
+     * @brief Ring buffer of queued nodes (count entries)
+     */
+    size_t *queue;
+    size_t head;
+    size_t len;
+    /**
+     * @brief Number of votes taken, the same in every worker
+     */
+    size_t votes;
+};
+
+static size_t alignUp(size_t off) {
+    return (off + REGION_ALIGN - 1) & ~((size_t)REGION_ALIGN - 1);
+}
+
+/**
+ * @brief Check on the other workers without blocking, while worker 0 waits at a barrier
+ */
+static void regionPoll(struct regionrun_t *run) {
+    for (size_t k = 1; k < run->parts; k++) {
+        int status = 0;
+        if (run->pids[k] > 0 && waitpid(run->pids[k], &status, WNOHANG) == run->pids[k]) {
+            run->pids[k] = 0;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                run->failed = 1;
+                __atomic_store_n(&run->ctl->abort, 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Wait for every worker to arrive
+ * @return 1 if successful; 0 if the solve has been aborted.
+ */
+static int regionBarrier(struct regionrun_t *run, size_t k) {
+    struct regioncontrol_t *c = run->ctl;
+    size_t gen = __atomic_load_n(&c->generation, __ATOMIC_ACQUIRE);
+    if (__atomic_add_fetch(&c->arrived, 1, __ATOMIC_ACQ_REL) == run->parts) {
+        __atomic_store_n(&c->arrived, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->generation, gen + 1, __ATOMIC_RELEASE);
+    } else {
+        size_t spins = 0;
+        while (__atomic_load_n(&c->generation, __ATOMIC_ACQUIRE) == gen) {
+            if (__atomic_load_n(&c->abort, __ATOMIC_ACQUIRE)) return 0;
+            if (k == 0 && ++spins % REGION_POLL_SPINS == 0) regionPoll(run);
+            sched_yield();
+        }
+    }
+    return !__atomic_load_n(&c->abort, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Agree across workers whether any of them is still busy
+ *
+ * Votes alternate between two sets of flags, so a worker that moves on can cast its next vote while others are still
+ * reading this one.
+ *
+ * @param w Worker
+ * @param busy Vote of this worker
+ * @param any Set to 1 if any worker voted busy
+ * @return 1 if successful; 0 if the solve has been aborted.
+ */
+static int regionVote(struct regionworker_t *w, int busy, int *any) {
+    struct regionrun_t *run = w->run;
+    size_t *set = run->busy + (w->votes++ & 1) * run->parts;
+    set[w->k] = (size_t)busy;
+    if (!regionBarrier(run, w->k)) return 0;
+    *any = 0;
+    for (size_t k = 0; k < run->parts; k++) {
+        if (set[k]) *any = 1;
+    }
+    return 1;
+}
+
+static void enqueue(struct regionworker_t *w, size_t v) {
+    if (w->run->queued[v]) return;
+    w->run->queued[v] = 1;
+    w->queue[(w->head + w->len++) % w->count] = v;
+}
+
+static size_t dequeue(struct regionworker_t *w) {
+    size_t v = w->queue[w->head];
+    w->head = (w->head + 1) % w->count;
+    w->len--;
+    w->run->queued[v] = 0;
+    return v;
+}
+
+/**
+ * @brief Queue a node if it has excess to move
+ */
+static void activate(struct regionworker_t *w, size_t v) {
+    if (w->run->exc[v] > 0.0 && w->run->label[v] < w->run->top) enqueue(w, v);
+}
+
+/**
+ * @brief Index of one of the worker's boundary arcs
+ */
+static size_t boundaryIndex(const struct regionworker_t *w, size_t arc) {
+    const struct regionrun_t *run = w->run;
+    size_t lo = run->boff[w->k], hi = run->boff[w->k + 1];
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (run->barc[mid] < arc) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Fill in the residual capacities and excesses of the worker's nodes
+ *
+ * Each source arc is saturated up front, after taking out whatever the node can send straight to the sink.
+ */
+static void regionInit(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    struct flowworkspace_t *ws = run->ws;
+    double direct = 0.0;
+    for (size_t i = 0; i < w->count; i++) {
+        size_t v = w->nodes[i];
+        double both = run->source[v] < run->sink[v] ? run->source[v] : run->sink[v];
+        direct += both;
+        run->exc[v] = run->source[v] - both;
+        run->back[v] = run->exc[v];
+        ws->snk[v] = run->sink[v] - both;
+        run->label[v] = run->top;
+        for (size_t j = 0; j < ws->d; j++) {
+            size_t slot = v * ws->d + j;
+            ws->res[slot] = (slotHead(ws, slot) != FLOW_UNREACHED) ? run->cap[slot] : 0.0;
+        }
+        for (size_t j = ws->inoff[v]; j < ws->inoff[v + 1]; j++) {
+            size_t slot = ws->inslot[j];
+            ws->res[slot + ws->m] = run->undirected ? run->cap[slot] : 0.0;
+        }
+    }
+    run->sinkflow[w->k] = direct;
+    for (size_t i = run->boff[w->k]; i < run->boff[w->k + 1]; i++) run->sent[i] = 0.0;
+}
+
+/**
+ * @brief Publish the labels of the tails of the worker's boundary arcs
+ */
+static void publishLabels(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    for (size_t i = run->boff[w->k]; i < run->boff[w->k + 1]; i++) {
+        run->blabel[i] = run->label[arcTail(run->ws, run->barc[i])];
+    }
+}
+
+/**
+ * @brief Start the worker's labels over from the sink and source arcs, queueing every node that gets one
+ */
+static void baseLabels(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    size_t n = run->ws->n;
+    while (w->len > 0) dequeue(w);
+    for (size_t i = 0; i < w->count; i++) {
+        size_t v = w->nodes[i];
+        run->label[v] = (run->ws->snk[v] > 0.0) ? 1 : (run->back[v] > 0.0) ? n + 1 : run->top;
+        if (run->label[v] < run->top) enqueue(w, v);
+    }
+}
+
+/**
+ * @brief Lower the labels of the tails of the worker's boundary arcs to one more than the published labels across
+ * @return 1 if any label changed; otherwise, 0.
+ */
+static int acrossLabels(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    int changed = 0;
+    for (size_t i = run->boff[w->k]; i < run->boff[w->k + 1]; i++) {
+        size_t arc = run->barc[i];
+        size_t across = run->blabel[run->bpeer[i]];
+        size_t v = arcTail(run->ws, arc);
+        if (run->ws->res[arc] > 0.0 && across < run->top && across + 1 < run->label[v]) {
+            run->label[v] = across + 1;
+            enqueue(w, v);
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Carry the queued labels through the worker's nodes: a node is one step further than any node it has a
+ * residual arc to
+ */
+static void spreadLabels(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    struct flowworkspace_t *ws = run->ws;
+    while (w->len > 0) {
+        size_t v = dequeue(w);
+        size_t count = arcCount(ws, v);
+        for (size_t i = 0; i < count; i++) {
+            size_t u;
+            size_t arc = arcAt(ws, v, i, &u);
+            if (u == FLOW_UNREACHED || run->p->owner[u] != w->k) continue;
+            if (ws->res[arcReverse(ws, arc)] > 0.0 && run->label[v] + 1 < run->label[u]) {
+                run->label[u] = run->label[v] + 1;
+                enqueue(w, u);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Rebuild the labels of the worker's nodes exactly, over as many rounds as it takes to settle across parts
+ *
+ * Pushes across the boundary are made against labels from the last exchange, so a node may have returned flow to the
+ * source before a path to the sink opened up behind it.  Nodes that can reach the sink again take back their full
+ * supply from the source, which keeps the labels valid for the source arcs too.
+ *
+ * @return 1 if successful; 0 if the solve has been aborted.
+ */
+static int exactRelabel(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    baseLabels(w);
+    int changed = 1, any = 0;
+    for (;;) {
+        if (!regionBarrier(run, w->k)) return 0;
+        spreadLabels(w);
+        publishLabels(w);
+        if (!regionVote(w, changed, &any)) return 0;
+        if (!any) break;
+        changed = acrossLabels(w);
+    }
+    for (size_t i = 0; i < w->count; i++) {
+        size_t v = w->nodes[i];
+        if (run->label[v] <= run->ws->n) {
+            double both = run->source[v] < run->sink[v] ? run->source[v] : run->sink[v];
+            double supply = run->source[v] - both;
+            if (run->back[v] < supply) {
+                run->exc[v] += supply - run->back[v];
+                run->back[v] = supply;
+            }
+        }
+        activate(w, v);
+    }
+    return 1;
+}
+
+/**
+ * @brief Relabel the worker's nodes from scratch against the labels across the boundary, and queue the active ones
+ *
+ * Keeps a discharge from raising labels one step at a time all the way up to the source.
+ */
+static void localRelabel(struct regionworker_t *w) {
+    baseLabels(w);
+    acrossLabels(w);
+    spreadLabels(w);
+    for (size_t i = 0; i < w->count; i++) activate(w, w->nodes[i]);
+}
+
+/**
+ * @brief Discharge the worker's active nodes until none are left
+ *
+ * Nodes across the boundary are seen with the labels of the last exchange; flow pushed to them is recorded in sent.
+ * After as many relabels as the worker has nodes, its labels are rebuilt with localRelabel().
+ */
+static void regionDischarge(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    struct flowworkspace_t *ws = run->ws;
+    size_t n = ws->n;
+    size_t relabels = 0;
+    while (w->len > 0) {
+        size_t v = dequeue(w);
+        while (run->exc[v] > 0.0 && run->label[v] < run->top) {
+            if (relabels >= w->count) {
+                relabels = 0;
+                localRelabel(w);
+                break;
+            }
+            size_t lv = run->label[v];
+            double delta;
+            if (ws->snk[v] > 0.0) {
+                delta = run->exc[v] < ws->snk[v] ? run->exc[v] : ws->snk[v];
+                ws->snk[v] -= delta;
+                run->exc[v] -= delta;
+                run->sinkflow[w->k] += delta;
+                continue;
+            }
+            if (lv > n && run->back[v] > 0.0) {
+                delta = run->exc[v] < run->back[v] ? run->exc[v] : run->back[v];
+                run->back[v] -= delta;
+                run->exc[v] -= delta;
+                continue;
+            }
+            size_t next = (run->back[v] > 0.0) ? n + 1 : run->top;
+            size_t count = arcCount(ws, v);
+            for (size_t i = 0; i < count && run->exc[v] > 0.0; i++) {
+                size_t u;
+                size_t arc = arcAt(ws, v, i, &u);
+                if (u == FLOW_UNREACHED || ws->res[arc] <= 0.0) continue;
+                int local = (run->p->owner[u] == w->k);
+                size_t bi = local ? 0 : boundaryIndex(w, arc);
+                size_t lu = local ? run->label[u] : run->blabel[run->bpeer[bi]];
+                if (lu >= lv) {
+                    if (lu + 1 < next) next = lu + 1;
+                    continue;
+                }
+                delta = run->exc[v] < ws->res[arc] ? run->exc[v] : ws->res[arc];
+                ws->res[arc] -= delta;
+                run->exc[v] -= delta;
+                if (local) {
+                    ws->res[arcReverse(ws, arc)] += delta;
+                    run->exc[u] += delta;
+                    activate(w, u);
+                } else {
+                    run->sent[bi] += delta;
+                }
+            }
+            if (run->exc[v] > 0.0) {
+                run->label[v] = (next < run->top) ? next : run->top;
+                relabels++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Take in the flow pushed to the worker's nodes over boundary arcs in the last round
+ */
+static void regionExchange(struct regionworker_t *w) {
+    struct regionrun_t *run = w->run;
+    struct flowworkspace_t *ws = run->ws;
+    for (size_t i = run->boff[w->k]; i < run->boff[w->k + 1]; i++) {
+        double amount = run->sent[run->bpeer[i]];
+        if (amount > 0.0) {
+            size_t v = arcTail(ws, run->barc[i]);
+            ws->res[run->barc[i]] += amount;
+            run->exc[v] += amount;
+            activate(w, v);
+        }
+    }
+    publishLabels(w);
+}
+
+/**
+ * @brief Run one worker of a region solve to completion
+ * @return 1 if successful; 0 if the solve failed or was aborted.
+ */
+static int regionWorker(struct regionrun_t *run, size_t k) {
+    struct regionworker_t w;
+    memset(&w, 0, sizeof(struct regionworker_t));
+    w.run = run;
+    w.k = k;
+    w.nodes = run->p->parts[k].nodes;
+    w.count = run->p->parts[k].nodecount;
+    w.queue = (size_t *)graphAlloc(run->ws->allocator, w.count * sizeof(size_t));
+    if (w.queue == NULL) {
+        __atomic_store_n(&run->ctl->abort, 1, __ATOMIC_RELEASE);
+        return 0;
+    }
+    regionInit(&w);
+    int retval = regionBarrier(run, k);
+    int active = 0;
+    while (retval) {
+        retval = exactRelabel(&w) && regionVote(&w, w.len > 0, &active);
+        if (!retval || !active) break;
+        for (size_t round = 0; round < FLOW_RELABEL_ROUNDS && active && retval; round++) {
+            for (size_t i = run->boff[k]; i < run->boff[k + 1]; i++) run->sent[i] = 0.0;
+            regionDischarge(&w);
+            retval = regionBarrier(run, k);
+            if (retval) {
+                regionExchange(&w);
+                retval = regionVote(&w, w.len > 0, &active);
+            }
+        }
+    }
+    graphFree(run->ws->allocator, w.queue, w.count * sizeof(size_t));
+    return retval;
+}
+
+/**
+ * @brief List the boundary arcs of every part, with the index of each one's reverse
+ * @return 1 if successful; otherwise, 0.
+ */
+static int regionBoundaries(struct regionrun_t *run) {
+    const struct flowworkspace_t *ws = run->ws;
+    const struct graphallocator_t *a = ws->allocator;
+    const size_t *owner = run->p->owner;
+    run->boff = (size_t *)graphAlloc(a, (run->parts + 1) * sizeof(size_t));
+    if (run->boff == NULL) return 0;
+    memset(run->boff, 0, (run->parts + 1) * sizeof(size_t));
+    for (size_t v = 0; v < ws->n; v++) {
+        size_t count = arcCount(ws, v);
+        for (size_t i = 0; i < count; i++) {
+            size_t u;
+            arcAt(ws, v, i, &u);
+            if (u != FLOW_UNREACHED && owner[u] != owner[v]) run->boff[owner[v] + 1]++;
+        }
+    }
+    for (size_t k = 0; k < run->parts; k++) run->boff[k + 1] += run->boff[k];
+    run->bcount = run->boff[run->parts];
+    size_t len = (run->bcount > 0 ? run->bcount : 1) * sizeof(size_t);
+    run->barc = (size_t *)graphAlloc(a, len);
+    run->bpeer = (size_t *)graphAlloc(a, len);
+    size_t *fill = (size_t *)graphAlloc(a, run->parts * sizeof(size_t));
+    if (run->barc == NULL || run->bpeer == NULL || fill == NULL) {
+        if (fill != NULL) graphFree(a, fill, run->parts * sizeof(size_t));
+        return 0;
+    }
+    memcpy(fill, run->boff, run->parts * sizeof(size_t));
+    for (size_t v = 0; v < ws->n; v++) {
+        size_t count = arcCount(ws, v);
+        for (size_t i = 0; i < count; i++) {
+            size_t u;
+            size_t arc = arcAt(ws, v, i, &u);
+            if (u != FLOW_UNREACHED && owner[u] != owner[v]) run->barc[fill[owner[v]]++] = arc;
+        }
+    }
+    graphFree(a, fill, run->parts * sizeof(size_t));
+    for (size_t k = 0; k < run->parts; k++) {
+        qsort(run->barc + run->boff[k], run->boff[k + 1] - run->boff[k], sizeof(size_t), compareArcs);
+    }
+    struct regionworker_t peer;
+    memset(&peer, 0, sizeof(struct regionworker_t));
+    peer.run = run;
+    for (size_t i = 0; i < run->bcount; i++) {
+        peer.k = owner[arcHead(ws, run->barc[i])];
+        run->bpeer[i] = boundaryIndex(&peer, arcReverse(ws, run->barc[i]));
+    }
+    return 1;
+}
+
+/**
+ * @brief Release the boundary lists of a region solve
+ */
+static void regionFreeBoundaries(struct regionrun_t *run) {
+    const struct graphallocator_t *a = run->ws->allocator;
+    size_t len = (run->bcount > 0 ? run->bcount : 1) * sizeof(size_t);
+    if (run->barc != NULL) graphFree(a, run->barc, len);
+    if (run->bpeer != NULL) graphFree(a, run->bpeer, len);
+    if (run->boff != NULL) graphFree(a, run->boff, (run->parts + 1) * sizeof(size_t));
+}
+
+/**
+ * @brief Create the shared mapping for the node and boundary state of a region solve
+ * @return 1 if successful; otherwise, 0.
+ */
+static int regionMap(struct regionrun_t *run, size_t n) {
+    size_t offctl = 0;
+    size_t offexc = alignUp(offctl + sizeof(struct regioncontrol_t));
+    size_t offback = alignUp(offexc + n * sizeof(double));
+    size_t offlabel = alignUp(offback + n * sizeof(double));
+    size_t offqueued = alignUp(offlabel + n * sizeof(size_t));
+    size_t offsent = alignUp(offqueued + n);
+    size_t offblabel = alignUp(offsent + run->bcount * sizeof(double));
+    size_t offbusy = alignUp(offblabel + run->bcount * sizeof(size_t));
+    size_t offsink = alignUp(offbusy + 2 * run->parts * sizeof(size_t));
+    run->maplen = alignUp(offsink + run->parts * sizeof(double));
+    void *map = mmap(NULL, run->maplen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) return 0;
+    char *base = (char *)map;
+    run->map = map;
+    run->ctl = (struct regioncontrol_t *)(base + offctl);
+    run->exc = (double *)(base + offexc);
+    run->back = (double *)(base + offback);
+    run->label = (size_t *)(base + offlabel);
+    run->queued = (unsigned char *)(base + offqueued);
+    run->sent = (double *)(base + offsent);
+    run->blabel = (size_t *)(base + offblabel);
+    run->busy = (size_t *)(base + offbusy);
+    run->sinkflow = (double *)(base + offsink);
+    return 1;
+}
+
+#endif
+
+/**
+ * @brief Compute the maximum flow of an ARRAY graph with one worker process per part of a partition.
+ *
+ * @param g ARRAY graph
+ * @param p Partition of g
+ * @param source Capacity from the source to each node (nodelen entries)
+ * @param sink Capacity from each node to the sink (nodelen entries)
+ * @param sinkside Set to 1 for the nodes on the sink side of the minimum cut (nodelen entries); may be NULL
+ * @param flow Set to the value of the maximum flow
+ * @return 1 if successful; otherwise, 0.
+ */
+int regionMaxFlow(struct graph_t *g, const struct partition_t *p, const double *source, const double *sink,
+                  unsigned char *sinkside, double *flow) {
+    if (g == NULL || p == NULL || p->g != g || source == NULL || sink == NULL || flow == NULL) return 0;
+    if ((g->gtype & ARRAY) != ARRAY || g->metaImpl == NULL || g->nodeImpl == NULL || p->ids != NULL) return 0;
+    const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+    if (p->nodecount != meta->nodelen) return 0;
+#ifdef __unix__
+    size_t n = meta->nodelen;
+    size_t m = n * meta->degree;
+    struct regionrun_t run;
+    memset(&run, 0, sizeof(struct regionrun_t));
+    run.p = p;
+    run.parts = p->partcount;
+    run.top = 2 * n + 1;
+    run.cap = (const double *)g->capImpl;
+    run.undirected = ((g->gtype & DIRECTED) != DIRECTED);
+    run.source = source;
+    run.sink = sink;
+    run.valueslen = (2 * m + 2 * n) * sizeof(double);
+    run.values = (double *)mmap(NULL, run.valueslen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if ((void *)run.values == MAP_FAILED) return 0;
+    run.ws = newWorkspace(g, 0, run.values);
+    int retval = run.ws != NULL;
+    if (retval) {
+        run.pids = (pid_t *)graphAlloc(run.ws->allocator, run.parts * sizeof(pid_t));
+        retval = run.pids != NULL && regionBoundaries(&run) && regionMap(&run, n);
+    }
+    if (retval) {
+        memset(run.pids, 0, run.parts * sizeof(pid_t));
+        size_t forked = 1;
+        for (; forked < run.parts; forked++) {
+            pid_t pid = fork();
+            if (pid == 0) _exit(regionWorker(&run, forked) ? 0 : 1);
+            if (pid < 0) break;
+            run.pids[forked] = pid;
+        }
+        retval = (forked == run.parts) && regionWorker(&run, 0);
+        if (!retval) __atomic_store_n(&run.ctl->abort, 1, __ATOMIC_RELEASE);
+        for (size_t k = 1; k < run.parts; k++) {
+            int status = 0;
+            if (run.pids[k] <= 0) continue;
+            while (waitpid(run.pids[k], &status, 0) < 0 && errno == EINTR) continue;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) retval = 0;
+        }
+        if (run.failed) retval = 0;
+    }
+    if (retval) {
+        struct flowworkspace_t *ws = run.ws;
+        double total = 0.0;
+        for (size_t k = 0; k < run.parts; k++) total += run.sinkflow[k];
+        //what is left of each source arc, for the search that marks the source side of the cut
+        for (size_t v = 0; v < n; v++) {
+            double both = source[v] < sink[v] ? source[v] : sink[v];
+            ws->src[v] = (source[v] - both) - run.back[v];
+        }
+        if (sinkside != NULL) {
+            buildLevels(ws);
+            for (size_t v = 0; v < n; v++) sinkside[v] = (unsigned char)flowSinkSide(ws, v);
+        }
+        double *farr = (double *)g->flowImpl;
+        for (size_t s = 0; s < m; s++) {
+            double backward = run.undirected ? run.cap[s] : 0.0;
+            farr[s] = (slotHead(ws, s) != FLOW_UNREACHED)
+                      ? ((run.cap[s] - ws->res[s]) - (backward - ws->res[s + m])) / 2.0 : 0.0;
+        }
+        *flow = total;
+    }
+    if (run.map != NULL) munmap(run.map, run.maplen);
+    if (run.ws != NULL) {
+        regionFreeBoundaries(&run);
+        if (run.pids != NULL) graphFree(run.ws->allocator, run.pids, run.parts * sizeof(pid_t));
+        destroyFlowWorkspace((void **)&run.ws);
+    }
+    munmap(run.values, run.valueslen);
+    return retval;
+#else
+    return arrayMaxFlow(g, source, sink, sinkside, flow);
+#endif
+}
@@ -0,0 +1,451 @@
+/**
+ * @brief Bulk allocation and zeroing for large graph arrays.
+ *
+ * Worker threads are only used when the library is built with GRAPHDATA_PTHREADS; otherwise, every operation runs on
+ * the calling thread with the same chunking.
+ */
+
+#include <util/memops.h>
+#include <util/crudops.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef GRAPHDATA_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Work description for a single zeroing worker.
+ */
+struct zerochunk_t {
+    /**
+     * Start of the chunk
+     */
+    char *start;
+    /**
+     * Number of bytes in the chunk
+     */
+    size_t bytes;
+};
+
+/**
+ * @brief Chunk of a copy, handed to a single worker
+ */
+struct copychunk_t {
+    /**
+     * Destination of the chunk
+     */
+    char *dst;
+    /**
+     * Source of the chunk
+     */
+    const char *src;
+    /**
+     * Number of bytes in the chunk
+     */
+    size_t bytes;
+};
+
+/**
+ * @brief Zero a block of memory, using non-temporal stores for the aligned interior where available.
+ * @param start Start of the block
+ * @param bytes Number of bytes to be zeroed
+ */
+static void streamZero(char *start, size_t bytes) {
+#ifdef __SSE2__
+    size_t head = (16 - ((uintptr_t)start & 15)) & 15;
+    if (bytes > head + 64) {
+        memset(start, 0, head);
+        char *p = start + head;
+        char *end = start + bytes;
+        char *vend = p + ((size_t)(end - p) & ~(size_t)63);
+        __m128i zero = _mm_setzero_si128();
+        for (; p < vend; p += 64) {
+            _mm_stream_si128((__m128i *)p, zero);
+            _mm_stream_si128((__m128i *)(p + 16), zero);
+            _mm_stream_si128((__m128i *)(p + 32), zero);
+            _mm_stream_si128((__m128i *)(p + 48), zero);
+        }
+        _mm_sfence();
+        memset(vend, 0, (size_t)(end - vend));
+        return;
+    }
+#endif
+    memset(start, 0, bytes);
+}
+
+#ifdef GRAPHDATA_PTHREADS
+/**
+ * @brief Thread entry point for zeroing a chunk
+ * @param arg zerochunk_t describing the work
+ * @return NULL
+ */
+static void * zeroWorker(void *arg) {
+    struct zerochunk_t *chunk = (struct zerochunk_t *)arg;
+    streamZero(chunk->start, chunk->bytes);
+    return NULL;
+}
+
+/**
+ * @brief Thread entry point for copying a chunk
+ * @param arg copychunk_t describing the work
+ * @return NULL
+ */
+static void * copyWorker(void *arg) {
+    struct copychunk_t *chunk = (struct copychunk_t *)arg;
+    memcpy(chunk->dst, chunk->src, chunk->bytes);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Allocate a zeroed array of count elements of the given size.
+ *
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return Pointer to the zeroed memory, if successful; otherwise, NULL (including on count * size overflow).
+ */
+void * allocZeroed(size_t count, size_t size) {
+    if (count == 0 || size == 0) return NULL;
+    //calloc() checks for overflow, and uses fresh (already zeroed) pages for large requests
+    return calloc(count, size);
+}
+
+/**
+ * @brief Round the byte length up to a multiple of the given page size
+ * @param bytes Length to be rounded
+ * @param psz Page size
+ * @return Rounded length
+ */
+static size_t roundPages(size_t bytes, size_t psz) {
+    return ((bytes + psz - 1) / psz) * psz;
+}
+
+/**
+ * @brief Allocate zeroed heap memory aligned to a huge page boundary
+ * @param bytes Number of bytes
+ * @return Pointer to the memory, or NULL on failure
+ */
+static void * alignedZeroed(size_t bytes) {
+    void *arr = NULL;
+#ifdef _WIN32
+    arr = _aligned_malloc(roundPages(bytes, MEM_HUGE_PAGE), MEM_HUGE_PAGE);
+#else
+    if (posix_memalign(&arr, MEM_HUGE_PAGE, roundPages(bytes, MEM_HUGE_PAGE)) != 0) arr = NULL;
+#endif
+    if (arr != NULL) {
+        //not fresh pages, so zero them--in parallel, so the workers get first touch
+        parallelZero(arr, bytes, 1);
+    }
+    return arr;
+}
+
+#ifdef __linux__
+/**
+ * @brief Create an anonymous mapping for the given strategy
+ * @param bytes Number of bytes
+ * @param strategy ALLOC_MMAP, ALLOC_THP or ALLOC_HUGETLB
+ * @return Pointer to the mapping, or NULL on failure
+ */
+static void * mapZeroed(size_t bytes, enum ALLOCSTRATEGY strategy) {
+    void *arr = NULL;
+    if (strategy == ALLOC_HUGETLB) {
+        arr = mmap(NULL, roundPages(bytes, MEM_HUGE_PAGE), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    } else if (strategy == ALLOC_THP) {
+        //over-allocate, then trim so the mapping starts and ends on huge page boundaries
+        size_t maplen = roundPages(bytes, MEM_HUGE_PAGE);
+        char *raw = mmap(NULL, maplen + MEM_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            char *start = (char *)roundPages((size_t)raw, MEM_HUGE_PAGE);
+            if (start > raw) munmap(raw, (size_t)(start - raw));
+            size_t tail = (size_t)(raw + maplen + MEM_HUGE_PAGE - (start + maplen));
+            if (tail > 0) munmap(start + maplen, tail);
+            madvise(start, maplen, MADV_HUGEPAGE);
+            arr = start;
+        }
+    } else {
+        arr = mmap(NULL, roundPages(bytes, memPageSize(ALLOC_MMAP)), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    return arr == MAP_FAILED ? NULL : arr;
+}
+#endif
+
+/**
+ * @brief Allocate a zeroed array of count elements of the given size, using the given allocation strategy.
+ *
+ * @param a Allocator used for ALLOC_MALLOC arrays; NULL for the default
+ * @param count Number of elements
+ * @param size Size of each element
+ * @param strategy Requested allocation strategy
+ * @param used Set to the strategy actually used
+ * @return Pointer to the zeroed memory, if successful; otherwise, NULL.
+ */
+void * allocArray(const struct graphallocator_t *a, size_t count, size_t size, enum ALLOCSTRATEGY strategy,
+                  enum ALLOCSTRATEGY *used) {
+    if (count == 0 || size == 0 || count > ((size_t)-1) / size) return NULL;
+    size_t bytes = count * size;
+    void *arr = NULL;
+    if (!graphMemReserve(a, bytes)) return NULL;
+#ifdef __linux__
+    for (enum ALLOCSTRATEGY s = strategy; arr == NULL && s >= ALLOC_MMAP; s--) {
+        arr = mapZeroed(bytes, s);
+        if (arr != NULL) *used = s;
+    }
+#endif
+    if (arr == NULL && strategy == ALLOC_ALIGNED) {
+        arr = alignedZeroed(bytes);
+        if (arr != NULL) *used = ALLOC_ALIGNED;
+    }
+    if (arr == NULL) {
+        if (isDefaultAllocator(a)) {
+            arr = allocZeroed(count, size);
+        } else {
+            //custom allocators make no promise of zeroed memory; graphAlloc() does its own accounting
+            graphMemRelease(a, bytes);
+            arr = graphAlloc(a, bytes);
+            if (arr == NULL) return NULL;
+            parallelZero(arr, count, size);
+        }
+        if (arr != NULL) *used = ALLOC_MALLOC;
+    }
+    if (arr == NULL) graphMemRelease(a, bytes);
+    return arr;
+}
+
+/**
+ * @brief Release an array created with allocArray()
+ *
+ * @param a Allocator the array was created with; NULL for the default
+ * @param count Number of elements the array was allocated with
+ * @param size Element size the array was allocated with
+ * @param used Strategy reported by allocArray()
+ * @param arrptr pointer-to-pointer for the array
+ * @return 1 if successful; 0 if error
+ */
+int freeArray(const struct graphallocator_t *a, size_t count, size_t size, enum ALLOCSTRATEGY used, void **arrptr) {
+    int retval = 0;
+    if (*arrptr != NULL) {
+        retval = 1;
+        switch (used) {
+#ifdef __linux__
+            case ALLOC_MMAP:
+            case ALLOC_THP:
+            case ALLOC_HUGETLB:
+                retval = (munmap(*arrptr, roundPages(count * size, memPageSize(used))) == 0);
+                graphMemRelease(a, count * size);
+                break;
+#endif
+            case ALLOC_ALIGNED:
+#ifdef _WIN32
+                _aligned_free(*arrptr);
+#else
+                free(*arrptr);
+#endif
+                graphMemRelease(a, count * size);
+                break;
+            default:
+                graphFree(a, *arrptr, count * size);
+                break;
+        }
+        *arrptr = NULL;
+    }
+    return retval;
+}
+
+/**
+ * @brief Memory actually taken by an array created with allocArray(), including the rounding to whole pages
+ * @param count Number of elements the array was allocated with
+ * @param size Element size the array was allocated with
+ * @param used Strategy reported by allocArray()
+ * @return Size in bytes
+ */
+size_t arrayFootprint(size_t count, size_t size, enum ALLOCSTRATEGY used) {
+    switch (used) {
+        case ALLOC_ALIGNED:
+            return roundPages(count * size, MEM_HUGE_PAGE);
+        case ALLOC_MMAP:
+        case ALLOC_THP:
+        case ALLOC_HUGETLB:
+            return roundPages(count * size, memPageSize(used));
+        default:
+            return count * size;
+    }
+}
+
+/**
+ * @brief Page size backing memory allocated with the given strategy.
+ * @param used Strategy reported by allocArray()
+ * @return Page size in bytes
+ */
+size_t memPageSize(enum ALLOCSTRATEGY used) {
+    if (used == ALLOC_THP || used == ALLOC_HUGETLB) return MEM_HUGE_PAGE;
+#ifdef __linux__
+    long psz = sysconf(_SC_PAGESIZE);
+    if (psz > 0) return (size_t)psz;
+#endif
+    return 4096;
+}
+
+/**
+ * @brief Calculate the number of worker threads to be used for a bulk operation over the given number of bytes.
+ *
+ * @param bytes Total size of the operation
+ * @return Number of workers (including the calling thread); always at least 1.
+ */
+size_t memThreadCount(size_t bytes) {
+    size_t workers = 1;
+#ifdef GRAPHDATA_PTHREADS
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 1) {
+        workers = bytes / MEM_MIN_CHUNK;
+        if (workers > (size_t)cpus) workers = (size_t)cpus;
+        if (workers == 0) workers = 1;
+    }
+#endif
+    return workers;
+}
+
+/**
+ * @brief Calculate the [start, end) range of the given part when len elements are split into parts.
+ *
+ * @param len Number of elements to be split
+ * @param parts Number of parts
+ * @param part Zero-based part number
+ * @param start Set to the first element of the part
+ * @param end Set to one past the last element of the part
+ * @return 1 if successful; 0 if parts is zero or part is out of range.
+ */
+int memChunkRange(size_t len, size_t parts, size_t part, size_t *start, size_t *end) {
+    int retval = 0;
+    if (parts > 0 && part < parts) {
+        size_t base = len / parts;
+        size_t extra = len % parts;
+        *start = part * base + (part < extra ? part : extra);
+        *end = *start + base + (part < extra ? 1 : 0);
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Zero the given memory using all available workers and streaming (non-temporal) stores.
+ *
+ * @param base Start of the memory to be zeroed
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return 1 if successful; 0 if base is NULL.
+ */
+int parallelZero(void *base, size_t count, size_t size) {
+    if (base == NULL) return 0;
+    size_t workers = memThreadCount(count * size);
+    if (workers == 1) {
+        streamZero((char *)base, count * size);
+        return 1;
+    }
+#ifdef GRAPHDATA_PTHREADS
+    struct zerochunk_t chunks[workers];
+    pthread_t threads[workers];
+    int started[workers];
+    for (size_t i = 0; i < workers; i++) {
+        size_t start, end;
+        memChunkRange(count, workers, i, &start, &end);
+        chunks[i].start = (char *)base + start * size;
+        chunks[i].bytes = (end - start) * size;
+        started[i] = 0;
+    }
+    //The calling thread takes the first chunk
+    for (size_t i = 1; i < workers; i++) {
+        started[i] = (pthread_create(&threads[i], NULL, zeroWorker, &chunks[i]) == 0);
+    }
+    streamZero(chunks[0].start, chunks[0].bytes);
+    for (size_t i = 1; i < workers; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            //could not start a worker--do the work here
+            streamZero(chunks[i].start, chunks[i].bytes);
+        }
+    }
+#endif
+    return 1;
+}
+
+/**
+ * @brief Copy memory using all available workers.
+ *
+ * @param dst Destination of the copy
+ * @param src Source of the copy
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return 1 if successful; 0 if either pointer is NULL.
+ */
+int parallelCopy(void *dst, const void *src, size_t count, size_t size) {
+    if (dst == NULL || src == NULL) return 0;
+    size_t workers = memThreadCount(count * size);
+    if (workers == 1) {
+        memcpy(dst, src, count * size);
+        return 1;
+    }
+#ifdef GRAPHDATA_PTHREADS
+    struct copychunk_t chunks[workers];
+    pthread_t threads[workers];
+    int started[workers];
+    for (size_t i = 0; i < workers; i++) {
+        size_t start, end;
+        memChunkRange(count, workers, i, &start, &end);
+        chunks[i].dst = (char *)dst + start * size;
+        chunks[i].src = (const char *)src + start * size;
+        chunks[i].bytes = (end - start) * size;
+        started[i] = 0;
+    }
+    //The calling thread takes the first chunk
+    for (size_t i = 1; i < workers; i++) {
+        started[i] = (pthread_create(&threads[i], NULL, copyWorker, &chunks[i]) == 0);
+    }
+    memcpy(chunks[0].dst, chunks[0].src, chunks[0].bytes);
+    for (size_t i = 1; i < workers; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            //could not start a worker--do the work here
+            memcpy(chunks[i].dst, chunks[i].src, chunks[i].bytes);
+        }
+    }
+#endif
+    return 1;
+}
+
+/**
+ * @brief Atomically add a value to a double.
+ *
+ * @param slot Value to be adjusted
+ * @param delta Amount to be added
+ * @param order Memory ordering of the update
+ * @return Value of the slot after the update
+ */
+double atomicAddDouble(double *slot, double delta, enum MEMORDER order) {
+    uint64_t *bits = (uint64_t *)slot;
+    int success = (order == MEMORDER_RELAXED) ? __ATOMIC_RELAXED : __ATOMIC_SEQ_CST;
+    uint64_t expected = __atomic_load_n(bits, __ATOMIC_RELAXED);
+    uint64_t desired;
+    double val;
+    do {
+        memcpy(&val, &expected, sizeof(double));
+        val += delta;
+        memcpy(&desired, &val, sizeof(double));
+        //on failure, expected is refreshed with the current pattern and the sum is recomputed
+    } while (!__atomic_compare_exchange_n(bits, &expected, desired, 1, success, __ATOMIC_RELAXED));
+    return val;
+}
@@ -0,0 +1,227 @@
+/**
+ * @brief Memory footprint of graphs.
+ */
+
+#include <util/memusage.h>
+#include <util/crudops.h>
+#include <util/memops.h>
+#include <util/attrstore.h>
+#include <util/interntable.h>
+#include <util/snapshot.h>
+#include <util/syncops.h>
+#include <util/graphstats.h>
+#include <util/adaptive.h>
+#include <util/partition.h>
+#include <impl/arraygraph.h>
+#include <impl/hashgraph.h>
+#include <impl/sharedmmapgraph.h>
+#include <string.h>
+
+/**
+ * @brief Heap block alignment assumed for the default allocator
+ */
+#define MEM_HEAP_ALIGN 16
+
+/**
+ * @brief Estimated overhead of one heap block of the given size
+ *
+ * Modelled on common malloc() implementations: one size_t header, with blocks rounded up to MEM_HEAP_ALIGN.
+ *
+ * @param g Graph the block belongs to; custom allocators are assumed to add nothing
+ * @param size Requested size of the block
+ * @return Estimated bytes beyond the requested size
+ */
+static size_t heapSlack(const struct graph_t *g, size_t size) {
+    if (!isDefaultAllocator(&g->allocator)) return 0;
+    size_t block = (size + sizeof(size_t) + MEM_HEAP_ALIGN - 1) & ~((size_t)MEM_HEAP_ALIGN - 1);
+    return block - size;
+}
+
+/**
+ * @brief Count one backing array created with allocArray()
+ * @param g Graph owning the array
+ * @param count Number of elements
+ * @param size Element size
+ * @param used Allocation strategy the array was created with
+ * @param bytes Incremented by the array size
+ * @param overhead Incremented by the page rounding or heap block overhead
+ */
+static void countArray(const struct graph_t *g, size_t count, size_t size, enum ALLOCSTRATEGY used, size_t *bytes,
+                       size_t *overhead) {
+    size_t len = count * size;
+    *bytes += len;
+    *overhead += (used == ALLOC_MALLOC) ? heapSlack(g, len) : arrayFootprint(count, size, used) - len;
+}
+
+/**
+ * @brief Count a feature list
+ * @param g Graph owning the list
+ * @param f First feature
+ * @param r Report to be updated
+ */
+static void countFeatures(const struct graph_t *g, const struct feature_t *f, struct graphmemory_t *r) {
+    for (; f != NULL; f = f->next) {
+        r->features += sizeof(struct feature_t);
+        r->overhead += heapSlack(g, sizeof(struct feature_t));
+    }
+}
+
+/**
+ * @brief Count the backing data of an ARRAY graph
+ * @param g ARRAY graph
+ * @param r Report to be updated
+ */
+static void countArrayGraph(const struct graph_t *g, struct graphmemory_t *r) {
+    const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+    if (meta == NULL) return;
+    size_t slots = meta->nodelen * meta->degree;
+    r->bookkeeping += sizeof(struct arraydata_t);
+    r->overhead += heapSlack(g, sizeof(struct arraydata_t));
+    if (meta->topology == NULL && g->nodeImpl != NULL) {
+        countArray(g, slots, sizeof(size_t), meta->nodealloc, &r->topology, &r->overhead);
+    }
+    if (meta->layers != NULL) {
+        r->bookkeeping += meta->layercap * sizeof(struct valuelayer_t);
+        r->overhead += heapSlack(g, meta->layercap * sizeof(struct valuelayer_t));
+        for (size_t l = 0; l < meta->layercount; l++) {
+            const struct valuelayer_t *layer = meta->layers + l;
+            if (layer->cap != NULL) countArray(g, slots, sizeof(double), layer->capalloc, &r->capacities, &r->overhead);
+            if (layer->flow != NULL) countArray(g, slots, sizeof(double), layer->flowalloc, &r->flows, &r->overhead);
+        }
+    } else {
+        if (g->capImpl != NULL) countArray(g, slots, sizeof(double), meta->capalloc, &r->capacities, &r->overhead);
+        if (g->flowImpl != NULL) countArray(g, slots, sizeof(double), meta->flowalloc, &r->flows, &r->overhead);
+    }
+}
+
+/**
+ * @brief Count the tile cache of a SHARED_MMAP graph
+ *
+ * Only the tiles mapped at the time are counted, split between topology, capacities and flows as they are laid out;
+ * the page rounding of each tile is overhead.
+ *
+ * @param g SHARED_MMAP graph
+ * @param r Report to be updated
+ */
+static void countMmapGraph(const struct graph_t *g, struct graphmemory_t *r) {
+    const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+    r->bookkeeping += sizeof(struct mmapdata_t) + mmapCacheBytes(g);
+    r->overhead += heapSlack(g, sizeof(struct mmapdata_t));
+    size_t tiles = mmapMappedBytes(g) / meta->tilebytes;
+    size_t slots = meta->tilenodes * meta->degree;
+    r->topology += tiles * slots * sizeof(size_t);
+    r->capacities += tiles * slots * sizeof(double);
+    r->flows += tiles * slots * sizeof(double);
+    r->overhead += tiles * (meta->tilebytes - slots * (sizeof(size_t) + 2 * sizeof(double)));
+}
+
+/**
+ * @brief Count the node and edge structures of a LINKED or HASHED graph
+ *
+ * The values held in each edge_t are reported as capacities and flows; the rest of the edge_t is topology.  Snapshot
+ * views only own their node list; the edges belong to the live graph.
+ *
+ * @param g LINKED or HASHED graph
+ * @param r Report to be updated
+ */
+static void countLinkGraph(const struct graph_t *g, struct graphmemory_t *r) {
+    int ownsedges = !isSnapshot(g);
+    for (const struct node_t *n = (const struct node_t *)g->nodeImpl; n != NULL; n = n->next) {
+        r->topology += sizeof(struct node_t);
+        r->overhead += heapSlack(g, sizeof(struct node_t));
+        countFeatures(g, n->attrs, r);
+        if (!ownsedges) continue;
+        for (const struct edge_t *e = n->edges; e != NULL; e = e->next) {
+            r->topology += sizeof(struct edge_t) - 2 * sizeof(double);
+            r->capacities += sizeof(double);
+            r->flows += sizeof(double);
+            r->overhead += heapSlack(g, sizeof(struct edge_t));
+            countFeatures(g, e->attrs, r);
+        }
+    }
+}
+
+/**
+ * @brief Count the node index of a HASHED graph
+ * @param g HASHED graph
+ * @param r Report to be updated
+ */
+static void countHashIndex(const struct graph_t *g, struct graphmemory_t *r) {
+    const struct hashdata_t *meta = (const struct hashdata_t *)g->metaImpl;
+    if (meta == NULL) return;
+    r->bookkeeping += sizeof(struct hashdata_t);
+    r->topology += meta->slotcount * sizeof(struct node_t *);
+    r->overhead += heapSlack(g, sizeof(struct hashdata_t)) + heapSlack(g, meta->slotcount * sizeof(struct node_t *));
+}
+
+/**
+ * @brief Count the feature name table and attribute columns
+ * @param g Graph in question
+ * @param r Report to be updated
+ */
+static void countFeatureStores(const struct graph_t *g, struct graphmemory_t *r) {
+    const struct interntable_t *t = g->features;
+    if (t != NULL) {
+        size_t bytes = sizeof(struct interntable_t) + t->slotcount * sizeof(size_t)
+                       + t->entrycap * sizeof(struct internentry_t);
+        r->overhead += heapSlack(g, sizeof(struct interntable_t)) + heapSlack(g, t->slotcount * sizeof(size_t))
+                       + heapSlack(g, t->entrycap * sizeof(struct internentry_t));
+        for (size_t id = 0; id < t->count; id++) {
+            size_t len = strlen(t->entries[id].name) + 1;
+            bytes += len;
+            r->overhead += heapSlack(g, len);
+        }
+        r->features += bytes;
+    }
+    const struct attrstore_t *store = g->attrs;
+    if (store != NULL) {
+        r->features += sizeof(struct attrstore_t) + store->colcap * sizeof(struct attrcolumn_t);
+        r->overhead += heapSlack(g, sizeof(struct attrstore_t)) + heapSlack(g, store->colcap * sizeof(struct attrcolumn_t));
+        for (size_t c = 0; c < store->colcount; c++) {
+            r->features += store->cols[c].len * sizeof(double);
+            r->overhead += heapSlack(g, store->cols[c].len * sizeof(double));
+        }
+    }
+}
+
+/**
+ * @brief Report the memory held by a graph
+ *
+ * @param g Graph in question
+ * @param report Filled in with the breakdown
+ * @return 1 if successful; 0 if the graph or report is NULL.
+ */
+int graphMemoryUsage(const struct graph_t *g, struct graphmemory_t *report) {
+    if (g == NULL || report == NULL) return 0;
+    memset(report, 0, sizeof(struct graphmemory_t));
+
+    report->bookkeeping = sizeof(struct graph_t) + graphSyncMemory(g) + snapshotMemory(g) + graphStatsMemory(g)
+                         + graphAdaptMemory(g) + partitionViewMemory(g);
+    report->overhead = heapSlack(g, sizeof(struct graph_t));
+    if (g->config != NULL) {
+        report->bookkeeping += sizeof(struct graphconfig_t);
+        report->overhead += heapSlack(g, sizeof(struct graphconfig_t));
+    }
+    if (g->labels != NULL) {
+        report->labels = sizeof(struct labels_t) + g->labels->labelcount * sizeof(size_t);
+        report->overhead += heapSlack(g, sizeof(struct labels_t)) + heapSlack(g, g->labels->labelcount * sizeof(size_t));
+    }
+
+    if (isPartitionView(g)) {
+        //partition views share the backing data of the partitioned graph
+    } else if (isMmapGraph(g)) {
+        countMmapGraph(g, report);
+    } else if ((g->gtype & ARRAY) == ARRAY) {
+        countArrayGraph(g, report);
+    } else if ((g->gtype & LINKED) == LINKED) {
+        countLinkGraph(g, report);
+    } else if ((g->gtype & HASHED) == HASHED) {
+        countLinkGraph(g, report);
+        countHashIndex(g, report);
+    }
+    countFeatureStores(g, report);
+
+    report->total = report->topology + report->capacities + report->flows + report->features + report->labels
+                    + report->bookkeeping + report->overhead;
+    return 1;
+}
@@ -0,0 +1,269 @@
+/**
+ * @brief NUMA placement for graph backing arrays.
+ *
+ * The Linux implementation uses the mbind() and move_pages() system calls directly, so there is no dependency on
+ * libnuma.  Placement is best-effort: if the kernel refuses a policy, the memory is still usable with the default
+ * placement.
+ */
+
+#include <util/numaops.h>
+#include <util/memops.h>
+#include <impl/arraygraph.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Maximum NUMA node count supported for placement masks.
+ */
+#define NUMA_MAX_NODES 1024
+/**
+ * @brief Number of pages queried per move_pages() call when reporting.
+ */
+#define NUMA_QUERY_BATCH 1024
+
+#ifdef __linux__
+/**
+ * @brief Bits per word of a node mask
+ */
+#define NUMA_MASK_BITS (8 * sizeof(unsigned long))
+
+/**
+ * @brief Size of a system page
+ * @return Page size in bytes
+ */
+static size_t pageSize() {
+    long psz = sysconf(_SC_PAGESIZE);
+    return psz > 0 ? (size_t)psz : 4096;
+}
+
+/**
+ * @brief Bind a page-aligned range to the given mode and node mask.
+ * @param addr Start of the range (page-aligned)
+ * @param len Length of the range
+ * @param mode MPOL_* mode
+ * @param mask Node mask
+ * @return 1 if the kernel accepted the policy; otherwise, 0.
+ */
+static int bindRange(void *addr, size_t len, int mode, const unsigned long *mask) {
+    if (len == 0) return 1;
+    return syscall(SYS_mbind, addr, len, mode, mask, (unsigned long)NUMA_MAX_NODES, 0UL) == 0;
+}
+
+/**
+ * @brief Count the pages of [start, start+len) by the NUMA node that currently holds them
+ * @param start Start of the range
+ * @param len Length of the range
+ * @param slice Slice structure to be updated
+ * @param numanodes Length of slice->nodepages
+ */
+static void countPages(const char *start, size_t len, struct numaslice_t *slice, size_t numanodes) {
+    size_t psz = pageSize();
+    const char *first = (const char *)((size_t)start & ~(psz - 1));
+    const char *end = start + len;
+    void *pages[NUMA_QUERY_BATCH];
+    int status[NUMA_QUERY_BATCH];
+    const char *p = first;
+    while (p < end) {
+        unsigned long count = 0;
+        while (count < NUMA_QUERY_BATCH && p < end) {
+            pages[count++] = (void *)p;
+            p += psz;
+        }
+        slice->pages += count;
+        if (syscall(SYS_move_pages, 0, count, pages, NULL, status, 0) == 0) {
+            for (unsigned long i = 0; i < count; i++) {
+                if (status[i] >= 0) {
+                    slice->resident++;
+                    if ((size_t)status[i] < numanodes) slice->nodepages[status[i]]++;
+                }
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Parse a kernel node list (ranges such as "0-1,3") into ascending node ids.
+ *
+ * @param list Node list to be parsed
+ * @param ids Array that receives the node ids
+ * @param maxids Length of ids
+ * @return Number of node ids written to ids
+ */
+size_t numaParseNodeList(const char *list, int *ids, size_t maxids) {
+    size_t count = 0;
+    if (list == NULL || ids == NULL) return 0;
+    const char *p = list;
+    while (*p != '\0' && count < maxids) {
+        if (*p < '0' || *p > '9') {
+            p++;
+            continue;
+        }
+        char *next;
+        unsigned long first = strtoul(p, &next, 10);
+        unsigned long last = first;
+        p = next;
+        if (*p == '-' && p[1] >= '0' && p[1] <= '9') {
+            last = strtoul(p + 1, &next, 10);
+            p = next;
+        }
+        for (unsigned long n = first; n <= last && n < NUMA_MAX_NODES && count < maxids; n++) {
+            //the kernel lists nodes in ascending order; ignore anything that would break that
+            if (count == 0 || (int)n > ids[count - 1]) ids[count++] = (int)n;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Ids of the online NUMA nodes, in ascending order.
+ *
+ * @param ids Array that receives the node ids
+ * @param maxids Length of ids
+ * @return Number of node ids written to ids; on systems without NUMA support, a single node 0.
+ */
+size_t numaOnlineNodes(int *ids, size_t maxids) {
+    size_t count = 0;
+    if (ids == NULL || maxids == 0) return 0;
+#ifdef __linux__
+    FILE *f = fopen("/sys/devices/system/node/online", "r");
+    if (f != NULL) {
+        char buf[256];
+        if (fgets(buf, sizeof(buf), f) != NULL) count = numaParseNodeList(buf, ids, maxids);
+        fclose(f);
+    }
+#endif
+    if (count == 0) {
+        ids[0] = 0;
+        count = 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Number of NUMA nodes available on the system.
+ * @return Number of online NUMA nodes; 1 on systems without NUMA support.
+ */
+size_t numaNodeCount() {
+    int ids[NUMA_MAX_NODES];
+    return numaOnlineNodes(ids, NUMA_MAX_NODES);
+}
+
+/**
+ * @brief Bind a placement policy to an array of rows.
+ *
+ * @param arr Array to be placed
+ * @param rows Number of rows (graph nodes)
+ * @param rowsize Size in bytes of each row (degree * element size)
+ * @param policy Placement policy
+ * @param pagesize Size of the pages backing the array
+ * @return 1 if the policy was applied (or there was nothing to apply); otherwise, 0.
+ */
+int numaBind(void *arr, size_t rows, size_t rowsize, enum NUMAPOLICY policy, size_t pagesize) {
+    int retval = 1;
+    if (arr == NULL || pagesize == 0) return 0;
+#ifdef __linux__
+    int ids[NUMA_MAX_NODES];
+    size_t numanodes = numaOnlineNodes(ids, NUMA_MAX_NODES);
+    if (numanodes > 1 && policy != NUMA_DEFAULT) {
+        size_t maplen = ((rows * rowsize + pagesize - 1) / pagesize) * pagesize;
+        unsigned long mask[NUMA_MAX_NODES / NUMA_MASK_BITS];
+        memset(mask, 0, sizeof(mask));
+        if (policy == NUMA_INTERLEAVE) {
+            for (size_t n = 0; n < numanodes; n++) mask[ids[n] / NUMA_MASK_BITS] |= 1UL << (ids[n] % NUMA_MASK_BITS);
+            retval = bindRange(arr, maplen, MPOL_INTERLEAVE, mask);
+        } else if (policy == NUMA_PARTITION) {
+            size_t prevend = 0;
+            for (size_t n = 0; n < numanodes; n++) {
+                size_t start, end;
+                memChunkRange(rows, numanodes, n, &start, &end);
+                //round the slice end to the nearest page boundary; the last slice takes the rest of the mapping
+                size_t bend = (n == numanodes - 1) ? maplen : ((end * rowsize + pagesize / 2) / pagesize) * pagesize;
+                if (bend > prevend) {
+                    memset(mask, 0, sizeof(mask));
+                    mask[ids[n] / NUMA_MASK_BITS] = 1UL << (ids[n] % NUMA_MASK_BITS);
+                    //preferred rather than bound, so a full node spills over instead of failing
+                    retval = retval & bindRange((char *)arr + prevend, bend - prevend, MPOL_PREFERRED, mask);
+                    prevend = bend;
+                }
+            }
+        }
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Create a report of where the backing arrays of the graph currently reside.
+ *
+ * @param g Graph to be inspected
+ * @return Pointer to a new report, if successful; otherwise, NULL.  Release with destroyNumaReport().
+ */
+struct numareport_t * graphNumaReport(const struct graph_t *g) {
+    if (g == NULL || g->metaImpl == NULL || (g->gtype & (ARRAY | SHARED_MMAP)) != ARRAY) return NULL;
+    struct arraydata_t *meta = (struct arraydata_t *)g->metaImpl;
+    struct numareport_t *report = (struct numareport_t *)malloc(sizeof(struct numareport_t));
+    if (report == NULL) return NULL;
+    int ids[NUMA_MAX_NODES];
+    report->policy = meta->numa;
+    report->slicecount = numaOnlineNodes(ids, NUMA_MAX_NODES);
+    //nodepages is indexed by node id, so it spans up to the highest online id
+    report->numanodes = (size_t)ids[report->slicecount - 1] + 1;
+    report->slices = (struct numaslice_t *)calloc(report->slicecount, sizeof(struct numaslice_t));
+    if (report->slices == NULL) {
+        free(report);
+        return NULL;
+    }
+    for (size_t n = 0; n < report->slicecount; n++) {
+        struct numaslice_t *slice = report->slices + n;
+        memChunkRange(meta->nodelen, report->slicecount, n, &slice->firstnode, &slice->endnode);
+        slice->numanode = (meta->numa == NUMA_PARTITION) ? ids[n] : -1;
+        slice->nodepages = (size_t *)calloc(report->numanodes, sizeof(size_t));
+        if (slice->nodepages == NULL) {
+            destroyNumaReport((void **)&report);
+            return NULL;
+        }
+#ifdef __linux__
+        size_t first = slice->firstnode * meta->degree;
+        size_t len = (slice->endnode - slice->firstnode) * meta->degree;
+        if (len > 0) {
+            if (g->nodeImpl != NULL)
+                countPages((const char *)((size_t *)g->nodeImpl + first), len * sizeof(size_t), slice, report->numanodes);
+            if (g->capImpl != NULL)
+                countPages((const char *)((double *)g->capImpl + first), len * sizeof(double), slice, report->numanodes);
+            if (g->flowImpl != NULL)
+                countPages((const char *)((double *)g->flowImpl + first), len * sizeof(double), slice, report->numanodes);
+        }
+#endif
+    }
+    return report;
+}
+
+/**
+ * @brief Clear out a NUMA report and all underlying structures
+ *
+ * @param rptr pointer-to-pointer for the report
+ * @return 1 if successful; 0 if error
+ */
+int destroyNumaReport(void **rptr) {
+    int retval = 0;
+    if (*rptr != NULL) {
+        struct numareport_t *report = (struct numareport_t *)*rptr;
+        if (report->slices != NULL) {
+            for (size_t n = 0; n < report->slicecount; n++) {
+                free(report->slices[n].nodepages);
+            }
+            free(report->slices);
+        }
+        free(report);
+        *rptr = NULL;
+        retval = 1;
+    }
+    return retval;
+}
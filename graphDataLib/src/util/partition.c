@@ -0,0 +1,1124 @@
+/**
+ * @brief Graph partitioning and domain decomposition.
+ */
+
+#include <util/partition.h>
+#include <util/crudops.h>
+#include <util/cartesian.h>
+#include <util/memops.h>
+#include <graphInit.h>
+#include <impl/arraygraph.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief PART_MULTILEVEL coarsens until the graph has at most this many nodes per part
+ */
+#define PART_COARSEN_NODES 32
+
+/**
+ * @brief Coarsening stops when a level keeps more than this percentage of the nodes of the level before
+ */
+#define PART_COARSEN_STALL 90
+
+/**
+ * @brief Largest number of boundary refinement passes per level
+ */
+#define PART_REFINE_PASSES 8
+
+/**
+ * @brief Seed of the node visiting order used by the matching, so that partitions are reproducible
+ */
+#define PART_SEED 0x9e3779b97f4a7c15ULL
+
+/**
+ * @brief View state of a partition view
+ */
+struct partview_t {
+    /**
+     * @brief Partition the view was made from
+     */
+    struct partition_t *p;
+    /**
+     * @brief Part number of the view
+     */
+    size_t part;
+    /**
+     * @brief Implementation of the partitioned graph when the view was made
+     */
+    enum GRAPHDOMAIN imptype;
+    /**
+     * @brief Unwrapped operations for imptype
+     */
+    struct graphops_t base;
+    /**
+     * @brief Unwrapped operations for the other of LINKED and HASHED, once migrateGraph() has moved the graph
+     */
+    struct graphops_t moved;
+};
+
+/**
+ * @brief Symmetric adjacency structure with node and edge weights, over node positions
+ */
+struct partgraph_t {
+    size_t n;
+    /**
+     * @brief Start of the neighbors of each node in adj (n + 1 entries)
+     */
+    size_t *xadj;
+    size_t *adj;
+    size_t *adjw;
+    /**
+     * @brief Allocated length of adj and adjw
+     */
+    size_t adjcap;
+    size_t *vwgt;
+};
+
+static size_t * allocSizes(const struct graphallocator_t *a, size_t count) {
+    return (size_t *)graphAlloc(a, (count > 0 ? count : 1) * sizeof(size_t));
+}
+
+static void freeSizes(const struct graphallocator_t *a, size_t *arr, size_t count) {
+    graphFree(a, arr, (count > 0 ? count : 1) * sizeof(size_t));
+}
+
+static void freePartGraph(const struct graphallocator_t *a, struct partgraph_t *pg) {
+    freeSizes(a, pg->xadj, pg->n + 1);
+    freeSizes(a, pg->adj, pg->adjcap);
+    freeSizes(a, pg->adjw, pg->adjcap);
+    freeSizes(a, pg->vwgt, pg->n);
+    memset(pg, 0, sizeof(struct partgraph_t));
+}
+
+static int allocPartGraph(const struct graphallocator_t *a, struct partgraph_t *pg, size_t n, size_t adjcap) {
+    memset(pg, 0, sizeof(struct partgraph_t));
+    pg->n = n;
+    pg->adjcap = adjcap;
+    pg->xadj = allocSizes(a, n + 1);
+    pg->adj = allocSizes(a, adjcap);
+    pg->adjw = allocSizes(a, adjcap);
+    pg->vwgt = allocSizes(a, n);
+    if (pg->xadj == NULL || pg->adj == NULL || pg->adjw == NULL || pg->vwgt == NULL) {
+        freePartGraph(a, pg);
+        return 0;
+    }
+    return 1;
+}
+
+static int compareIds(const void *a, const void *b) {
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Binary search of an ascending id array
+ * @return Position of the id; count if it is not there.
+ */
+static size_t findId(const size_t *ids, size_t count, size_t id) {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ids[mid] < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < count && ids[lo] == id) ? lo : count;
+}
+
+/**
+ * @brief Function called for each edge of the graph, with the positions of its ends
+ */
+typedef void (*funcPartEdge)(size_t u, size_t v, void *ctx);
+
+/**
+ * @brief Visit every edge of the graph between two different partitioned nodes
+ *
+ * u is the owning end: the node holding the edge in its slots or list.
+ */
+static void forEachPartEdge(const struct partition_t *p, funcPartEdge fn, void *ctx) {
+    const struct graph_t *g = p->g;
+    if ((g->gtype & ARRAY) == ARRAY) {
+        const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+        const size_t *nodes = (const size_t *)g->nodeImpl;
+        for (size_t s = 0; s < meta->nodelen * meta->degree; s++) {
+            size_t u = s / meta->degree;
+            size_t v = nodes[s];
+            if (v != 0 && v < p->nodecount && v != u) fn(u, v, ctx);
+        }
+        return;
+    }
+    size_t u = 0;
+    for (const struct node_t *n = (const struct node_t *)g->nodeImpl; n != NULL; n = n->next) {
+        u = findId(p->ids, p->nodecount, n->nodeid);
+        for (const struct edge_t *e = n->edges; e != NULL; e = e->next) {
+            size_t v = findId(p->ids, p->nodecount, e->v);
+            if (v < p->nodecount && v != u) fn(u, v, ctx);
+        }
+    }
+}
+
+/**
+ * @brief Adjacency under construction
+ */
+struct adjbuild_t {
+    struct partgraph_t *pg;
+    size_t *outdeg;
+    size_t *fill;
+};
+
+static void countEdge(size_t u, size_t v, void *ctx) {
+    struct adjbuild_t *b = (struct adjbuild_t *)ctx;
+    b->pg->xadj[u + 1]++;
+    b->pg->xadj[v + 1]++;
+    b->outdeg[u]++;
+}
+
+static void placeEdge(size_t u, size_t v, void *ctx) {
+    struct adjbuild_t *b = (struct adjbuild_t *)ctx;
+    size_t su = b->pg->xadj[u] + b->fill[u]++;
+    size_t sv = b->pg->xadj[v] + b->fill[v]++;
+    b->pg->adj[su] = v;
+    b->pg->adjw[su] = 1;
+    b->pg->adj[sv] = u;
+    b->pg->adjw[sv] = 1;
+}
+
+/**
+ * @brief Collect the node ids of the graph, and build its symmetric adjacency
+ * @param p Partition with its graph set
+ * @param pg Set to the adjacency, with unit weights
+ * @param outdeg Set to the number of edges owned by each node (nodecount entries, allocated here)
+ * @return 1 if successful; otherwise, 0.
+ */
+static int buildAdjacency(struct partition_t *p, struct partgraph_t *pg, size_t **outdeg) {
+    const struct graphallocator_t *a = p->allocator;
+    const struct graph_t *g = p->g;
+    if ((g->gtype & ARRAY) == ARRAY) {
+        const struct arraydata_t *meta = (const struct arraydata_t *)g->metaImpl;
+        if (meta == NULL || g->nodeImpl == NULL) return 0;
+        p->nodecount = meta->nodelen;
+    } else {
+        size_t n = 0;
+        for (const struct node_t *nd = (const struct node_t *)g->nodeImpl; nd != NULL; nd = nd->next) n++;
+        p->ids = allocSizes(a, n);
+        if (p->ids == NULL) return 0;
+        n = 0;
+        for (const struct node_t *nd = (const struct node_t *)g->nodeImpl; nd != NULL; nd = nd->next) {
+            p->ids[n++] = nd->nodeid;
+        }
+        qsort(p->ids, n, sizeof(size_t), compareIds);
+        p->nodecount = n;
+    }
+    size_t n = p->nodecount;
+    *outdeg = allocSizes(a, n);
+    size_t *fill = allocSizes(a, n);
+    struct partgraph_t counted;
+    memset(&counted, 0, sizeof(struct partgraph_t));
+    counted.xadj = allocSizes(a, n + 1);
+    if (*outdeg == NULL || fill == NULL || counted.xadj == NULL) {
+        freeSizes(a, *outdeg, n);
+        freeSizes(a, fill, n);
+        freeSizes(a, counted.xadj, n + 1);
+        *outdeg = NULL;
+        return 0;
+    }
+    memset(*outdeg, 0, n * sizeof(size_t));
+    memset(fill, 0, n * sizeof(size_t));
+    memset(counted.xadj, 0, (n + 1) * sizeof(size_t));
+    struct adjbuild_t b = { &counted, *outdeg, fill };
+    forEachPartEdge(p, countEdge, &b);
+    for (size_t i = 0; i < n; i++) counted.xadj[i + 1] += counted.xadj[i];
+
+    int retval = allocPartGraph(a, pg, n, counted.xadj[n]);
+    if (retval) {
+        memcpy(pg->xadj, counted.xadj, (n + 1) * sizeof(size_t));
+        for (size_t i = 0; i < n; i++) pg->vwgt[i] = 1;
+        b.pg = pg;
+        forEachPartEdge(p, placeEdge, &b);
+    } else {
+        freeSizes(a, *outdeg, n);
+        *outdeg = NULL;
+    }
+    freeSizes(a, fill, n);
+    freeSizes(a, counted.xadj, n + 1);
+    return retval;
+}
+
+/*
+ * Geometric schemes.  Each part is a box of the grid; owners are filled in by walking the box.
+ */
+
+/**
+ * @brief Scratch space of the geometric schemes, dimcount entries each
+ */
+struct gridwork_t {
+    size_t *lo;
+    size_t *hi;
+    size_t *pk;
+    size_t *coords;
+};
+
+/**
+ * @brief Whether the geometric schemes can be used on the graph
+ */
+static int isGridGraph(const struct partition_t *p) {
+    const struct graph_t *g = p->g;
+    return (g->gtype & (ARRAY | SPATIAL)) == (ARRAY | SPATIAL) && g->dims != NULL && g->dims->dimcount > 0
+           && p->nodecount == cartesianIndexLength(g->dims);
+}
+
+/**
+ * @brief Record the box held in the scratch space as the box of a part, and set its owners
+ * @param p Partition
+ * @param w Scratch space holding the box
+ * @param part Part number
+ * @return 1 if successful; otherwise, 0.
+ */
+static int setBox(struct partition_t *p, struct gridwork_t *w, size_t part) {
+    const struct dimensions_t *dims = p->g->dims;
+    size_t d = dims->dimcount;
+    size_t *box = allocSizes(p->allocator, 2 * d);
+    if (box == NULL) return 0;
+    p->parts[part].box = box;
+    memcpy(box, w->lo, d * sizeof(size_t));
+    memcpy(box + d, w->hi, d * sizeof(size_t));
+    for (size_t k = 0; k < d; k++) {
+        if (w->hi[k] <= w->lo[k]) return 1;
+    }
+    memcpy(w->coords, w->lo, d * sizeof(size_t));
+    for (;;) {
+        size_t idx = 0;
+        indexFromCartesian(p->g->dims, &idx, w->coords);
+        p->owner[idx] = part;
+        size_t k = 0;
+        while (k < d && ++w->coords[k] == w->hi[k]) {
+            w->coords[k] = w->lo[k];
+            k++;
+        }
+        if (k == d) break;
+    }
+    return 1;
+}
+
+static int slabSplit(struct partition_t *p, struct gridwork_t *w) {
+    const struct dimensions_t *dims = p->g->dims;
+    size_t last = dims->dimcount - 1;
+    if (p->partcount > dims->dimarr[last]) return 0;
+    for (size_t k = 0; k < dims->dimcount; k++) {
+        w->lo[k] = 0;
+        w->hi[k] = dims->dimarr[k];
+    }
+    for (size_t i = 0; i < p->partcount; i++) {
+        memChunkRange(dims->dimarr[last], p->partcount, i, &w->lo[last], &w->hi[last]);
+        if (!setBox(p, w, i)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Split into a grid of blocks
+ *
+ * The prime factors of the part count are handed out largest first, each to the dimension with the longest blocks
+ * left, which keeps the blocks close to cubes.
+ */
+static int blockSplit(struct partition_t *p, struct gridwork_t *w) {
+    const struct dimensions_t *dims = p->g->dims;
+    size_t d = dims->dimcount;
+    size_t factors[8 * sizeof(size_t)];
+    size_t fcount = 0;
+    size_t rest = p->partcount;
+    for (size_t f = 2; f * f <= rest; f++) {
+        while (rest % f == 0) {
+            factors[fcount++] = f;
+            rest /= f;
+        }
+    }
+    if (rest > 1) factors[fcount++] = rest;
+
+    for (size_t k = 0; k < d; k++) w->pk[k] = 1;
+    for (size_t i = fcount; i > 0; i--) {
+        size_t f = factors[i - 1];
+        size_t best = d;
+        for (size_t k = 0; k < d; k++) {
+            if (w->pk[k] * f > dims->dimarr[k]) continue;
+            //dimarr[k] / pk[k] > dimarr[best] / pk[best], without the division
+            if (best == d || dims->dimarr[k] * w->pk[best] > dims->dimarr[best] * w->pk[k]) best = k;
+        }
+        if (best == d) return 0;
+        w->pk[best] *= f;
+    }
+
+    for (size_t i = 0; i < p->partcount; i++) {
+        size_t c = i;
+        for (size_t k = 0; k < d; k++) {
+            memChunkRange(dims->dimarr[k], w->pk[k], c % w->pk[k], &w->lo[k], &w->hi[k]);
+            c /= w->pk[k];
+        }
+        if (!setBox(p, w, i)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Recursive coordinate bisection of the box in the scratch space into parts first to first + parts - 1
+ *
+ * The longest side is cut in proportion to the part counts of the two sides.  The box is restored before returning.
+ */
+static int bisectSplit(struct partition_t *p, struct gridwork_t *w, size_t first, size_t parts) {
+    size_t d = p->g->dims->dimcount;
+    if (parts == 1) return setBox(p, w, first);
+    size_t axis = 0;
+    for (size_t k = 1; k < d; k++) {
+        if (w->hi[k] - w->lo[k] > w->hi[axis] - w->lo[axis]) axis = k;
+    }
+    size_t lo = w->lo[axis], hi = w->hi[axis];
+    size_t left = parts / 2;
+    size_t across = 1;
+    for (size_t k = 0; k < d; k++) {
+        if (k != axis) across *= w->hi[k] - w->lo[k];
+    }
+    if (across == 0) return 0;
+    //each side needs at least one node for every part it holds
+    size_t leftlayers = (left + across - 1) / across;
+    size_t rightlayers = (parts - left + across - 1) / across;
+    if (leftlayers + rightlayers > hi - lo) return 0;
+    size_t cut = lo + ((hi - lo) * left) / parts;
+    if (cut < lo + leftlayers) cut = lo + leftlayers;
+    if (cut > hi - rightlayers) cut = hi - rightlayers;
+
+    w->hi[axis] = cut;
+    int retval = bisectSplit(p, w, first, left);
+    w->hi[axis] = hi;
+    if (retval) {
+        w->lo[axis] = cut;
+        retval = bisectSplit(p, w, first + left, parts - left);
+        w->lo[axis] = lo;
+    }
+    return retval;
+}
+
+/**
+ * @brief Split a grid graph with one of the geometric schemes
+ * @return 1 if successful; otherwise, 0.
+ */
+static int gridSplit(struct partition_t *p) {
+    if (!isGridGraph(p)) return 0;
+    const struct dimensions_t *dims = p->g->dims;
+    size_t d = dims->dimcount;
+    size_t *scratch = allocSizes(p->allocator, 4 * d);
+    if (scratch == NULL) return 0;
+    struct gridwork_t w = { scratch, scratch + d, scratch + 2 * d, scratch + 3 * d };
+    int retval = 0;
+    switch (p->scheme) {
+        case PART_SLAB:
+            retval = slabSplit(p, &w);
+            break;
+        case PART_BLOCK:
+            retval = blockSplit(p, &w);
+            break;
+        case PART_BISECT:
+            for (size_t k = 0; k < d; k++) {
+                w.lo[k] = 0;
+                w.hi[k] = dims->dimarr[k];
+            }
+            retval = bisectSplit(p, &w, 0, p->partcount);
+            break;
+        default:
+            break;
+    }
+    if (retval && dims->order != ORDER_ROWMAJOR) {
+        //the unused ids of a padded order have no edges; each goes with the id before it (id 0 is always a node)
+        for (size_t u = 1; u < p->nodecount; u++) {
+            if (cartesianFromIndex(&u, w.coords, p->g->dims) != 0) p->owner[u] = p->owner[u - 1];
+        }
+    }
+    freeSizes(p->allocator, scratch, 4 * d);
+    return retval;
+}
+
+/*
+ * Multilevel scheme.  Heavy-edge matching merges pairs of nodes into a coarser graph until it is small, the coarsest
+ * graph is split by region growing, and the split is carried back through each level with a round of refinement.
+ */
+
+/**
+ * @brief Next value of the generator that orders the matching
+ */
+static size_t nextRandom(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (size_t)(*state >> 11);
+}
+
+/**
+ * @brief Build the next coarser graph by heavy-edge matching
+ * @param a Allocator
+ * @param pg Graph to be coarsened
+ * @param cg Set to the coarse graph
+ * @param cmap Coarse node of each node of pg (pg->n entries, filled in here)
+ * @param seed State of the ordering generator
+ * @return 1 if successful; otherwise, 0.
+ */
+static int coarsenGraph(const struct graphallocator_t *a, const struct partgraph_t *pg, struct partgraph_t *cg,
+                        size_t *cmap, uint64_t *seed) {
+    size_t n = pg->n;
+    size_t *match = allocSizes(a, n);
+    size_t *order = allocSizes(a, n);
+    if (match == NULL || order == NULL) {
+        freeSizes(a, match, n);
+        freeSizes(a, order, n);
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        match[i] = PART_NONE;
+        order[i] = i;
+    }
+    for (size_t i = n; i > 1; i--) {
+        size_t j = nextRandom(seed) % i;
+        size_t t = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = t;
+    }
+    for (size_t i = 0; i < n; i++) {
+        size_t u = order[i];
+        if (match[u] != PART_NONE) continue;
+        size_t best = u, bestw = 0;
+        for (size_t j = pg->xadj[u]; j < pg->xadj[u + 1]; j++) {
+            size_t v = pg->adj[j];
+            if (match[v] == PART_NONE && v != u && pg->adjw[j] > bestw) {
+                best = v;
+                bestw = pg->adjw[j];
+            }
+        }
+        match[u] = best;
+        match[best] = u;
+    }
+
+    size_t cn = 0;
+    for (size_t u = 0; u < n; u++) cmap[u] = PART_NONE;
+    for (size_t u = 0; u < n; u++) {
+        if (cmap[u] != PART_NONE) continue;
+        cmap[u] = cn;
+        cmap[match[u]] = cn;
+        //order is reused to hold the first member of each coarse node
+        order[cn++] = u;
+    }
+
+    size_t *slot = allocSizes(a, cn);
+    int retval = slot != NULL && allocPartGraph(a, cg, cn, pg->adjcap);
+    if (retval) {
+        //slot holds the position of each coarse neighbor in the adjacency of the coarse node being built
+        for (size_t c = 0; c < cn; c++) slot[c] = PART_NONE;
+        size_t fill = 0;
+        for (size_t c = 0; c < cn; c++) {
+            cg->xadj[c] = fill;
+            size_t pair[2] = { order[c], match[order[c]] };
+            size_t members = (pair[1] == pair[0]) ? 1 : 2;
+            cg->vwgt[c] = 0;
+            for (size_t m = 0; m < members; m++) {
+                cg->vwgt[c] += pg->vwgt[pair[m]];
+                for (size_t j = pg->xadj[pair[m]]; j < pg->xadj[pair[m] + 1]; j++) {
+                    size_t cv = cmap[pg->adj[j]];
+                    if (cv == c) continue;
+                    if (slot[cv] != PART_NONE && slot[cv] >= cg->xadj[c]) {
+                        cg->adjw[slot[cv]] += pg->adjw[j];
+                    } else {
+                        slot[cv] = fill;
+                        cg->adj[fill] = cv;
+                        cg->adjw[fill++] = pg->adjw[j];
+                    }
+                }
+            }
+        }
+        cg->xadj[cn] = fill;
+    }
+    if (slot != NULL) freeSizes(a, slot, cn);
+    freeSizes(a, match, n);
+    freeSizes(a, order, n);
+    return retval;
+}
+
+/**
+ * @brief Split a graph by greedy region growing
+ *
+ * Each part in turn grows breadth-first from the lowest unassigned node until it reaches its share of the weight left,
+ * always leaving at least one node for each part still to come; the last part takes the rest.
+ *
+ * @param a Allocator
+ * @param pg Graph to be split
+ * @param parts Number of parts (at most pg->n)
+ * @param where Set to the part of each node
+ * @return 1 if successful; otherwise, 0.
+ */
+static int growParts(const struct graphallocator_t *a, const struct partgraph_t *pg, size_t parts, size_t *where) {
+    size_t n = pg->n;
+    size_t *queue = allocSizes(a, n);
+    size_t *queued = allocSizes(a, n);
+    if (queue == NULL || queued == NULL) {
+        freeSizes(a, queue, n);
+        freeSizes(a, queued, n);
+        return 0;
+    }
+    size_t weight = 0;
+    for (size_t u = 0; u < n; u++) {
+        where[u] = PART_NONE;
+        queued[u] = PART_NONE;
+        weight += pg->vwgt[u];
+    }
+    size_t left = n, scan = 0;
+    for (size_t k = 0; k < parts; k++) {
+        if (k == parts - 1) {
+            for (size_t u = 0; u < n; u++) {
+                if (where[u] == PART_NONE) where[u] = k;
+            }
+            break;
+        }
+        size_t target = weight / (parts - k);
+        size_t pw = 0, head = 0, tail = 0;
+        while (pw < target && left > parts - 1 - k) {
+            if (head == tail) {
+                while (where[scan] != PART_NONE) scan++;
+                queue[tail++] = scan;
+                queued[scan] = k;
+            }
+            size_t u = queue[head++];
+            if (where[u] != PART_NONE) continue;
+            where[u] = k;
+            pw += pg->vwgt[u];
+            left--;
+            for (size_t j = pg->xadj[u]; j < pg->xadj[u + 1]; j++) {
+                size_t v = pg->adj[j];
+                if (where[v] == PART_NONE && queued[v] != k) {
+                    queued[v] = k;
+                    queue[tail++] = v;
+                }
+            }
+        }
+        weight -= pw;
+    }
+    freeSizes(a, queue, n);
+    freeSizes(a, queued, n);
+    return 1;
+}
+
+/**
+ * @brief Boundary refinement of a split
+ *
+ * Each pass visits every node, and moves it to the neighboring part it has the most edge weight to when that cuts
+ * fewer edges, or cuts as many while evening out the part weights, or brings an overweight part back under maxw.  No
+ * move may take a part over maxw or leave a part empty.
+ *
+ * @param a Allocator
+ * @param pg Graph in question
+ * @param parts Number of parts
+ * @param maxw Largest part weight allowed
+ * @param where Part of each node, updated in place
+ * @return 1 if successful; otherwise, 0.
+ */
+static int refineParts(const struct graphallocator_t *a, const struct partgraph_t *pg, size_t parts, size_t maxw,
+                       size_t *where) {
+    size_t *pw = allocSizes(a, parts);
+    size_t *conn = allocSizes(a, parts);
+    size_t *touched = allocSizes(a, parts);
+    if (pw == NULL || conn == NULL || touched == NULL) {
+        freeSizes(a, pw, parts);
+        freeSizes(a, conn, parts);
+        freeSizes(a, touched, parts);
+        return 0;
+    }
+    memset(pw, 0, parts * sizeof(size_t));
+    memset(conn, 0, parts * sizeof(size_t));
+    for (size_t u = 0; u < pg->n; u++) pw[where[u]] += pg->vwgt[u];
+
+    for (size_t pass = 0; pass < PART_REFINE_PASSES; pass++) {
+        size_t moved = 0;
+        for (size_t u = 0; u < pg->n; u++) {
+            size_t from = where[u];
+            size_t tcount = 0;
+            for (size_t j = pg->xadj[u]; j < pg->xadj[u + 1]; j++) {
+                size_t t = where[pg->adj[j]];
+                if (conn[t] == 0) touched[tcount++] = t;
+                conn[t] += pg->adjw[j];
+            }
+            size_t internal = conn[from];
+            size_t best = PART_NONE;
+            if (pw[from] > pg->vwgt[u]) {
+                for (size_t i = 0; i < tcount; i++) {
+                    size_t t = touched[i];
+                    if (t == from || pw[t] + pg->vwgt[u] > maxw) continue;
+                    if (best == PART_NONE || conn[t] > conn[best] || (conn[t] == conn[best] && pw[t] < pw[best])) {
+                        best = t;
+                    }
+                }
+            }
+            size_t gain = (best != PART_NONE) ? conn[best] : 0;
+            for (size_t i = 0; i < tcount; i++) conn[touched[i]] = 0;
+            if (best == PART_NONE) continue;
+            int move = gain > internal || (gain == internal && pw[best] + pg->vwgt[u] < pw[from]) || pw[from] > maxw;
+            if (move) {
+                where[u] = best;
+                pw[from] -= pg->vwgt[u];
+                pw[best] += pg->vwgt[u];
+                moved++;
+            }
+        }
+        if (moved == 0) break;
+    }
+    freeSizes(a, pw, parts);
+    freeSizes(a, conn, parts);
+    freeSizes(a, touched, parts);
+    return 1;
+}
+
+/**
+ * @brief Multilevel split of a graph: coarsen, split the coarsest graph, and project back with refinement
+ * @return 1 if successful; otherwise, 0.
+ */
+static int multilevelSplit(const struct graphallocator_t *a, const struct partgraph_t *pg, size_t parts, size_t maxw,
+                           size_t *where, uint64_t *seed) {
+    if (pg->n > PART_COARSEN_NODES * parts) {
+        size_t *cmap = allocSizes(a, pg->n);
+        if (cmap == NULL) return 0;
+        struct partgraph_t cg;
+        if (!coarsenGraph(a, pg, &cg, cmap, seed)) {
+            freeSizes(a, cmap, pg->n);
+            return 0;
+        }
+        int retval = 1;
+        if (cg.n * 100 <= pg->n * PART_COARSEN_STALL) {
+            size_t *cwhere = allocSizes(a, cg.n);
+            retval = cwhere != NULL && multilevelSplit(a, &cg, parts, maxw, cwhere, seed);
+            if (retval) {
+                for (size_t u = 0; u < pg->n; u++) where[u] = cwhere[cmap[u]];
+            }
+            if (cwhere != NULL) freeSizes(a, cwhere, cg.n);
+            freePartGraph(a, &cg);
+            freeSizes(a, cmap, pg->n);
+            return retval && refineParts(a, pg, parts, maxw, where);
+        }
+        //matching no longer shrinks the graph; split it at this level
+        freePartGraph(a, &cg);
+        freeSizes(a, cmap, pg->n);
+    }
+    return growParts(a, pg, parts, where) && refineParts(a, pg, parts, maxw, where);
+}
+
+/*
+ * Part contents, common to every scheme.
+ */
+
+/**
+ * @brief Node id at a position
+ */
+static size_t idAt(const struct partition_t *p, size_t pos) {
+    return (p->ids != NULL) ? p->ids[pos] : pos;
+}
+
+/**
+ * @brief Fill in the nodes, owned edge count, boundary edges and halo of every part, from the owners
+ * @return 1 if successful; otherwise, 0.
+ */
+static int fillParts(struct partition_t *p, const struct partgraph_t *pg, const size_t *outdeg) {
+    const struct graphallocator_t *a = p->allocator;
+    size_t n = p->nodecount;
+    for (size_t u = 0; u < n; u++) {
+        struct graphpart_t *part = &p->parts[p->owner[u]];
+        part->nodecount++;
+        part->edgecount += outdeg[u];
+        for (size_t j = pg->xadj[u]; j < pg->xadj[u + 1]; j++) {
+            if (p->owner[pg->adj[j]] != p->owner[u]) part->boundarycount++;
+        }
+    }
+    for (size_t k = 0; k < p->partcount; k++) {
+        struct graphpart_t *part = &p->parts[k];
+        part->nodes = allocSizes(a, part->nodecount);
+        part->boundary = allocSizes(a, 2 * part->boundarycount);
+        if (part->nodes == NULL || part->boundary == NULL) return 0;
+    }
+    //the counts are rebuilt as the arrays are filled
+    for (size_t k = 0; k < p->partcount; k++) {
+        p->cutedges += p->parts[k].boundarycount;
+        p->parts[k].nodecount = 0;
+        p->parts[k].boundarycount = 0;
+    }
+    //each cut edge is a boundary edge of both of its parts
+    p->cutedges /= 2;
+    for (size_t u = 0; u < n; u++) {
+        struct graphpart_t *part = &p->parts[p->owner[u]];
+        part->nodes[part->nodecount++] = idAt(p, u);
+        for (size_t j = pg->xadj[u]; j < pg->xadj[u + 1]; j++) {
+            if (p->owner[pg->adj[j]] == p->owner[u]) continue;
+            part->boundary[2 * part->boundarycount] = idAt(p, u);
+            part->boundary[2 * part->boundarycount + 1] = idAt(p, pg->adj[j]);
+            part->boundarycount++;
+        }
+    }
+
+    size_t *queue = allocSizes(a, n);
+    size_t *seen = allocSizes(a, n);
+    if (queue == NULL || seen == NULL) {
+        freeSizes(a, queue, n);
+        freeSizes(a, seen, n);
+        return 0;
+    }
+    for (size_t u = 0; u < n; u++) seen[u] = PART_NONE;
+    int retval = 1;
+    for (size_t k = 0; k < p->partcount && retval; k++) {
+        struct graphpart_t *part = &p->parts[k];
+        //breadth-first, one level per halo layer, starting from the whole part
+        size_t head = 0, tail = 0;
+        for (size_t u = 0; u < n; u++) {
+            if (p->owner[u] == k) {
+                seen[u] = k;
+                queue[tail++] = u;
+            }
+        }
+        for (size_t level = 0; level < p->halowidth && head < tail; level++) {
+            size_t end = tail;
+            for (; head < end; head++) {
+                size_t u = queue[head];
+                for (size_t j = pg->xadj[u]; j < pg->xadj[u + 1]; j++) {
+                    size_t v = pg->adj[j];
+                    if (seen[v] != k) {
+                        seen[v] = k;
+                        queue[tail++] = v;
+                    }
+                }
+            }
+        }
+        part->halocount = tail - part->nodecount;
+        part->halo = allocSizes(a, part->halocount);
+        if (part->halo == NULL) {
+            retval = 0;
+        } else {
+            for (size_t i = 0; i < part->halocount; i++) part->halo[i] = idAt(p, queue[part->nodecount + i]);
+            qsort(part->halo, part->halocount, sizeof(size_t), compareIds);
+        }
+    }
+    freeSizes(a, queue, n);
+    freeSizes(a, seen, n);
+    return retval;
+}
+
+/**
+ * @brief Partition a graph
+ *
+ * @param g Graph to be partitioned
+ * @param scheme Partitioning scheme
+ * @param partcount Number of parts
+ * @param halowidth Width of the halos, in edges
+ * @return Pointer to the partition, if successful; otherwise, NULL.
+ */
+struct partition_t * partitionGraph(struct graph_t *g, enum PARTSCHEME scheme, size_t partcount, size_t halowidth) {
+    if (g == NULL || g->nodeImpl == NULL || partcount == 0) return NULL;
+    if ((g->gtype & (ARRAY | LINKED | HASHED)) == 0 || isPartitionView(g)) return NULL;
+    const struct graphallocator_t *a = &g->allocator;
+    struct partition_t *p = (struct partition_t *)graphAlloc(a, sizeof(struct partition_t));
+    if (p == NULL) return NULL;
+    memset(p, 0, sizeof(struct partition_t));
+    p->scheme = scheme;
+    p->partcount = partcount;
+    p->halowidth = halowidth;
+    p->g = g;
+    p->allocator = a;
+
+    struct partgraph_t pg;
+    size_t *outdeg = NULL;
+    if (!buildAdjacency(p, &pg, &outdeg)) {
+        destroyPartition((void **)&p);
+        return NULL;
+    }
+    int success = partcount <= p->nodecount;
+    if (success) {
+        p->owner = allocSizes(a, p->nodecount);
+        p->parts = (struct graphpart_t *)graphAlloc(a, partcount * sizeof(struct graphpart_t));
+        success = p->owner != NULL && p->parts != NULL;
+    }
+    if (success) {
+        memset(p->parts, 0, partcount * sizeof(struct graphpart_t));
+        if (scheme == PART_MULTILEVEL) {
+            uint64_t seed = PART_SEED;
+            size_t maxw = (p->nodecount * PART_IMBALANCE + 100 * partcount - 1) / (100 * partcount);
+            success = multilevelSplit(a, &pg, partcount, maxw, p->owner, &seed);
+        } else {
+            success = gridSplit(p);
+        }
+    }
+    if (success) success = fillParts(p, &pg, outdeg);
+    freePartGraph(a, &pg);
+    freeSizes(a, outdeg, p->nodecount);
+    if (!success) destroyPartition((void **)&p);
+    return p;
+}
+
+/**
+ * @brief Clear out a partition
+ *
+ * @param pptr pointer-to-pointer for the partition
+ * @return 1 if successful; 0 if the pointer is NULL.
+ */
+int destroyPartition(void **pptr) {
+    int retval = 0;
+    if (pptr != NULL && *pptr != NULL) {
+        struct partition_t *p = (struct partition_t *)*pptr;
+        const struct graphallocator_t *a = p->allocator;
+        if (p->parts != NULL) {
+            size_t d = (p->g->dims != NULL) ? p->g->dims->dimcount : 0;
+            for (size_t k = 0; k < p->partcount; k++) {
+                struct graphpart_t *part = &p->parts[k];
+                if (part->nodes != NULL) freeSizes(a, part->nodes, part->nodecount);
+                if (part->halo != NULL) freeSizes(a, part->halo, part->halocount);
+                if (part->boundary != NULL) freeSizes(a, part->boundary, 2 * part->boundarycount);
+                if (part->box != NULL) freeSizes(a, part->box, 2 * d);
+            }
+            graphFree(a, p->parts, p->partcount * sizeof(struct graphpart_t));
+        }
+        if (p->owner != NULL) freeSizes(a, p->owner, p->nodecount);
+        if (p->ids != NULL) freeSizes(a, p->ids, p->nodecount);
+        graphFree(a, p, sizeof(struct partition_t));
+        *pptr = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Find the part holding a node
+ * @param p Partition
+ * @param nodeid Node identifier
+ * @return Part number; PART_NONE if the node is not in the partition.
+ */
+size_t partOwner(const struct partition_t *p, size_t nodeid) {
+    if (p == NULL) return PART_NONE;
+    size_t pos = (p->ids != NULL) ? findId(p->ids, p->nodecount, nodeid) : nodeid;
+    return (pos < p->nodecount) ? p->owner[pos] : PART_NONE;
+}
+
+/*
+ * Partition views.  Ids are not renumbered, since ARRAY slots hold absolute node ids; instead each operation checks
+ * its ids against the part and its halo before passing the call on to the graph's implementation.  The calls are
+ * made on the partitioned graph itself, so the view always sees its current backing data (after migrateGraph(),
+ * arraySelectLayer() or a change to the head of a node list) rather than a copy taken when it was made.
+ */
+
+/**
+ * @brief Implementation a graph's operations are set for, as in getOperations()
+ */
+static enum GRAPHDOMAIN viewImpType(const struct graph_t *g) {
+    return ((g->gtype & SHARED_MMAP) == SHARED_MMAP) ? SHARED_MMAP : (g->gtype & (ARRAY | LINKED | HASHED));
+}
+
+/**
+ * @brief Unwrapped operations for the current implementation of the partitioned graph
+ */
+static const struct graphops_t * viewOps(const struct graph_t *g) {
+    const struct partview_t *v = g->partview;
+    return (viewImpType(v->p->g) == v->imptype) ? &v->base : &v->moved;
+}
+
+/**
+ * @brief Whether a node can be read through a view: it is in the part or its halo
+ */
+static int inReach(const struct partview_t *v, size_t nodeid) {
+    if (partOwner(v->p, nodeid) == v->part) return 1;
+    const struct graphpart_t *part = &v->p->parts[v->part];
+    return findId(part->halo, part->halocount, nodeid) < part->halocount;
+}
+
+/**
+ * @brief Whether an edge's values can be updated through a view: its owning end is in the part
+ */
+static int ownsEdge(const struct graph_t *g, size_t u, size_t v) {
+    size_t start = ((g->gtype & DIRECTED) == DIRECTED || u < v) ? u : v;
+    return partOwner(g->partview->p, start) == g->partview->part;
+}
+
+static size_t viewNodeCount(struct graph_t *g) {
+    return g->partview->p->parts[g->partview->part].nodecount;
+}
+
+static size_t viewEdgeCount(struct graph_t *g) {
+    return g->partview->p->parts[g->partview->part].edgecount;
+}
+
+static struct node_t * viewGetNode(const size_t *nodeid, const struct graph_t *g) {
+    if (nodeid == NULL || !inReach(g->partview, *nodeid)) return NULL;
+    return viewOps(g)->getNode(nodeid, g->partview->p->g);
+}
+
+static struct edge_t * viewGetEdge(const size_t *u, const size_t *v, const struct graph_t *g) {
+    if (u == NULL || v == NULL || !inReach(g->partview, *u) || !inReach(g->partview, *v)) return NULL;
+    return viewOps(g)->getEdge(u, v, g->partview->p->g);
+}
+
+static struct node_t * viewGetNeighbors(const size_t *nodeid, const struct graph_t *g) {
+    if (nodeid == NULL || !inReach(g->partview, *nodeid)) return NULL;
+    return viewOps(g)->getNeighbors(nodeid, g->partview->p->g);
+}
+
+static struct edge_t * viewGetEdges(const size_t *nodeid, const struct graph_t *g) {
+    if (nodeid == NULL || !inReach(g->partview, *nodeid)) return NULL;
+    return viewOps(g)->getEdges(nodeid, g->partview->p->g);
+}
+
+static int viewGetCapacity(const size_t *uid, const size_t *vid, double *cap, const struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !inReach(g->partview, *uid) || !inReach(g->partview, *vid)) return 0;
+    return viewOps(g)->getCapacity(uid, vid, cap, g->partview->p->g);
+}
+
+static int viewGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !inReach(g->partview, *uid) || !inReach(g->partview, *vid)) return 0;
+    return viewOps(g)->getFlow(uid, vid, flow, g->partview->p->g);
+}
+
+static int viewSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !ownsEdge(g, *uid, *vid)) return 0;
+    return viewOps(g)->setCapacity(uid, vid, cap, g->partview->p->g);
+}
+
+static int viewAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !ownsEdge(g, *uid, *vid)) return 0;
+    return viewOps(g)->addCapacity(uid, vid, cap, g->partview->p->g);
+}
+
+static int viewSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !ownsEdge(g, *uid, *vid)) return 0;
+    return viewOps(g)->setFlow(uid, vid, flow, g->partview->p->g);
+}
+
+static int viewAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !ownsEdge(g, *uid, *vid)) return 0;
+    return viewOps(g)->addFlow(uid, vid, flow, g->partview->p->g);
+}
+
+static int viewAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !ownsEdge(g, *uid, *vid)) return 0;
+    return viewOps(g)->atomicAddCapacity(uid, vid, cap, g->partview->p->g);
+}
+
+static int viewAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    if (uid == NULL || vid == NULL || !ownsEdge(g, *uid, *vid)) return 0;
+    return viewOps(g)->atomicAddFlow(uid, vid, flow, g->partview->p->g);
+}
+
+/**
+ * @brief Create a view of one part, sharing the backing data of the partitioned graph.
+ *
+ * @param p Partition
+ * @param part Part number
+ * @return Pointer to the view, if successful; otherwise, NULL.
+ */
+struct graph_t * partitionView(struct partition_t *p, size_t part) {
+    if (p == NULL || part >= p->partcount) return NULL;
+    struct graph_t *g = p->g;
+    struct graph_t *view = basicGraphInitWith(&g->allocator);
+    if (view == NULL) return NULL;
+    struct partview_t *v = (struct partview_t *)graphAlloc(&view->allocator, sizeof(struct partview_t));
+    if (v == NULL) {
+        destroyGraph((void **)&view);
+        return NULL;
+    }
+    memset(v, 0, sizeof(struct partview_t));
+    v->p = p;
+    v->part = part;
+    v->base.g = view;
+    view->partview = v;
+    view->gtype = g->gtype;
+    view->dims = g->dims;
+    //the backing data is reached through p->g at call time, never through the view's own pointers
+    v->imptype = viewImpType(g);
+
+    int success = setImplementationOps(&v->base, v->imptype);
+    if (success && (v->imptype == LINKED || v->imptype == HASHED)) {
+        v->moved.g = view;
+        success = setImplementationOps(&v->moved, (v->imptype == LINKED) ? HASHED : LINKED);
+    }
+    if (success && g->config != NULL) {
+        view->config = copyConfigWith(&view->allocator, g->config);
+        if (view->config == NULL) {
+            success = 0;
+        } else {
+            view->config->allocator = &view->allocator;
+            view->config->concurrency = CONCURRENCY_NONE;
+            view->config->stats = STATS_OFF;
+            view->config->adapt = ADAPT_OFF;
+        }
+    }
+    if (!success) destroyGraph((void **)&view);
+    return view;
+}
+
+/**
+ * @brief Determine whether a graph is a partition view
+ * @param g Graph in question
+ * @return 1 if g was created by partitionView(); otherwise, 0.
+ */
+int isPartitionView(const struct graph_t *g) {
+    return g != NULL && g->partview != NULL;
+}
+
+/**
+ * @brief Replace the operations of a partition view with ones restricted to its part.
+ *
+ * @param gops Operations structure for a partition view
+ * @return 1 if successful; 0 if the graph is not a partition view.
+ */
+int partitionViewWrap(struct graphops_t *gops) {
+    int retval = 0;
+    if (gops != NULL && isPartitionView(gops->g)) {
+        gops->nodeCount = viewNodeCount;
+        gops->edgeCount = viewEdgeCount;
+        gops->getNode = viewGetNode;
+        gops->getEdge = viewGetEdge;
+        gops->getNeighbors = viewGetNeighbors;
+        gops->getEdges = viewGetEdges;
+        gops->getCapacity = viewGetCapacity;
+        gops->getFlow = viewGetFlow;
+        gops->addNode = NULL;
+        gops->removeNode = NULL;
+        gops->addEdge = NULL;
+        gops->removeEdge = NULL;
+        gops->setCapacity = viewSetCapacity;
+        gops->addCapacity = viewAddCapacity;
+        gops->setFlow = viewSetFlow;
+        gops->addFlow = viewAddFlow;
+        gops->atomicAddCapacity = viewAtomicAddCapacity;
+        gops->atomicAddFlow = viewAtomicAddFlow;
+        gops->resetGraph = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Clear out the view state of a partition view
+ *
+ * @param g Graph in question
+ * @return 1 if successful; 0 if the graph is not a partition view.
+ */
+int destroyPartitionView(struct graph_t *g) {
+    int retval = 0;
+    if (isPartitionView(g)) {
+        graphFree(&g->allocator, g->partview, sizeof(struct partview_t));
+        g->partview = NULL;
+        //the dimensions belong to the partitioned graph
+        g->dims = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Memory held by the view state of a partition view
+ * @param g Graph in question
+ * @return Size in bytes; 0 for other graphs.
+ */
+size_t partitionViewMemory(const struct graph_t *g) {
+    return isPartitionView(g) ? sizeof(struct partview_t) : 0;
+}
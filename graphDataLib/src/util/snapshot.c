@@ -0,0 +1,553 @@
+/**
+ * @brief Copy-on-write snapshots of LINKED and HASHED graphs.
+ *
+ * Versions are tracked with epochs.  Each snapshot takes the next epoch number, and each copied edge list records the
+ * epoch it was created in.  A list created in epoch c and replaced in epoch r can be seen by exactly the snapshots
+ * with c < epoch <= r, so it is released once none of those are left.  Lists that were never copied were created in
+ * epoch 0.
+ */
+
+#include <util/snapshot.h>
+#include <util/crudops.h>
+#include <impl/hashgraph.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef GRAPHDATA_PTHREADS
+#include <pthread.h>
+#endif
+
+/**
+ * @brief Initial capacity of the bookkeeping arrays
+ */
+#define SNAP_INIT_CAP 8
+
+/**
+ * @brief Edge list replaced in the live graph, but still visible to snapshots
+ */
+struct retiredlist_t {
+    /**
+     * @brief Head of the old edge list
+     */
+    struct edge_t *edges;
+    /**
+     * @brief Epoch the list was created in
+     */
+    size_t created;
+    /**
+     * @brief Epoch the list was replaced in
+     */
+    size_t retired;
+};
+
+/**
+ * @brief Snapshot bookkeeping, for both a live graph and its snapshot views
+ */
+struct snapshotstate_t {
+    /**
+     * @brief For views, the bookkeeping of the live graph; NULL for the live graph.
+     */
+    struct snapshotstate_t *origin;
+    /**
+     * @brief For the live graph, the epoch of the latest snapshot; for views, the epoch of the view.
+     */
+    size_t epoch;
+    /**
+     * @brief Highest epoch of the snapshots still active; 0 if there are none.
+     */
+    size_t maxactive;
+    /**
+     * @brief Number of active snapshots
+     */
+    size_t activecount;
+    /**
+     * @brief Capacity of the active array
+     */
+    size_t activecap;
+    /**
+     * @brief Epochs of the active snapshots
+     */
+    size_t *active;
+    /**
+     * @brief Number of retired lists
+     */
+    size_t retiredcount;
+    /**
+     * @brief Capacity of the retired array
+     */
+    size_t retiredcap;
+    /**
+     * @brief Lists retired from the live graph
+     */
+    struct retiredlist_t *retired;
+    /**
+     * @brief Number of entries in the creation map
+     */
+    size_t mapcount;
+    /**
+     * @brief Number of slots in the creation map (always a power of two)
+     */
+    size_t mapslots;
+    /**
+     * @brief Node ids of the creation map
+     */
+    size_t *mapkeys;
+    /**
+     * @brief Creation epoch of the node's current edge list; 0 marks an empty slot.
+     */
+    size_t *mapvals;
+    /**
+     * @brief Allocator of the live graph
+     */
+    const struct graphallocator_t *allocator;
+#ifdef GRAPHDATA_PTHREADS
+    /**
+     * @brief Guards the bookkeeping between the updater and threads releasing snapshots
+     */
+    pthread_mutex_t lock;
+#endif
+};
+
+static void stateLock(struct snapshotstate_t *s) {
+#ifdef GRAPHDATA_PTHREADS
+    pthread_mutex_lock(&s->lock);
+#endif
+}
+
+static void stateUnlock(struct snapshotstate_t *s) {
+#ifdef GRAPHDATA_PTHREADS
+    pthread_mutex_unlock(&s->lock);
+#endif
+}
+
+/**
+ * @brief Home slot of a node id in the creation map
+ * @param s Bookkeeping
+ * @param nodeid Node id
+ * @return Slot index
+ */
+static size_t mapHome(const struct snapshotstate_t *s, size_t nodeid) {
+    return (size_t)(((uint64_t)nodeid * 0x9E3779B97F4A7C15ULL) >> 17) & (s->mapslots - 1);
+}
+
+/**
+ * @brief Epoch in which the current edge list of a node was created
+ * @param s Bookkeeping
+ * @param nodeid Node id
+ * @return Creation epoch; 0 if the list has never been copied.
+ */
+static size_t mapGet(const struct snapshotstate_t *s, size_t nodeid) {
+    if (s->mapcount == 0) return 0;
+    size_t mask = s->mapslots - 1;
+    size_t pos = mapHome(s, nodeid);
+    while (s->mapvals[pos] != 0) {
+        if (s->mapkeys[pos] == nodeid) return s->mapvals[pos];
+        pos = (pos + 1) & mask;
+    }
+    return 0;
+}
+
+/**
+ * @brief Record the creation epoch of the current edge list of a node
+ * @param s Bookkeeping
+ * @param nodeid Node id
+ * @param epoch Creation epoch (non-zero)
+ * @return 1 if successful; 0 if the map could not grow.
+ */
+static int mapSet(struct snapshotstate_t *s, size_t nodeid, size_t epoch) {
+    if (2 * (s->mapcount + 1) > s->mapslots) {
+        size_t nslots = (s->mapslots == 0) ? 2 * SNAP_INIT_CAP : 2 * s->mapslots;
+        size_t *nkeys = (size_t *)graphAlloc(s->allocator, nslots * sizeof(size_t));
+        size_t *nvals = (size_t *)graphAlloc(s->allocator, nslots * sizeof(size_t));
+        if (nkeys == NULL || nvals == NULL) {
+            graphFree(s->allocator, nkeys, nslots * sizeof(size_t));
+            graphFree(s->allocator, nvals, nslots * sizeof(size_t));
+            return 0;
+        }
+        memset(nvals, 0, nslots * sizeof(size_t));
+        size_t *okeys = s->mapkeys;
+        size_t *ovals = s->mapvals;
+        size_t oslots = s->mapslots;
+        s->mapkeys = nkeys;
+        s->mapvals = nvals;
+        s->mapslots = nslots;
+        for (size_t i = 0; i < oslots; i++) {
+            if (ovals[i] != 0) {
+                size_t pos = mapHome(s, okeys[i]);
+                while (nvals[pos] != 0) pos = (pos + 1) & (nslots - 1);
+                nkeys[pos] = okeys[i];
+                nvals[pos] = ovals[i];
+            }
+        }
+        graphFree(s->allocator, okeys, oslots * sizeof(size_t));
+        graphFree(s->allocator, ovals, oslots * sizeof(size_t));
+    }
+    size_t mask = s->mapslots - 1;
+    size_t pos = mapHome(s, nodeid);
+    while (s->mapvals[pos] != 0 && s->mapkeys[pos] != nodeid) pos = (pos + 1) & mask;
+    if (s->mapvals[pos] == 0) s->mapcount++;
+    s->mapkeys[pos] = nodeid;
+    s->mapvals[pos] = epoch;
+    return 1;
+}
+
+/**
+ * @brief Make room for one more entry in a bookkeeping array
+ * @param a Allocator
+ * @param arr pointer to the array
+ * @param count Entries in use
+ * @param cap pointer to the capacity of the array
+ * @param size Size of each entry
+ * @return 1 if successful; otherwise, 0.
+ */
+static int reserveOne(const struct graphallocator_t *a, void **arr, size_t count, size_t *cap, size_t size) {
+    if (count < *cap) return 1;
+    size_t ncap = (*cap == 0) ? SNAP_INIT_CAP : 2 * *cap;
+    void *narr = graphRealloc(a, *arr, *cap * size, ncap * size);
+    if (narr == NULL) return 0;
+    *arr = narr;
+    *cap = ncap;
+    return 1;
+}
+
+/**
+ * @brief Copy an edge list, including the edge features
+ * @param a Allocator
+ * @param oedges Head of the list
+ * @param nedges Set to the head of the copy
+ * @return 1 if successful; otherwise, 0 (and the partial copy is released).
+ */
+static int copyEdges(const struct graphallocator_t *a, const struct edge_t *oedges, struct edge_t **nedges) {
+    struct edge_t *tail = NULL;
+    *nedges = NULL;
+    for (const struct edge_t *e = oedges; e != NULL; e = e->next) {
+        struct edge_t *ne = cloneEdgeWith(a, e);
+        if (ne == NULL || !cloneFeaturesWith(a, e->attrs, &ne->attrs)) {
+            destroyEdgesWith(a, (void **)&ne);
+            destroyEdgesWith(a, (void **)nedges);
+            return 0;
+        }
+        if (tail == NULL) {
+            *nedges = ne;
+        } else {
+            tail->next = ne;
+            ne->prev = tail;
+        }
+        tail = ne;
+    }
+    return 1;
+}
+
+/**
+ * @brief Release the retired lists that no active snapshot can see
+ *
+ * Caller must hold the bookkeeping lock.
+ *
+ * @param s Bookkeeping of the live graph
+ */
+static void reclaim(struct snapshotstate_t *s) {
+    size_t r = 0;
+    while (r < s->retiredcount) {
+        struct retiredlist_t *rl = s->retired + r;
+        int visible = 0;
+        for (size_t i = 0; i < s->activecount && !visible; i++) {
+            visible = (s->active[i] > rl->created && s->active[i] <= rl->retired);
+        }
+        if (visible) {
+            r++;
+        } else {
+            destroyEdgesWith(s->allocator, (void **)&rl->edges);
+            s->retired[r] = s->retired[--s->retiredcount];
+        }
+    }
+    if (s->activecount == 0) {
+        //nothing is shared any more, so every current list counts as never copied
+        if (s->mapvals != NULL) memset(s->mapvals, 0, s->mapslots * sizeof(size_t));
+        s->mapcount = 0;
+    }
+}
+
+/**
+ * @brief Retrieve the bookkeeping of the live graph, creating it if necessary
+ * @param g Live graph
+ * @return Pointer to the bookkeeping, or NULL on failure
+ */
+static struct snapshotstate_t * requireState(struct graph_t *g) {
+    if (g->snapshots == NULL) {
+        struct snapshotstate_t *s = (struct snapshotstate_t *)graphAlloc(&g->allocator, sizeof(struct snapshotstate_t));
+        if (s != NULL) {
+            memset(s, 0, sizeof(struct snapshotstate_t));
+            s->allocator = &g->allocator;
+#ifdef GRAPHDATA_PTHREADS
+            pthread_mutex_init(&s->lock, NULL);
+#endif
+        }
+        g->snapshots = s;
+    }
+    return g->snapshots;
+}
+
+/**
+ * @brief Determine whether a graph is a snapshot view
+ * @param g Graph in question
+ * @return 1 if g was created by snapshotGraph(); otherwise, 0.
+ */
+int isSnapshot(const struct graph_t *g) {
+    return g != NULL && g->snapshots != NULL && g->snapshots->origin != NULL;
+}
+
+/**
+ * @brief Number of snapshots of a live graph that have not been released
+ * @param g Live graph
+ * @return Count of active snapshots; 0 for snapshot views and graphs never snapshotted.
+ */
+size_t snapshotCount(const struct graph_t *g) {
+    size_t count = 0;
+    if (g != NULL && g->snapshots != NULL && !isSnapshot(g)) {
+        stateLock(g->snapshots);
+        count = g->snapshots->activecount;
+        stateUnlock(g->snapshots);
+    }
+    return count;
+}
+
+/**
+ * @brief Take a read-only snapshot of a LINKED or HASHED graph.
+ *
+ * @param g Live graph
+ * @return Pointer to the snapshot view, if successful; otherwise, NULL.
+ */
+struct graph_t * snapshotGraph(struct graph_t *g) {
+    if (g == NULL || (g->gtype & (LINKED | HASHED)) == 0 || isSnapshot(g)) return NULL;
+    struct snapshotstate_t *s = requireState(g);
+    if (s == NULL) return NULL;
+
+    struct graph_t *view = basicGraphInitWith(&g->allocator);
+    if (view == NULL) return NULL;
+    view->gtype = g->gtype;
+    struct snapshotstate_t *vs = (struct snapshotstate_t *)graphAlloc(&view->allocator, sizeof(struct snapshotstate_t));
+    if (vs == NULL) {
+        destroyGraph((void **)&view);
+        return NULL;
+    }
+    memset(vs, 0, sizeof(struct snapshotstate_t));
+    vs->origin = s;
+    vs->allocator = &view->allocator;
+
+    stateLock(s);
+    if (!reserveOne(s->allocator, (void **)&s->active, s->activecount, &s->activecap, sizeof(size_t))) {
+        stateUnlock(s);
+        graphFree(&view->allocator, vs, sizeof(struct snapshotstate_t));
+        destroyGraph((void **)&view);
+        return NULL;
+    }
+    vs->epoch = ++s->epoch;
+    s->active[s->activecount++] = vs->epoch;
+    __atomic_store_n(&s->maxactive, vs->epoch, __ATOMIC_RELEASE);
+    stateUnlock(s);
+    //from here on, the view releases through releaseSnapshot()
+    view->snapshots = vs;
+
+    int success = 1;
+    if (g->config != NULL) {
+        view->config = copyConfigWith(&view->allocator, g->config);
+        if (view->config == NULL) {
+            success = 0;
+        } else {
+            view->config->allocator = &view->allocator;
+            view->config->concurrency = CONCURRENCY_NONE;
+            view->config->stats = STATS_OFF;
+        }
+    }
+    struct node_t *tail = NULL;
+    for (struct node_t *n = (struct node_t *)g->nodeImpl; n != NULL && success; n = n->next) {
+        struct node_t *vn = initNodeWith(&view->allocator);
+        if (vn == NULL) {
+            success = 0;
+        } else {
+            vn->nodeid = n->nodeid;
+            vn->edges = n->edges;
+            if (tail == NULL) {
+                view->nodeImpl = vn;
+            } else {
+                tail->next = vn;
+                vn->prev = tail;
+            }
+            tail = vn;
+        }
+    }
+    //HASHED views get an index of their own over the view's node headers
+    if (success && (view->gtype & HASHED) == HASHED) success = hashGraphIndex(view);
+    if (!success) releaseSnapshot((void **)&view);
+    return view;
+}
+
+/**
+ * @brief Release a snapshot view, and any old edge lists that no other snapshot can see.
+ *
+ * @param snapptr pointer-to-pointer for the snapshot
+ * @return 1 if successful; 0 if the pointer is NULL or is not a snapshot.
+ */
+int releaseSnapshot(void **snapptr) {
+    if (snapptr == NULL || !isSnapshot((struct graph_t *)*snapptr)) return 0;
+    struct graph_t *view = (struct graph_t *)*snapptr;
+    struct graphallocator_t a = view->allocator;
+    struct snapshotstate_t *vs = view->snapshots;
+    struct snapshotstate_t *s = vs->origin;
+
+    //node headers only--the edge lists belong to the live graph or its retired versions
+    struct node_t *n = (struct node_t *)view->nodeImpl;
+    while (n != NULL) {
+        struct node_t *next = n->next;
+        graphFree(&a, n, sizeof(struct node_t));
+        n = next;
+    }
+    view->nodeImpl = NULL;
+    if ((view->gtype & HASHED) == HASHED) hashGraphDropIndex(view);
+
+    stateLock(s);
+    size_t maxactive = 0;
+    size_t i = 0;
+    while (i < s->activecount) {
+        if (s->active[i] == vs->epoch) {
+            s->active[i] = s->active[--s->activecount];
+        } else {
+            if (s->active[i] > maxactive) maxactive = s->active[i];
+            i++;
+        }
+    }
+    __atomic_store_n(&s->maxactive, maxactive, __ATOMIC_RELEASE);
+    reclaim(s);
+    stateUnlock(s);
+
+    graphFree(&a, vs, sizeof(struct snapshotstate_t));
+    view->snapshots = NULL;
+    destroyGraph(snapptr);
+    return 1;
+}
+
+/**
+ * @brief Give a node of the live graph an edge list that no snapshot shares, copying it if necessary.
+ *
+ * @param g Live graph
+ * @param n Node about to be modified
+ * @return 1 if the node's edge list can be modified; 0 if a copy was needed but could not be made.
+ */
+int snapshotPrepareWrite(struct graph_t *g, struct node_t *n) {
+    if (g == NULL || n == NULL) return 0;
+    if (g->snapshots == NULL) return 1;
+    //views are read-only
+    if (isSnapshot(g)) return 0;
+    struct snapshotstate_t *s = g->snapshots;
+    if (__atomic_load_n(&s->maxactive, __ATOMIC_ACQUIRE) == 0) return 1;
+
+    int retval = 1;
+    stateLock(s);
+    size_t created = mapGet(s, n->nodeid);
+    if (s->maxactive > created) {
+        struct edge_t *copy = NULL;
+        retval = copyEdges(s->allocator, n->edges, &copy);
+        if (retval && !(reserveOne(s->allocator, (void **)&s->retired, s->retiredcount, &s->retiredcap,
+                                   sizeof(struct retiredlist_t)) && mapSet(s, n->nodeid, s->epoch))) {
+            destroyEdgesWith(s->allocator, (void **)&copy);
+            retval = 0;
+        }
+        if (retval) {
+            if (n->edges != NULL) {
+                struct retiredlist_t *rl = s->retired + s->retiredcount++;
+                rl->edges = n->edges;
+                rl->created = created;
+                rl->retired = s->epoch;
+            }
+            n->edges = copy;
+        }
+    }
+    stateUnlock(s);
+    return retval;
+}
+
+/**
+ * @brief Hand the edge list of a node being removed to the snapshots that share it.
+ *
+ * @param g Live graph
+ * @param n Node being removed
+ * @return 1 if the list was retired; 0 if no snapshot shares it, and the caller must release it.
+ */
+int snapshotRetireEdges(struct graph_t *g, struct node_t *n) {
+    if (g == NULL || n == NULL || g->snapshots == NULL || isSnapshot(g)) return 0;
+    struct snapshotstate_t *s = g->snapshots;
+    if (__atomic_load_n(&s->maxactive, __ATOMIC_ACQUIRE) == 0) return 0;
+
+    int retval = 0;
+    stateLock(s);
+    size_t created = mapGet(s, n->nodeid);
+    if (s->maxactive > created) {
+        if (n->edges != NULL) {
+            if (reserveOne(s->allocator, (void **)&s->retired, s->retiredcount, &s->retiredcap,
+                           sizeof(struct retiredlist_t))) {
+                struct retiredlist_t *rl = s->retired + s->retiredcount++;
+                rl->edges = n->edges;
+                rl->created = created;
+                rl->retired = s->epoch;
+            }
+            //if the list cannot be recorded it is leaked rather than released under a reader
+            n->edges = NULL;
+        }
+        //a node re-added with the same id starts with a list no snapshot can see
+        mapSet(s, n->nodeid, s->epoch);
+        retval = 1;
+    }
+    stateUnlock(s);
+    return retval;
+}
+
+/**
+ * @brief Clear out the snapshot bookkeeping of a live graph, including all retired edge lists.
+ *
+ * @param g Live graph
+ * @return 1 if successful; 0 if there was no bookkeeping.
+ */
+int destroySnapshotState(struct graph_t *g) {
+    int retval = 0;
+    if (g != NULL && g->snapshots != NULL && !isSnapshot(g)) {
+        struct snapshotstate_t *s = g->snapshots;
+        const struct graphallocator_t *a = s->allocator;
+        for (size_t r = 0; r < s->retiredcount; r++) {
+            destroyEdgesWith(a, (void **)&s->retired[r].edges);
+        }
+        graphFree(a, s->retired, s->retiredcap * sizeof(struct retiredlist_t));
+        graphFree(a, s->active, s->activecap * sizeof(size_t));
+        graphFree(a, s->mapkeys, s->mapslots * sizeof(size_t));
+        graphFree(a, s->mapvals, s->mapslots * sizeof(size_t));
+#ifdef GRAPHDATA_PTHREADS
+        pthread_mutex_destroy(&s->lock);
+#endif
+        graphFree(a, s, sizeof(struct snapshotstate_t));
+        g->snapshots = NULL;
+        retval = 1;
+    }
+    return retval;
+}
+
+/**
+ * @brief Memory held by the snapshot bookkeeping of a graph, including the retired edge lists of a live graph
+ * @param g Live graph or snapshot view
+ * @return Size in bytes; 0 if there is no bookkeeping.
+ */
+size_t snapshotMemory(const struct graph_t *g) {
+    size_t bytes = 0;
+    if (g != NULL && g->snapshots != NULL) {
+        struct snapshotstate_t *s = g->snapshots;
+        bytes = sizeof(struct snapshotstate_t);
+        if (s->origin == NULL) {
+            stateLock(s);
+            bytes += s->retiredcap * sizeof(struct retiredlist_t) + s->activecap * sizeof(size_t)
+                     + 2 * s->mapslots * sizeof(size_t);
+            for (size_t r = 0; r < s->retiredcount; r++) {
+                for (const struct edge_t *e = s->retired[r].edges; e != NULL; e = e->next) bytes += sizeof(struct edge_t);
+            }
+            stateUnlock(s);
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,410 @@
+/**
+ * @brief Striped locking for graphs shared between threads.
+ *
+ * Locks are only available when the library is built with GRAPHDATA_PTHREADS; otherwise, graphSyncInit() fails and a
+ * CONCURRENCY_STRIPED graph cannot be created.
+ */
+
+#include <util/syncops.h>
+#include <util/crudops.h>
+
+#ifdef GRAPHDATA_PTHREADS
+#include <pthread.h>
+
+/**
+ * @brief Cache line size used to keep stripes apart
+ */
+#define SYNC_LINE 64
+
+/**
+ * @brief Single lock stripe, padded to a cache line so neighbouring stripes do not share one
+ */
+struct lockstripe_t {
+    /**
+     * @brief Stripe mutex
+     */
+    pthread_mutex_t lock;
+    /**
+     * @brief Padding to the end of the cache line
+     */
+    char pad[SYNC_LINE - (sizeof(pthread_mutex_t) % SYNC_LINE)];
+};
+
+/**
+ * @brief Locking state of a graph
+ */
+struct graphsync_t {
+    /**
+     * @brief Number of stripes (always a power of two)
+     */
+    size_t stripecount;
+    /**
+     * @brief Stripe locks, indexed by owning node id
+     */
+    struct lockstripe_t *stripes;
+    /**
+     * @brief Lock over the list structure (LINKED and HASHED graphs only)
+     */
+    pthread_rwlock_t structure;
+    /**
+     * @brief 1 if the structure lock is in use; otherwise, 0.
+     */
+    int sharedreads;
+    /**
+     * @brief Unwrapped operations for the graph's implementation
+     */
+    struct graphops_t base;
+};
+
+/**
+ * @brief Retrieve the stripe lock for a node
+ * @param s Locking state
+ * @param nodeid Node id
+ * @return Mutex guarding the node's edges
+ */
+static pthread_mutex_t * stripeLock(struct graphsync_t *s, size_t nodeid) {
+    return &s->stripes[nodeid & (s->stripecount - 1)].lock;
+}
+
+/**
+ * @brief Node owning the edge (u,v), whose stripe guards it
+ * @param g Graph in question
+ * @param uid Edge start
+ * @param vid Edge end
+ * @return u for DIRECTED graphs; otherwise, the smaller of u and v.
+ */
+static size_t edgeOwner(const struct graph_t *g, const size_t *uid, const size_t *vid) {
+    if ((g->gtype & DIRECTED) == DIRECTED) return *uid;
+    return (*uid < *vid) ? *uid : *vid;
+}
+
+/**
+ * @brief Take the shared structure lock (if used) and the given stripe
+ * @param s Locking state
+ * @param nodeid Node id whose stripe is taken
+ * @return Stripe mutex, for unlockShared()
+ */
+static pthread_mutex_t * lockShared(struct graphsync_t *s, size_t nodeid) {
+    if (s->sharedreads) pthread_rwlock_rdlock(&s->structure);
+    pthread_mutex_t *m = stripeLock(s, nodeid);
+    pthread_mutex_lock(m);
+    return m;
+}
+
+/**
+ * @brief Release the locks taken by lockShared()
+ * @param s Locking state
+ * @param m Stripe mutex returned by lockShared()
+ */
+static void unlockShared(struct graphsync_t *s, pthread_mutex_t *m) {
+    pthread_mutex_unlock(m);
+    if (s->sharedreads) pthread_rwlock_unlock(&s->structure);
+}
+
+/**
+ * @brief Take the structure lock exclusively, or every stripe (in order) if the structure lock is not used
+ * @param s Locking state
+ */
+static void lockAll(struct graphsync_t *s) {
+    if (s->sharedreads) {
+        pthread_rwlock_wrlock(&s->structure);
+    } else {
+        for (size_t i = 0; i < s->stripecount; i++) pthread_mutex_lock(&s->stripes[i].lock);
+    }
+}
+
+/**
+ * @brief Release the locks taken by lockAll()
+ * @param s Locking state
+ */
+static void unlockAll(struct graphsync_t *s) {
+    if (s->sharedreads) {
+        pthread_rwlock_unlock(&s->structure);
+    } else {
+        for (size_t i = s->stripecount; i > 0; i--) pthread_mutex_unlock(&s->stripes[i - 1].lock);
+    }
+}
+
+/*
+ * Locking wrappers, one per graphops_t entry.  Each takes the locks described in syncops.h and forwards to the
+ * unwrapped operation.
+ */
+
+static size_t syncNodeCount(struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_rwlock_rdlock(&s->structure);
+    size_t count = s->base.nodeCount(g);
+    pthread_rwlock_unlock(&s->structure);
+    return count;
+}
+
+static size_t syncEdgeCount(struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    lockAll(s);
+    size_t count = s->base.edgeCount(g);
+    unlockAll(s);
+    return count;
+}
+
+static struct node_t * syncGetNode(const size_t *nodeid, const struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_rwlock_rdlock(&s->structure);
+    struct node_t *n = s->base.getNode(nodeid, g);
+    pthread_rwlock_unlock(&s->structure);
+    return n;
+}
+
+static struct edge_t * syncGetEdge(const size_t *u, const size_t *v, const struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, u, v));
+    struct edge_t *e = s->base.getEdge(u, v, g);
+    unlockShared(s, m);
+    return e;
+}
+
+static struct node_t * syncGetNeighbors(const size_t *nodeid, const struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, *nodeid);
+    struct node_t *n = s->base.getNeighbors(nodeid, g);
+    unlockShared(s, m);
+    return n;
+}
+
+static struct edge_t * syncGetEdges(const size_t *nodeid, const struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, *nodeid);
+    struct edge_t *e = s->base.getEdges(nodeid, g);
+    unlockShared(s, m);
+    return e;
+}
+
+static int syncGetCapacity(const size_t *uid, const size_t *vid, double *cap, const struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+    int retval = s->base.getCapacity(uid, vid, cap, g);
+    unlockShared(s, m);
+    return retval;
+}
+
+static int syncGetFlow(const size_t *uid, const size_t *vid, double *flow, const struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+    int retval = s->base.getFlow(uid, vid, flow, g);
+    unlockShared(s, m);
+    return retval;
+}
+
+static int syncAddNode(const size_t *nodeid, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    lockAll(s);
+    int retval = s->base.addNode(nodeid, g);
+    unlockAll(s);
+    return retval;
+}
+
+static int syncRemoveNode(const size_t *nodeid, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    lockAll(s);
+    int retval = s->base.removeNode(nodeid, g);
+    unlockAll(s);
+    return retval;
+}
+
+static int syncAddEdge(const size_t *uid, const size_t *vid, double *cap, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+    int retval = s->base.addEdge(uid, vid, cap, g);
+    unlockShared(s, m);
+    return retval;
+}
+
+static int syncRemoveEdge(const size_t *uid, const size_t *vid, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    int retval;
+    if (s->sharedreads) {
+        //unlinking may move list heads, which readers of other stripes can be walking through
+        lockAll(s);
+        retval = s->base.removeEdge(uid, vid, g);
+        unlockAll(s);
+    } else {
+        pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+        retval = s->base.removeEdge(uid, vid, g);
+        unlockShared(s, m);
+    }
+    return retval;
+}
+
+static int syncSetCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+    int retval = s->base.setCapacity(uid, vid, cap, g);
+    unlockShared(s, m);
+    return retval;
+}
+
+static int syncAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+    int retval = s->base.addCapacity(uid, vid, cap, g);
+    unlockShared(s, m);
+    return retval;
+}
+
+static int syncSetFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+    int retval = s->base.setFlow(uid, vid, flow, g);
+    unlockShared(s, m);
+    return retval;
+}
+
+static int syncAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_mutex_t *m = lockShared(s, edgeOwner(g, uid, vid));
+    int retval = s->base.addFlow(uid, vid, flow, g);
+    unlockShared(s, m);
+    return retval;
+}
+
+static int syncAtomicAddCapacity(const size_t *uid, const size_t *vid, const double *cap, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_rwlock_rdlock(&s->structure);
+    int retval = s->base.atomicAddCapacity(uid, vid, cap, g);
+    pthread_rwlock_unlock(&s->structure);
+    return retval;
+}
+
+static int syncAtomicAddFlow(const size_t *uid, const size_t *vid, const double *flow, struct graph_t *g) {
+    struct graphsync_t *s = g->sync;
+    pthread_rwlock_rdlock(&s->structure);
+    int retval = s->base.atomicAddFlow(uid, vid, flow, g);
+    pthread_rwlock_unlock(&s->structure);
+    return retval;
+}
+
+static int syncResetGraph(struct graph_t *g, void *args, void (*callback)(void)) {
+    struct graphsync_t *s = g->sync;
+    lockAll(s);
+    int retval = s->base.resetGraph(g, args, callback);
+    unlockAll(s);
+    return retval;
+}
+#endif
+
+/**
+ * @brief Create the locking state for a graph, according to its configuration.
+ *
+ * @param g Graph to be shared between threads
+ * @return 1 if successful; 0 if the locks could not be created, or the library was built without thread support.
+ */
+int graphSyncInit(struct graph_t *g) {
+    int retval = 0;
+#ifdef GRAPHDATA_PTHREADS
+    if (g != NULL && g->sync == NULL) {
+        size_t count = 1;
+        size_t want = (g->config != NULL && g->config->lockstripes > 0) ? g->config->lockstripes : SYNC_DEFAULT_STRIPES;
+        while (count < want) count <<= 1;
+        struct graphsync_t *s = (struct graphsync_t *)graphAlloc(&g->allocator, sizeof(struct graphsync_t));
+        if (s == NULL) return 0;
+        s->stripes = (struct lockstripe_t *)graphAlloc(&g->allocator, count * sizeof(struct lockstripe_t));
+        if (s->stripes == NULL || pthread_rwlock_init(&s->structure, NULL) != 0) {
+            graphFree(&g->allocator, s->stripes, count * sizeof(struct lockstripe_t));
+            graphFree(&g->allocator, s, sizeof(struct graphsync_t));
+            return 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (pthread_mutex_init(&s->stripes[i].lock, NULL) != 0) {
+                //unwind the locks that were initialised
+                while (i > 0) pthread_mutex_destroy(&s->stripes[--i].lock);
+                pthread_rwlock_destroy(&s->structure);
+                graphFree(&g->allocator, s->stripes, count * sizeof(struct lockstripe_t));
+                graphFree(&g->allocator, s, sizeof(struct graphsync_t));
+                return 0;
+            }
+        }
+        s->stripecount = count;
+        s->sharedreads = ((g->gtype & (LINKED | HASHED)) != 0);
+        g->sync = s;
+        retval = 1;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Replace the operations of a graph with locking wrappers.
+ *
+ * @param gops Operations structure for a graph with locking state
+ * @return 1 if successful; 0 if the graph has no locking state.
+ */
+int graphSyncWrap(struct graphops_t *gops) {
+    int retval = 0;
+#ifdef GRAPHDATA_PTHREADS
+    if (gops != NULL && gops->g != NULL && gops->g->sync != NULL) {
+        struct graphsync_t *s = gops->g->sync;
+        s->base = *gops;
+        if (s->sharedreads) {
+            //ARRAY structure is fixed, so only LINKED and HASHED reads need the locks
+            if (gops->nodeCount != NULL) gops->nodeCount = syncNodeCount;
+            if (gops->getNode != NULL) gops->getNode = syncGetNode;
+            if (gops->getEdge != NULL) gops->getEdge = syncGetEdge;
+            if (gops->getNeighbors != NULL) gops->getNeighbors = syncGetNeighbors;
+            if (gops->getEdges != NULL) gops->getEdges = syncGetEdges;
+            if (gops->getCapacity != NULL) gops->getCapacity = syncGetCapacity;
+            if (gops->getFlow != NULL) gops->getFlow = syncGetFlow;
+            if (gops->edgeCount != NULL) gops->edgeCount = syncEdgeCount;
+            //the update is already atomic; only the edge lookup needs the list to hold still
+            if (gops->atomicAddCapacity != NULL) gops->atomicAddCapacity = syncAtomicAddCapacity;
+            if (gops->atomicAddFlow != NULL) gops->atomicAddFlow = syncAtomicAddFlow;
+        }
+        if (gops->addNode != NULL) gops->addNode = syncAddNode;
+        if (gops->removeNode != NULL) gops->removeNode = syncRemoveNode;
+        if (gops->addEdge != NULL) gops->addEdge = syncAddEdge;
+        if (gops->removeEdge != NULL) gops->removeEdge = syncRemoveEdge;
+        if (gops->setCapacity != NULL) gops->setCapacity = syncSetCapacity;
+        if (gops->addCapacity != NULL) gops->addCapacity = syncAddCapacity;
+        if (gops->setFlow != NULL) gops->setFlow = syncSetFlow;
+        if (gops->addFlow != NULL) gops->addFlow = syncAddFlow;
+        if (gops->resetGraph != NULL) gops->resetGraph = syncResetGraph;
+        retval = 1;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Clear out the locking state of a graph
+ *
+ * @param g Graph owning the locking state
+ * @return 1 if successful; 0 if there was no locking state.
+ */
+int destroyGraphSync(struct graph_t *g) {
+    int retval = 0;
+#ifdef GRAPHDATA_PTHREADS
+    if (g != NULL && g->sync != NULL) {
+        struct graphsync_t *s = g->sync;
+        for (size_t i = 0; i < s->stripecount; i++) pthread_mutex_destroy(&s->stripes[i].lock);
+        pthread_rwlock_destroy(&s->structure);
+        graphFree(&g->allocator, s->stripes, s->stripecount * sizeof(struct lockstripe_t));
+        graphFree(&g->allocator, s, sizeof(struct graphsync_t));
+        g->sync = NULL;
+        retval = 1;
+    }
+#endif
+    return retval;
+}
+
+/**
+ * @brief Memory held by the locking state of a graph
+ * @param g Graph in question
+ * @return Size in bytes; 0 if there is no locking state.
+ */
+size_t graphSyncMemory(const struct graph_t *g) {
+    size_t bytes = 0;
+#ifdef GRAPHDATA_PTHREADS
+    if (g != NULL && g->sync != NULL) {
+        bytes = sizeof(struct graphsync_t) + g->sync->stripecount * sizeof(struct lockstripe_t);
+    }
+#endif
+    return bytes;
+}
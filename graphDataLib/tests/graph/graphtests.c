@@ -8,13 +8,34 @@
 #include <graphOps.h>
 #include <util/crudops.h>
 #include <stdlib.h>
+#include <string.h>
 #include <util/cartesian.h>
+#include <util/numaops.h>
+#include <util/snapshot.h>
+#include <util/attrstore.h>
+#include <util/maxflow.h>
+#include <util/expansion.h>
+#include <util/graphio.h>
+#include <util/imageio.h>
+#include <util/graphstats.h>
+#include <util/memusage.h>
+#include <util/adaptive.h>
+#include <util/partition.h>
+#include <impl/arraygraph.h>
+#include <impl/sharedmmapgraph.h>
+#include <impl/linkops.h>
+#include <impl/hashops.h>
+#include <impl/arrayops.h>
+#include <pthread.h>
+#include <unistd.h>
 
 
 #define ARRAY_DIM_CUBE 10
 #define ARRAY_CAP_VAL 55.0
 #define LINK_CAP_VAL 37.0
 #define LINK_NODE_COUNT 6
+#define SYNC_THREADS 8
+#define SYNC_REPEATS 1000
 
 
 /**
@@ -82,6 +103,1633 @@ START_TEST(arrayGraphTest) {
 }
 END_TEST
 
+/**
+ * @brief Test NUMA-placed array graphs and the placement report
+ */
+START_TEST(arrayNumaTest) {
+    //sparse node lists only name the online nodes
+    int parsed[8];
+    ck_assert(numaParseNodeList("0,2\n", parsed, 8) == 2);
+    ck_assert(parsed[0] == 0 && parsed[1] == 2);
+    ck_assert(numaParseNodeList("0-1,3-4", parsed, 8) == 4);
+    ck_assert(parsed[0] == 0 && parsed[1] == 1 && parsed[2] == 3 && parsed[3] == 4);
+    ck_assert(numaParseNodeList("0-7", parsed, 3) == 3);
+
+    enum NUMAPOLICY policies[2] = { NUMA_PARTITION, NUMA_INTERLEAVE };
+    for (int p = 0; p < 2; p++) {
+        struct dimensions_t *dims = createDimensions(3, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+        struct graphconfig_t *cfg = initConfig();
+        ck_assert(cfg != NULL);
+        ck_assert(cfg->numa == NUMA_DEFAULT);
+        cfg->numa = policies[p];
+        struct graph_t *g = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL, 0, dims, cfg);
+        ck_assert(destroyConfig((void **)&cfg) == 1);
+        ck_assert(g != NULL);
+        ck_assert(g->config != NULL);
+        ck_assert(g->config->numa == policies[p]);
+
+        //touch every capacity entry
+        size_t nlen = cartesianIndexLength(dims);
+        double *caparr = (double *)g->capImpl;
+        for (size_t i = 0; i < nlen * dims->dimcount; i++) {
+            ck_assert(caparr[i] == 0.0);
+            caparr[i] = ARRAY_CAP_VAL;
+        }
+
+        struct numareport_t *report = graphNumaReport(g);
+        ck_assert(report != NULL);
+        ck_assert(report->policy == policies[p]);
+        ck_assert(report->slicecount == numaNodeCount());
+        int ids[1024];
+        size_t idcount = numaOnlineNodes(ids, 1024);
+        ck_assert(report->numanodes == (size_t)ids[idcount - 1] + 1);
+        size_t next = 0;
+        size_t resident = 0;
+        for (size_t n = 0; n < report->slicecount; n++) {
+            struct numaslice_t *slice = report->slices + n;
+            ck_assert(slice->firstnode == next);
+            next = slice->endnode;
+            ck_assert(slice->resident <= slice->pages);
+            ck_assert(slice->numanode == (policies[p] == NUMA_PARTITION ? ids[n] : -1));
+            resident += slice->resident;
+        }
+        ck_assert(next == nlen);
+        ck_assert(resident > 0);
+        ck_assert(destroyNumaReport((void **)&report) == 1);
+        ck_assert(report == NULL);
+
+        ck_assert(clearGraph(g) == 1);
+        ck_assert(destroyGraph((void **)&g) == 1);
+        destroyDimensions((void **)&dims);
+    }
+}
+END_TEST
+
+/**
+ * @brief Test that the array allocation strategy is applied and reported through the metadata
+ */
+START_TEST(arrayAllocTest) {
+    enum ALLOCSTRATEGY strategies[4] = { ALLOC_ALIGNED, ALLOC_MMAP, ALLOC_THP, ALLOC_HUGETLB };
+    for (int s = 0; s < 4; s++) {
+        struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE * 10, ARRAY_DIM_CUBE * 10);
+        struct graphconfig_t *cfg = initConfig();
+        ck_assert(cfg->alloc == ALLOC_MALLOC);
+        cfg->alloc = strategies[s];
+        struct graph_t *g = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL, 0, dims, cfg);
+        destroyConfig((void **)&cfg);
+        ck_assert(g != NULL);
+        struct arraydata_t *meta = (struct arraydata_t *)g->metaImpl;
+        ck_assert(meta->alloc == strategies[s]);
+        ck_assert(meta->nodealloc <= strategies[s]);
+        ck_assert(meta->capalloc <= strategies[s]);
+        ck_assert(meta->flowalloc <= strategies[s]);
+
+        struct graphops_t *gops = getOperations(g);
+        double *farr = (double *)g->flowImpl;
+        for (size_t i = 0; i < meta->nodelen * meta->degree; i++) farr[i] = ARRAY_CAP_VAL;
+        ck_assert(gops->resetGraph(g, NULL, NULL) == 1);
+        for (size_t i = 0; i < meta->nodelen * meta->degree; i++) ck_assert(farr[i] == 0.0);
+
+        destroyGraphops((void **)&gops);
+        ck_assert(clearGraph(g) == 1);
+        ck_assert(destroyGraph((void **)&g) == 1);
+        destroyDimensions((void **)&dims);
+    }
+}
+END_TEST
+
+/**
+ * @brief Bookkeeping for the counting allocator used in allocatorTest
+ */
+struct counts_t {
+    size_t allocs;
+    size_t frees;
+    size_t bytes;
+};
+
+static void * countAlloc(size_t size, void *ctx) {
+    struct counts_t *c = (struct counts_t *)ctx;
+    c->allocs++;
+    c->bytes += size;
+    return malloc(size);
+}
+
+static void countFree(void *ptr, size_t size, void *ctx) {
+    struct counts_t *c = (struct counts_t *)ctx;
+    c->frees++;
+    c->bytes -= size;
+    free(ptr);
+}
+
+/**
+ * @brief Test that every internal structure of ARRAY and LINKED graphs is taken from, and returned to, the configured
+ * allocator.
+ */
+START_TEST(allocatorTest) {
+    struct counts_t counts = { 0, 0, 0 };
+    struct graphallocator_t counter = { countAlloc, NULL, countFree, &counts };
+    struct graphconfig_t *cfg = initConfig();
+    cfg->allocator = &counter;
+
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL | LABELED, 2, dims, cfg);
+    ck_assert(g != NULL);
+    ck_assert(g->config->allocator == &g->allocator);
+    //graph, labels, label array, config, metadata, and the three backing arrays
+    ck_assert(counts.allocs == 8);
+    ck_assert(((double *)g->capImpl)[ARRAY_DIM_CUBE] == 0.0);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    ck_assert(counts.allocs == counts.frees);
+    ck_assert(counts.bytes == 0);
+    destroyDimensions((void **)&dims);
+
+    counts.allocs = 0;
+    counts.frees = 0;
+    g = initGraphWithConfig(LINKED | DIRECTED | GENERIC, 0, NULL, cfg);
+    ck_assert(g != NULL);
+    struct graphops_t *gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    ck_assert(counts.allocs == 2 + LINK_NODE_COUNT + (LINK_NODE_COUNT - 1) * LINK_NODE_COUNT);
+    //remove from the head of both lists
+    size_t first = 0;
+    size_t second = 1;
+    ck_assert(gops->removeEdge(&first, &second, g) == 1);
+    ck_assert(gops->getEdge(&first, &second, g) == NULL);
+    ck_assert(gops->removeEdge(&second, &first, g) == 1);
+    ck_assert(gops->removeNode(&first, g) == 1);
+    ck_assert(gops->nodeCount(g) == LINK_NODE_COUNT - 1);
+    ck_assert(gops->edgeCount(g) == (LINK_NODE_COUNT - 1) * (LINK_NODE_COUNT - 2));
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    ck_assert(counts.allocs == counts.frees);
+    ck_assert(counts.bytes == 0);
+
+    destroyConfig((void **)&cfg);
+}
+END_TEST
+
+/**
+ * @brief Work item for the threads in concurrentTest
+ */
+struct syncwork_t {
+    struct graphops_t *gops;
+    size_t u;
+    size_t v;
+    int addedges;
+    int atomic;
+};
+
+static void * syncWorker(void *arg) {
+    struct syncwork_t *w = (struct syncwork_t *)arg;
+    struct graph_t *g = w->gops->g;
+    double one = 1.0;
+    for (size_t i = 0; i < SYNC_REPEATS; i++) {
+        if (w->addedges) {
+            w->gops->addEdge(&w->u, &w->v, &one, g);
+        } else if (w->atomic) {
+            w->gops->atomicAddCapacity(&w->u, &w->v, &one, g);
+            w->gops->atomicAddFlow(&w->v, &w->u, &one, g);
+        } else if (i % 2 == 0) {
+            w->gops->addCapacity(&w->u, &w->v, &one, g);
+        } else {
+            //the reversed edge of an undirected graph shares the same lock stripe
+            w->gops->addCapacity(&w->v, &w->u, &one, g);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run SYNC_THREADS workers against the same graph
+ */
+static void runSyncWorkers(struct graphops_t *gops, size_t u, size_t v, int addedges, int atomic) {
+    pthread_t threads[SYNC_THREADS];
+    struct syncwork_t work[SYNC_THREADS];
+    for (size_t t = 0; t < SYNC_THREADS; t++) {
+        work[t].gops = gops;
+        //edge-adding threads share two source nodes, so some of them always contend for a stripe
+        work[t].u = addedges ? u + (t % 2) : u;
+        work[t].v = v;
+        work[t].addedges = addedges;
+        work[t].atomic = atomic;
+        ck_assert(pthread_create(&threads[t], NULL, syncWorker, &work[t]) == 0);
+    }
+    for (size_t t = 0; t < SYNC_THREADS; t++) pthread_join(threads[t], NULL);
+}
+
+/**
+ * @brief Test that concurrent updates to a CONCURRENCY_STRIPED graph are not lost.
+ */
+START_TEST(concurrentTest) {
+    struct graphconfig_t *cfg = initConfig();
+    cfg->concurrency = CONCURRENCY_STRIPED;
+    cfg->lockstripes = 5;
+
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL, 0, dims, cfg);
+    ck_assert(g != NULL);
+    ck_assert(g->sync != NULL);
+    struct graphops_t *gops = getOperations(g);
+    size_t u = 1;
+    size_t v = 2;
+    double cap = 0.0;
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+    runSyncWorkers(gops, u, v, 0, 0);
+    ck_assert(gops->getCapacity(&u, &v, &cap, g) == 1);
+    ck_assert(cap == (double)(SYNC_THREADS * SYNC_REPEATS));
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    destroyDimensions((void **)&dims);
+
+    g = initGraphWithConfig(LINKED | DIRECTED | GENERIC, 0, NULL, cfg);
+    ck_assert(g != NULL);
+    gops = getOperations(g);
+    for (size_t i = 0; i < 3; i++) ck_assert(gops->addNode(&i, g) == 1);
+    runSyncWorkers(gops, 0, 2, 1, 0);
+    ck_assert(gops->edgeCount(g) == SYNC_THREADS * SYNC_REPEATS);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+
+    destroyConfig((void **)&cfg);
+}
+END_TEST
+
+/**
+ * @brief Test that the atomic value operations lose no updates without any locking, in both memory orders.
+ */
+START_TEST(atomicTest) {
+    enum MEMORDER orders[2] = { MEMORDER_SEQCST, MEMORDER_RELAXED };
+    for (int o = 0; o < 2; o++) {
+        struct graphconfig_t *cfg = initConfig();
+        cfg->memorder = orders[o];
+        struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+        struct graph_t *g = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL, 0, dims, cfg);
+        ck_assert(g != NULL);
+        ck_assert(g->sync == NULL);
+        struct graphops_t *gops = getOperations(g);
+        size_t u = 3;
+        size_t v = 4;
+        double val = 0.0;
+        ck_assert(gops->addEdge(&u, &v, &val, g) == 1);
+        runSyncWorkers(gops, u, v, 0, 1);
+        ck_assert(gops->getCapacity(&u, &v, &val, g) == 1);
+        ck_assert(val == (double)(SYNC_THREADS * SYNC_REPEATS));
+        ck_assert(gops->getFlow(&v, &u, &val, g) == 1);
+        ck_assert(val == (double)(SYNC_THREADS * SYNC_REPEATS));
+        destroyGraphops((void **)&gops);
+        ck_assert(clearGraph(g) == 1);
+        ck_assert(destroyGraph((void **)&g) == 1);
+        destroyDimensions((void **)&dims);
+
+        g = initGraphWithConfig(LINKED | DIRECTED | GENERIC, 0, NULL, cfg);
+        gops = getOperations(g);
+        fillLinkTestGraph(g, gops);
+        u = 0;
+        v = 1;
+        runSyncWorkers(gops, u, v, 0, 1);
+        ck_assert(gops->getCapacity(&u, &v, &val, g) == 1);
+        ck_assert(val == LINK_CAP_VAL + (double)(SYNC_THREADS * SYNC_REPEATS));
+        ck_assert(gops->getFlow(&v, &u, &val, g) == 1);
+        ck_assert(val == (double)(SYNC_THREADS * SYNC_REPEATS));
+        destroyGraphops((void **)&gops);
+        ck_assert(clearGraph(g) == 1);
+        ck_assert(destroyGraph((void **)&g) == 1);
+        destroyConfig((void **)&cfg);
+    }
+}
+END_TEST
+
+/**
+ * @brief Test that snapshots keep their view while the live graph changes, and that every version is released.
+ */
+START_TEST(snapshotTest) {
+    struct counts_t counts = { 0, 0, 0 };
+    struct graphallocator_t counter = { countAlloc, NULL, countFree, &counts };
+    struct graphconfig_t *cfg = initConfig();
+    cfg->allocator = &counter;
+    struct graph_t *g = initGraphWithConfig(LINKED | DIRECTED | GENERIC, 0, NULL, cfg);
+    destroyConfig((void **)&cfg);
+    struct graphops_t *gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    size_t a = 0, b = 1, c = 2, d = 3;
+    double cap = 5.0;
+    double val = 0.0;
+
+    struct graph_t *first = snapshotGraph(g);
+    ck_assert(first != NULL);
+    ck_assert(isSnapshot(first) == 1);
+    ck_assert(isSnapshot(g) == 0);
+    ck_assert(snapshotGraph(first) == NULL);
+    struct graphops_t *fops = getOperations(first);
+    ck_assert(fops->addEdge == NULL);
+    ck_assert(fops->setCapacity == NULL);
+    //writes to the view through the backend are refused
+    ck_assert(linkAddNode(&a, first) == 0);
+
+    ck_assert(gops->setCapacity(&a, &b, &cap, g) == 1);
+    ck_assert(gops->removeEdge(&a, &c, g) == 1);
+    ck_assert(gops->removeNode(&d, g) == 1);
+    ck_assert(fops->getCapacity(&a, &b, &val, first) == 1);
+    ck_assert(val == LINK_CAP_VAL);
+    ck_assert(fops->getEdge(&a, &c, first) != NULL);
+    ck_assert(fops->nodeCount(first) == LINK_NODE_COUNT);
+    ck_assert(fops->edgeCount(first) == (LINK_NODE_COUNT - 1) * LINK_NODE_COUNT);
+
+    struct graph_t *second = snapshotGraph(g);
+    cap = 9.0;
+    ck_assert(gops->setCapacity(&a, &b, &cap, g) == 1);
+    ck_assert(fops->getCapacity(&a, &b, &val, second) == 1);
+    ck_assert(val == 5.0);
+    ck_assert(fops->getEdge(&a, &c, second) == NULL);
+    ck_assert(fops->nodeCount(second) == LINK_NODE_COUNT - 1);
+
+    //releasing the older view must keep the versions the newer one still sees
+    destroyGraphops((void **)&fops);
+    ck_assert(releaseSnapshot((void **)&first) == 1);
+    ck_assert(first == NULL);
+    struct graphops_t *sops = getOperations(second);
+    ck_assert(sops->getCapacity(&a, &b, &val, second) == 1);
+    ck_assert(val == 5.0);
+    ck_assert(gops->getCapacity(&a, &b, &val, g) == 1);
+    ck_assert(val == 9.0);
+    destroyGraphops((void **)&sops);
+    ck_assert(clearGraph(second) == 1);
+    ck_assert(destroyGraph((void **)&second) == 1);
+
+    //with no snapshots left, writes go straight to the live lists
+    ck_assert(gops->addCapacity(&a, &b, &cap, g) == 1);
+    ck_assert(gops->getCapacity(&a, &b, &val, g) == 1);
+    ck_assert(val == 18.0);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    ck_assert(counts.allocs == counts.frees);
+    ck_assert(counts.bytes == 0);
+}
+END_TEST
+
+/**
+ * @brief Work item for the snapshot readers in snapshotReadersTest
+ */
+struct snapwork_t {
+    struct graphops_t *ops;
+    struct graph_t *view;
+    size_t mismatches;
+};
+
+static void * snapshotReader(void *arg) {
+    struct snapwork_t *w = (struct snapwork_t *)arg;
+    for (size_t i = 0; i < SYNC_REPEATS / 10; i++) {
+        if (w->ops->nodeCount(w->view) != LINK_NODE_COUNT) w->mismatches++;
+        for (size_t u = 0; u < LINK_NODE_COUNT; u++) {
+            for (size_t v = 0; v < LINK_NODE_COUNT; v++) {
+                double val = 0.0;
+                if (u != v && (w->ops->getCapacity(&u, &v, &val, w->view) != 1 || val != LINK_CAP_VAL)) w->mismatches++;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Test that readers of a HASHED snapshot see a fixed view while the live graph is updated, and that the live
+ * graph cannot be cleared or destroyed under them.
+ */
+START_TEST(snapshotReadersTest) {
+    struct graph_t *g = initGraph(HASHED | DIRECTED | GENERIC, 0, NULL);
+    struct graphops_t *gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    struct graph_t *view = snapshotGraph(g);
+    ck_assert(view != NULL);
+    ck_assert((view->gtype & HASHED) == HASHED);
+    ck_assert(snapshotCount(g) == 1);
+    struct graphops_t *vops = getOperations(view);
+    ck_assert(vops->addEdge == NULL);
+    //writes to the view through the backend are refused
+    size_t extra = LINK_NODE_COUNT;
+    ck_assert(hashAddNode(&extra, view) == 0);
+
+    pthread_t threads[SYNC_THREADS];
+    struct snapwork_t work[SYNC_THREADS];
+    for (size_t t = 0; t < SYNC_THREADS; t++) {
+        work[t].ops = vops;
+        work[t].view = view;
+        work[t].mismatches = 0;
+        ck_assert(pthread_create(&threads[t], NULL, snapshotReader, &work[t]) == 0);
+    }
+    for (size_t i = 0; i < SYNC_REPEATS; i++) {
+        size_t u = i % LINK_NODE_COUNT;
+        size_t v = (i + 1) % LINK_NODE_COUNT;
+        double cap = (double)i;
+        ck_assert(gops->setCapacity(&u, &v, &cap, g) == 1);
+        ck_assert(gops->addFlow(&u, &v, &cap, g) == 1);
+        ck_assert(gops->removeEdge(&v, &u, g) == 1);
+        ck_assert(gops->addEdge(&v, &u, &cap, g) == 1);
+    }
+    ck_assert(gops->addNode(&extra, g) == 1);
+    size_t gone = 0;
+    ck_assert(gops->removeNode(&gone, g) == 1);
+    ck_assert(gops->resetGraph(g, NULL, NULL) == 1);
+    for (size_t t = 0; t < SYNC_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        ck_assert(work[t].mismatches == 0);
+    }
+    ck_assert(vops->edgeCount(view) == (LINK_NODE_COUNT - 1) * LINK_NODE_COUNT);
+    ck_assert(gops->nodeCount(g) == LINK_NODE_COUNT);
+    ck_assert(gops->getEdge(&gone, &extra, g) == NULL);
+
+    //the live graph cannot go away while the snapshot is held
+    ck_assert(clearGraph(g) == 0);
+    ck_assert(destroyGraph((void **)&g) == 0);
+    ck_assert(g != NULL);
+    destroyGraphops((void **)&vops);
+    ck_assert(releaseSnapshot((void **)&view) == 1);
+    ck_assert(snapshotCount(g) == 0);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+}
+END_TEST
+
+/**
+ * @brief Test full and structure-only clones of ARRAY and LINKED graphs.
+ */
+START_TEST(cloneTest) {
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    struct graphops_t *gops = getOperations(g);
+    size_t u = 1, v = 2;
+    double cap = ARRAY_CAP_VAL;
+    double val = 0.0;
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+    ck_assert(setAttrByName(g, "weight", ATTR_NODE, 5, 2.5) == 1);
+
+    struct graph_t *full = cloneGraph(g, CLONE_FULL);
+    ck_assert(full != NULL);
+    ck_assert(full->nodeImpl != g->nodeImpl);
+    ck_assert(gops->getCapacity(&u, &v, &val, full) == 1);
+    ck_assert(val == ARRAY_CAP_VAL);
+    ck_assert(gops->addCapacity(&u, &v, &cap, g) == 1);
+    ck_assert(gops->getCapacity(&u, &v, &val, full) == 1);
+    ck_assert(val == ARRAY_CAP_VAL);
+    ck_assert(getAttrByName(full, "weight", ATTR_NODE, 5, &val) == 1);
+    ck_assert(val == 2.5);
+
+    struct graph_t *shape = cloneGraph(g, CLONE_STRUCTURE);
+    ck_assert(shape != NULL);
+    ck_assert(shape->nodeImpl == g->nodeImpl);
+    ck_assert(shape->attrs == NULL);
+    ck_assert(gops->getCapacity(&u, &v, &val, shape) == 1);
+    ck_assert(val == 0.0);
+    //the shared topology cannot change through the clone
+    u = 3;
+    v = 4;
+    ck_assert(gops->addEdge(&u, &v, &cap, shape) == 0);
+    //...nor through the original, which cannot be cleared until its clones are gone
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 0);
+    u = 1;
+    v = 2;
+    ck_assert(gops->removeEdge(&u, &v, g) == 0);
+    struct graph_t *shape2 = cloneGraph(shape, CLONE_STRUCTURE);
+    ck_assert(shape2 != NULL && shape2->nodeImpl == g->nodeImpl);
+    ck_assert(clearGraph(g) == 0);
+    ck_assert(clearGraph(shape) == 1);
+    ck_assert(destroyGraph((void **)&shape) == 1);
+    ck_assert(clearGraph(g) == 0);
+    ck_assert(clearGraph(shape2) == 1);
+    ck_assert(destroyGraph((void **)&shape2) == 1);
+    ck_assert(g->nodeImpl != NULL);
+    struct edge_t *e = gops->getEdge(&u, &v, g);
+    ck_assert(e != NULL);
+    free(e);
+    ck_assert(clearGraph(full) == 1);
+    ck_assert(destroyGraph((void **)&full) == 1);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    destroyDimensions((void **)&dims);
+
+    struct counts_t counts = { 0, 0, 0 };
+    struct graphallocator_t counter = { countAlloc, NULL, countFree, &counts };
+    struct graphconfig_t *cfg = initConfig();
+    cfg->allocator = &counter;
+    g = initGraphWithConfig(LINKED | DIRECTED | GENERIC, 0, NULL, cfg);
+    destroyConfig((void **)&cfg);
+    gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    full = cloneGraph(g, CLONE_FULL);
+    shape = cloneGraph(g, CLONE_STRUCTURE);
+    ck_assert(full != NULL && shape != NULL);
+    ck_assert(gops->edgeCount(full) == gops->edgeCount(g));
+    ck_assert(gops->edgeCount(shape) == gops->edgeCount(g));
+    u = 0;
+    v = 1;
+    ck_assert(gops->getCapacity(&u, &v, &val, full) == 1);
+    ck_assert(val == LINK_CAP_VAL);
+    ck_assert(gops->getCapacity(&u, &v, &val, shape) == 1);
+    ck_assert(val == 0.0);
+    ck_assert(gops->removeNode(&u, shape) == 1);
+    ck_assert(gops->nodeCount(g) == LINK_NODE_COUNT);
+    ck_assert(clearGraph(shape) == 1);
+    ck_assert(destroyGraph((void **)&shape) == 1);
+    ck_assert(clearGraph(full) == 1);
+    ck_assert(destroyGraph((void **)&full) == 1);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    ck_assert(counts.allocs == counts.frees);
+    ck_assert(counts.bytes == 0);
+}
+END_TEST
+
+/**
+ * @brief Layer callback for layerTest: reset the active layer
+ */
+static int resetLayer(struct graph_t *g, size_t layer, void *ctx) {
+    size_t *visited = (size_t *)ctx;
+    (*visited)++;
+    return arrayResetGraph(g, NULL, NULL);
+}
+
+/**
+ * @brief Test named value layers sharing one ARRAY topology.
+ */
+START_TEST(layerTest) {
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    struct graphops_t *gops = getOperations(g);
+    size_t u = 1, v = 2;
+    double cap = 5.0;
+    double val = 0.0;
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+    ck_assert(arrayLayerCount(g) == 1);
+    ck_assert(arrayFindLayer(g, "a") == LAYER_NONE);
+
+    size_t la = arrayAddLayer(g, "a");
+    size_t lb = arrayAddLayer(g, "b");
+    ck_assert(la == 1 && lb == 2);
+    ck_assert(arrayAddLayer(g, "a") == la);
+    ck_assert(arrayFindLayer(g, "b") == lb);
+    ck_assert(arrayLayerCount(g) == 3);
+    ck_assert(arrayActiveLayer(g) == 0);
+    void *nodes = g->nodeImpl;
+
+    ck_assert(arraySelectLayer(g, la) == 1);
+    ck_assert(g->nodeImpl == nodes);
+    ck_assert(gops->getCapacity(&u, &v, &val, g) == 1);
+    ck_assert(val == 0.0);
+    cap = 7.0;
+    ck_assert(gops->setCapacity(&u, &v, &cap, g) == 1);
+    ck_assert(arraySelectLayer(g, lb) == 1);
+    cap = 9.0;
+    ck_assert(gops->setCapacity(&u, &v, &cap, g) == 1);
+    //topology changes are seen by every layer
+    size_t x = 3, y = 4;
+    ck_assert(gops->addEdge(&x, &y, &cap, g) == 1);
+    ck_assert(arraySelectLayer(g, 0) == 1);
+    ck_assert(gops->getCapacity(&x, &y, &val, g) == 1);
+    ck_assert(arraySelectLayer(g, 3) == 0);
+
+    double caps[3], flows[3];
+    double adds[3] = { 1.0, 2.0, 3.0 };
+    ck_assert(arrayGetLayerValues(&v, &u, caps, NULL, g) == 1);
+    ck_assert(caps[0] == 5.0 && caps[1] == 7.0 && caps[2] == 9.0);
+    ck_assert(arrayAddLayerValues(&u, &v, NULL, adds, g) == 1);
+    ck_assert(arrayGetLayerValues(&u, &v, NULL, flows, g) == 1);
+    ck_assert(flows[0] == 1.0 && flows[1] == 2.0 && flows[2] == 3.0);
+
+    size_t visited = 0;
+    ck_assert(arraySelectLayer(g, la) == 1);
+    ck_assert(arrayForEachLayer(g, resetLayer, &visited) == 1);
+    ck_assert(visited == 3);
+    ck_assert(arrayActiveLayer(g) == la);
+    ck_assert(arrayGetLayerValues(&u, &v, caps, flows, g) == 1);
+    for (size_t l = 0; l < 3; l++) ck_assert(caps[l] == 0.0 && flows[l] == 0.0);
+
+    //a removed edge leaves nothing behind in the inactive layers for the next edge in its slot
+    size_t p = 5, q = 6, r = 7;
+    cap = 1.0;
+    ck_assert(arraySelectLayer(g, 0) == 1);
+    ck_assert(gops->addEdge(&p, &q, &cap, g) == 1);
+    ck_assert(arraySelectLayer(g, la) == 1);
+    cap = 7.0;
+    ck_assert(gops->setCapacity(&p, &q, &cap, g) == 1);
+    ck_assert(gops->setFlow(&p, &q, &cap, g) == 1);
+    ck_assert(arraySelectLayer(g, 0) == 1);
+    ck_assert(gops->removeEdge(&p, &q, g) == 1);
+    cap = 1.0;
+    ck_assert(gops->addEdge(&p, &r, &cap, g) == 1);
+    ck_assert(arraySelectLayer(g, la) == 1);
+    ck_assert(gops->getCapacity(&p, &r, &val, g) == 1);
+    ck_assert(val == 0.0);
+    ck_assert(gops->getFlow(&p, &r, &val, g) == 1);
+    ck_assert(val == 0.0);
+
+    //full clones copy every layer, with the same ids and active layer
+    for (size_t l = 0; l < 3; l++) {
+        cap = 4.0 + 2.0 * (double)l;
+        ck_assert(arraySelectLayer(g, l) == 1 && gops->setCapacity(&u, &v, &cap, g) == 1);
+    }
+    ck_assert(arraySelectLayer(g, la) == 1);
+    struct graph_t *c = cloneGraph(g, CLONE_FULL);
+    ck_assert(c != NULL);
+    ck_assert(arrayLayerCount(c) == 3 && arrayActiveLayer(c) == la);
+    ck_assert(arrayFindLayer(c, "b") == lb);
+    ck_assert(arrayGetLayerValues(&u, &v, caps, NULL, c) == 1);
+    ck_assert(caps[0] == 4.0 && caps[1] == 6.0 && caps[2] == 8.0);
+    ck_assert(arraySelectLayer(c, lb) == 1);
+    ck_assert(gops->getCapacity(&u, &v, &val, c) == 1 && val == 8.0);
+    cap = 1.0;
+    ck_assert(gops->setCapacity(&u, &v, &cap, c) == 1);
+    ck_assert(arrayGetLayerValues(&u, &v, caps, NULL, g) == 1 && caps[2] == 8.0);
+    ck_assert(clearGraph(c) == 1);
+    ck_assert(destroyGraph((void **)&c) == 1);
+
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    destroyDimensions((void **)&dims);
+}
+END_TEST
+
+/**
+ * @brief Max-flow over the edges of an ARRAY graph.
+ */
+START_TEST(maxflowTest) {
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    struct graphops_t *gops = getOperations(g);
+    size_t len = cartesianIndexLength(dims);
+    //two paths from 1 to 3: through 2 (bottleneck 2) and through 4 (bottleneck 1)
+    size_t ends[4][2] = { {1, 2}, {2, 3}, {1, 4}, {4, 3} };
+    double caps[4] = { 3.0, 2.0, 1.0, 5.0 };
+    for (size_t i = 0; i < 4; i++) {
+        ck_assert(gops->addEdge(&ends[i][0], &ends[i][1], &caps[i], g) == 1);
+    }
+    double *source = calloc(len, sizeof(double));
+    double *sink = calloc(len, sizeof(double));
+    unsigned char *side = calloc(len, sizeof(unsigned char));
+    source[1] = 10.0;
+    sink[3] = 10.0;
+    double flow = 0.0;
+    ck_assert(arrayMaxFlow(g, source, sink, side, &flow) == 1);
+    ck_assert(flow == 3.0);
+    ck_assert(side[1] == 0 && side[3] == 1);
+    double val = 0.0;
+    size_t u = 1, v = 2;
+    ck_assert(gops->getFlow(&u, &v, &val, g) == 1);
+    ck_assert(val == 2.0);
+    u = 3; v = 4;
+    ck_assert(gops->getFlow(&u, &v, &val, g) == 1);
+    //stored from the lower id, so the flow from 4 to 3 shows as negative
+    ck_assert(val == -1.0);
+
+    //workspace arc flows, over an arc of capacity 5 one way and 2 the other
+    struct flowworkspace_t *ws = initFlowWorkspace(g, 0);
+    ck_assert(ws != NULL);
+    size_t degree = ((const struct arraydata_t *)g->metaImpl)->degree;
+    size_t slot = degree;
+    while (((size_t *)g->nodeImpl)[slot] != 2) slot++;
+    flowAddArc(ws, slot, 5.0, 2.0);
+    flowAddTerminal(ws, 1, 3.0, 0.0);
+    flowAddTerminal(ws, 2, 0.0, 10.0);
+    ck_assert(flowSolve(ws) == 3.0);
+    ck_assert(flowArcFlow(ws, slot) == 3.0);
+    flowReset(ws);
+    flowAddArc(ws, slot, 5.0, 2.0);
+    flowAddTerminal(ws, 2, 10.0, 0.0);
+    flowAddTerminal(ws, 1, 0.0, 10.0);
+    ck_assert(flowSolve(ws) == 2.0);
+    ck_assert(flowArcFlow(ws, slot) == -2.0);
+    ck_assert(destroyFlowWorkspace((void **)&ws) == 1);
+
+    free(source);
+    free(sink);
+    free(side);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    destroyDimensions((void **)&dims);
+}
+END_TEST
+
+#define EXP_SIDE 4
+#define EXP_LABELS 3
+
+/**
+ * @brief Alpha-expansion on a small LABELED grid.
+ */
+START_TEST(expansionTest) {
+    struct dimensions_t *dims = createDimensions(2, EXP_SIDE, EXP_SIDE);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL | LABELED, EXP_LABELS, dims);
+    ck_assert(g != NULL);
+    struct graphops_t *gops = getOperations(g);
+    size_t n = EXP_SIDE * EXP_SIDE;
+    double w = 1.0;
+    for (size_t p = 0; p < n; p++) {
+        size_t right = p + 1, down = p + EXP_SIDE;
+        if (p % EXP_SIDE < EXP_SIDE - 1) ck_assert(gops->addEdge(&p, &right, &w, g) == 1);
+        if (p / EXP_SIDE < EXP_SIDE - 1) ck_assert(gops->addEdge(&p, &down, &w, g) == 1);
+    }
+    //left half prefers label 0, right half label 2; node 5 is noise that prefers label 1
+    double datacost[EXP_LABELS * EXP_SIDE * EXP_SIDE];
+    size_t labeling[EXP_SIDE * EXP_SIDE];
+    for (size_t p = 0; p < n; p++) {
+        size_t want = (p % EXP_SIDE < EXP_SIDE / 2) ? 0 : 2;
+        for (size_t l = 0; l < EXP_LABELS; l++) datacost[l * n + p] = (l == want) ? 0.0 : 2.0;
+        labeling[p] = 1;
+    }
+    datacost[0 * n + 5] = 1.5;
+    datacost[1 * n + 5] = 0.0;
+
+    double energy = 0.0;
+    ck_assert(alphaExpansion(g, datacost, NULL, NULL, labeling, 0, &energy) == 1);
+    for (size_t p = 0; p < n; p++) {
+        ck_assert(labeling[p] == ((p % EXP_SIDE < EXP_SIDE / 2) ? 0 : 2));
+    }
+    //noise pixel data cost plus one boundary edge per row
+    ck_assert(energy == 1.5 + EXP_SIDE);
+    ck_assert(labelingEnergy(g, datacost, NULL, NULL, labeling) == energy);
+    //labels out of range are refused
+    labeling[0] = EXP_LABELS;
+    ck_assert(alphaExpansion(g, datacost, NULL, NULL, labeling, 0, NULL) == 0);
+
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    destroyDimensions((void **)&dims);
+}
+END_TEST
+
+/**
+ * @brief Write text to a temporary stream, rewound for reading
+ */
+static FILE * textStream(const char *text) {
+    FILE *f = tmpfile();
+    ck_assert(f != NULL);
+    fputs(text, f);
+    rewind(f);
+    return f;
+}
+
+/**
+ * @brief Edge list and DIMACS import and export.
+ */
+START_TEST(graphioTest) {
+    struct graph_t *g = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    struct graphops_t *gops = getOperations(g);
+    size_t count = 0, errline = 0;
+    FILE *f = textStream("# comment\n1 2 2.5\n\n2\t3\n% other comment\n3 1 1e3\n12345678901 2 -0.125\r\n4 5 0.1");
+    ck_assert(importEdgeList(g, f, &count, &errline) == 1);
+    fclose(f);
+    ck_assert(count == 5 && errline == 0);
+    ck_assert(gops->nodeCount(g) == 6);
+    size_t u = 1, v = 2;
+    double val = 0.0;
+    ck_assert(gops->getCapacity(&u, &v, &val, g) == 1 && val == 2.5);
+    u = 2; v = 3;
+    ck_assert(gops->getCapacity(&u, &v, &val, g) == 1 && val == 1.0);
+    u = 3; v = 1;
+    ck_assert(gops->getCapacity(&u, &v, &val, g) == 1 && val == 1000.0);
+    u = 12345678901; v = 2;
+    ck_assert(gops->getCapacity(&u, &v, &val, g) == 1 && val == -0.125);
+    u = 4; v = 5;
+    ck_assert(gops->getCapacity(&u, &v, &val, g) == 1 && val == 0.1);
+    f = textStream("6 7\n6 x\n");
+    ck_assert(importEdgeList(g, f, &count, &errline) == 0);
+    fclose(f);
+    ck_assert(errline == 2);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+
+    //DIMACS into an undirected ARRAY graph--the reverse arcs are already present
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    gops = getOperations(g);
+    size_t source = 0, sink = 0;
+    f = textStream("c example\np max 4 6\nn 1 s\nn 3 t\na 1 2 3\na 2 1 3\na 2 3 2\na 1 4 1\na 4 3 5\na 3 4 5\n");
+    ck_assert(importDimacs(g, f, &source, &sink, &count, &errline) == 1);
+    fclose(f);
+    //DIMACS ids are one more than graph ids
+    ck_assert(source == 0 && sink == 2 && count == 4);
+    u = 2; v = 3;
+    ck_assert(gops->getCapacity(&u, &v, &val, g) == 1 && val == 5.0);
+
+    //write it back out, and read the arcs into a directed graph
+    f = tmpfile();
+    ck_assert(exportDimacs(g, f, source, sink) == 1);
+    rewind(f);
+    char header[64];
+    ck_assert(fgets(header, sizeof(header), f) != NULL && strcmp(header, "p max 4 8\n") == 0);
+    ck_assert(fgets(header, sizeof(header), f) != NULL && strcmp(header, "n 1 s\n") == 0);
+    rewind(f);
+    //a directed ARRAY graph cannot hold the arcs into DIMACS node 1, and says so rather than dropping them
+    struct graph_t *ag = initGraph(ARRAY | DIRECTED | SPATIAL, 0, dims);
+    errline = 0;
+    ck_assert(importDimacs(ag, f, NULL, NULL, &count, &errline) == 0);
+    ck_assert(errline > 0 && count < 8);
+    rewind(f);
+    clearGraph(ag);
+    destroyGraph((void **)&ag);
+    ag = initGraph(ARRAY | DIRECTED | SPATIAL, 0, dims);
+    FILE *af = textStream("p max 4 3\na 1 2 3\na 2 1 5\na 2 4 2\n");
+    ck_assert(importDimacs(ag, af, NULL, NULL, &count, &errline) == 0);
+    fclose(af);
+    ck_assert(errline == 3 && count == 1);
+    clearGraph(ag);
+    destroyGraph((void **)&ag);
+    struct graph_t *dg = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    struct graphops_t *dops = getOperations(dg);
+    ck_assert(importDimacs(dg, f, &source, &sink, &count, &errline) == 1);
+    fclose(f);
+    ck_assert(source == 0 && sink == 2 && count == 8);
+    u = 3; v = 0;
+    ck_assert(dops->getCapacity(&u, &v, &val, dg) == 1 && val == 1.0);
+    f = tmpfile();
+    ck_assert(exportEdgeList(dg, f) == 1);
+    rewind(f);
+    struct graph_t *lg = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    ck_assert(importEdgeList(lg, f, &count, &errline) == 1);
+    fclose(f);
+    ck_assert(count == 8);
+    f = textStream("a 1 2 3\n");
+    ck_assert(importDimacs(lg, f, NULL, NULL, NULL, &errline) == 0);
+    fclose(f);
+    ck_assert(errline == 1);
+    f = textStream("p max 2 1\na 0 1 3\n");
+    ck_assert(importDimacs(lg, f, NULL, NULL, NULL, &errline) == 0);
+    fclose(f);
+    ck_assert(errline == 2);
+
+    destroyGraphops((void **)&dops);
+    ck_assert(clearGraph(lg) == 1);
+    ck_assert(destroyGraph((void **)&lg) == 1);
+    ck_assert(clearGraph(dg) == 1);
+    ck_assert(destroyGraph((void **)&dg) == 1);
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    destroyDimensions((void **)&dims);
+}
+END_TEST
+
+/**
+ * @brief Image and volume loading into SPATIAL ARRAY graphs.
+ */
+START_TEST(imageTest) {
+    //3 x 2 gray image: 0 0 2 / 0 1 2
+    FILE *f = textStream("P2\n# test image\n3 2\n255\n0 0 2\n0 1 2\n");
+    struct imagegraph_t *ig = loadPNM(f, 1.0);
+    fclose(f);
+    ck_assert(ig != NULL);
+    ck_assert(ig->channels == 1 && ig->maxval == 255);
+    ck_assert(ig->dims->dimarr[0] == 3 && ig->dims->dimarr[1] == 2);
+    ck_assert(ig->intensity[4] == 1.0);
+    struct graphops_t *gops = getOperations(ig->g);
+    double val = 0.0;
+    size_t u = 0, v = 1;
+    ck_assert(gops->getCapacity(&u, &v, &val, ig->g) == 1 && val == 1.0);
+    u = 1; v = 2;
+    ck_assert(gops->getCapacity(&u, &v, &val, ig->g) == 1);
+    ck_assert(val > 0.1353 && val < 0.1354);
+    u = 1; v = 4;
+    ck_assert(gops->getCapacity(&u, &v, &val, ig->g) == 1);
+    ck_assert(val > 0.6065 && val < 0.6066);
+    //no wrap-around from the end of one row to the start of the next
+    u = 2; v = 3;
+    ck_assert(gops->getCapacity(&u, &v, &val, ig->g) == 0);
+    destroyGraphops((void **)&gops);
+    ck_assert(destroyImageGraph((void **)&ig) == 1);
+    ck_assert(ig == NULL);
+
+    //binary 16-bit RGB
+    f = tmpfile();
+    const unsigned char rgb[] = { 'P', '6', '\n', '2', ' ', '1', '\n', '1', '0', '0', '0', '\n',
+                                  0x01, 0x00, 0, 0, 0, 0,  0x01, 0x00, 0, 3, 0, 4 };
+    fwrite(rgb, 1, sizeof(rgb), f);
+    rewind(f);
+    ig = loadPNM(f, 5.0);
+    fclose(f);
+    ck_assert(ig != NULL && ig->channels == 3);
+    ck_assert(ig->intensity[0] == 256.0 && ig->intensity[5] == 4.0);
+    gops = getOperations(ig->g);
+    u = 0; v = 1;
+    ck_assert(gops->getCapacity(&u, &v, &val, ig->g) == 1);
+    ck_assert(val > 0.6065 && val < 0.6066);
+    destroyGraphops((void **)&gops);
+    destroyImageGraph((void **)&ig);
+
+    //2 x 2 x 2 big-endian 16-bit volume
+    f = tmpfile();
+    const unsigned char vox[16] = { 0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0, 8 };
+    fwrite(vox, 1, sizeof(vox), f);
+    rewind(f);
+    ig = loadRawVolume(f, 2, 2, 2, 2, 1, 1.0);
+    fclose(f);
+    ck_assert(ig != NULL);
+    ck_assert(ig->dims->dimcount == 3 && ig->intensity[7] == 8.0);
+    gops = getOperations(ig->g);
+    u = 0; v = 4;
+    ck_assert(gops->getCapacity(&u, &v, &val, ig->g) == 1);
+    ck_assert(val > 0.0003 && val < 0.0004);
+    destroyGraphops((void **)&gops);
+    destroyImageGraph((void **)&ig);
+
+    f = textStream("P5\n2 2\n255\n\x01");
+    ck_assert(loadPNM(f, 1.0) == NULL);
+    fclose(f);
+
+    //sizes whose sample count overflows are rejected before anything is allocated
+    f = textStream("P6\n4294967296 4294967296\n255\n");
+    ck_assert(loadPNM(f, 1.0) == NULL);
+    fclose(f);
+    f = textStream("");
+    ck_assert(loadRawVolume(f, (size_t)1 << 30, (size_t)1 << 30, (size_t)1 << 10, 1, 0, 1.0) == NULL);
+    fclose(f);
+}
+END_TEST
+
+/**
+ * @brief Operation statistics, when the library is built with them; otherwise, STATS_ON graphs must still work.
+ */
+START_TEST(statsTest) {
+    ck_assert(graphStatsBucketLimit(5) == 5);
+    ck_assert(graphStatsBucketLimit(8) == 8 && graphStatsBucketLimit(16) == 17);
+    //the top power of two keeps all its buckets; only longer latencies reach the overflow bucket
+    ck_assert(graphStatsBucketLimit(STATS_OVERFLOW_BUCKET - 1) == ((uint64_t)1 << (STATS_MAX_EXP + 1)) - 1);
+    ck_assert(graphStatsBucketLimit(STATS_OVERFLOW_BUCKET) == UINT64_MAX);
+    ck_assert(graphStatOpName(STATOP_ADDEDGE) != NULL && graphStatOpName(STATOP_COUNT) == NULL);
+
+    struct graphconfig_t *cfg = initConfig();
+    cfg->stats = STATS_ON;
+    struct graph_t *g = initGraphWithConfig(LINKED | DIRECTED | GENERIC, 0, NULL, cfg);
+    destroyConfig((void **)&cfg);
+    ck_assert(g != NULL);
+    struct graphops_t *gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    size_t u = 0, v = 1;
+    double cap = 0.0;
+    for (int i = 0; i < 10; i++) ck_assert(gops->getCapacity(&u, &v, &cap, g) == 1);
+
+    struct graphstats_t *stats = (struct graphstats_t *)malloc(sizeof(struct graphstats_t));
+    if (getGraphStats(g, stats)) {
+        ck_assert(stats->ops[STATOP_GETCAPACITY].calls == 10);
+        ck_assert(stats->ops[STATOP_GETCAPACITY].probes >= 20);
+        ck_assert(stats->ops[STATOP_GETCAPACITY].maxprobe >= 2);
+        ck_assert(stats->ops[STATOP_ADDEDGE].calls > 0);
+        ck_assert(graphStatsPercentile(&stats->ops[STATOP_GETCAPACITY], 99.0) > 0);
+        ck_assert(resetGraphStats(g) == 1);
+        ck_assert(getGraphStats(g, stats) == 1 && stats->ops[STATOP_GETCAPACITY].calls == 0);
+    } else {
+        ck_assert(g->stats == NULL);
+    }
+    free(stats);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+
+    //graphs without STATS_ON keep nothing
+    g = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    struct graphstats_t none;
+    ck_assert(getGraphStats(g, &none) == 0);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+}
+END_TEST
+
+/**
+ * @brief Memory reports for ARRAY and LINKED graphs, and the global memory limit.
+ */
+START_TEST(memoryTest) {
+    size_t baseline = graphMemoryInUse();
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    ck_assert(graphMemoryInUse() > baseline);
+    struct graphmemory_t mem;
+    ck_assert(graphMemoryUsage(g, &mem) == 1);
+    size_t slots = ARRAY_DIM_CUBE * ARRAY_DIM_CUBE * 2;
+    ck_assert(mem.topology == slots * sizeof(size_t));
+    ck_assert(mem.capacities == slots * sizeof(double) && mem.flows == slots * sizeof(double));
+    ck_assert(mem.labels == 0 && mem.features == 0);
+    ck_assert(mem.bookkeeping >= sizeof(struct graph_t));
+    ck_assert(mem.total == mem.topology + mem.capacities + mem.flows + mem.bookkeeping + mem.overhead);
+    //arraylen is set, so node lookups work
+    size_t id = 3;
+    struct graphops_t *gops = getOperations(g);
+    struct node_t *n = gops->getNode(&id, g);
+    ck_assert(n != NULL && n->nodeid == 3);
+    free(n);
+    destroyGraphops((void **)&gops);
+    id = ARRAY_DIM_CUBE * ARRAY_DIM_CUBE;
+    ck_assert(arrayGetNode(&id, g) == NULL);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    ck_assert(graphMemoryInUse() == baseline);
+
+    g = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    ck_assert(graphMemoryUsage(g, &mem) == 1);
+    size_t edges = LINK_NODE_COUNT * (LINK_NODE_COUNT - 1);
+    ck_assert(mem.capacities == edges * sizeof(double));
+    ck_assert(mem.topology == LINK_NODE_COUNT * sizeof(struct node_t) + edges * (sizeof(struct edge_t) - 2 * sizeof(double)));
+
+    //with the limit reached, allocations fail instead of growing the graph
+    setGraphMemoryLimit(graphMemoryInUse());
+    size_t extra = LINK_NODE_COUNT;
+    ck_assert(gops->addNode(&extra, g) == 0);
+    size_t u = 0, v = 1;
+    double cap = 1.0;
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 0);
+    ck_assert(initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims) == NULL);
+    ck_assert(getGraphMemoryLimit() > 0);
+    setGraphMemoryLimit(0);
+    ck_assert(gops->addNode(&extra, g) == 1);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    ck_assert(graphMemoryInUse() == baseline);
+    destroyDimensions((void **)&dims);
+}
+END_TEST
+
+/**
+ * @brief Test the HASHED implementation: lookups, removal with index repair, index growth and cloning.
+ */
+START_TEST(hashGraphTest) {
+    size_t baseline = graphMemoryInUse();
+    struct graph_t *g = initGraph(HASHED | DIRECTED | GENERIC, 0, NULL);
+    ck_assert(g != NULL && (g->gtype & HASHED) == HASHED);
+    struct graphops_t *gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    ck_assert(gops->nodeCount(g) == LINK_NODE_COUNT);
+    ck_assert(gops->edgeCount(g) == (LINK_NODE_COUNT - 1) * LINK_NODE_COUNT);
+    size_t u = 2, v = 4;
+    double cap = 0.0;
+    ck_assert(gops->getCapacity(&u, &v, &cap, g) == 1 && cap == LINK_CAP_VAL);
+    ck_assert(gops->addNode(&u, g) == 0);
+
+    //removing a node takes its edges and their reverses
+    ck_assert(gops->removeNode(&u, g) == 1);
+    ck_assert(gops->getNode(&u, g) == NULL);
+    ck_assert(gops->getEdge(&v, &u, g) == NULL);
+    ck_assert(gops->nodeCount(g) == LINK_NODE_COUNT - 1);
+    ck_assert(gops->edgeCount(g) == (LINK_NODE_COUNT - 2) * (LINK_NODE_COUNT - 1));
+    for (size_t i = 0; i < LINK_NODE_COUNT; i++) {
+        ck_assert((gops->getNode(&i, g) != NULL) == (i != u));
+    }
+
+    //grow well past the initial index
+    for (size_t i = 100; i < 1100; i++) ck_assert(gops->addNode(&i, g) == 1);
+    for (size_t i = 100; i < 1100; i += 2) ck_assert(gops->removeNode(&i, g) == 1);
+    for (size_t i = 100; i < 1100; i++) {
+        struct node_t *n = gops->getNode(&i, g);
+        ck_assert((n != NULL) == (i % 2 == 1));
+        if (n != NULL) ck_assert(n->nodeid == i);
+    }
+
+    struct graph_t *c = cloneGraph(g, CLONE_FULL);
+    ck_assert(c != NULL && (c->gtype & HASHED) == HASHED);
+    struct graphops_t *cops = getOperations(c);
+    ck_assert(cops->nodeCount(c) == gops->nodeCount(g));
+    u = 0;
+    ck_assert(cops->getCapacity(&u, &v, &cap, c) == 1 && cap == LINK_CAP_VAL);
+    destroyGraphops((void **)&cops);
+    clearGraph(c);
+    destroyGraph((void **)&c);
+
+    destroyGraphops((void **)&gops);
+    ck_assert(clearGraph(g) == 1);
+    destroyGraph((void **)&g);
+    ck_assert(graphMemoryInUse() == baseline);
+}
+END_TEST
+
+/**
+ * @brief Test ADAPT_AUTO graphs moving between LINKED and HASHED, and explicit migration.
+ */
+START_TEST(adaptiveTest) {
+    size_t baseline = graphMemoryInUse();
+    struct graphconfig_t *cfg = initConfig();
+    cfg->adapt = ADAPT_AUTO;
+    cfg->adaptnodes = 32;
+    struct graph_t *g = initGraphWithConfig(LINKED | UNDIRECTED | GENERIC, 0, NULL, cfg);
+    ck_assert(g != NULL);
+    struct graphops_t *gops = getOperations(g);
+    double cap = LINK_CAP_VAL;
+    for (size_t i = 0; i < 31; i++) ck_assert(gops->addNode(&i, g) == 1);
+    ck_assert((g->gtype & LINKED) == LINKED && getGraphMigrations(g) == 0);
+    size_t u = 30, v = 3;
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+    struct edge_t *e = gops->getEdge(&v, &u, g);
+    ck_assert(e != NULL);
+
+    //reaching the threshold moves the graph, and the same operations keep working
+    u = 31;
+    ck_assert(gops->addNode(&u, g) == 1);
+    ck_assert((g->gtype & HASHED) == HASHED && getGraphMigrations(g) == 1);
+    u = 30;
+    ck_assert(gops->getEdge(&u, &v, g) == e);
+    ck_assert(gops->nodeCount(g) == 32 && gops->edgeCount(g) == 1);
+
+    //shrinking to a quarter of the threshold moves it back
+    ck_assert(gops->removeEdge(&v, &u, g) == 1);
+    for (size_t i = 31; i >= 8; i--) ck_assert(gops->removeNode(&i, g) == 1);
+    ck_assert((g->gtype & LINKED) == LINKED && getGraphMigrations(g) == 2);
+    ck_assert(gops->nodeCount(g) == 8);
+    ck_assert(gops->edgeCount(g) == 0);
+
+    //a lookup-heavy workload moves a small graph
+    for (size_t i = 8; i < 20; i++) ck_assert(gops->addNode(&i, g) == 1);
+    for (size_t r = 0; r < ADAPT_LOOKUP_FACTOR * 20; r++) {
+        size_t id = r % 20;
+        ck_assert(gops->getNode(&id, g) != NULL);
+    }
+    u = 0;
+    v = 19;
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+    ck_assert((g->gtype & HASHED) == HASHED && getGraphMigrations(g) == 3);
+
+    struct graphmemory_t mem;
+    ck_assert(graphMemoryUsage(g, &mem) == 1);
+    ck_assert(mem.total == mem.topology + mem.capacities + mem.flows + mem.bookkeeping + mem.overhead);
+
+    //a migrated graph can still be snapshotted, and keeps moving while the snapshot is held
+    struct graph_t *snap = snapshotGraph(g);
+    ck_assert(snap != NULL && (snap->gtype & HASHED) == HASHED);
+    double scaled = 2 * LINK_CAP_VAL;
+    ck_assert(gops->setCapacity(&u, &v, &scaled, g) == 1);
+
+    //explicit moves, for graphs with or without ADAPT_AUTO
+    ck_assert(migrateGraph(g, LINKED) == 1 && (g->gtype & LINKED) == LINKED);
+    ck_assert(gops->getCapacity(&v, &u, &cap, g) == 1 && cap == scaled);
+    ck_assert(migrateGraph(snap, LINKED) == 0);
+    struct graphops_t *sops = getOperations(snap);
+    ck_assert(sops->getCapacity(&v, &u, &cap, snap) == 1 && cap == LINK_CAP_VAL);
+    destroyGraphops((void **)&sops);
+    ck_assert(releaseSnapshot((void **)&snap) == 1);
+    ck_assert(migrateGraph(g, ARRAY) == 0);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+
+    g = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    gops = getOperations(g);
+    fillLinkTestGraph(g, gops);
+    destroyGraphops((void **)&gops);
+    ck_assert(migrateGraph(g, HASHED) == 1);
+    gops = getOperations(g);
+    ck_assert(gops->nodeCount(g) == LINK_NODE_COUNT);
+    ck_assert(gops->edgeCount(g) == (LINK_NODE_COUNT - 1) * LINK_NODE_COUNT);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    destroyConfig((void **)&cfg);
+    ck_assert(graphMemoryInUse() == baseline);
+}
+END_TEST
+
+/**
+ * @brief Connect each node of a w x h SPATIAL ARRAY graph to its neighbors along x and y
+ */
+static void fillGridEdges(struct graph_t *g, struct graphops_t *gops, size_t w, size_t h) {
+    double cap = 1.0;
+    for (size_t p = 0; p < w * h; p++) {
+        size_t right = p + 1, down = p + w;
+        if (p % w + 1 < w) ck_assert(gops->addEdge(&p, &right, &cap, g) == 1);
+        if (down < w * h) ck_assert(gops->addEdge(&p, &down, &cap, g) == 1);
+    }
+}
+
+/**
+ * @brief Test the geometric and multilevel partitioners, and views of single parts.
+ */
+START_TEST(partitionTest) {
+    size_t baseline = graphMemoryInUse();
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    struct graphops_t *gops = getOperations(g);
+    fillGridEdges(g, gops, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+
+    //slabs of rows 0-2, 3-5, 6-7 and 8-9
+    struct partition_t *p = partitionGraph(g, PART_SLAB, 4, 1);
+    ck_assert(p != NULL);
+    ck_assert(p->parts[0].nodecount == 30 && p->parts[3].nodecount == 20);
+    ck_assert(p->parts[0].halocount == 10 && p->parts[0].halo[0] == 30);
+    ck_assert(p->parts[0].boundarycount == 10 && p->parts[1].halocount == 20);
+    ck_assert(p->parts[0].boundary[0] == 20 && p->parts[0].boundary[1] == 30);
+    ck_assert(p->parts[0].edgecount == 57 && p->cutedges == 30);
+    ck_assert(partOwner(p, 35) == 1 && partOwner(p, 100) == PART_NONE);
+
+    //the view reads its part and halo, and updates the edges it owns
+    struct graph_t *view = partitionView(p, 0);
+    ck_assert(view != NULL && isPartitionView(view));
+    struct graphops_t *vops = getOperations(view);
+    ck_assert(vops->addNode == NULL && vops->addEdge == NULL && vops->resetGraph == NULL);
+    ck_assert(vops->nodeCount(view) == 30 && vops->edgeCount(view) == 57);
+    size_t u = 25, v = 35;
+    double flow = 2.0, cap = 0.0;
+    ck_assert(vops->setFlow(&u, &v, &flow, view) == 1);
+    ck_assert(gops->getFlow(&u, &v, &flow, g) == 1 && flow == 2.0);
+    ck_assert(vops->getCapacity(&v, &u, &cap, view) == 1 && cap == 1.0);
+    u = 35;
+    v = 45;
+    ck_assert(vops->setFlow(&u, &v, &flow, view) == 0);
+    ck_assert(vops->getCapacity(&u, &v, &cap, view) == 0);
+    ck_assert(vops->getNode(&v, view) == NULL);
+    struct graphmemory_t mem;
+    ck_assert(graphMemoryUsage(view, &mem) == 1 && mem.topology == 0 && mem.capacities == 0);
+    //switching layers is seen by the view
+    size_t layer = arrayAddLayer(g, "view");
+    ck_assert(layer != LAYER_NONE && arraySelectLayer(g, layer) == 1);
+    u = 25;
+    v = 35;
+    cap = 3.0;
+    ck_assert(vops->setCapacity(&u, &v, &cap, view) == 1);
+    ck_assert(gops->getCapacity(&u, &v, &cap, g) == 1 && cap == 3.0);
+    ck_assert(arraySelectLayer(g, 0) == 1);
+    ck_assert(vops->getCapacity(&u, &v, &cap, view) == 1 && cap == 1.0);
+    destroyGraphops((void **)&vops);
+    ck_assert(clearGraph(view) == 1);
+    ck_assert(destroyGraph((void **)&view) == 1);
+    ck_assert(destroyPartition((void **)&p) == 1 && p == NULL);
+
+    //2 x 2 blocks of 5 x 5
+    p = partitionGraph(g, PART_BLOCK, 4, 1);
+    ck_assert(p != NULL);
+    for (size_t k = 0; k < 4; k++) {
+        ck_assert(p->parts[k].nodecount == 25 && p->parts[k].halocount == 10 && p->parts[k].boundarycount == 10);
+    }
+    ck_assert(p->parts[1].box[0] == 5 && p->parts[1].box[1] == 0 && p->parts[1].box[2] == 10);
+    ck_assert(p->cutedges == 20);
+    destroyPartition((void **)&p);
+
+    //columns 0-2, then the rest halved along y
+    p = partitionGraph(g, PART_BISECT, 3, 0);
+    ck_assert(p != NULL);
+    ck_assert(p->parts[0].nodecount == 30 && p->parts[1].nodecount == 35 && p->parts[2].nodecount == 35);
+    ck_assert(p->parts[0].halocount == 0 && partOwner(p, 99) == 2);
+    destroyPartition((void **)&p);
+    ck_assert(partitionGraph(g, PART_SLAB, ARRAY_DIM_CUBE + 1, 0) == NULL);
+
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    destroyDimensions((void **)&dims);
+
+    //two cliques joined by a single edge are split along it
+    g = initGraph(LINKED | UNDIRECTED | GENERIC, 0, NULL);
+    gops = getOperations(g);
+    for (size_t i = 0; i < 16; i++) {
+        u = 3 * i;
+        ck_assert(gops->addNode(&u, g) == 1);
+    }
+    for (size_t i = 0; i < 16; i++) {
+        for (size_t j = i + 1; j < 16; j++) {
+            u = 3 * i;
+            v = 3 * j;
+            if ((i < 8) == (j < 8)) ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+        }
+    }
+    u = 21;
+    v = 24;
+    ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+    p = partitionGraph(g, PART_MULTILEVEL, 2, 1);
+    ck_assert(p != NULL);
+    ck_assert(p->cutedges == 1 && p->parts[0].nodecount == 8 && p->parts[0].edgecount == 29);
+    ck_assert(p->parts[0].halocount == 1 && p->parts[0].halo[0] == 24);
+    ck_assert(partOwner(p, 0) != partOwner(p, 45) && partOwner(p, 1) == PART_NONE);
+    ck_assert(partitionGraph(g, PART_SLAB, 2, 0) == NULL);
+    //views follow the graph through a move between implementations and a change of its first node
+    view = partitionView(p, partOwner(p, 3));
+    vops = getOperations(view);
+    ck_assert(migrateGraph(g, HASHED) == 1);
+    u = 3;
+    v = 6;
+    ck_assert(vops->getCapacity(&u, &v, &cap, view) == 1 && cap == 1.0);
+    ck_assert(migrateGraph(g, LINKED) == 1);
+    u = ((struct node_t *)g->nodeImpl)->nodeid;
+    ck_assert(gops->removeNode(&u, g) == 1);
+    u = (u == 3) ? 9 : 3;
+    flow = 1.0;
+    ck_assert(vops->setFlow(&u, &v, &flow, view) == 1);
+    ck_assert(gops->getFlow(&u, &v, &flow, g) == 1 && flow == 1.0);
+    destroyGraphops((void **)&vops);
+    destroyGraph((void **)&view);
+    destroyPartition((void **)&p);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+
+    //larger grids are coarsened first, and stay balanced
+    dims = createDimensions(2, 3 * ARRAY_DIM_CUBE, 3 * ARRAY_DIM_CUBE);
+    g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    gops = getOperations(g);
+    fillGridEdges(g, gops, 3 * ARRAY_DIM_CUBE, 3 * ARRAY_DIM_CUBE);
+    p = partitionGraph(g, PART_MULTILEVEL, 4, 0);
+    ck_assert(p != NULL);
+    size_t maxpart = (p->nodecount * PART_IMBALANCE + 399) / 400;
+    for (size_t k = 0; k < 4; k++) ck_assert(p->parts[k].nodecount > 0 && p->parts[k].nodecount <= maxpart);
+    ck_assert(p->cutedges < 4 * 3 * ARRAY_DIM_CUBE);
+    destroyPartition((void **)&p);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    destroyDimensions((void **)&dims);
+    ck_assert(graphMemoryInUse() == baseline);
+}
+END_TEST
+
+/**
+ * @brief Max-flow solved over the parts of a partition agrees with the single-threaded solve.
+ */
+START_TEST(regionFlowTest) {
+    size_t baseline = graphMemoryInUse();
+    struct dimensions_t *dims = createDimensions(2, ARRAY_DIM_CUBE, ARRAY_DIM_CUBE);
+    struct graph_t *g = initGraph(ARRAY | DIRECTED | SPATIAL, 0, dims);
+    struct graphops_t *gops = getOperations(g);
+    size_t len = cartesianIndexLength(dims);
+    double *source = calloc(len, sizeof(double));
+    double *sink = calloc(len, sizeof(double));
+    unsigned char *side = calloc(len, sizeof(unsigned char));
+    unsigned char *regionside = calloc(len, sizeof(unsigned char));
+    //capacities and terminal weights from a fixed linear congruential sequence
+    unsigned int seed = 12345;
+    for (size_t u = 0; u < len; u++) {
+        size_t right = u + 1, down = u + ARRAY_DIM_CUBE;
+        seed = seed * 1103515245 + 12345;
+        double cap = (double)((seed >> 16) % 10);
+        if ((u + 1) % ARRAY_DIM_CUBE != 0) ck_assert(gops->addEdge(&u, &right, &cap, g) == 1);
+        seed = seed * 1103515245 + 12345;
+        cap = (double)((seed >> 16) % 10);
+        if (down < len) ck_assert(gops->addEdge(&u, &down, &cap, g) == 1);
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 4 == 0) source[u] = (double)((seed >> 20) % 20);
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 4 == 0) sink[u] = (double)((seed >> 20) % 20);
+    }
+    double flow = 0.0, regionflow = -1.0;
+    ck_assert(arrayMaxFlow(g, source, sink, side, &flow) == 1);
+    ck_assert(flow > 0.0);
+
+    enum PARTSCHEME schemes[3] = { PART_BLOCK, PART_BISECT, PART_MULTILEVEL };
+    for (size_t i = 0; i < 3; i++) {
+        struct partition_t *p = partitionGraph(g, schemes[i], 2 + i, 0);
+        ck_assert(p != NULL);
+        ck_assert(regionMaxFlow(g, p, source, sink, regionside, &regionflow) == 1);
+        ck_assert(regionflow == flow);
+        ck_assert(memcmp(side, regionside, len) == 0);
+        destroyPartition((void **)&p);
+    }
+    //the edge flows are stored in the graph; node 0 has no edges in, so it sends on no more than its source weight
+    double net = 0.0, val = 0.0;
+    size_t u = 0, v = 1;
+    ck_assert(gops->getFlow(&u, &v, &val, g) == 1);
+    net += val;
+    v = ARRAY_DIM_CUBE;
+    ck_assert(gops->getFlow(&u, &v, &val, g) == 1);
+    net += val;
+    ck_assert(net <= source[0]);
+
+    free(source);
+    free(sink);
+    free(side);
+    free(regionside);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    destroyDimensions((void **)&dims);
+    ck_assert(graphMemoryInUse() == baseline);
+}
+END_TEST
+
+/**
+ * @brief Test that a tiled SHARED_MMAP grid works through its operations while only part of it is mapped, and that its
+ * values are still in the file when the graph is reopened.
+ */
+START_TEST(mmapGraphTest) {
+    size_t baseline = graphMemoryInUse();
+    char path[] = "/tmp/graphtilesXXXXXX";
+    int fd = mkstemp(path);
+    ck_assert(fd >= 0);
+    close(fd);
+    struct graphconfig_t *cfg = initConfig();
+    cfg->mmappath = path;
+    cfg->tileside = 4;
+    cfg->tilecache = 2;
+    //10x10 nodes in 3x3 tiles, the last row and column of tiles only partly used
+    struct dimensions_t *dims = createDimensions(2, 10, 10);
+    size_t len = cartesianIndexLength(dims);
+    ck_assert(initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL | LABELED | SHARED_MMAP, 2, dims, cfg) == NULL);
+    struct graph_t *g = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL | SHARED_MMAP, 0, dims, cfg);
+    ck_assert(g != NULL);
+    ck_assert(isMmapGraph(g) == 1);
+    ck_assert(cloneGraph(g, CLONE_FULL) == NULL);
+    struct graphops_t *gops = getOperations(g);
+    ck_assert(gops->nodeCount(g) == len);
+    for (size_t u = 0; u < len; u++) {
+        size_t right = u + 1, down = u + 10;
+        double cap = (double)(u % 7);
+        if ((u + 1) % 10 != 0) ck_assert(gops->addEdge(&u, &right, &cap, g) == 1);
+        if (down < len) ck_assert(gops->addEdge(&u, &down, &cap, g) == 1);
+    }
+    const struct mmapdata_t *meta = (const struct mmapdata_t *)g->metaImpl;
+    ck_assert(meta->tilecount == 9);
+    ck_assert(meta->evictions > 0);
+    ck_assert(mmapMappedBytes(g) <= 2 * meta->tilebytes);
+    //undirected edges are found from either end, across tile borders
+    size_t u = 43, v = 44, w = 33;
+    double val = 0.0, flow = 1.5;
+    ck_assert(gops->getCapacity(&v, &u, &val, g) == 1);
+    ck_assert(val == (double)(43 % 7));
+    ck_assert(gops->setFlow(&u, &v, &flow, g) == 1);
+    ck_assert(gops->addFlow(&v, &u, &flow, g) == 1);
+    ck_assert(gops->getCapacity(&w, &u, &val, g) == 1);
+    ck_assert(val == (double)(33 % 7));
+    size_t ecount = 0;
+    struct edge_t *edges = gops->getEdges(&u, g);
+    for (struct edge_t *e = edges; e != NULL; e = e->next) ecount++;
+    ck_assert(ecount == 2);
+    destroyEdges((void **)&edges);
+    struct graphmemory_t report;
+    ck_assert(graphMemoryUsage(g, &report) == 1);
+    ck_assert(report.topology > 0 && report.flows > 0);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+
+    //the file keeps its values, but only for the same tile side
+    cfg->tileside = 5;
+    ck_assert(initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL | SHARED_MMAP, 0, dims, cfg) == NULL);
+    cfg->tileside = 4;
+    g = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL | SHARED_MMAP, 0, dims, cfg);
+    ck_assert(g != NULL);
+    gops = getOperations(g);
+    ck_assert(gops->getFlow(&u, &v, &val, g) == 1);
+    ck_assert(val == 3.0);
+    ck_assert(gops->removeEdge(&v, &u, g) == 1);
+    ck_assert(gops->getFlow(&u, &v, &val, g) == 0);
+    ck_assert(gops->resetGraph(g, NULL, NULL) == 1);
+    ck_assert(gops->getCapacity(&u, &w, &val, g) == 1);
+    ck_assert(val == 0.0);
+    destroyGraphops((void **)&gops);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+
+    unlink(path);
+    destroyDimensions((void **)&dims);
+    destroyConfig((void **)&cfg);
+    ck_assert(graphMemoryInUse() == baseline);
+}
+END_TEST
+
+/**
+ * @brief Test that a tiled SHARED_MMAP grid gives the same max-flow, cut and edge flows as the same grid in memory.
+ */
+START_TEST(mmapFlowTest) {
+    size_t baseline = graphMemoryInUse();
+    char path[] = "/tmp/graphtilesXXXXXX";
+    int fd = mkstemp(path);
+    ck_assert(fd >= 0);
+    close(fd);
+    struct graphconfig_t *cfg = initConfig();
+    cfg->mmappath = path;
+    cfg->tileside = 4;
+    cfg->tilecache = 2;
+    struct dimensions_t *dims = createDimensions(2, 10, 10);
+    size_t len = cartesianIndexLength(dims);
+    struct graph_t *tg = initGraphWithConfig(ARRAY | UNDIRECTED | SPATIAL | SHARED_MMAP, 0, dims, cfg);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    ck_assert(tg != NULL && g != NULL);
+    struct graphops_t *tops = getOperations(tg);
+    struct graphops_t *gops = getOperations(g);
+    double *source = calloc(len, sizeof(double));
+    double *sink = calloc(len, sizeof(double));
+    unsigned char *side = calloc(len, sizeof(unsigned char));
+    unsigned char *tside = calloc(len, sizeof(unsigned char));
+    unsigned int seed = 777;
+    for (size_t u = 0; u < len; u++) {
+        size_t right = u + 1, down = u + 10;
+        seed = seed * 1103515245u + 12345u;
+        double cap = (double)((seed >> 16) % 9 + 1);
+        if ((u + 1) % 10 != 0) {
+            ck_assert(tops->addEdge(&u, &right, &cap, tg) == 1);
+            ck_assert(gops->addEdge(&u, &right, &cap, g) == 1);
+        }
+        if (down < len) {
+            ck_assert(tops->addEdge(&u, &down, &cap, tg) == 1);
+            ck_assert(gops->addEdge(&u, &down, &cap, g) == 1);
+        }
+        if (u < 10) source[u] = 20.0;
+        if (u >= len - 10) sink[u] = 20.0;
+    }
+    double flow = 0.0, tflow = 0.0;
+    ck_assert(arrayMaxFlow(g, source, sink, side, &flow) == 1);
+    ck_assert(arrayMaxFlow(tg, source, sink, tside, &tflow) == 1);
+    ck_assert(flow > 0.0 && tflow == flow);
+    ck_assert(memcmp(side, tside, len) == 0);
+    for (size_t u = 0; u + 10 < len; u++) {
+        size_t down = u + 10;
+        double f = 0.0, tf = 0.0;
+        ck_assert(gops->getFlow(&u, &down, &f, g) == 1 && tops->getFlow(&u, &down, &tf, tg) == 1);
+        ck_assert(f == tf);
+    }
+    free(source);
+    free(sink);
+    free(side);
+    free(tside);
+    destroyGraphops((void **)&tops);
+    destroyGraphops((void **)&gops);
+    clearGraph(tg);
+    destroyGraph((void **)&tg);
+    clearGraph(g);
+    destroyGraph((void **)&g);
+    unlink(path);
+    destroyDimensions((void **)&dims);
+    destroyConfig((void **)&cfg);
+    ck_assert(graphMemoryInUse() == baseline);
+}
+END_TEST
+
+/**
+ * @brief Test that a grid with Morton or tiled ids gives the same cut as the row-major grid, through the whole-graph
+ * and the region solvers.
+ */
+START_TEST(nodeOrderTest) {
+    size_t baseline = graphMemoryInUse();
+    enum NODEORDER orders[3] = { ORDER_ROWMAJOR, ORDER_MORTON, ORDER_TILED };
+    double flows[3] = { 0.0, 0.0, 0.0 };
+    unsigned char *cuts[3] = { NULL, NULL, NULL };
+    size_t width = 13, height = 9;
+    for (size_t o = 0; o < 3; o++) {
+        struct dimensions_t *dims = createDimensions(2, width, height);
+        ck_assert(setDimensionOrder(dims, orders[o], 4) == 0);
+        struct graph_t *g = initGraph(ARRAY | DIRECTED | SPATIAL, 0, dims);
+        ck_assert(g != NULL);
+        struct graphops_t *gops = getOperations(g);
+        size_t len = cartesianIndexLength(dims);
+        ck_assert(gops->nodeCount(g) == len);
+        double *source = calloc(len, sizeof(double));
+        double *sink = calloc(len, sizeof(double));
+        unsigned char *side = calloc(len, sizeof(unsigned char));
+        unsigned char *regionside = calloc(len, sizeof(unsigned char));
+        cuts[o] = calloc(width * height, sizeof(unsigned char));
+        //the same capacities for the same coordinates, whatever the ids
+        unsigned int seed = 777;
+        size_t coords[2], next[2];
+        for (coords[1] = 0; coords[1] < height; coords[1]++) {
+            for (coords[0] = 0; coords[0] < width; coords[0]++) {
+                size_t u = 0, v = 0;
+                ck_assert(indexFromCartesian(dims, &u, coords) == 0);
+                for (size_t k = 0; k < 2; k++) {
+                    memcpy(next, coords, sizeof(next));
+                    next[k]++;
+                    seed = seed * 1103515245 + 12345;
+                    double cap = (double)((seed >> 16) % 10);
+                    if (indexFromCartesian(dims, &v, next) == 0 && next[k] < dims->dimarr[k]) {
+                        ck_assert(gops->addEdge(&u, &v, &cap, g) == 1);
+                    }
+                }
+                seed = seed * 1103515245 + 12345;
+                if ((seed >> 16) % 4 == 0) source[u] = (double)((seed >> 20) % 20);
+                seed = seed * 1103515245 + 12345;
+                if ((seed >> 16) % 4 == 0) sink[u] = (double)((seed >> 20) % 20);
+            }
+        }
+        ck_assert(arrayMaxFlow(g, source, sink, side, &flows[o]) == 1);
+        struct partition_t *p = partitionGraph(g, PART_BLOCK, 4, 0);
+        ck_assert(p != NULL);
+        double regionflow = -1.0;
+        ck_assert(regionMaxFlow(g, p, source, sink, regionside, &regionflow) == 1);
+        ck_assert(regionflow == flows[o]);
+        destroyPartition((void **)&p);
+        for (size_t u = 0; u < len; u++) {
+            if (cartesianFromIndex(&u, coords, dims) != 0) continue;
+            ck_assert(side[u] == regionside[u]);
+            cuts[o][coords[1] * width + coords[0]] = side[u];
+        }
+        free(source);
+        free(sink);
+        free(side);
+        free(regionside);
+        destroyGraphops((void **)&gops);
+        clearGraph(g);
+        destroyGraph((void **)&g);
+        destroyDimensions((void **)&dims);
+    }
+    ck_assert(flows[0] > 0.0 && flows[1] == flows[0] && flows[2] == flows[0]);
+    ck_assert(memcmp(cuts[0], cuts[1], width * height) == 0);
+    ck_assert(memcmp(cuts[0], cuts[2], width * height) == 0);
+    for (size_t o = 0; o < 3; o++) free(cuts[o]);
+    ck_assert(graphMemoryInUse() == baseline);
+}
+END_TEST
+
 /**
  * @brief Test basic operation for the link graph structure.
  */
@@ -132,7 +1780,29 @@ Suite * init_suite(void) {
     tc_core = tcase_create("Core");
 
     tcase_add_test(tc_core, arrayGraphTest);
+    tcase_add_test(tc_core, arrayNumaTest);
+    tcase_add_test(tc_core, arrayAllocTest);
     tcase_add_test(tc_core, linkGraphTest);
+    tcase_add_test(tc_core, allocatorTest);
+    tcase_add_test(tc_core, concurrentTest);
+    tcase_add_test(tc_core, atomicTest);
+    tcase_add_test(tc_core, snapshotTest);
+    tcase_add_test(tc_core, snapshotReadersTest);
+    tcase_add_test(tc_core, cloneTest);
+    tcase_add_test(tc_core, layerTest);
+    tcase_add_test(tc_core, maxflowTest);
+    tcase_add_test(tc_core, expansionTest);
+    tcase_add_test(tc_core, graphioTest);
+    tcase_add_test(tc_core, imageTest);
+    tcase_add_test(tc_core, statsTest);
+    tcase_add_test(tc_core, memoryTest);
+    tcase_add_test(tc_core, hashGraphTest);
+    tcase_add_test(tc_core, adaptiveTest);
+    tcase_add_test(tc_core, partitionTest);
+    tcase_add_test(tc_core, regionFlowTest);
+    tcase_add_test(tc_core, mmapGraphTest);
+    tcase_add_test(tc_core, mmapFlowTest);
+    tcase_add_test(tc_core, nodeOrderTest);
     suite_add_tcase(s, tc_core);
 
     return s;
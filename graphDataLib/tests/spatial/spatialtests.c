@@ -180,6 +180,153 @@ START_TEST(indexFailTest) {
 }
 END_TEST
 
+/**
+ * @brief Check that every coordinate of a grid maps to its own index and back, and that steps agree with the coordinates
+ * @param dims Three-dimensional grid with an order set
+ */
+static void checkOrder(struct dimensions_t *dims) {
+    size_t span = cartesianIndexLength(dims);
+    ck_assert(span >= dims->dimarr[0] * dims->dimarr[1] * dims->dimarr[2]);
+    unsigned char *seen = calloc(span, sizeof(unsigned char));
+    ck_assert(seen != NULL);
+    size_t coords[3], back[3], step[3];
+    for (coords[2] = 0; coords[2] < dims->dimarr[2]; coords[2]++) {
+        for (coords[1] = 0; coords[1] < dims->dimarr[1]; coords[1]++) {
+            for (coords[0] = 0; coords[0] < dims->dimarr[0]; coords[0]++) {
+                size_t idx = 0, next = 0, expected = 0;
+                ck_assert(indexFromCartesian(dims, &idx, coords) == 0);
+                ck_assert(idx < span && seen[idx] == 0);
+                seen[idx] = 1;
+                ck_assert(cartesianFromIndex(&idx, back, dims) == 0);
+                checkArrays(coords, back, 3);
+                for (size_t k = 0; k < 3; k++) {
+                    memcpy(step, coords, sizeof(step));
+                    step[k]++;
+                    if (step[k] < dims->dimarr[k]) {
+                        ck_assert(cartesianStep(dims, &idx, k, &next) == 0);
+                        indexFromCartesian(dims, &expected, step);
+                        ck_assert(next == expected);
+                    } else {
+                        ck_assert(cartesianStep(dims, &idx, k, &next) == 1);
+                        //row-major indexes only check the total, so a step off the end of a row wraps
+                        if (dims->order != ORDER_ROWMAJOR) ck_assert(indexFromCartesian(dims, &expected, step) == 1);
+                    }
+                }
+            }
+        }
+    }
+    //the padding ids are not nodes
+    for (size_t idx = 0; idx < span; idx++) {
+        ck_assert(cartesianFromIndex(&idx, back, dims) == (seen[idx] ? 0 : 1));
+    }
+    ck_assert(cartesianFromIndex(&span, back, dims) == 1);
+    free(seen);
+}
+
+/**
+ * @brief Test the Morton and tiled orders against row-major coordinates
+ */
+START_TEST(orderTest) {
+    size_t coord[2] = { 3, 1 };
+    size_t idx = 0;
+    struct dimensions_t *dims = createDimensions(2, 256, 256);
+    ck_assert(setDimensionOrder(dims, ORDER_MORTON, 0) == 0);
+    ck_assert(cartesianIndexLength(dims) == 65536);
+    //x bits on the even positions, y bits on the odd ones
+    ck_assert(indexFromCartesian(dims, &idx, coord) == 0);
+    ck_assert(idx == 7);
+    ck_assert(setDimensionOrder(dims, ORDER_ROWMAJOR, 0) == 0);
+    ck_assert(indexFromCartesian(dims, &idx, coord) == 0);
+    ck_assert(idx == 259);
+    destroyDimensions((void **)&dims);
+
+    dims = createDimensions(3, 5, 12, 3);
+    ck_assert(setDimensionOrder(dims, ORDER_MORTON, 0) == 0);
+    ck_assert(cartesianIndexLength(dims) == 8 * 16 * 4);
+    checkOrder(dims);
+    ck_assert(setDimensionOrder(dims, ORDER_TILED, 4) == 0);
+    ck_assert(cartesianIndexLength(dims) == 8 * 12 * 4);
+    checkOrder(dims);
+    ck_assert(setDimensionOrder(dims, ORDER_ROWMAJOR, 0) == 0);
+    checkOrder(dims);
+    destroyDimensions((void **)&dims);
+
+    //ids that would not fit
+    dims = createDimensions(3, (size_t)1 << 30, (size_t)1 << 30, 16);
+    ck_assert(setDimensionOrder(dims, ORDER_MORTON, 0) == 1);
+    ck_assert(dims->order == ORDER_ROWMAJOR);
+    destroyDimensions((void **)&dims);
+}
+END_TEST
+
+/**
+ * @brief Test the batch conversions against plain division, including grids just under the 32-bit limit of the
+ * reciprocal multipliers and indexes outside the bounds
+ */
+START_TEST(batchTest) {
+    struct dimensions_t *grids[5] = {
+        createDimensions(3, 7, 1, 13), createDimensions(3, 256, 256, 256), createDimensions(3, 1000, 3, 5),
+        createDimensions(3, 65537, 65535, 1), createDimensions(3, 1 << 20, 1 << 20, 3)
+    };
+    size_t count = 103;
+    size_t *idx = calloc(count, sizeof(size_t));
+    size_t *back = calloc(count, sizeof(size_t));
+    size_t *coords = calloc(3 * count, sizeof(size_t));
+    ck_assert(idx != NULL && back != NULL && coords != NULL);
+    for (size_t gi = 0; gi < 5; gi++) {
+        struct dimensions_t *dims = grids[gi];
+        ck_assert(dims != NULL);
+        size_t len = cartesianIndexLength(dims);
+        ck_assert((dims->divisor != NULL) == (gi < 4));
+        uint64_t seed = 99;
+        idx[0] = 0;
+        idx[1] = len - 1;
+        for (size_t i = 2; i < count; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            idx[i] = (size_t)((seed >> 11) % len);
+        }
+        ck_assert(cartesianFromIndices(dims, idx, count, coords) == 0);
+        for (size_t i = 0; i < count; i++) {
+            size_t rest = idx[i];
+            for (size_t k = 0; k < 3; k++) {
+                ck_assert(coords[i * 3 + k] == rest % dims->dimarr[k]);
+                rest /= dims->dimarr[k];
+            }
+        }
+        ck_assert(indicesFromCartesian(dims, coords, count, back) == 0);
+        checkArrays(idx, back, count);
+        //one index outside the bounds, in the vector part and in the tail
+        idx[5] = len;
+        ck_assert(cartesianFromIndices(dims, idx, count, coords) == 1);
+        idx[5] = 0;
+        idx[count - 1] = (size_t)-1;
+        ck_assert(cartesianFromIndices(dims, idx, count, coords) == 1);
+    }
+    for (size_t gi = 0; gi < 5; gi++) destroyDimensions((void **)&grids[gi]);
+
+    //other orders give the same results as the single conversions
+    struct dimensions_t *dims = createDimensions(3, 5, 12, 3);
+    ck_assert(setDimensionOrder(dims, ORDER_MORTON, 0) == 0);
+    size_t len = cartesianIndexLength(dims);
+    for (size_t i = 0; i < count; i++) idx[i] = (i * 37) % len;
+    int expected = 0;
+    for (size_t i = 0; i < count; i++) expected |= cartesianFromIndex(&idx[i], coords + 3 * i, dims);
+    ck_assert(cartesianFromIndices(dims, idx, count, coords) == expected);
+    for (size_t i = 0; i < count; i++) {
+        size_t single[3];
+        if (cartesianFromIndex(&idx[i], single, dims) == 0) checkArrays(single, coords + 3 * i, 3);
+    }
+    coords[0] = 5;
+    ck_assert(indicesFromCartesian(dims, coords, 1, back) == 1);
+    ck_assert(cartesianFromIndices(NULL, idx, count, coords) == -1);
+    ck_assert(indicesFromCartesian(dims, NULL, count, back) == -1);
+    destroyDimensions((void **)&dims);
+    free(idx);
+    free(back);
+    free(coords);
+}
+END_TEST
+
 START_TEST(badDataTests) {
     size_t idx1 = 1000005;
     size_t calcarr[3] = {0,0,0};
@@ -234,6 +381,8 @@ Suite * init_suite(void) {
     tcase_add_test(tc_core, coordFailTest);
     tcase_add_test(tc_core, indexTest);
     tcase_add_test(tc_core, indexFailTest);
+    tcase_add_test(tc_core, orderTest);
+    tcase_add_test(tc_core, batchTest);
     tcase_add_test(tc_core, badDataTests);
     suite_add_tcase(s, tc_core);
 
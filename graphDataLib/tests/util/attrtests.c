@@ -0,0 +1,196 @@
+/**
+ * Perform testing of functions in the util/attrstore.c file
+ *
+ */
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <graphInit.h>
+#include <util/crudops.h>
+#include <util/attrstore.h>
+#include <util/interntable.h>
+
+#define ATTR_DIM 10
+#define ATTR_FILL -1.0
+
+/**
+ * @brief Verify column creation, lookup, and single-value access on an ARRAY graph
+ */
+START_TEST(arrayColumnTest) {
+    struct dimensions_t *dims = createDimensions(2, ATTR_DIM, ATTR_DIM);
+    struct graph_t *g = initGraph(ARRAY | UNDIRECTED | SPATIAL, 0, dims);
+    ck_assert(g != NULL);
+    ck_assert(g->attrs == NULL);
+    ck_assert(attrFindColumn(g, "intensity", ATTR_NODE) == ATTR_NONE);
+
+    size_t intensity = attrColumnId(g, "intensity", ATTR_NODE, ATTR_FILL);
+    size_t weight = attrColumnId(g, "weight", ATTR_EDGE, 0.0);
+    ck_assert(intensity != ATTR_NONE);
+    ck_assert(weight != ATTR_NONE);
+    ck_assert(intensity != weight);
+    ck_assert(attrColumnId(g, "intensity", ATTR_NODE, 0.0) == intensity);
+    ck_assert(attrFindColumn(g, "intensity", ATTR_NODE) == intensity);
+    //same name in a different domain is a different column
+    ck_assert(attrFindColumn(g, "intensity", ATTR_EDGE) == ATTR_NONE);
+
+    //ARRAY columns are full length, and never grow
+    size_t len = 0;
+    double *col = attrColumn(g, intensity, &len);
+    ck_assert(col != NULL);
+    ck_assert(len == ATTR_DIM * ATTR_DIM);
+    for (size_t i = 0; i < len; i++) ck_assert(col[i] == ATTR_FILL);
+    ck_assert(attrColumn(g, weight, &len) != NULL);
+    ck_assert(len == ATTR_DIM * ATTR_DIM * 2);
+    ck_assert(setAttr(g, intensity, ATTR_DIM * ATTR_DIM, 1.0) == 0);
+
+    double val = 0.0;
+    ck_assert(setAttr(g, intensity, 5, 3.5) == 1);
+    ck_assert(getAttr(g, intensity, 5, &val) == 1);
+    ck_assert(val == 3.5);
+    ck_assert(setAttrByName(g, "weight", ATTR_EDGE, 7, 2.0) == 1);
+    ck_assert(getAttrByName(g, "weight", ATTR_EDGE, 7, &val) == 1);
+    ck_assert(val == 2.0);
+    ck_assert(getAttrByName(g, "missing", ATTR_EDGE, 7, &val) == 0);
+
+    //bulk access sees the individual writes
+    col = attrColumn(g, intensity, &len);
+    ck_assert(col[5] == 3.5);
+    ck_assert(attrColumnFill(g, intensity, 0.25) == 1);
+    double sum = 0.0;
+    for (size_t i = 0; i < len; i++) sum += col[i];
+    ck_assert(sum == 0.25 * len);
+
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+    destroyDimensions((void **)&dims);
+}
+END_TEST
+
+/**
+ * @brief Verify that columns of non-ARRAY graphs grow to hold the ids set, and that many columns can be created
+ */
+START_TEST(growColumnTest) {
+    struct graph_t *g = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    ck_assert(g != NULL);
+    size_t score = attrColumnId(g, "score", ATTR_NODE, ATTR_FILL);
+    ck_assert(setAttr(g, score, 10000, 4.0) == 1);
+    size_t len = 0;
+    double *col = attrColumn(g, score, &len);
+    ck_assert(len > 10000);
+    ck_assert(col[10000] == 4.0);
+    ck_assert(col[9999] == ATTR_FILL);
+    double val = 0.0;
+    ck_assert(getAttr(g, score, len + 5, &val) == 1);
+    ck_assert(val == ATTR_FILL);
+    ck_assert(getAttr(g, score + 1, 0, &val) == 0);
+    //ids too large for any column are refused rather than wrapping the length
+    ck_assert(setAttr(g, score, (size_t)1 << (8 * sizeof(size_t) - 1), 1.0) == 0);
+    ck_assert(setAttr(g, score, (size_t)-1, 1.0) == 0);
+    ck_assert(attrColumn(g, score, &len) == col);
+
+    char name[16];
+    for (int c = 0; c < 40; c++) {
+        snprintf(name, sizeof(name), "col%d", c);
+        size_t colid = attrColumnId(g, name, ATTR_EDGE, 0.0);
+        ck_assert(colid == (size_t)c + 1);
+        ck_assert(setAttr(g, colid, (size_t)c, (double)c) == 1);
+    }
+    ck_assert(getAttrByName(g, "col33", ATTR_EDGE, 33, &val) == 1);
+    ck_assert(val == 33.0);
+    ck_assert(attrColumnReserve(g, score, 50000) == 1);
+    ck_assert(attrColumn(g, score, &len)[10000] == 4.0);
+    ck_assert(len == 50000);
+
+    ck_assert(clearGraph(g) == 1);
+    ck_assert(destroyGraph((void **)&g) == 1);
+}
+END_TEST
+
+/**
+ * @brief Verify that names are interned to dense ids, survive table growth, and can be used to search feature lists
+ */
+START_TEST(internTest) {
+    struct interntable_t *t = initInternTable(NULL);
+    ck_assert(t != NULL);
+    ck_assert(internLookup(t, "alpha") == INTERN_NONE);
+    ck_assert(internName(t, "alpha") == 0);
+    ck_assert(internName(t, "beta") == 1);
+    ck_assert(internName(t, "alpha") == 0);
+
+    char name[16];
+    for (int i = 0; i < 200; i++) {
+        snprintf(name, sizeof(name), "name%d", i);
+        ck_assert(internName(t, name) == (size_t)i + 2);
+    }
+    ck_assert(t->count == 202);
+    ck_assert(2 * t->count <= t->slotcount);
+    for (int i = 0; i < 200; i++) {
+        snprintf(name, sizeof(name), "name%d", i);
+        ck_assert(internLookup(t, name) == (size_t)i + 2);
+    }
+    ck_assert(internLookup(t, "beta") == 1);
+    ck_assert(strcmp(internedName(t, 1), "beta") == 0);
+    ck_assert(internedName(t, 202) == NULL);
+    ck_assert(destroyInternTable((void **)&t) == 1);
+    ck_assert(t == NULL);
+
+    //graph tables hand out ids shared by feature lists and the attribute store
+    struct graph_t *g = initGraph(LINKED | DIRECTED | GENERIC, 0, NULL);
+    size_t weight = graphFeatureId(g, "weight");
+    size_t label = graphFeatureId(g, "label");
+    ck_assert(weight != INTERN_NONE && label != INTERN_NONE && weight != label);
+    struct feature_t *f1 = initFeature();
+    struct feature_t *f2 = initFeature();
+    f1->hashid = weight;
+    f1->val = 1.5;
+    f2->hashid = label;
+    f2->val = 3.0;
+    f1->next = f2;
+    f2->prev = f1;
+    ck_assert(findFeature(f1, label) == f2);
+    ck_assert(findFeature(f1, weight)->val == 1.5);
+    ck_assert(findFeature(f1, label + weight + 1) == NULL);
+    destroyFeatures((void **)&f1);
+
+    size_t colid = attrFeatureColumn(g, weight, ATTR_NODE, 0.0);
+    ck_assert(colid != ATTR_NONE);
+    ck_assert(attrColumnId(g, "weight", ATTR_NODE, 0.0) == colid);
+    ck_assert(attrFeatureColumn(g, label + weight + 1, ATTR_NODE, 0.0) == ATTR_NONE);
+    ck_assert(destroyGraph((void **)&g) == 1);
+}
+END_TEST
+
+Suite * init_suite(void) {
+    Suite * s;
+    TCase *tc_core;
+
+    s = suite_create("Attributes");
+
+    /* Core test case */
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, arrayColumnTest);
+    tcase_add_test(tc_core, growColumnTest);
+    tcase_add_test(tc_core, internTest);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+
+
+int main(void) {
+    int number_failed;
+    Suite * s;
+    SRunner *sr;
+
+    s = init_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -58,6 +58,87 @@ START_TEST(primeNumberTest) {
 }
 END_TEST
 
+/**
+ * @brief Verify WyHash64() edge cases, batch equivalence, and bucket spread for sequential labels
+ */
+START_TEST(hash64Test) {
+    ck_assert(WyHash64(NULL, 5, HASH_SEED64) == 0);
+    ck_assert(WyHash64("abc", 0, HASH_SEED64) == 0);
+    ck_assert(WyHash64("abc", 3, HASH_SEED64) == WyHash64("abc", 3, HASH_SEED64));
+    ck_assert(WyHash64("abc", 3, HASH_SEED64) != WyHash64("abd", 3, HASH_SEED64));
+    ck_assert(WyHash64("abc", 3, HASH_SEED64) != WyHash64("abc", 3, HASH_SEED64 + 1));
+
+    //keys of every length class, including the 16/48 byte boundaries, in a batch that is not a multiple of the lanes
+    const char *text = "The quick brown fox jumps over the lazy dog, then naps in the sun for a while.";
+    size_t n = 79;
+    const char *keys[79];
+    size_t lens[79];
+    uint64_t out[79];
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = (i % 13 == 5) ? NULL : text;
+        lens[i] = i;
+    }
+    WyHash64Batch(keys, lens, n, HASH_SEED64, out);
+    for (size_t i = 0; i < n; i++) {
+        ck_assert(out[i] == WyHash64(keys[i], lens[i], HASH_SEED64));
+        if (keys[i] == NULL || lens[i] == 0) ck_assert(out[i] == 0);
+    }
+
+    //sequential node labels should spread evenly over a power-of-two table
+    size_t buckets[256] = { 0 };
+    char label[32];
+    for (int i = 0; i < 256 * 64; i++) {
+        int len = snprintf(label, sizeof(label), "node%d", i);
+        buckets[WyHash64(label, (size_t)len, HASH_SEED64) & 255]++;
+    }
+    for (int i = 0; i < 256; i++) {
+        ck_assert(buckets[i] > 32 && buckets[i] < 96);
+    }
+}
+END_TEST
+
+/**
+ * @brief Verify the prime table, the segmented search, and the primality test against each other
+ */
+START_TEST(primeTableTest) {
+    //every tabled prime is the largest prime below its power of two, on both sides of the sieve limit
+    size_t prev = 0;
+    for (int k = 2; k < (int)(8 * sizeof(size_t)); k++) {
+        size_t pow2 = (size_t)1 << k;
+        size_t p = primeTableSize(pow2 / 2 + 1);
+        ck_assert(p > prev);
+        ck_assert(p < pow2);
+        ck_assert(isPrime(p));
+        for (size_t c = p + 1; c < pow2; c++) ck_assert(!isPrime(c));
+        ck_assert(maxPrimeBelow(pow2) == p);
+        prev = p;
+    }
+    ck_assert(primeTableSize(0) == 3);
+    ck_assert(primeTableSize(1000) == 1021);
+    ck_assert(primeTableSize(1021) == 1021);
+    ck_assert(primeTableSize(1022) == 2039);
+    ck_assert(primeTableSize(SIZE_MAX) == 0);
+
+    //segmented search across window boundaries agrees with the primality test
+    ck_assert(maxPrimeBelow(0) == 0);
+    ck_assert(maxPrimeBelow(2) == 0);
+    ck_assert(maxPrimeBelow(3) == 2);
+    for (size_t idx = 4; idx < 20000; idx += 7) {
+        size_t p = maxPrimeBelow(idx);
+        ck_assert(isPrime(p));
+        for (size_t c = p + 1; c < idx; c++) ck_assert(!isPrime(c));
+    }
+    //large queries (sieve and primality-test paths)
+    ck_assert(maxPrimeBelow(100000000) == 99999989);
+    ck_assert(maxPrimeBelow((size_t)1 << 32) == 4294967291UL);
+    ck_assert(maxPrimeBelow(((size_t)1 << 32) + 1) == 4294967291UL);
+    ck_assert(maxPrimeBelow((size_t)1 << 40) == ((size_t)1 << 40) - 87);
+    ck_assert(maxPrimeBelow(((size_t)1 << 50) + 1) == ((size_t)1 << 50) - 27);
+    ck_assert(!isPrime(3215031751UL));
+    ck_assert(isPrime(4294967291UL));
+}
+END_TEST
+
 Suite * init_suite(void) {
     Suite * s;
     TCase *tc_core;
@@ -68,6 +149,8 @@ Suite * init_suite(void) {
     tc_core = tcase_create("Core");
 
     tcase_add_test(tc_core, primeNumberTest);
+    tcase_add_test(tc_core, hash64Test);
+    tcase_add_test(tc_core, primeTableTest);
     suite_add_tcase(s, tc_core);
 
     return s;
@@ -0,0 +1,123 @@
+/**
+ * Perform testing of functions in the util/memops.c file
+ *
+ */
+
+#include <check.h>
+#include <stdlib.h>
+#include <util/memops.h>
+
+#define MEM_TEST_LEN 1000003
+#define MEM_LARGE_LEN (8 * MEM_MIN_CHUNK / sizeof(double) + 5)
+
+/**
+ * @brief Verify that the chunk ranges cover the full length with no gaps or overlaps.
+ */
+START_TEST(chunkRangeTest) {
+    size_t start = 0;
+    size_t end = 0;
+    for (size_t parts = 1; parts < 17; parts++) {
+        size_t next = 0;
+        for (size_t p = 0; p < parts; p++) {
+            ck_assert(memChunkRange(MEM_TEST_LEN, parts, p, &start, &end) == 1);
+            ck_assert(start == next);
+            ck_assert(end >= start);
+            ck_assert(end - start <= MEM_TEST_LEN / parts + 1);
+            next = end;
+        }
+        ck_assert(next == MEM_TEST_LEN);
+        ck_assert(memChunkRange(MEM_TEST_LEN, parts, parts, &start, &end) == 0);
+    }
+    ck_assert(memChunkRange(MEM_TEST_LEN, 0, 0, &start, &end) == 0);
+}
+END_TEST
+
+/**
+ * @brief Verify that zeroed allocations and parallel resets leave every element at zero.
+ */
+START_TEST(zeroTest) {
+    double *arr = (double *)allocZeroed(MEM_LARGE_LEN, sizeof(double));
+    ck_assert(arr != NULL);
+    for (size_t i = 0; i < MEM_LARGE_LEN; i++) {
+        ck_assert(arr[i] == 0.0);
+        arr[i] = (double)i + 1.0;
+    }
+    ck_assert(parallelZero(arr, MEM_LARGE_LEN, sizeof(double)) == 1);
+    for (size_t i = 0; i < MEM_LARGE_LEN; i++) {
+        ck_assert(arr[i] == 0.0);
+    }
+    //unaligned start and odd length
+    char *bytes = (char *)arr;
+    for (size_t i = 0; i < 1000; i++) bytes[i] = 1;
+    ck_assert(parallelZero(bytes + 3, 991, 1) == 1);
+    ck_assert(bytes[2] == 1);
+    ck_assert(bytes[3] == 0);
+    ck_assert(bytes[993] == 0);
+    ck_assert(bytes[994] == 1);
+    free(arr);
+
+    ck_assert(parallelZero(NULL, 10, sizeof(double)) == 0);
+    ck_assert(allocZeroed(0, sizeof(double)) == NULL);
+    ck_assert(memThreadCount(0) == 1);
+}
+END_TEST
+
+/**
+ * @brief Verify that each allocation strategy returns zeroed, writable memory and can be released.
+ */
+START_TEST(allocStrategyTest) {
+    enum ALLOCSTRATEGY strategies[5] = { ALLOC_MALLOC, ALLOC_ALIGNED, ALLOC_MMAP, ALLOC_THP, ALLOC_HUGETLB };
+    for (int s = 0; s < 5; s++) {
+        enum ALLOCSTRATEGY used = ALLOC_HUGETLB;
+        double *arr = (double *)allocArray(NULL, MEM_TEST_LEN, sizeof(double), strategies[s], &used);
+        ck_assert(arr != NULL);
+        ck_assert(used <= strategies[s]);
+        if (used != ALLOC_MALLOC) {
+            ck_assert(((size_t)arr % memPageSize(used)) == 0);
+        }
+        for (size_t i = 0; i < MEM_TEST_LEN; i++) {
+            ck_assert(arr[i] == 0.0);
+            arr[i] = 1.0;
+        }
+        ck_assert(freeArray(NULL, MEM_TEST_LEN, sizeof(double), used, (void **)&arr) == 1);
+        ck_assert(arr == NULL);
+    }
+    enum ALLOCSTRATEGY used = ALLOC_MALLOC;
+    ck_assert(allocArray(NULL, 0, sizeof(double), ALLOC_THP, &used) == NULL);
+    ck_assert(allocArray(NULL, (size_t)-1, sizeof(double), ALLOC_MALLOC, &used) == NULL);
+    ck_assert(memPageSize(ALLOC_THP) == MEM_HUGE_PAGE);
+}
+END_TEST
+
+Suite * init_suite(void) {
+    Suite * s;
+    TCase *tc_core;
+
+    s = suite_create("Memory");
+
+    /* Core test case */
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, chunkRangeTest);
+    tcase_add_test(tc_core, zeroTest);
+    tcase_add_test(tc_core, allocStrategyTest);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+
+
+int main(void) {
+    int number_failed;
+    Suite * s;
+    SRunner *sr;
+
+    s = init_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}